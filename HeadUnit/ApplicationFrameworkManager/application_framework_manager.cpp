@@ -122,6 +122,7 @@ void ApplicationFrameworkManager::registerApplication(int iviId,
     info.runId = 0;
     info.pid = 0;
     info.launchTime = QDateTime();
+    info.restartPending = false;
 
     m_applications[iviId] = info;
 }
@@ -333,6 +334,34 @@ void ApplicationFrameworkManager::resumeApp(int iviId)
     updateAppState(iviId, "active");
 }
 
+// Used by the compositor's watchdog when an app stops responding
+void ApplicationFrameworkManager::restartApp(int iviId)
+{
+    AppInfo *appInfo = getAppInfo(iviId);
+    if (!appInfo) {
+        logWarning(QString("Restart request for unknown IVI-ID: %1").arg(iviId));
+        return;
+    }
+
+    if (!appInfo->process || appInfo->process->state() == QProcess::NotRunning) {
+        logInfo(QString("%1 not running, launching instead").arg(appInfo->name));
+        launchApp(iviId);
+        return;
+    }
+
+    if (appInfo->restartPending) {
+        logInfo(QString("%1 is already restarting").arg(appInfo->name));
+        return;
+    }
+
+    // killProcess() waits for the exit; a hung app gets SIGKILL right away
+    // and is launched again from onProcessFinished()
+    logWarning(QString("Restarting %1 (PID: %2)").arg(appInfo->name).arg(appInfo->pid));
+    appInfo->restartPending = true;
+    updateAppState(iviId, "restarting");
+    appInfo->process->kill();
+}
+
 QString ApplicationFrameworkManager::getAppState(int iviId)
 {
     AppInfo *appInfo = getAppInfo(iviId);
@@ -454,22 +483,15 @@ QProcessEnvironment ApplicationFrameworkManager::createAppEnvironment(int iviId)
     env.insert("QT_LOGGING_RULES", "qt.qpa.wayland*=false");
     // env.insert("QT_DEBUG_PLUGINS", "1");  // Uncomment for debug
 
-    if(iviId == 1002 || iviId == 1004){
-        env.insert("QT_IM_MODULE", QByteArray("qtvirtualkeyboard"));
-
-    }
+    // Apps must not load a keyboard of their own: text input is served by
+    // the compositor's keyboard over the wayland text-input protocol
+    env.remove("QT_IM_MODULE");
 
     logInfo(QString("Environment for %1 (IVI-ID: %2):").arg(getAppInfo(iviId)->name).arg(iviId));
     logInfo(QString("  XDG_RUNTIME_DIR: %1").arg(xdgRuntime));
     logInfo(QString("  WAYLAND_DISPLAY: wayland-1"));
     logInfo(QString("  QT_IVI_SURFACE_ID: %1").arg(iviId));
     logInfo(QString("  QT_QPA_PLATFORM: wayland"));
-    if(iviId == 1002){
-        logInfo(QString("QT_IM_MODULE set for MediaPlayer"));
-    }
-    if(iviId == 1004){
-        logInfo(QString("QT_IM_MODULE set for Navigation"));
-    }
 
     return env;
 }
@@ -503,6 +525,13 @@ void ApplicationFrameworkManager::onProcessFinished(int exitCode, QProcess::Exit
 
             updateAppState(appInfo.iviId, "stopped");
             appInfo.pid = 0;
+
+            if (appInfo.restartPending) {
+                appInfo.restartPending = false;
+                const int iviId = appInfo.iviId;
+                // Let QProcess finish its own handling before it is reused
+                QTimer::singleShot(0, this, [this, iviId]() { launchApp(iviId); });
+            }
             break;
         }
     }
@@ -689,6 +718,13 @@ void ApplicationLifecycleDBus::ResumeApp(int iviId)
     }
 }
 
+void ApplicationLifecycleDBus::RestartApp(int iviId)
+{
+    if (m_manager) {
+        m_manager->restartApp(iviId);
+    }
+}
+
 void ApplicationLifecycleDBus::LaunchInitialApps()
 {
     if (m_manager) {
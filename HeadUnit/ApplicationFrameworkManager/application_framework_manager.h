@@ -26,12 +26,14 @@ struct AppInfo {
     int runId;
     qint64 pid;
     QDateTime launchTime;
+    bool restartPending;
 
     AppInfo()
         : iviId(0)
         , process(nullptr)
         , runId(0)
         , pid(0)
+        , restartPending(false)
     {}
 };
 
@@ -52,6 +54,7 @@ public Q_SLOTS:
     Q_NOREPLY void TerminateApp(int iviId);
     Q_NOREPLY void PauseApp(int iviId);
     Q_NOREPLY void ResumeApp(int iviId);
+    Q_NOREPLY void RestartApp(int iviId);
     Q_NOREPLY void LaunchInitialApps();  // NEW
 
     QString GetAppState(int iviId);
@@ -88,6 +91,7 @@ public:
     void terminateApp(int iviId);
     void pauseApp(int iviId);
     void resumeApp(int iviId);
+    void restartApp(int iviId);
     QString getAppState(int iviId);
     QList<int> getRunningApps();
     void notifyAppConnected(int iviId);
@@ -0,0 +1,270 @@
+// audio_focus_manager.cpp
+
+#include "audio_focus_manager.h"
+#include <QDBusConnection>
+#include <QDBusError>
+#include <QDBusServiceWatcher>
+#include <QDebug>
+
+// ============================================================================
+// AudioFocusManager Implementation
+// ============================================================================
+
+AudioFocusManager::AudioFocusManager(QObject *parent)
+    : QObject(parent)
+    , m_dbusAdaptor(nullptr)
+    , m_watcher(new QDBusServiceWatcher(QString(), QDBusConnection::sessionBus(),
+                                        QDBusServiceWatcher::WatchForUnregistration, this))
+    , m_nextOrder(1)
+{
+    connect(m_watcher, &QDBusServiceWatcher::serviceUnregistered,
+            this, &AudioFocusManager::onServiceUnregistered);
+
+    registerDBusService();
+}
+
+AudioFocusManager::~AudioFocusManager()
+{
+}
+
+void AudioFocusManager::registerDBusService()
+{
+    m_dbusAdaptor = new AudioFocusDBus(this);
+    QDBusConnection sessionBus = QDBusConnection::sessionBus();
+
+    if (!sessionBus.registerService("com.headunit.AudioFocus")) {
+        qWarning() << "[AudioFocus] Failed to register D-Bus service:"
+                   << sessionBus.lastError().message();
+        return;
+    }
+
+    if (!sessionBus.registerObject("/com/headunit/AudioFocus", this)) {
+        qWarning() << "[AudioFocus] Failed to register D-Bus object:"
+                   << sessionBus.lastError().message();
+        return;
+    }
+
+    qInfo() << "[AudioFocus] D-Bus service registered: com.headunit.AudioFocus";
+}
+
+int AudioFocusManager::streamPriority(const QString &stream)
+{
+    // No client plays system or navigation audio yet
+    if (stream == "system") return 30;      // chimes, warnings
+    if (stream == "navigation") return 20;  // turn-by-turn prompts
+    if (stream == "media") return 10;
+    return 5;
+}
+
+QString AudioFocusManager::requestFocus(const QString &clientId, const QString &stream,
+                                        const QString &focusType, qint64 requestTimeUs,
+                                        const QString &busName)
+{
+    if (focusType != "gain" && focusType != "transient" && focusType != "transient_may_duck") {
+        qWarning() << "[AudioFocus] Invalid focus type from" << clientId << ":" << focusType;
+        return "denied";
+    }
+
+    // Exclusive holders of higher priority cannot be interrupted. Checked
+    // before touching the stack so a denied re-request keeps what it held.
+    int existing = -1;
+    for (int i = 0; i < m_stack.size(); ++i) {
+        if (m_stack[i].clientId == clientId) {
+            existing = i;
+            break;
+        }
+    }
+    const int topIndex = (existing == 0) ? 1 : 0;
+    if (topIndex < m_stack.size()) {
+        const AudioFocusEntry &top = m_stack[topIndex];
+        if (top.priority > streamPriority(stream) && top.focusType != "transient_may_duck") {
+            qInfo() << "[AudioFocus] Denied" << clientId << "- held exclusively by" << top.clientId;
+            return "denied";
+        }
+    }
+
+    // A re-request replaces the previous entry of the same client
+    QString previousState;
+    if (existing >= 0) {
+        previousState = m_stack[existing].state;
+        m_stack.removeAt(existing);
+    }
+
+    AudioFocusEntry entry;
+    entry.clientId = clientId;
+    entry.busName = busName;
+    entry.stream = stream;
+    entry.focusType = focusType;
+    entry.state = previousState;
+    entry.priority = streamPriority(stream);
+    entry.requestTimeUs = requestTimeUs;
+    entry.order = m_nextOrder++;
+
+    if (!busName.isEmpty()) {
+        m_watcher->addWatchedService(busName);
+    }
+
+    // Highest priority first; the newest request wins among equals
+    int pos = 0;
+    while (pos < m_stack.size() && m_stack[pos].priority > entry.priority) {
+        ++pos;
+    }
+    m_stack.insert(pos, entry);
+
+    qInfo() << "[AudioFocus]" << clientId << "requested" << focusType
+            << "on stream" << stream << "(priority" << entry.priority << ")";
+
+    reevaluate(requestTimeUs);
+
+    const QString state = focusState(clientId);
+    return state.isEmpty() ? QString("loss") : state;
+}
+
+void AudioFocusManager::abandonFocus(const QString &clientId)
+{
+    for (int i = 0; i < m_stack.size(); ++i) {
+        if (m_stack[i].clientId == clientId) {
+            const qint64 requestTimeUs = m_stack[i].requestTimeUs;
+            m_stack.removeAt(i);
+            qInfo() << "[AudioFocus]" << clientId << "abandoned focus";
+            reevaluate(requestTimeUs);
+            return;
+        }
+    }
+}
+
+void AudioFocusManager::onServiceUnregistered(const QString &busName)
+{
+    m_watcher->removeWatchedService(busName);
+
+    qint64 requestTimeUs = 0;
+    bool removed = false;
+    for (int i = m_stack.size() - 1; i >= 0; --i) {
+        if (m_stack[i].busName == busName) {
+            qInfo() << "[AudioFocus]" << m_stack[i].clientId << "left the bus, dropping its focus";
+            requestTimeUs = qMax(requestTimeUs, m_stack[i].requestTimeUs);
+            m_stack.removeAt(i);
+            removed = true;
+        }
+    }
+
+    if (removed) {
+        reevaluate(requestTimeUs);
+    }
+}
+
+QString AudioFocusManager::focusOwner() const
+{
+    return m_stack.isEmpty() ? QString() : m_stack.first().clientId;
+}
+
+QString AudioFocusManager::focusState(const QString &clientId) const
+{
+    for (const auto &entry : m_stack) {
+        if (entry.clientId == clientId) {
+            return entry.state;
+        }
+    }
+    return QString();
+}
+
+void AudioFocusManager::reevaluate(qint64 requestTimeUs)
+{
+    if (m_stack.isEmpty()) {
+        return;
+    }
+
+    AudioFocusEntry &top = m_stack.first();
+    setEntryState(top, "gain", kDuckReleaseMs, requestTimeUs);
+    const QString topType = top.focusType;
+
+    QStringList dropped;
+    for (int i = 1; i < m_stack.size(); ++i) {
+        AudioFocusEntry &entry = m_stack[i];
+        if (topType == "transient_may_duck") {
+            setEntryState(entry, "duck", kDuckAttackMs, requestTimeUs);
+        } else if (topType == "transient") {
+            setEntryState(entry, "loss_transient", kDuckAttackMs, requestTimeUs);
+        } else {
+            setEntryState(entry, "loss", kDuckAttackMs, requestTimeUs);
+            dropped.append(entry.clientId);
+        }
+    }
+
+    // Permanent loss: the client has to request focus again
+    for (const QString &clientId : std::as_const(dropped)) {
+        for (int i = 0; i < m_stack.size(); ++i) {
+            if (m_stack[i].clientId == clientId) {
+                m_stack.removeAt(i);
+                break;
+            }
+        }
+    }
+}
+
+void AudioFocusManager::setEntryState(AudioFocusEntry &entry, const QString &state,
+                                      int rampMs, qint64 requestTimeUs)
+{
+    if (entry.state == state) {
+        return;
+    }
+
+    const bool wasSilent = entry.state.isEmpty();
+    entry.state = state;
+
+    // Fresh grants start at full gain, no ramp needed
+    const int ramp = (state == "gain" && wasSilent) ? 0 : rampMs;
+    const double gain = (state == "duck") ? kDuckGain : (state == "gain" ? 1.0 : 0.0);
+
+    qInfo() << "[AudioFocus]" << entry.clientId << "->" << state
+            << "gain:" << gain << "ramp:" << ramp << "ms";
+
+    if (m_dbusAdaptor) {
+        emit m_dbusAdaptor->FocusChanged(entry.clientId, state, gain, ramp, requestTimeUs);
+    }
+}
+
+// ============================================================================
+// AudioFocusDBus Implementation
+// ============================================================================
+
+AudioFocusDBus::AudioFocusDBus(QObject *parent)
+    : QDBusAbstractAdaptor(parent)
+{
+    m_manager = qobject_cast<AudioFocusManager*>(parent);
+    setAutoRelaySignals(true);
+}
+
+QString AudioFocusDBus::RequestFocus(const QString &clientId, const QString &stream,
+                                     const QString &focusType, qlonglong requestTimeUs,
+                                     const QDBusMessage &message)
+{
+    if (m_manager) {
+        return m_manager->requestFocus(clientId, stream, focusType, requestTimeUs,
+                                       message.service());
+    }
+    return "denied";
+}
+
+void AudioFocusDBus::AbandonFocus(const QString &clientId)
+{
+    if (m_manager) {
+        m_manager->abandonFocus(clientId);
+    }
+}
+
+QString AudioFocusDBus::GetFocusOwner()
+{
+    if (m_manager) {
+        return m_manager->focusOwner();
+    }
+    return QString();
+}
+
+QString AudioFocusDBus::GetFocusState(const QString &clientId)
+{
+    if (m_manager) {
+        return m_manager->focusState(clientId);
+    }
+    return QString();
+}
@@ -0,0 +1,111 @@
+// audio_focus_manager.h
+
+#ifndef AUDIO_FOCUS_MANAGER_H
+#define AUDIO_FOCUS_MANAGER_H
+
+#include <QObject>
+#include <QList>
+#include <QMap>
+#include <QString>
+#include <QDBusAbstractAdaptor>
+#include <QDBusMessage>
+
+class QDBusServiceWatcher;
+
+/**
+ * Audio focus request held by one client. MediaPlayer is the only one today;
+ * the navigation and system streams are ranked for prompts and chimes that
+ * do not exist yet.
+ */
+struct AudioFocusEntry {
+    QString clientId;
+    QString busName;        // unique name of the requester, watched for crashes
+    QString stream;
+    QString focusType;      // "gain", "transient", "transient_may_duck"
+    QString state;          // "gain", "duck", "loss_transient", "loss"
+    int priority;
+    qint64 requestTimeUs;   // CLOCK_MONOTONIC of the original request
+    quint64 order;
+
+    AudioFocusEntry()
+        : priority(0)
+        , requestTimeUs(0)
+        , order(0)
+    {}
+};
+
+/**
+ * D-Bus Adaptor for Audio Focus Interface
+ */
+class AudioFocusDBus : public QDBusAbstractAdaptor
+{
+    Q_OBJECT
+    Q_CLASSINFO("D-Bus Interface", "com.headunit.AudioFocus")
+
+public:
+    explicit AudioFocusDBus(QObject *parent);
+
+public Q_SLOTS:
+    QString RequestFocus(const QString &clientId, const QString &stream,
+                         const QString &focusType, qlonglong requestTimeUs,
+                         const QDBusMessage &message);
+    Q_NOREPLY void AbandonFocus(const QString &clientId);
+    QString GetFocusOwner();
+    QString GetFocusState(const QString &clientId);
+
+Q_SIGNALS:
+    void FocusChanged(const QString &clientId, const QString &state,
+                      double duckGain, int rampMs, qlonglong requestTimeUs);
+
+private:
+    class AudioFocusManager *m_manager;
+};
+
+/**
+ * Arbitrates audio focus between streams by priority.
+ *
+ * The top of the stack always holds "gain". Everyone below it is ducked,
+ * paused or dropped depending on the focus type the top holder asked for.
+ * Ducking is only announced here (target gain + ramp length); the ramp
+ * itself runs in each client's mixer so it is sample accurate.
+ *
+ * The bus name of every requester is watched, so a client that exits or
+ * crashes without abandoning is taken off the stack.
+ */
+class AudioFocusManager : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit AudioFocusManager(QObject *parent = nullptr);
+    ~AudioFocusManager();
+
+    QString requestFocus(const QString &clientId, const QString &stream,
+                         const QString &focusType, qint64 requestTimeUs,
+                         const QString &busName = QString());
+    void abandonFocus(const QString &clientId);
+    QString focusOwner() const;
+    QString focusState(const QString &clientId) const;
+
+    static int streamPriority(const QString &stream);
+
+private slots:
+    void onServiceUnregistered(const QString &busName);
+
+private:
+    void registerDBusService();
+    void reevaluate(qint64 requestTimeUs);
+    void setEntryState(AudioFocusEntry &entry, const QString &state,
+                       int rampMs, qint64 requestTimeUs);
+
+    QList<AudioFocusEntry> m_stack;   // sorted, highest priority first
+    AudioFocusDBus *m_dbusAdaptor;
+    QDBusServiceWatcher *m_watcher;
+    quint64 m_nextOrder;
+
+    static constexpr double kDuckGain = 0.2;     // ~ -14 dB
+    static constexpr int kDuckAttackMs = 150;
+    static constexpr int kDuckReleaseMs = 600;
+};
+
+#endif // AUDIO_FOCUS_MANAGER_H
@@ -1,5 +1,6 @@
 // main.cpp (for AFM standalone executable)
 #include "application_framework_manager.h"
+#include "audio_focus_manager.h"
 #include <QCoreApplication>
 #include <QDebug>
 
@@ -13,10 +14,12 @@ int main(int argc, char *argv[])
     qInfo() << "================================================";
 
     ApplicationFrameworkManager afm;
+    AudioFocusManager audioFocus;
 
     qInfo() << "[AFM] Service ready and listening on D-Bus";
     qInfo() << "[AFM] Service name: com.headunit.AppLifecycle";
     qInfo() << "[AFM] Object path: /com/headunit/AppLifecycle";
+    qInfo() << "[AFM] Audio focus: com.headunit.AudioFocus";
     qInfo() << "================================================";
 
     return app.exec();
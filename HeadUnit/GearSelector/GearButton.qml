@@ -7,6 +7,7 @@ Button {
     property string gear: ""
     property string label: ""
     property bool isActive: false
+    property bool isPending: false      // requested, not yet confirmed by the vehicle
 
     width: 55
     height: 70
@@ -19,14 +20,17 @@ Button {
             return "#2d2d2d"
         }
         radius: 8
+        opacity: isPending ? 0.6 : 1.0
         border.width: isActive ? 2 : 1
         border.color: isActive ? theme.accentColor : "#404040"
 
         Behavior on color {
+            enabled: !theme.transitioning
             ColorAnimation { duration: 200 }
         }
 
         Behavior on border.color {
+            enabled: !theme.transitioning
             ColorAnimation { duration: 200 }
         }
     }
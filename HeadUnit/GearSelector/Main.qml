@@ -32,6 +32,7 @@ Window {
                     label: "Park"
                     width: parent.width
                     isActive: gearHandler.currentGear === "P"
+                    isPending: isActive && gearHandler.gearPending
                     onClicked: gearHandler.setGear("P")
                 }
 
@@ -41,6 +42,7 @@ Window {
                     label: "Reverse"
                     width: parent.width
                     isActive: gearHandler.currentGear === "R"
+                    isPending: isActive && gearHandler.gearPending
                     onClicked: gearHandler.setGear("R")
                 }
 
@@ -50,6 +52,7 @@ Window {
                     label: "Neutral"
                     width: parent.width
                     isActive: gearHandler.currentGear === "N"
+                    isPending: isActive && gearHandler.gearPending
                     onClicked: gearHandler.setGear("N")
                 }
 
@@ -59,6 +62,7 @@ Window {
                     label: "Drive"
                     width: parent.width
                     isActive: gearHandler.currentGear === "D"
+                    isPending: isActive && gearHandler.gearPending
                     onClicked: gearHandler.setGear("D")
                 }
             }
@@ -85,6 +89,7 @@ Window {
                             border.color: "#666666"
 
                             Behavior on color {
+                                enabled: !theme.transitioning
                                 ColorAnimation { duration: 200 }
                             }
                         }
@@ -1,14 +1,72 @@
 // Updated gs_handler.cpp for PiRacer integration
 #include "gs_handler.h"
 #include <QDebug>
-#include <QDBusReply>
+#include <QDBusConnectionInterface>
+#include <QDBusPendingCallWatcher>
+#include <QDBusPendingReply>
+#include <QDBusUnixFileDescriptor>
+#include <cmath>
+
+namespace {
+
+// Native vehicle data service (VehicleData/), preferred when it runs
+const char kVehicleDataService[] = "com.headunit.VehicleData";
+const char kVehicleDataPath[] = "/com/headunit/VehicleData";
+
+// Python dashboard service, used when the native one is not running
+const char kDashboardService[] = "com.piracer.dashboard";
+const char kDashboardPath[] = "/com/piracer/dashboard";
+
+const QStringList kValidGears = {"P", "R", "N", "D"};
+
+// Speed is only shown, so the native service sends it at most 10 times a
+// second and only when it moved by more than 0.5 km/h (speed is in cm/s).
+// Gear changes come without limit, they confirm gear requests.
+constexpr double kSpeedRateHz = 10.0;
+constexpr double kSpeedDeadband = 13.9;
+
+// Once a speed update arrives, speed is read from the telemetry channel on
+// every frame until it has held still for a second; the subscription wakes
+// the reader up again when it moves. 0.1 cm/s hides float noise.
+constexpr int kSteadyFrames = 30;
+constexpr double kSpeedEpsilon = 0.1;
+
+// Battery level is estimated once a second; half a percent is the least
+// the display shows
+constexpr double kBatteryRateHz = 1.0;
+constexpr double kBatteryDeadband = 0.5;
+
+}
 
 GS_Handler::GS_Handler(QObject *parent)
     : QObject{parent}
     , m_currentGear("P")
+    , m_confirmedGear("P")
+    , m_gearSerial(0)
+    , m_gearTimeout(new QTimer(this))
+    , m_gearTimeouts(0)
+    , m_gearFailures(0)
+    , m_currentSpeed(0.0)
+    , m_batteryLevel(0.0)
     , m_piracerInterface(nullptr)
     , m_dbusConnected(false)
+    , m_telemetryTimer(new QTimer(this))
+    , m_speedSequence(0)
+    , m_steadyFrames(0)
 {
+    bool ok = false;
+    const int pollMs = qEnvironmentVariableIntValue("HEADUNIT_TELEMETRY_POLL_MS", &ok);
+    m_telemetryTimer->setInterval(ok && pollMs > 0 ? pollMs : 33);
+    connect(m_telemetryTimer, &QTimer::timeout, this, &GS_Handler::pollTelemetry);
+
+    const int gearTimeoutMs = qEnvironmentVariableIntValue("HEADUNIT_GEAR_TIMEOUT_MS", &ok);
+    m_gearTimeout->setSingleShot(true);
+    m_gearTimeout->setInterval(ok && gearTimeoutMs > 0 ? gearTimeoutMs : 1000);
+    connect(m_gearTimeout, &QTimer::timeout, this, [this]() {
+        m_gearTimeouts++;
+        failGearRequest(QStringLiteral("not confirmed within %1 ms").arg(m_gearTimeout->interval()));
+    });
+
     setupDBusConnection();
 }
 
@@ -31,71 +89,9 @@ void GS_Handler::setupDBusConnection()
     
     qDebug() << "Successfully connected to D-Bus session bus";
 
-    // Connect to PiRacer dashboard service
-    m_piracerInterface = new QDBusInterface(
-        "com.piracer.dashboard",           // Service name from your Python service
-        "/com/piracer/dashboard",          // Path
-        "com.piracer.dashboard",           // Interface
-        sessionBus,
-        this
-    );
+    // Gear, speed and battery come from the native service if it is running
+    selectVehicleService();
 
-    if (!m_piracerInterface->isValid()) {
-        qWarning() << "PiRacer dashboard service not available:" 
-                   << sessionBus.lastError().message();
-        // Try to continue anyway - service might start later
-    } else {
-        qDebug() << "Connected to PiRacer dashboard service";
-        m_dbusConnected = true;
-        
-        // Get current gear from PiRacer
-        syncGearFromPiRacer();
-    }
-
-    // Connect to gear change signals from PiRacer
-    bool connected = sessionBus.connect(
-        "com.piracer.dashboard",
-        "/com/piracer/dashboard",
-        "com.piracer.dashboard",
-        "GearChanged",
-        this,
-        SLOT(handlePiRacerGearChange(QString))
-    );
-    
-    if (connected) {
-        qDebug() << "Connected to PiRacer GearChanged signal";
-    } else {
-        qWarning() << "Failed to connect to GearChanged signal";
-    }
-    
-    // Connect to speed changes to display in UI
-    connected = sessionBus.connect(
-        "com.piracer.dashboard",
-        "/com/piracer/dashboard",
-        "com.piracer.dashboard",
-        "SpeedChanged",
-        this,
-        SLOT(handleSpeedChange(double))
-    );
-    
-    if (connected) {
-        qDebug() << "Connected to PiRacer SpeedChanged signal";
-    }
-    
-    // Connect to battery changes
-    connected = sessionBus.connect(
-        "com.piracer.dashboard",
-        "/com/piracer/dashboard",
-        "com.piracer.dashboard",
-        "BatteryChanged",
-        this,
-        SLOT(handleBatteryChange(double))
-    );
-    
-    if (connected) {
-        qDebug() << "Connected to PiRacer BatteryChanged signal";
-    }
-    
     // Monitor service availability
     sessionBus.connect(
         "org.freedesktop.DBus",
@@ -107,34 +103,243 @@ void GS_Handler::setupDBusConnection()
     );
 }
 
-void GS_Handler::syncGearFromPiRacer()
+void GS_Handler::selectVehicleService()
 {
-    if (!m_piracerInterface || !m_piracerInterface->isValid()) {
+    QDBusConnection sessionBus = QDBusConnection::sessionBus();
+    const bool nativeAvailable = sessionBus.interface()
+        && sessionBus.interface()->isServiceRegistered(kVehicleDataService);
+    const QString service = nativeAvailable ? kVehicleDataService : kDashboardService;
+    const QString path = nativeAvailable ? kVehicleDataPath : kDashboardPath;
+
+    if (service == m_vehicleService && m_piracerInterface && m_piracerInterface->isValid()) {
         return;
     }
-    
-    QDBusReply<QString> reply = m_piracerInterface->call("GetGear");
-    if (reply.isValid()) {
-        QString gear = reply.value();
-        if (gear != m_currentGear) {
-            m_currentGear = gear;
-            emit currentGearChanged();
-            qDebug() << "Synced gear from PiRacer:" << gear;
+
+    // Drop the signals of the previous source, so samples never arrive twice
+    if (!m_vehicleService.isEmpty()) {
+        connectVehicleSignals(m_vehicleService, false);
+    }
+
+    m_vehicleService = service;
+    delete m_piracerInterface;
+    m_piracerInterface = new QDBusInterface(service, path, service, sessionBus, this);
+    connectVehicleSignals(service, true);
+
+    const bool wasConnected = m_dbusConnected;
+    m_dbusConnected = m_piracerInterface->isValid();
+    detachTelemetry();
+    if (m_dbusConnected) {
+        qDebug() << "Using vehicle data from" << service;
+        if (nativeAvailable) {
+            // The current values arrive with the subscriptions
+            subscribe("GearChanged", 0.0, 0.0);
+            subscribe("SpeedChanged", kSpeedRateHz, kSpeedDeadband);
+            subscribe("BatteryChanged", kBatteryRateHz, kBatteryDeadband);
+            requestTelemetryChannel();
+        } else {
+            syncGearFromPiRacer();
         }
     } else {
-        qWarning() << "Failed to get gear from PiRacer:" << reply.error().message();
+        qWarning() << "Vehicle data service not available:"
+                   << sessionBus.lastError().message();
+        // Try to continue anyway - service might start later
+    }
+    if (wasConnected != m_dbusConnected) {
+        emit connectionStateChanged();
+    }
+}
+
+void GS_Handler::connectVehicleSignals(const QString &service, bool connect)
+{
+    QDBusConnection sessionBus = QDBusConnection::sessionBus();
+
+    // The native service sends targeted updates to subscribers; the
+    // dashboard script only broadcasts. Service and interface share the name.
+    struct Hook {
+        const char *member;
+        const char *slot;
+    };
+    const bool native = service == kVehicleDataService;
+    const QString path = native ? kVehicleDataPath : kDashboardPath;
+    const QVector<Hook> hooks = native
+        ? QVector<Hook>{ { "Updated", SLOT(handleVehicleUpdate(QString, QDBusVariant)) } }
+        : QVector<Hook>{ { "GearChanged", SLOT(handlePiRacerGearChange(QString)) },
+                         { "SpeedChanged", SLOT(handleSpeedChange(double)) },
+                         { "BatteryChanged", SLOT(handleBatteryChange(double)) } };
+
+    for (const Hook &hook : hooks) {
+        if (!connect) {
+            sessionBus.disconnect(service, path, service, hook.member, this, hook.slot);
+        } else if (sessionBus.connect(service, path, service, hook.member, this, hook.slot)) {
+            qDebug() << "Connected to" << service << hook.member << "signal";
+        } else {
+            qWarning() << "Failed to connect to" << hook.member << "signal of" << service;
+        }
     }
 }
 
+void GS_Handler::subscribe(const QString &signal, double maxRateHz, double deadband)
+{
+    QDBusPendingCall call = m_piracerInterface->asyncCall("Subscribe", signal, maxRateHz, deadband);
+    auto *watcher = new QDBusPendingCallWatcher(call, this);
+    connect(watcher, &QDBusPendingCallWatcher::finished, this,
+            [signal](QDBusPendingCallWatcher *finished) {
+        finished->deleteLater();
+        const QDBusPendingReply<bool> reply = *finished;
+        if (reply.isError() || !reply.value()) {
+            qWarning() << "Subscribing to" << signal << "failed:" << reply.error().message();
+        }
+    });
+}
+
+void GS_Handler::requestTelemetryChannel()
+{
+    QDBusPendingCall call = m_piracerInterface->asyncCall("GetTelemetryChannel");
+    auto *watcher = new QDBusPendingCallWatcher(call, this);
+    connect(watcher, &QDBusPendingCallWatcher::finished, this,
+            [this](QDBusPendingCallWatcher *finished) {
+        finished->deleteLater();
+        const QDBusPendingReply<QDBusUnixFileDescriptor> reply = *finished;
+        if (reply.isError() || !reply.value().isValid()) {
+            qWarning() << "No telemetry channel, speed from subscription updates only:"
+                       << reply.error().message();
+            return;
+        }
+        if (m_vehicleService == kVehicleDataService
+            && m_telemetry.attach(reply.value().fileDescriptor())) {
+            qDebug() << "Reading speed from the telemetry channel every"
+                     << m_telemetryTimer->interval() << "ms while it changes";
+        }
+    });
+}
+
+void GS_Handler::detachTelemetry()
+{
+    m_telemetryTimer->stop();
+    m_telemetry.detach();
+}
+
+void GS_Handler::pollTelemetry()
+{
+    // One atomic load when nothing was written
+    const quint64 sequence = m_telemetry.latestSequence(telemetry::Speed);
+    telemetry::Sample sample;
+    if (sequence != m_speedSequence && m_telemetry.latest(telemetry::Speed, &sample)) {
+        m_speedSequence = sequence;
+        if (std::fabs(sample.value - m_currentSpeed) > kSpeedEpsilon) {
+            m_steadyFrames = 0;
+            handleSpeedChange(sample.value);
+            return;
+        }
+    }
+
+    // Idle until the subscription reports speed outside the deadband again
+    if (++m_steadyFrames >= kSteadyFrames) {
+        m_telemetryTimer->stop();
+    }
+}
+
+void GS_Handler::handleVehicleUpdate(const QString &signal, const QDBusVariant &value)
+{
+    if (signal == QLatin1String("SpeedChanged")) {
+        handleSpeedChange(value.variant().toDouble());
+        // The update says speed moved; follow it frame by frame from the channel
+        if (m_telemetry.isAttached() && !m_telemetryTimer->isActive()) {
+            m_steadyFrames = 0;
+            m_telemetryTimer->start();
+        }
+    } else if (signal == QLatin1String("GearChanged")) {
+        handlePiRacerGearChange(value.variant().toString());
+    } else if (signal == QLatin1String("BatteryChanged")) {
+        handleBatteryChange(value.variant().toDouble());
+    }
+}
+
+void GS_Handler::syncGearFromPiRacer()
+{
+    if (!m_piracerInterface || !m_piracerInterface->isValid()) {
+        return;
+    }
+
+    QDBusPendingCall call = m_piracerInterface->asyncCall("GetGear");
+    auto *watcher = new QDBusPendingCallWatcher(call, this);
+    connect(watcher, &QDBusPendingCallWatcher::finished, this,
+            [this](QDBusPendingCallWatcher *finished) {
+        finished->deleteLater();
+        const QDBusPendingReply<QString> reply = *finished;
+        if (reply.isError()) {
+            qWarning() << "Failed to get gear from PiRacer:" << reply.error().message();
+            return;
+        }
+        qDebug() << "Synced gear from PiRacer:" << reply.value();
+        applyGear(reply.value());
+    });
+}
+
 void GS_Handler::handlePiRacerGearChange(const QString &newGear)
 {
     qDebug() << "Received gear change from PiRacer:" << newGear;
-    if (m_currentGear != newGear) {
-        m_currentGear = newGear;
+    applyGear(newGear);
+}
+
+void GS_Handler::applyGear(const QString &gear)
+{
+    m_confirmedGear = gear;
+
+    if (!m_pendingGear.isEmpty()) {
+        if (gear != m_pendingGear) {
+            // Echo of an older request or a change on the car; the timeout
+            // reverts to this gear if ours never arrives
+            emit gearPendingChanged();
+            return;
+        }
+        m_gearConfirmLatency.record(quint64(m_gearRequested.nsecsElapsed() / 1000));
+        m_gearTimeout->stop();
+        m_pendingGear.clear();
+        qDebug() << "Gear" << gear << "confirmed after" << m_gearRequested.elapsed() << "ms";
+        emit gearPendingChanged();
+        emit gearStatsChanged();
+    }
+
+    if (m_currentGear != gear) {
+        m_currentGear = gear;
         emit currentGearChanged();
     }
 }
 
+void GS_Handler::failGearRequest(const QString &reason)
+{
+    if (m_pendingGear.isEmpty()) {
+        return;
+    }
+
+    const QString gear = m_pendingGear;
+    qWarning() << "Gear change to" << gear << "failed:" << reason
+               << "- reverting to" << m_confirmedGear;
+    m_gearTimeout->stop();
+    m_pendingGear.clear();
+    emit gearPendingChanged();
+
+    if (m_currentGear != m_confirmedGear) {
+        m_currentGear = m_confirmedGear;
+        emit currentGearChanged();
+    }
+    emit gearChangeFailed(gear, reason);
+    emit gearStatsChanged();
+}
+
+QVariantMap GS_Handler::latencyMap(const LatencyHistogram &histogram)
+{
+    QVariantMap map;
+    map["count"] = histogram.count();
+    map["meanMs"] = histogram.meanUs() / 1000.0;
+    map["p50Ms"] = histogram.percentileUs(0.50) / 1000.0;
+    map["p95Ms"] = histogram.percentileUs(0.95) / 1000.0;
+    map["p99Ms"] = histogram.percentileUs(0.99) / 1000.0;
+    map["maxMs"] = histogram.maxUs() / 1000.0;
+    return map;
+}
+
 void GS_Handler::handleSpeedChange(double speed)
 {
     // Speed in cm/s from PiRacer
@@ -144,7 +349,7 @@ void GS_Handler::handleSpeedChange(double speed)
 
 void GS_Handler::handleBatteryChange(double battery)
 {
-    // Battery percentage from PiRacer
+    // Battery percentage from the vehicle data service
     m_batteryLevel = battery;
     emit batteryChanged(battery);
 }
@@ -153,67 +358,120 @@ void GS_Handler::handleServiceOwnerChanged(const QString &serviceName,
                                            const QString &oldOwner, 
                                            const QString &newOwner)
 {
-    if (serviceName == "com.piracer.dashboard") {
-        if (newOwner.isEmpty()) {
-            // Service disappeared
-            qWarning() << "PiRacer dashboard service disconnected";
+    Q_UNUSED(oldOwner);
+
+    if (serviceName != kVehicleDataService && serviceName != kDashboardService) {
+        return;
+    }
+
+    if (newOwner.isEmpty()) {
+        // Service disappeared
+        qWarning() << serviceName << "disconnected";
+        if (serviceName == m_vehicleService) {
+            failGearRequest(serviceName + " disconnected");
+            detachTelemetry();
             m_dbusConnected = false;
-            emit dbusConnectionError("PiRacer service disconnected");
-        } else {
-            // Service appeared
-            qDebug() << "PiRacer dashboard service connected";
-            m_dbusConnected = true;
-            
-            // Recreate interface
-            delete m_piracerInterface;
-            m_piracerInterface = new QDBusInterface(
-                "com.piracer.dashboard",
-                "/com/piracer/dashboard",
-                "com.piracer.dashboard",
-                QDBusConnection::sessionBus(),
-                this
-            );
-            
-            // Sync current state
-            syncGearFromPiRacer();
-            emit dbusConnectionRestored();
+            emit connectionStateChanged();
+            emit dbusConnectionError(serviceName + " disconnected");
+
+            // Fall back to the dashboard service if the native one went away
+            if (serviceName == kVehicleDataService) {
+                selectVehicleService();
+            }
         }
+        return;
+    }
+
+    // Service appeared: switch to it if it is preferred, then sync state
+    qDebug() << serviceName << "connected";
+    const bool wasConnected = m_dbusConnected;
+    selectVehicleService();
+    if (!wasConnected && m_dbusConnected) {
+        emit dbusConnectionRestored();
     }
 }
 
 void GS_Handler::setCurrentGear(const QString &gear)
 {
-    // Validate gear input
-    QStringList validGears = {"P", "R", "N", "D"};
-    if (!validGears.contains(gear)) {
+    setGear(gear);
+}
+
+void GS_Handler::setGear(const QString &gear)
+{
+    if (!kValidGears.contains(gear)) {
         qWarning() << "Invalid gear requested:" << gear;
         return;
     }
-    
-    if (m_currentGear != gear) {
-        QString oldGear = m_currentGear;
+    if (gear == m_currentGear) {
+        return;     // already requested or engaged
+    }
+    if (gear == m_confirmedGear) {
+        // Back to the engaged gear while another is pending: nothing to wait
+        // for, the vehicle does not echo a gear it is already in. The pending
+        // request may have gone out already, so the gear is still sent, but
+        // replies to it and to the cancelled request are ignored.
+        ++m_gearSerial;
+        qDebug() << "Cancelling gear request" << m_pendingGear << "- staying in" << gear;
+        m_gearTimeout->stop();
+        m_pendingGear.clear();
         m_currentGear = gear;
-        
-        qDebug() << "Setting gear from" << oldGear << "to" << m_currentGear;
-        
         emit currentGearChanged();
-        emit gearChangeRequested(gear);
-        
-        // Send gear change to PiRacer dashboard service
+        emit gearPendingChanged();
         if (m_piracerInterface && m_piracerInterface->isValid()) {
-            QDBusReply<void> reply = m_piracerInterface->call("SetGear", gear);
-            if (!reply.isValid()) {
-                qWarning() << "Failed to set gear on PiRacer:" << reply.error().message();
-                // Optionally revert the change
-                // m_currentGear = oldGear;
-                // emit currentGearChanged();
-            } else {
-                qDebug() << "Successfully sent gear change to PiRacer";
-            }
-        } else {
-            qWarning() << "PiRacer service not available - gear change not sent";
+            m_piracerInterface->call(QDBus::NoBlock, "SetGear", gear);
         }
+        return;
     }
+    if (!m_piracerInterface || !m_piracerInterface->isValid()) {
+        qWarning() << "PiRacer service not available - gear change not sent";
+        m_gearFailures++;
+        emit gearChangeFailed(gear, QStringLiteral("vehicle data service not available"));
+        emit gearStatsChanged();
+        return;
+    }
+
+    // A newer request replaces a pending one; its replies are ignored
+    const quint32 serial = ++m_gearSerial;
+    const bool wasPending = !m_pendingGear.isEmpty();
+    qDebug() << "Requesting gear" << gear << "- engaged:" << m_confirmedGear;
+
+    m_pendingGear = gear;
+    m_currentGear = gear;
+    m_gearRequested.start();
+    m_gearTimeout->start();
+    emit currentGearChanged();
+    if (!wasPending) {
+        emit gearPendingChanged();
+    }
+    emit gearChangeRequested(gear);
+
+    QDBusPendingCall call = m_piracerInterface->asyncCall("SetGear", gear);
+    auto *watcher = new QDBusPendingCallWatcher(call, this);
+    connect(watcher, &QDBusPendingCallWatcher::finished, this,
+            [this, serial](QDBusPendingCallWatcher *finished) {
+        finished->deleteLater();
+        if (serial != m_gearSerial) {
+            return;
+        }
+        m_gearCallLatency.record(quint64(m_gearRequested.nsecsElapsed() / 1000));
+
+        // The native service answers false when the frame could not be sent,
+        // the dashboard script has no return value
+        const QDBusMessage reply = finished->reply();
+        QString error;
+        if (reply.type() == QDBusMessage::ErrorMessage) {
+            error = reply.errorMessage();
+        } else if (!reply.arguments().isEmpty() && !reply.arguments().first().toBool()) {
+            error = QStringLiteral("rejected by the vehicle data service");
+        }
+
+        if (!error.isEmpty() && !m_pendingGear.isEmpty()) {
+            m_gearFailures++;
+            failGearRequest(error);
+        } else {
+            emit gearStatsChanged();
+        }
+    });
 }
 
 QString GS_Handler::currentGear() const
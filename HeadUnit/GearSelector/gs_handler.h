@@ -7,11 +7,25 @@
 #include <QtDBus/QDBusConnection>
 #include <QtDBus/QDBusMessage>
 #include <QtDBus/QDBusError>
+#include <QTimer>
+#include <QElapsedTimer>
+#include <QVariantMap>
+#include <QtDBus/QDBusVariant>
+#include "../latency_histogram.h"
+#include "../telemetry_channel.h"
 
 class GS_Handler : public QObject
 {
     Q_OBJECT
+    // Requested gear while a change is pending, otherwise the vehicle's
     Q_PROPERTY(QString currentGear READ currentGear WRITE setCurrentGear NOTIFY currentGearChanged)
+    Q_PROPERTY(bool gearPending READ gearPending NOTIFY gearPendingChanged)
+    Q_PROPERTY(QString confirmedGear READ confirmedGear NOTIFY gearPendingChanged)
+    // Request to SetGear reply, and request to GearChanged echo
+    Q_PROPERTY(QVariantMap gearCallLatency READ gearCallLatency NOTIFY gearStatsChanged)
+    Q_PROPERTY(QVariantMap gearConfirmLatency READ gearConfirmLatency NOTIFY gearStatsChanged)
+    Q_PROPERTY(int gearTimeouts READ gearTimeouts NOTIFY gearStatsChanged)
+    Q_PROPERTY(int gearFailures READ gearFailures NOTIFY gearStatsChanged)
     Q_PROPERTY(double currentSpeed READ currentSpeed NOTIFY speedChanged)
     Q_PROPERTY(double batteryLevel READ batteryLevel NOTIFY batteryChanged)
     Q_PROPERTY(bool isConnected READ isConnected NOTIFY connectionStateChanged)
@@ -22,7 +36,19 @@ public:
 
     QString currentGear() const;
     void setCurrentGear(const QString &gear);
-    
+
+    // Sends the request without waiting. The gear shows as pending until the
+    // vehicle echoes it through GearChanged; a rejected or unconfirmed
+    // request reverts to the confirmed gear.
+    Q_INVOKABLE void setGear(const QString &gear);
+
+    bool gearPending() const { return !m_pendingGear.isEmpty(); }
+    QString confirmedGear() const { return m_confirmedGear; }
+    QVariantMap gearCallLatency() const { return latencyMap(m_gearCallLatency); }
+    QVariantMap gearConfirmLatency() const { return latencyMap(m_gearConfirmLatency); }
+    int gearTimeouts() const { return m_gearTimeouts; }
+    int gearFailures() const { return m_gearFailures; }
+
     double currentSpeed() const;
     double batteryLevel() const;
     bool isConnected() const;
@@ -32,6 +58,7 @@ public slots:
     void handlePiRacerGearChange(const QString &newGear);
     void handleSpeedChange(double speed);
     void handleBatteryChange(double battery);
+    void handleVehicleUpdate(const QString &signal, const QDBusVariant &value);
     void handleServiceOwnerChanged(const QString &serviceName, 
                                   const QString &oldOwner, 
                                   const QString &newOwner);
@@ -39,6 +66,9 @@ public slots:
 signals:
     void currentGearChanged();
     void gearChangeRequested(const QString &gear);
+    void gearChangeFailed(const QString &gear, const QString &reason);
+    void gearPendingChanged();
+    void gearStatsChanged();
     void speedChanged(double speed);
     void batteryChanged(double battery);
     void dbusConnectionError(const QString &error);
@@ -47,13 +77,36 @@ signals:
 
 private:
     QString m_currentGear;
+    QString m_confirmedGear;                // last gear reported by the vehicle
+    QString m_pendingGear;                  // empty = no request in flight
+    quint32 m_gearSerial;                   // latest request; older replies are ignored
+    QElapsedTimer m_gearRequested;
+    QTimer *m_gearTimeout;
+    LatencyHistogram m_gearCallLatency;
+    LatencyHistogram m_gearConfirmLatency;
+    int m_gearTimeouts;
+    int m_gearFailures;
     double m_currentSpeed;
     double m_batteryLevel;
-    QDBusInterface *m_piracerInterface;
+    QDBusInterface *m_piracerInterface;    // gear and speed source
+    QString m_vehicleService;               // service behind m_piracerInterface
     bool m_dbusConnected;
-    
+    telemetry::Reader m_telemetry;         // speed per frame while it moves
+    QTimer *m_telemetryTimer;
+    quint64 m_speedSequence;
+    int m_steadyFrames;                     // frames without a visible change
+
     void setupDBusConnection();
+    void selectVehicleService();
     void syncGearFromPiRacer();
+    void failGearRequest(const QString &reason);
+    void applyGear(const QString &gear);
+    static QVariantMap latencyMap(const LatencyHistogram &histogram);
+    void connectVehicleSignals(const QString &service, bool connect);
+    void subscribe(const QString &signal, double maxRateHz, double deadband);
+    void requestTelemetryChannel();
+    void detachTelemetry();
+    void pollTelemetry();
 };
 
 #endif // GS_HANDLER_H
\ No newline at end of file
@@ -4,6 +4,7 @@
 #include <QDebug>
 #include "gs_handler.h"
 #include "../theme_client.h"
+#include "../app_liveness.h"
 
 int main(int argc, char *argv[])
 {
@@ -20,6 +21,9 @@ int main(int argc, char *argv[])
     // Create theme client
     ThemeClient themeClient;
 
+    // Answers the compositor's watchdog
+    AppLiveness liveness;
+
     QQmlApplicationEngine engine;
 
     // Expose to QML
@@ -0,0 +1,391 @@
+// compositor_stats.cpp
+#include "compositor_stats.h"
+#include "surface_registry.h"
+#include <QDBusConnection>
+#include <QDBusError>
+#include <QDebug>
+#include <QQuickItem>
+#include <QQuickWindow>
+#include <QScreen>
+#include <QWaylandQuickItem>
+#include <QWaylandSurface>
+#include <QtAlgorithms>
+#include <cmath>
+
+namespace {
+
+// Longer gaps between swaps mean the scene was idle, not that frames dropped
+constexpr qint64 kIdleGapNs = 250 * 1000 * 1000;
+
+} // namespace
+
+// ============================================================================
+// CompositorStats Implementation
+// ============================================================================
+
+CompositorStats::CompositorStats(SurfaceRegistry *registry, QObject *parent)
+    : QObject(parent)
+    , m_registry(registry)
+    , m_dbusAdaptor(nullptr)
+    , m_hudVisible(qEnvironmentVariableIntValue("HEADUNIT_COMPOSITOR_HUD") == 1)
+    , m_framesAtRefresh(0)
+    , m_idleNsAtRefresh(0)
+    , m_fps(0.0)
+    , m_idlePercent(0.0)
+{
+    m_clock.start();
+    m_refreshTimer.setInterval(1000);
+    connect(&m_refreshTimer, &QTimer::timeout, this, &CompositorStats::refresh);
+
+    connect(m_registry, &SurfaceRegistry::surfaceAdded, this,
+            [this](int iviId, QQuickItem *item, bool) { onSurfaceAdded(iviId, item); });
+    connect(m_registry, &SurfaceRegistry::surfaceRemoved, this, [this](int iviId) {
+        m_items.remove(iviId);
+    });
+
+    registerDBusService();
+
+    // The HUD has nothing to show without numbers
+    if (qEnvironmentVariableIntValue("HEADUNIT_COMPOSITOR_STATS") == 1 || m_hudVisible) {
+        setEnabled(true);
+    }
+}
+
+CompositorStats::~CompositorStats()
+{
+    disconnectWindow();
+}
+
+void CompositorStats::registerDBusService()
+{
+    m_dbusAdaptor = new CompositorStatsDBus(this);
+    QDBusConnection sessionBus = QDBusConnection::sessionBus();
+
+    if (!sessionBus.registerService("com.headunit.Compositor")) {
+        qWarning() << "[CompositorStats] Failed to register D-Bus service:"
+                   << sessionBus.lastError().message();
+        return;
+    }
+
+    if (!sessionBus.registerObject("/com/headunit/Compositor/Stats", this)) {
+        qWarning() << "[CompositorStats] Failed to register D-Bus object:"
+                   << sessionBus.lastError().message();
+        return;
+    }
+
+    qInfo() << "[CompositorStats] D-Bus service registered: com.headunit.Compositor.Stats";
+}
+
+int CompositorStats::slotFor(int iviId)
+{
+    const int slot = iviId - 1000;
+    return slot >= 0 && slot < kSlots ? slot : -1;
+}
+
+void CompositorStats::attachWindow(QQuickWindow *window)
+{
+    disconnectWindow();
+    m_window = window;
+    if (!window) {
+        return;
+    }
+
+    if (window->screen() && window->screen()->refreshRate() > 1.0) {
+        m_periodNs.store(qint64(1e9 / window->screen()->refreshRate()), std::memory_order_relaxed);
+    }
+    if (isEnabled()) {
+        connectWindow();
+    }
+}
+
+void CompositorStats::setEnabled(bool enabled)
+{
+    if (enabled == isEnabled()) {
+        return;
+    }
+
+    m_enabled.store(enabled, std::memory_order_relaxed);
+    if (enabled) {
+        reset();
+        connectWindow();
+        m_refreshClock.start();
+        m_refreshTimer.start();
+    } else {
+        disconnectWindow();
+        m_refreshTimer.stop();
+    }
+
+    qInfo() << "[CompositorStats]" << (enabled ? "Enabled" : "Disabled");
+    emit enabledChanged();
+}
+
+void CompositorStats::setHudVisible(bool visible)
+{
+    if (visible == m_hudVisible) {
+        return;
+    }
+    m_hudVisible = visible;
+    if (visible) {
+        setEnabled(true);
+    }
+    emit hudVisibleChanged();
+}
+
+void CompositorStats::connectWindow()
+{
+    if (!m_window || !m_windowConnections.isEmpty()) {
+        return;
+    }
+
+    // Emitted on the render thread with the threaded loop: atomics only
+    m_windowConnections << connect(m_window, &QQuickWindow::beforeRendering, this, [this]() {
+        m_renderStartNs.store(m_clock.nsecsElapsed(), std::memory_order_relaxed);
+    }, Qt::DirectConnection);
+
+    m_windowConnections << connect(m_window, &QQuickWindow::afterRendering, this, [this]() {
+        const qint64 start = m_renderStartNs.load(std::memory_order_relaxed);
+        if (start > 0) {
+            m_renderTime.record(quint64(m_clock.nsecsElapsed() - start) / 1000);
+        }
+    }, Qt::DirectConnection);
+
+    m_windowConnections << connect(m_window, &QQuickWindow::frameSwapped, this,
+                                   &CompositorStats::onFrameSwapped, Qt::DirectConnection);
+}
+
+void CompositorStats::disconnectWindow()
+{
+    for (const QMetaObject::Connection &connection : std::as_const(m_windowConnections)) {
+        disconnect(connection);
+    }
+    m_windowConnections.clear();
+    m_lastSwapNs.store(0, std::memory_order_relaxed);
+}
+
+void CompositorStats::onSurfaceAdded(int iviId, QQuickItem *item)
+{
+    auto *waylandItem = qobject_cast<QWaylandQuickItem *>(item);
+    const int slot = slotFor(iviId);
+    if (!waylandItem || !waylandItem->surface() || slot < 0) {
+        return;
+    }
+
+    m_items.insert(iviId, item);
+    m_slots[slot].pendingCommitNs.store(0, std::memory_order_relaxed);
+
+    connect(waylandItem->surface(), &QWaylandSurface::redraw, this, [this, iviId, slot]() {
+        if (!isEnabled()) {
+            return;
+        }
+        SurfaceSlot &s = m_slots[slot];
+        s.commits.fetch_add(1, std::memory_order_relaxed);
+
+        // Hidden surfaces are not presented; their commits have no latency
+        QQuickItem *item = m_items.value(iviId);
+        if (!item || !item->isVisible()) {
+            return;
+        }
+        qint64 expected = 0;
+        s.pendingCommitNs.compare_exchange_strong(expected, m_clock.nsecsElapsed(),
+                                                  std::memory_order_relaxed);
+    });
+}
+
+void CompositorStats::onFrameSwapped()
+{
+    const qint64 now = m_clock.nsecsElapsed();
+    const qint64 last = m_lastSwapNs.exchange(now, std::memory_order_relaxed);
+    m_frames.fetch_add(1, std::memory_order_relaxed);
+
+    if (last > 0 && now - last >= kIdleGapNs) {
+        m_idleGaps.fetch_add(1, std::memory_order_relaxed);
+        m_idleNs.fetch_add(now - last, std::memory_order_relaxed);
+    } else if (last > 0) {
+        const qint64 interval = now - last;
+        m_frameInterval.record(quint64(interval) / 1000);
+
+        const qint64 period = m_periodNs.load(std::memory_order_relaxed);
+        const qint64 missed = (interval + period / 2) / period - 1;
+        if (missed > 0) {
+            m_dropped.fetch_add(quint64(missed), std::memory_order_relaxed);
+        }
+    }
+
+    const qint64 keyboard = m_keyboardRequestNs.exchange(0, std::memory_order_relaxed);
+    if (keyboard > 0 && keyboard <= now) {
+        m_keyboardOpen.record(quint64(now - keyboard) / 1000);
+    }
+
+    for (SurfaceSlot &s : m_slots) {
+        const qint64 committed = s.pendingCommitNs.exchange(0, std::memory_order_relaxed);
+        if (committed > 0 && committed <= now) {
+            s.commitToPresent.record(quint64(now - committed) / 1000);
+        }
+    }
+}
+
+void CompositorStats::refresh()
+{
+    const qint64 elapsedMs = m_refreshClock.restart();
+    const quint64 frames = m_frames.load(std::memory_order_relaxed);
+    m_fps = elapsedMs > 0 ? (frames - m_framesAtRefresh) * 1000.0 / elapsedMs : 0.0;
+    m_framesAtRefresh = frames;
+
+    // Idle time is booked when the gap ends, so average it over the window
+    const qint64 idleNs = m_idleNs.load(std::memory_order_relaxed);
+    if (elapsedMs > 0) {
+        m_idlePercent = qBound(0.0, (idleNs - m_idleNsAtRefresh) / 1e4 / elapsedMs, 100.0);
+    }
+    m_idleNsAtRefresh = idleNs;
+
+    if (m_hudVisible) {
+        m_surfaceLines.clear();
+        for (int iviId : surfaceIds()) {
+            const SurfaceSlot &s = m_slots[slotFor(iviId)];
+            m_surfaceLines << QStringLiteral("%1: %2/s p95 %3 ms")
+                                  .arg(m_registry->appName(iviId))
+                                  .arg(m_registry->commitRate(iviId), 0, 'f', 0)
+                                  .arg(s.commitToPresent.percentileUs(0.95) / 1000.0, 0, 'f', 1);
+        }
+    }
+
+    emit updated();
+}
+
+void CompositorStats::markKeyboardRequested()
+{
+    if (isEnabled()) {
+        m_keyboardRequestNs.store(m_clock.nsecsElapsed(), std::memory_order_relaxed);
+    }
+}
+
+QVariantMap CompositorStats::frameStats() const
+{
+    QVariantMap stats;
+    stats["enabled"] = isEnabled();
+    stats["frames"] = m_frames.load(std::memory_order_relaxed);
+    stats["droppedFrames"] = droppedFrames();
+    stats["idleGaps"] = m_idleGaps.load(std::memory_order_relaxed);
+    stats["idleTimeMs"] = m_idleNs.load(std::memory_order_relaxed) / 1000000;
+    stats["fps"] = m_fps;
+    stats["opaqueFullscreen"] = m_registry->isCurrentOpaque();
+    stats["refreshPeriodUs"] = m_periodNs.load(std::memory_order_relaxed) / 1000;
+    stats["frameIntervalP50Us"] = m_frameInterval.percentileUs(0.50);
+    stats["frameIntervalP95Us"] = m_frameInterval.percentileUs(0.95);
+    stats["frameIntervalP99Us"] = m_frameInterval.percentileUs(0.99);
+    stats["frameIntervalMaxUs"] = m_frameInterval.maxUs();
+    stats["renderTimeP50Us"] = m_renderTime.percentileUs(0.50);
+    stats["renderTimeP95Us"] = m_renderTime.percentileUs(0.95);
+    stats["renderTimeMaxUs"] = m_renderTime.maxUs();
+    stats["keyboardOpens"] = m_keyboardOpen.count();
+    stats["keyboardOpenP50Us"] = m_keyboardOpen.percentileUs(0.50);
+    stats["keyboardOpenP95Us"] = m_keyboardOpen.percentileUs(0.95);
+    stats["keyboardOpenMaxUs"] = m_keyboardOpen.maxUs();
+    return stats;
+}
+
+QVariantMap CompositorStats::surfaceStats(int iviId) const
+{
+    QVariantMap stats;
+    const int slot = slotFor(iviId);
+    if (slot < 0) {
+        return stats;
+    }
+
+    const SurfaceSlot &s = m_slots[slot];
+    stats["iviId"] = iviId;
+    stats["appName"] = m_registry->appName(iviId);
+    stats["running"] = m_registry->isAppRunning(iviId);
+    stats["commits"] = s.commits.load(std::memory_order_relaxed);
+    stats["commitRate"] = m_registry->commitRate(iviId);
+    stats["presented"] = s.commitToPresent.count();
+    stats["commitToPresentMeanUs"] = s.commitToPresent.meanUs();
+    stats["commitToPresentP50Us"] = s.commitToPresent.percentileUs(0.50);
+    stats["commitToPresentP95Us"] = s.commitToPresent.percentileUs(0.95);
+    stats["commitToPresentP99Us"] = s.commitToPresent.percentileUs(0.99);
+    stats["commitToPresentMaxUs"] = s.commitToPresent.maxUs();
+    stats.insert(m_registry->configureStats(iviId));
+    return stats;
+}
+
+QList<int> CompositorStats::surfaceIds() const
+{
+    QList<int> ids;
+    for (int slot = 0; slot < kSlots; ++slot) {
+        if (m_slots[slot].commits.load(std::memory_order_relaxed) > 0 || m_items.contains(1000 + slot)) {
+            ids.append(1000 + slot);
+        }
+    }
+    return ids;
+}
+
+void CompositorStats::reset()
+{
+    m_frameInterval.reset();
+    m_renderTime.reset();
+    m_keyboardOpen.reset();
+    m_keyboardRequestNs.store(0, std::memory_order_relaxed);
+    m_frames.store(0, std::memory_order_relaxed);
+    m_dropped.store(0, std::memory_order_relaxed);
+    m_idleGaps.store(0, std::memory_order_relaxed);
+    m_idleNs.store(0, std::memory_order_relaxed);
+    m_idleNsAtRefresh = 0;
+    m_lastSwapNs.store(0, std::memory_order_relaxed);
+    m_framesAtRefresh = 0;
+    for (SurfaceSlot &s : m_slots) {
+        s.pendingCommitNs.store(0, std::memory_order_relaxed);
+        s.commits.store(0, std::memory_order_relaxed);
+        s.commitToPresent.reset();
+    }
+}
+
+// ============================================================================
+// CompositorStatsDBus Implementation
+// ============================================================================
+
+CompositorStatsDBus::CompositorStatsDBus(QObject *parent)
+    : QDBusAbstractAdaptor(parent)
+{
+    m_stats = qobject_cast<CompositorStats*>(parent);
+}
+
+bool CompositorStatsDBus::IsEnabled()
+{
+    return m_stats && m_stats->isEnabled();
+}
+
+void CompositorStatsDBus::SetEnabled(bool enabled)
+{
+    if (m_stats) {
+        m_stats->setEnabled(enabled);
+    }
+}
+
+void CompositorStatsDBus::SetHudVisible(bool visible)
+{
+    if (m_stats) {
+        m_stats->setHudVisible(visible);
+    }
+}
+
+QVariantMap CompositorStatsDBus::GetFrameStats()
+{
+    return m_stats ? m_stats->frameStats() : QVariantMap();
+}
+
+QVariantMap CompositorStatsDBus::GetSurfaceStats(int iviId)
+{
+    return m_stats ? m_stats->surfaceStats(iviId) : QVariantMap();
+}
+
+QList<int> CompositorStatsDBus::GetSurfaceIds()
+{
+    return m_stats ? m_stats->surfaceIds() : QList<int>();
+}
+
+void CompositorStatsDBus::Reset()
+{
+    if (m_stats) {
+        m_stats->reset();
+    }
+}
@@ -0,0 +1,151 @@
+// compositor_stats.h
+#ifndef COMPOSITOR_STATS_H
+#define COMPOSITOR_STATS_H
+
+#include <QObject>
+#include <QDBusAbstractAdaptor>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QPointer>
+#include <QStringList>
+#include <QTimer>
+#include <QVariantMap>
+#include <atomic>
+#include "../latency_histogram.h"
+
+class QQuickItem;
+class QQuickWindow;
+class SurfaceRegistry;
+
+/**
+ * D-Bus Adaptor for the compositor statistics
+ */
+class CompositorStatsDBus : public QDBusAbstractAdaptor
+{
+    Q_OBJECT
+    Q_CLASSINFO("D-Bus Interface", "com.headunit.Compositor.Stats")
+
+public:
+    explicit CompositorStatsDBus(QObject *parent);
+
+public Q_SLOTS:
+    bool IsEnabled();
+    void SetEnabled(bool enabled);
+    void SetHudVisible(bool visible);
+    QVariantMap GetFrameStats();
+    QVariantMap GetSurfaceStats(int iviId);
+    QList<int> GetSurfaceIds();
+    void Reset();
+
+private:
+    class CompositorStats *m_stats;
+};
+
+/**
+ * Frame pacing and surface commit instrumentation for the compositor.
+ *
+ * Hooks the output window's beforeRendering/afterRendering/frameSwapped and
+ * every registered surface's commits. Render-side hooks use direct
+ * connections and only touch atomics, so they work with the threaded render
+ * loop. While disabled no window hook is connected and a commit costs one
+ * relaxed load.
+ *
+ * Enabled with HEADUNIT_COMPOSITOR_STATS=1 (HUD: HEADUNIT_COMPOSITOR_HUD=1)
+ * or at runtime over D-Bus.
+ */
+class CompositorStats : public QObject
+{
+    Q_OBJECT
+    Q_PROPERTY(bool enabled READ isEnabled WRITE setEnabled NOTIFY enabledChanged)
+    Q_PROPERTY(bool hudVisible READ isHudVisible WRITE setHudVisible NOTIFY hudVisibleChanged)
+    Q_PROPERTY(double fps READ fps NOTIFY updated)
+    Q_PROPERTY(double frameP50Ms READ frameP50Ms NOTIFY updated)
+    Q_PROPERTY(double frameP99Ms READ frameP99Ms NOTIFY updated)
+    Q_PROPERTY(double renderP95Ms READ renderP95Ms NOTIFY updated)
+    Q_PROPERTY(quint64 droppedFrames READ droppedFrames NOTIFY updated)
+    Q_PROPERTY(double idlePercent READ idlePercent NOTIFY updated)
+    Q_PROPERTY(QStringList surfaceLines READ surfaceLines NOTIFY updated)
+
+public:
+    explicit CompositorStats(SurfaceRegistry *registry, QObject *parent = nullptr);
+    ~CompositorStats();
+
+    void attachWindow(QQuickWindow *window);
+
+    bool isEnabled() const { return m_enabled.load(std::memory_order_relaxed); }
+    void setEnabled(bool enabled);
+
+    bool isHudVisible() const { return m_hudVisible; }
+    void setHudVisible(bool visible);
+
+    double fps() const { return m_fps; }
+    double frameP50Ms() const { return m_frameInterval.percentileUs(0.50) / 1000.0; }
+    double frameP99Ms() const { return m_frameInterval.percentileUs(0.99) / 1000.0; }
+    double renderP95Ms() const { return m_renderTime.percentileUs(0.95) / 1000.0; }
+    quint64 droppedFrames() const { return m_dropped.load(std::memory_order_relaxed); }
+    double idlePercent() const { return m_idlePercent; }
+    QStringList surfaceLines() const { return m_surfaceLines; }
+
+    QVariantMap frameStats() const;
+    QVariantMap surfaceStats(int iviId) const;
+    QList<int> surfaceIds() const;
+    Q_INVOKABLE void reset();
+    // Time from here to the next presented frame is the keyboard open latency
+    Q_INVOKABLE void markKeyboardRequested();
+
+signals:
+    void enabledChanged();
+    void hudVisibleChanged();
+    void updated();
+
+private:
+    // IVI ids are 1000 + n; one slot per id keeps the frame path lock free
+    static constexpr int kSlots = 16;
+    struct SurfaceSlot {
+        std::atomic<qint64> pendingCommitNs{0};    // oldest commit not yet presented
+        std::atomic<quint64> commits{0};
+        LatencyHistogram commitToPresent;
+    };
+
+    static int slotFor(int iviId);
+
+    void registerDBusService();
+    void connectWindow();
+    void disconnectWindow();
+    void onSurfaceAdded(int iviId, QQuickItem *item);
+    void onFrameSwapped();
+    void refresh();
+
+    SurfaceRegistry *m_registry;
+    CompositorStatsDBus *m_dbusAdaptor;
+    QPointer<QQuickWindow> m_window;
+    QList<QMetaObject::Connection> m_windowConnections;
+    QHash<int, QPointer<QQuickItem>> m_items;
+
+    std::atomic<bool> m_enabled{false};
+    bool m_hudVisible;
+
+    QElapsedTimer m_clock;
+    std::atomic<qint64> m_periodNs{16666667};
+    std::atomic<qint64> m_renderStartNs{0};
+    std::atomic<qint64> m_lastSwapNs{0};
+    std::atomic<quint64> m_frames{0};
+    std::atomic<quint64> m_dropped{0};
+    std::atomic<quint64> m_idleGaps{0};
+    std::atomic<qint64> m_idleNs{0};
+    std::atomic<qint64> m_keyboardRequestNs{0};
+    LatencyHistogram m_frameInterval;
+    LatencyHistogram m_renderTime;
+    LatencyHistogram m_keyboardOpen;
+    SurfaceSlot m_slots[kSlots];
+
+    QTimer m_refreshTimer;
+    QElapsedTimer m_refreshClock;
+    quint64 m_framesAtRefresh;
+    qint64 m_idleNsAtRefresh;
+    double m_fps;
+    double m_idlePercent;
+    QStringList m_surfaceLines;
+};
+
+#endif // COMPOSITOR_STATS_H
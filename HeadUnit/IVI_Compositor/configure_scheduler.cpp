@@ -0,0 +1,182 @@
+// configure_scheduler.cpp
+#include "configure_scheduler.h"
+#include <QDebug>
+#include <QQuickItem>
+#include <QQuickWindow>
+#include <QTimer>
+#include <QWaylandIviSurface>
+#include <QWaylandSurface>
+
+ConfigureScheduler::ConfigureScheduler(QObject *parent)
+    : QObject(parent)
+    , m_dirty(false)
+{
+}
+
+void ConfigureScheduler::track(int iviId, QWaylandIviSurface *surface, QQuickItem *item)
+{
+    State &state = m_states[iviId];
+    state = State();
+    state.surface = surface;
+    state.item = item;
+
+    if (surface && surface->surface()) {
+        QWaylandSurface *waylandSurface = surface->surface();
+        connect(waylandSurface, &QWaylandSurface::redraw, this, [this, iviId, waylandSurface]() {
+            committed(iviId, waylandSurface->destinationSize());
+        });
+    }
+    hookWindow(item->window());
+}
+
+void ConfigureScheduler::untrack(int iviId)
+{
+    const State state = m_states.take(iviId);
+    if (state.surface && state.surface->surface()) {
+        disconnect(state.surface->surface(), nullptr, this, nullptr);
+    }
+}
+
+ConfigureScheduler::Counters ConfigureScheduler::counters(int iviId) const
+{
+    return m_states.value(iviId).counters;
+}
+
+void ConfigureScheduler::hookWindow(QQuickWindow *window)
+{
+    if (!window || m_windows.contains(window)) {
+        return;
+    }
+    m_windows.insert(window);
+
+    // afterAnimating runs on the GUI thread once per frame, after animations
+    // (keyboard slide, panel transitions) have moved the items
+    connect(window, &QQuickWindow::afterAnimating, this, [this]() {
+        if (m_dirty) {
+            flush();
+        }
+    });
+    connect(window, &QObject::destroyed, this, [this, window]() {
+        m_windows.remove(window);
+    });
+}
+
+void ConfigureScheduler::requestFrame(const State &state)
+{
+    if (state.item && state.item->window()) {
+        hookWindow(state.item->window());
+        state.item->window()->update();
+    }
+}
+
+void ConfigureScheduler::sendNow(int iviId, const QSize &size)
+{
+    auto it = m_states.find(iviId);
+    if (it == m_states.end() || size.isEmpty()) {
+        return;
+    }
+    it->counters.requested++;
+    it->pending = QSize();
+    send(iviId, *it, size);
+}
+
+void ConfigureScheduler::request(int iviId, const QSize &size)
+{
+    auto it = m_states.find(iviId);
+    if (it == m_states.end() || size.isEmpty()) {
+        return;
+    }
+
+    State &state = *it;
+    if (state.pending.isValid()) {
+        if (state.pending == size) {
+            // e.g. a deferred request of a surface that was just shown
+            m_dirty = true;
+            requestFrame(state);
+            return;
+        }
+        state.counters.coalesced++;
+    } else if (size == state.lastSent) {
+        return;
+    }
+
+    state.counters.requested++;
+    state.pending = size;
+    m_dirty = true;
+    requestFrame(state);
+}
+
+void ConfigureScheduler::flush()
+{
+    m_dirty = false;
+
+    for (auto it = m_states.begin(); it != m_states.end(); ++it) {
+        State &state = *it;
+        if (!state.pending.isValid()) {
+            continue;
+        }
+        // Sent when shown; a hidden client could not commit the ack anyway
+        if (!state.item || !state.item->isVisible()) {
+            continue;
+        }
+
+        if (state.awaited.isValid()) {
+            if (state.sentAt.elapsed() < kAckTimeoutMs) {
+                continue;   // the ack commit or the timeout brings us back
+            }
+            qDebug() << "[ConfigureScheduler] No commit at" << state.awaited
+                     << "from IVI-ID" << it.key() << "- sending anyway";
+            state.counters.timedOut++;
+            state.awaited = QSize();
+        }
+
+        if (state.pending == state.lastSent) {
+            state.pending = QSize();
+            continue;
+        }
+        const QSize size = state.pending;
+        state.pending = QSize();
+        send(it.key(), state, size);
+    }
+}
+
+void ConfigureScheduler::send(int iviId, State &state, const QSize &size)
+{
+    if (state.surface) {
+        state.surface->sendConfigure(size);
+    }
+    state.lastSent = size;
+    state.awaited = size;
+    state.sentAt.start();
+    state.counters.sent++;
+    emit countersChanged(iviId);
+
+    // Revisit a still pending request once the ack has timed out
+    QTimer::singleShot(kAckTimeoutMs + 10, Qt::PreciseTimer, this, [this, iviId]() {
+        auto it = m_states.constFind(iviId);
+        if (it != m_states.constEnd() && it->pending.isValid()) {
+            m_dirty = true;
+            requestFrame(*it);
+        }
+    });
+}
+
+void ConfigureScheduler::committed(int iviId, const QSize &size)
+{
+    auto it = m_states.find(iviId);
+    if (it == m_states.end() || !it->awaited.isValid()) {
+        return;
+    }
+    if (size != it->awaited) {
+        return;     // still a frame at the old size
+    }
+
+    it->awaited = QSize();
+    it->counters.acked++;
+    emit countersChanged(iviId);
+
+    if (it->pending.isValid()) {
+        m_dirty = true;
+        requestFrame(*it);
+    }
+}
@@ -0,0 +1,80 @@
+// configure_scheduler.h
+#ifndef CONFIGURE_SCHEDULER_H
+#define CONFIGURE_SCHEDULER_H
+
+#include <QObject>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QPointer>
+#include <QSet>
+#include <QSize>
+
+class QQuickItem;
+class QQuickWindow;
+class QWaylandIviSurface;
+
+// Coalesces ivi_surface configure events.
+//
+// Size requests are collected and sent once per frame of the item's window
+// (on afterAnimating), latest size wins. A surface has at most one configure
+// in flight: ivi-application has no ack_configure, so the first commit at the
+// configured size counts as the ack, with a timeout for clients that never
+// resize. Hidden surfaces keep their request until they are shown. This way a
+// keyboard slide or panel animation produces one or two configures instead
+// of one per animation step.
+class ConfigureScheduler : public QObject
+{
+    Q_OBJECT
+
+public:
+    struct Counters {
+        quint64 requested = 0;
+        quint64 sent = 0;
+        quint64 coalesced = 0;      // requests replaced before being sent
+        quint64 acked = 0;
+        quint64 timedOut = 0;
+    };
+
+    static constexpr int kAckTimeoutMs = 250;
+
+    explicit ConfigureScheduler(QObject *parent = nullptr);
+
+    // surface may be null, e.g. in tests: configures are then only counted
+    void track(int iviId, QWaylandIviSurface *surface, QQuickItem *item);
+    void untrack(int iviId);
+
+    // First configure of a surface, sent immediately
+    void sendNow(int iviId, const QSize &size);
+    void request(int iviId, const QSize &size);
+
+    // A frame of the surface at its destination size; the surface's redraw
+    // is connected here by track()
+    void committed(int iviId, const QSize &size);
+
+    Counters counters(int iviId) const;
+
+signals:
+    void countersChanged(int iviId);
+
+private:
+    struct State {
+        QWaylandIviSurface *surface = nullptr;
+        QPointer<QQuickItem> item;
+        QSize pending;
+        QSize awaited;              // configured size not yet committed
+        QSize lastSent;
+        QElapsedTimer sentAt;
+        Counters counters;
+    };
+
+    void hookWindow(QQuickWindow *window);
+    void requestFrame(const State &state);
+    void flush();
+    void send(int iviId, State &state, const QSize &size);
+
+    QHash<int, State> m_states;
+    QSet<QQuickWindow *> m_windows;
+    bool m_dirty;
+};
+
+#endif // CONFIGURE_SCHEDULER_H
@@ -182,6 +182,18 @@ void DBusManager::terminateApp(int iviId)
     }
 }
 
+void DBusManager::restartApp(int iviId)
+{
+    if (!m_afmInterface || !m_afmConnected) {
+        qWarning() << "[DBusManager] AFM not connected, cannot restart app" << iviId;
+        return;
+    }
+
+    // Not waiting for the AFM: this is called while an app is hung
+    qInfo() << "[DBusManager] Restarting app via AFM:" << iviId;
+    m_afmInterface->call(QDBus::NoBlock, "RestartApp", iviId);
+}
+
 void DBusManager::notifyAppConnected(int iviId)
 {
     if (!m_afmInterface || !m_afmConnected) {
@@ -24,6 +24,7 @@ public:
     Q_INVOKABLE void launchApp(int iviId);
     Q_INVOKABLE void activateApp(int iviId);
     Q_INVOKABLE void terminateApp(int iviId);
+    Q_INVOKABLE void restartApp(int iviId);
     Q_INVOKABLE void notifyAppConnected(int iviId);
     Q_INVOKABLE void notifyAppDisconnected(int iviId);
     Q_INVOKABLE QString getAppState(int iviId);
@@ -0,0 +1,172 @@
+// layout_engine.cpp
+#include "layout_engine.h"
+#include <QDebug>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QVariantMap>
+
+namespace {
+
+QRect rectFromJson(const QJsonObject &obj)
+{
+    return QRect(obj.value("x").toInt(), obj.value("y").toInt(),
+                 obj.value("width").toInt(), obj.value("height").toInt());
+}
+
+} // namespace
+
+LayoutEngine::LayoutEngine(QObject *parent)
+    : QObject(parent)
+{
+    const QString custom = qEnvironmentVariable("HEADUNIT_LAYOUT");
+    if (!custom.isEmpty() && load(custom)) {
+        return;
+    }
+    if (!load(QStringLiteral(":/layout/default.json"))) {
+        qCritical() << "[LayoutEngine] Built-in layout is invalid";
+    }
+}
+
+bool LayoutEngine::load(const QString &path)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        qWarning() << "[LayoutEngine] Cannot open" << path << ":" << file.errorString();
+        return false;
+    }
+
+    QJsonParseError error;
+    const QJsonDocument doc = QJsonDocument::fromJson(file.readAll(), &error);
+    if (!doc.isObject()) {
+        qWarning() << "[LayoutEngine] Invalid layout" << path << ":" << error.errorString();
+        return false;
+    }
+    const QJsonObject root = doc.object();
+
+    QVector<Output> outputs;
+    for (const QJsonValue &value : root.value("outputs").toArray()) {
+        const QJsonObject obj = value.toObject();
+        if (!obj.value("enabled").toBool(true)) {
+            continue;
+        }
+
+        Output output;
+        output.name = obj.value("name").toString();
+        output.size = QSize(obj.value("width").toInt(), obj.value("height").toInt());
+        output.screen = obj.value("screen").toInt();
+        const QJsonObject regions = obj.value("regions").toObject();
+        for (auto it = regions.begin(); it != regions.end(); ++it) {
+            output.regions.insert(it.key(), rectFromJson(it.value().toObject()));
+        }
+        if (output.name.isEmpty() || output.size.isEmpty()) {
+            qWarning() << "[LayoutEngine] Skipping output without name or size in" << path;
+            continue;
+        }
+
+        if (obj.value("primary").toBool()) {
+            outputs.prepend(output);
+        } else {
+            outputs.append(output);
+        }
+    }
+    if (outputs.isEmpty()) {
+        qWarning() << "[LayoutEngine] No enabled output in" << path;
+        return false;
+    }
+
+    QHash<QString, Placement> roles;
+    const QJsonObject roleObj = root.value("roles").toObject();
+    for (auto it = roleObj.begin(); it != roleObj.end(); ++it) {
+        const QJsonObject obj = it.value().toObject();
+        roles.insert(it.key(), { obj.value("output").toString(), obj.value("region").toString() });
+    }
+
+    QHash<int, QString> surfaceRoles;
+    const QJsonObject surfaces = root.value("surfaces").toObject();
+    for (auto it = surfaces.begin(); it != surfaces.end(); ++it) {
+        surfaceRoles.insert(it.key().toInt(), it.value().toString());
+    }
+
+    m_outputs = outputs;
+    m_roles = roles;
+    m_surfaceRoles = surfaceRoles;
+    m_defaultRole = root.value("defaultRole").toString(QStringLiteral("app"));
+
+    qInfo() << "[LayoutEngine] Loaded" << path << "- outputs:" << m_outputs.size()
+            << "primary:" << m_outputs.first().name << m_outputs.first().size;
+    return true;
+}
+
+const LayoutEngine::Output *LayoutEngine::output(const QString &name) const
+{
+    for (const Output &output : m_outputs) {
+        if (output.name == name) {
+            return &output;
+        }
+    }
+    return nullptr;
+}
+
+QString LayoutEngine::primaryOutput() const
+{
+    return m_outputs.isEmpty() ? QString() : m_outputs.first().name;
+}
+
+QSize LayoutEngine::primarySize() const
+{
+    return m_outputs.isEmpty() ? QSize(1024, 600) : m_outputs.first().size;
+}
+
+QVariantList LayoutEngine::secondaryOutputs() const
+{
+    QVariantList list;
+    for (int i = 1; i < m_outputs.size(); ++i) {
+        const Output &output = m_outputs[i];
+        QVariantMap map;
+        map["name"] = output.name;
+        map["width"] = output.size.width();
+        map["height"] = output.size.height();
+        map["screen"] = output.screen;
+        list.append(map);
+    }
+    return list;
+}
+
+QRect LayoutEngine::regionRect(const QString &outputName, const QString &region) const
+{
+    const Output *out = output(outputName);
+    return out ? out->regions.value(region) : QRect();
+}
+
+QString LayoutEngine::roleFor(int iviId) const
+{
+    const QString role = m_surfaceRoles.value(iviId, m_defaultRole);
+    // A role on a disabled output falls back to the default placement
+    if (!m_roles.contains(role) || !output(m_roles.value(role).output)) {
+        return m_defaultRole;
+    }
+    return role;
+}
+
+LayoutEngine::Placement LayoutEngine::placementFor(int iviId) const
+{
+    return m_roles.value(roleFor(iviId));
+}
+
+QString LayoutEngine::outputFor(int iviId) const
+{
+    return placementFor(iviId).output;
+}
+
+QString LayoutEngine::regionFor(int iviId) const
+{
+    return placementFor(iviId).region;
+}
+
+QSize LayoutEngine::surfaceSize(int iviId) const
+{
+    const Placement placement = placementFor(iviId);
+    return regionRect(placement.output, placement.region).size();
+}
@@ -0,0 +1,66 @@
+// layout_engine.h
+#ifndef LAYOUT_ENGINE_H
+#define LAYOUT_ENGINE_H
+
+#include <QObject>
+#include <QHash>
+#include <QRect>
+#include <QSize>
+#include <QString>
+#include <QVariantList>
+#include <QVector>
+
+// Screen layout of the compositor, read from a JSON description.
+//
+// The description lists outputs (size, screen index, named regions) and
+// roles that place a surface in a region of an output; IVI ids are mapped to
+// roles. The built-in layout is qrc:/layout/default.json, HEADUNIT_LAYOUT
+// points to a replacement file. Outputs with "enabled": false are ignored,
+// and roles on them fall back to defaultRole.
+//
+// Surface sizes come from here, so a configure can be computed once when a
+// surface appears instead of following item geometry.
+class LayoutEngine : public QObject
+{
+    Q_OBJECT
+    Q_PROPERTY(QString primaryOutput READ primaryOutput CONSTANT)
+    Q_PROPERTY(QVariantList secondaryOutputs READ secondaryOutputs CONSTANT)
+    Q_PROPERTY(QSize primarySize READ primarySize CONSTANT)
+
+public:
+    explicit LayoutEngine(QObject *parent = nullptr);
+
+    QString primaryOutput() const;
+    QVariantList secondaryOutputs() const;
+    QSize primarySize() const;
+    int outputCount() const { return m_outputs.size(); }
+
+    Q_INVOKABLE QRect regionRect(const QString &output, const QString &region) const;
+    Q_INVOKABLE QString roleFor(int iviId) const;
+    Q_INVOKABLE QString outputFor(int iviId) const;
+    Q_INVOKABLE QString regionFor(int iviId) const;
+    Q_INVOKABLE QSize surfaceSize(int iviId) const;
+
+private:
+    struct Output {
+        QString name;
+        QSize size;
+        int screen = 0;
+        QHash<QString, QRect> regions;
+    };
+    struct Placement {
+        QString output;
+        QString region;
+    };
+
+    bool load(const QString &path);
+    const Output *output(const QString &name) const;
+    Placement placementFor(int iviId) const;
+
+    QVector<Output> m_outputs;              // primary first
+    QHash<QString, Placement> m_roles;
+    QHash<int, QString> m_surfaceRoles;
+    QString m_defaultRole;
+};
+
+#endif // LAYOUT_ENGINE_H
@@ -2,18 +2,39 @@
 #include <QGuiApplication>
 #include <QQmlApplicationEngine>
 #include <QQmlContext>
+#include <QQuickWindow>
+#include <QWaylandCompositor>
+#include <QWaylandOutput>
 #include <QDir>
 #include <QDebug>
 #include "dbus_manager.h"
+#include "surface_registry.h"
+#include "layout_engine.h"
+#include "compositor_stats.h"
+#include "snapshot_cache.h"
+#include "surface_watchdog.h"
 #include "../theme_client.h"
 
 int main(int argc, char *argv[])
 {
     qputenv("QT_WAYLAND_DISABLE_WINDOWDECORATION", "1");
 
+    // Import client buffers directly (dmabuf, then wayland-egl) instead of
+    // copying them; integrations that fail to initialise are skipped and shm
+    // clients still work, e.g. under QT_QPA_PLATFORM=offscreen
+    if (!qEnvironmentVariableIsSet("QT_WAYLAND_CLIENT_BUFFER_INTEGRATION")) {
+        qputenv("QT_WAYLAND_CLIENT_BUFFER_INTEGRATION", "linux-dmabuf-unstable-v1;wayland-egl");
+    }
+
     // Enable virtual keyboard for the compositor
     qputenv("QT_IM_MODULE", QByteArray("qtvirtualkeyboard"));
 
+    // Software scenegraph: repaints only the dirty region of the window, for
+    // testing damage behaviour without a GPU
+    if (qEnvironmentVariableIntValue("HEADUNIT_COMPOSITOR_SOFTWARE") == 1) {
+        QQuickWindow::setGraphicsApi(QSGRendererInterface::Software);
+    }
+
     QGuiApplication app(argc, argv);
     app.setOrganizationName("HeadUnit");
     app.setOrganizationDomain("com.headunit");
@@ -24,11 +45,38 @@ int main(int argc, char *argv[])
 
     ThemeClient themeClient;
 
+    // Outputs, regions and surface placement (HEADUNIT_LAYOUT overrides)
+    LayoutEngine layoutEngine;
+
+    // One render thread per output window. Read when the first window is
+    // created, so setting it here is still in time.
+    if (layoutEngine.outputCount() > 1 && !qEnvironmentVariableIsSet("QSG_RENDER_LOOP")) {
+        qputenv("QSG_RENDER_LOOP", "threaded");
+    }
+
+    // Owns the iviId -> surface mapping and visibility
+    SurfaceRegistry surfaceRegistry(&layoutEngine);
+
+    // Frame timing and commit latency (off unless HEADUNIT_COMPOSITOR_STATS=1)
+    CompositorStats compositorStats(&surfaceRegistry);
+
+    // Last frame of every app for switch transitions and AppSwitcher thumbnails
+    SnapshotCache snapshotCache(&surfaceRegistry);
+
+    // Pings every client; hung ones get an overlay and an AFM restart
+    SurfaceWatchdog surfaceWatchdog(&surfaceRegistry, &dbusManager);
+
     QQmlApplicationEngine engine;
 
     // Expose D-Bus manager to QML
     engine.rootContext()->setContextProperty("dbusManager", &dbusManager);
     engine.rootContext()->setContextProperty("theme", &themeClient);
+    engine.rootContext()->setContextProperty("layoutEngine", &layoutEngine);
+    engine.rootContext()->setContextProperty("surfaceRegistry", &surfaceRegistry);
+    engine.rootContext()->setContextProperty("compositorStats", &compositorStats);
+    engine.rootContext()->setContextProperty("snapshotCache", &snapshotCache);
+    engine.rootContext()->setContextProperty("surfaceWatchdog", &surfaceWatchdog);
+    engine.addImageProvider("snapshot", new SnapshotImageProvider(&snapshotCache));
 
     qDebug() << "=== Starting HeadUnit Compositor ===";
     qDebug() << "Platform:" << QGuiApplication::platformName();
@@ -51,6 +99,11 @@ int main(int argc, char *argv[])
         return -1;
     }
 
+    auto *compositor = qobject_cast<QWaylandCompositor *>(engine.rootObjects().first());
+    if (compositor && compositor->defaultOutput()) {
+        compositorStats.attachWindow(qobject_cast<QQuickWindow *>(compositor->defaultOutput()->window()));
+    }
+
     qInfo() << "=== HeadUnit Compositor Ready ===";
 
     return app.exec();
@@ -37,6 +37,7 @@ Rectangle {
                 border.width: surfaceManager.currentRightApp === 0 ? 2 : 1
 
                 Behavior on color {
+                    enabled: !theme.transitioning
                     ColorAnimation { duration: 150 }
                 }
             }
@@ -81,8 +82,16 @@ Rectangle {
                 border.width: surfaceManager.currentRightApp === 1002 ? 2 : 1
 
                 Behavior on color {
+                    enabled: !theme.transitioning
                     ColorAnimation { duration: 150 }
                 }
+
+                SnapshotThumbnail {
+                    anchors.fill: parent
+                    anchors.margins: 2
+                    appId: 1002
+                    opacity: surfaceManager.currentRightApp === 1002 ? 0 : 0.35
+                }
             }
 
             contentItem: Column {
@@ -125,8 +134,16 @@ Rectangle {
                 border.width: surfaceManager.currentRightApp === 1003 ? 2 : 1
 
                 Behavior on color {
+                    enabled: !theme.transitioning
                     ColorAnimation { duration: 150 }
                 }
+
+                SnapshotThumbnail {
+                    anchors.fill: parent
+                    anchors.margins: 2
+                    appId: 1003
+                    opacity: surfaceManager.currentRightApp === 1003 ? 0 : 0.35
+                }
             }
 
             contentItem: Column {
@@ -169,8 +186,16 @@ Rectangle {
                 border.width: surfaceManager.currentRightApp === 1004 ? 2 : 1
 
                 Behavior on color {
+                    enabled: !theme.transitioning
                     ColorAnimation { duration: 150 }
                 }
+
+                SnapshotThumbnail {
+                    anchors.fill: parent
+                    anchors.margins: 2
+                    appId: 1004
+                    opacity: surfaceManager.currentRightApp === 1004 ? 0 : 0.35
+                }
             }
 
             contentItem: Column {
@@ -213,8 +238,16 @@ Rectangle {
                 border.width: surfaceManager.currentRightApp === 1005 ? 2 : 1
 
                 Behavior on color {
+                    enabled: !theme.transitioning
                     ColorAnimation { duration: 150 }
                 }
+
+                SnapshotThumbnail {
+                    anchors.fill: parent
+                    anchors.margins: 2
+                    appId: 1005
+                    opacity: surfaceManager.currentRightApp === 1005 ? 0 : 0.35
+                }
             }
 
             contentItem: Column {
@@ -252,6 +285,7 @@ Rectangle {
                 border.width: volumePopup.visible ? 2 : 1
 
                 Behavior on color {
+                    enabled: !theme.transitioning
                     ColorAnimation { duration: 150 }
                 }
             }
@@ -342,6 +376,7 @@ Rectangle {
                     border.width: 2
 
                     Behavior on color {
+                        enabled: !theme.transitioning
                         ColorAnimation { duration: 100 }
                     }
                 }
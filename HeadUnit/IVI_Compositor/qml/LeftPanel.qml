@@ -25,7 +25,7 @@ Rectangle {
         anchors.top: parent.top
         anchors.left: parent.left
         anchors.right: parent.right
-        height: 150
+        height: layoutEngine.regionRect(layoutEngine.primaryOutput, "gear").y
         color: "#2d2d2d"
 
         Column {
@@ -121,7 +121,8 @@ Rectangle {
                     anchors.centerIn: parent
                     spacing: 15
 
-                    // Temperature icon with pulse
+                    // Temperature icon, pulses once per reading change.
+                    // A looping animation would repaint the output every frame.
                     Text {
                         id: tempIcon
                         text: "🌡"
@@ -129,9 +130,10 @@ Rectangle {
                         anchors.verticalCenter: parent.verticalCenter
 
                         SequentialAnimation on scale {
-                            loops: Animation.Infinite
-                            NumberAnimation { to: 1.1; duration: 2000; easing.type: Easing.InOutQuad }
-                            NumberAnimation { to: 1.0; duration: 2000; easing.type: Easing.InOutQuad }
+                            id: tempPulse
+                            running: false
+                            NumberAnimation { to: 1.1; duration: 400; easing.type: Easing.InOutQuad }
+                            NumberAnimation { to: 1.0; duration: 400; easing.type: Easing.InOutQuad }
                         }
                     }
 
@@ -149,6 +151,8 @@ Rectangle {
                                 font.pixelSize: 28
                                 font.bold: true
 
+                                onTextChanged: tempPulse.restart()
+
                                 Behavior on color {
                                     ColorAnimation { duration: 500 }
                                 }
@@ -223,6 +227,13 @@ Rectangle {
         }
     }
 
+    // Outside the container, whose children count tells if the gear is there
+    NotRespondingOverlay {
+        id: gearNotResponding
+        anchors.fill: gearSelectorContainer
+        z: 20
+    }
+
     // Placeholder
     Column {
         anchors.centerIn: gearSelectorContainer
@@ -238,6 +249,7 @@ Rectangle {
 
             SequentialAnimation on opacity {
                 loops: Animation.Infinite
+                running: gearSelectorContainer.children.length === 0
                 NumberAnimation { to: 0.3; duration: 1000 }
                 NumberAnimation { to: 1.0; duration: 1000 }
             }
@@ -251,11 +263,13 @@ Rectangle {
         }
     }
 
-    // Timer to update clock
+    // Timer to update clock. The display only shows minutes, so it fires on
+    // the minute boundary instead of every second.
     Timer {
-        interval: 1000
+        id: clockTimer
+        interval: msToNextMinute()
         running: true
-        repeat: true
+        repeat: false
 
         property string lastMinute: ""
 
@@ -271,6 +285,15 @@ Rectangle {
                 glowAnimation.restart()
             }
             lastMinute = currentMinute
+
+            interval = msToNextMinute()
+            start()
+        }
+
+        function msToNextMinute() {
+            var now = new Date()
+            // Small slack so the tick lands after the minute has rolled over
+            return 60000 - (now.getSeconds() * 1000 + now.getMilliseconds()) + 20
         }
     }
 
@@ -299,14 +322,14 @@ Rectangle {
         // Set parent first
         surfaceItem.parent = gearSelectorContainer
 
-        // Center horizontally in the container
-        // Container is 300px wide, surface is 200px wide
-        // So we need 50px offset from left
-        surfaceItem.x = (gearSelectorContainer.width - surfaceItem.width) / 2
-        surfaceItem.y = 0
+        // Centre horizontally; the size comes from the layout's gear region
+        // and is applied by surfaceRegistry after this
+        surfaceItem.anchors.horizontalCenter = gearSelectorContainer.horizontalCenter
+        surfaceItem.anchors.top = gearSelectorContainer.top
 
         surfaceItem.visible = true
         surfaceItem.z = 10
+        gearNotResponding.appId = surfaceItem.iviId
 
         console.log("LeftPanel: GearSelector positioned at", surfaceItem.x, ",", surfaceItem.y)
         console.log("LeftPanel: Surface added successfully")
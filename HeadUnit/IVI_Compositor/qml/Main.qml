@@ -8,7 +8,8 @@ WaylandCompositor {
 
     socketName: "wayland-1"
 
-    /*// Text Input Manager for virtual keyboard support
+    // Text input protocols: clients' text fields drive the one keyboard
+    // hosted here (RightPanel) instead of loading a keyboard per process
     TextInputManager {
         id: textInputManager
     }
@@ -16,7 +17,7 @@ WaylandCompositor {
     // QtTextInputMethodManager for Qt Virtual Keyboard integration
     QtTextInputMethodManager {
         id: qtTextInputMethodManager
-    }*/
+    }
 
     // IVI Application extension
     IviApplication {
@@ -42,13 +43,49 @@ WaylandCompositor {
             output.window.rightPanel.addSurface(item)
         }
 
+        onSurfaceCreatedForOutput: function(outputName, region, item) {
+            var window = secondaryWindows[outputName]
+            if (window) {
+                window.addSurface(item, region)
+            } else {
+                console.warn("No window for output", outputName)
+            }
+        }
+
         onSurfaceDestroyed: function(iviId) {
             console.log("Surface destroyed:", iviId)
             notifyAppDisconnected(iviId)
         }
     }
 
-    // Wayland Output
+    // Windows of the secondary outputs, by layout output name
+    property var secondaryWindows: ({})
+
+    // Secondary outputs from the layout description. Each window renders on
+    // its own render thread with the threaded render loop.
+    Instantiator {
+        model: layoutEngine.secondaryOutputs
+
+        delegate: WaylandOutput {
+            compositor: waylandCompositor
+            sizeFollowsWindow: true
+
+            window: OutputWindow {
+                outputName: modelData.name
+                width: modelData.width
+                height: modelData.height
+                screen: modelData.screen < Qt.application.screens.length
+                        ? Qt.application.screens[modelData.screen]
+                        : Qt.application.screens[0]
+            }
+        }
+
+        onObjectAdded: function(index, object) {
+            secondaryWindows[object.window.outputName] = object.window
+        }
+    }
+
+    // Primary Wayland Output
     WaylandOutput {
         id: output
         compositor: waylandCompositor
@@ -60,16 +97,17 @@ WaylandCompositor {
             property alias leftPanel: leftPanelItem
             property alias rightPanel: rightPanelItem
 
-            width: 1024
-            height: 600
+            width: layoutEngine.primarySize.width
+            height: layoutEngine.primarySize.height
             visible: true
             title: "HeadUnit IVI Compositor"
             flags: Qt.FramelessWindowHint
+            // Cleared by the renderer; no full-window rectangle to composite
+            color: "#1a1a1a"
 
-            Rectangle {
+            Item {
                 id: background
                 anchors.fill: parent
-                color: "#1a1a1a"
 
                 // Left panel - Clock, Temperature, GearSelector
                 LeftPanel {
@@ -77,7 +115,7 @@ WaylandCompositor {
                     anchors.left: parent.left
                     anchors.top: parent.top
                     anchors.bottom: parent.bottom
-                    width: 200
+                    width: layoutEngine.regionRect(layoutEngine.primaryOutput, "left").width
                 }
 
                 // Right panel - HomeView / Apps + AppSwitcher
@@ -86,7 +124,7 @@ WaylandCompositor {
                     anchors.right: parent.right
                     anchors.top: parent.top
                     anchors.bottom: parent.bottom
-                    width: 824
+                    width: layoutEngine.regionRect(layoutEngine.primaryOutput, "right").width
 
                     onApplicationSwitchRequested: function(appId) {
                         console.log("=== Application Switch Requested ===")
@@ -163,6 +201,16 @@ WaylandCompositor {
                         }
                     }
                 }
+
+                // Frame timing HUD (HEADUNIT_COMPOSITOR_HUD=1 or over D-Bus)
+                Loader {
+                    anchors.top: parent.top
+                    anchors.right: parent.right
+                    anchors.topMargin: 90
+                    anchors.rightMargin: 5
+                    active: compositorStats.hudVisible
+                    source: "StatsOverlay.qml"
+                }
             }
         }
     }
@@ -185,24 +233,21 @@ WaylandCompositor {
         dbusManager.launchApp(iviId)
     }
 
+    function leftPanelWidth() {
+        return layoutEngine.regionRect(layoutEngine.primaryOutput, "left").width
+    }
+
     function getAppName(iviId) {
-        var names = {
-            0: "Home",
-            1001: "GearSelector",
-            1002: "MediaPlayer",
-            1003: "ThemeColor",
-            1004: "Navigation",
-            1005: "Settings"
-        }
-        return names[iviId] || "None"
+        return surfaceRegistry.appName(iviId)
     }
 
     Component.onCompleted: {
         console.log("=== HeadUnit Compositor Ready ===")
         console.log("Socket: wayland-1")
-        console.log("Resolution: 1024x600")
-        console.log("Left panel: 200px")
-        console.log("Right panel: 824px")
+        console.log("Resolution:", layoutEngine.primarySize.width + "x" + layoutEngine.primarySize.height)
+        console.log("Left panel:", leftPanelWidth() + "px")
+        console.log("Right panel:", output.window.width - leftPanelWidth() + "px")
+        console.log("Secondary outputs:", layoutEngine.secondaryOutputs.length)
         console.log("Starting on: HomeView")
         console.log("Text Input Manager enabled")
         console.log("=================================")
@@ -65,9 +65,10 @@ Item {
                     border.color: "#ffffff"
                     border.width: 3
 
-                    // Pulsing animation
+                    // Pulsing animation, only while HomeView is on screen
                     SequentialAnimation on scale {
                         loops: Animation.Infinite
+                        running: surfaceRegistry.currentRightApp === 0
                         NumberAnimation { to: 1.2; duration: 1000 }
                         NumberAnimation { to: 1.0; duration: 1000 }
                     }
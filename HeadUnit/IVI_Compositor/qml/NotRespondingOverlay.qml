@@ -0,0 +1,62 @@
+import QtQuick
+
+// Covers a client that stopped answering surfaceWatchdog's pings. The frozen
+// surface stays underneath; touches go to the overlay instead of queueing up
+// in the hung client.
+Rectangle {
+    id: overlay
+
+    property int appId: 0
+
+    visible: appId !== 0 && surfaceWatchdog.hungSurfaces.indexOf(appId) !== -1
+    color: "#cc1a1a1a"
+
+    MouseArea {
+        anchors.fill: parent
+    }
+
+    Column {
+        anchors.centerIn: parent
+        width: parent.width - 20
+        spacing: 12
+
+        Text {
+            width: parent.width
+            text: surfaceRegistry.appName(overlay.appId) + " is not responding"
+            color: "#ffffff"
+            font.pixelSize: 18
+            wrapMode: Text.WordWrap
+            horizontalAlignment: Text.AlignHCenter
+        }
+
+        Text {
+            width: parent.width
+            text: "It will be restarted automatically"
+            color: "#808080"
+            font.pixelSize: 12
+            wrapMode: Text.WordWrap
+            horizontalAlignment: Text.AlignHCenter
+        }
+
+        Rectangle {
+            anchors.horizontalCenter: parent.horizontalCenter
+            width: 140
+            height: 40
+            radius: 6
+            color: restartArea.pressed ? theme.buttonPressedColor : theme.buttonColor
+
+            Text {
+                anchors.centerIn: parent
+                text: "Restart now"
+                color: "#ffffff"
+                font.pixelSize: 14
+            }
+
+            MouseArea {
+                id: restartArea
+                anchors.fill: parent
+                onClicked: surfaceWatchdog.restartApp(overlay.appId)
+            }
+        }
+    }
+}
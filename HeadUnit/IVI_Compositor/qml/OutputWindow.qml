@@ -0,0 +1,38 @@
+import QtQuick
+import QtQuick.Window
+
+// Window of a secondary output from the layout description (cluster, rear
+// seat). Surfaces are placed into the named regions of that output.
+Window {
+    id: outputWindow
+
+    property string outputName: ""
+    property var regionItems: ({})
+
+    visible: true
+    title: "HeadUnit " + outputName
+    flags: Qt.FramelessWindowHint
+    color: "#000000"
+
+    function regionItem(region) {
+        if (!regionItems[region]) {
+            var rect = layoutEngine.regionRect(outputName, region)
+            regionItems[region] = regionComponent.createObject(contentItem, {
+                "x": rect.x, "y": rect.y, "width": rect.width, "height": rect.height
+            })
+        }
+        return regionItems[region]
+    }
+
+    function addSurface(surfaceItem, region) {
+        var container = regionItem(region)
+        console.log("OutputWindow:", outputName, "adding surface", surfaceItem.iviId, "to", region)
+        surfaceItem.parent = container
+        surfaceItem.anchors.fill = container
+    }
+
+    Component {
+        id: regionComponent
+        Item { }
+    }
+}
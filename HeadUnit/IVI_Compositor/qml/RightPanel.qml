@@ -1,11 +1,13 @@
 import QtQuick
 import QtWayland.Compositor
 import QtQuick.VirtualKeyboard
+import QtQuick.VirtualKeyboard.Settings
 
 Rectangle {
     id: rightPanel
 
-    color: "#1a1a1a"
+    // An opaque app covering its slot hides everything beneath it
+    color: surfaceRegistry.currentOpaque ? "transparent" : "#1a1a1a"
 
     signal applicationSwitchRequested(int appId)
 
@@ -37,7 +39,7 @@ Rectangle {
             HomeView {
                 id: homeView
                 anchors.fill: parent
-                visible: true  // Start visible
+                visible: surfaceRegistry.currentRightApp === 0
                 z: 5
 
                 onApplicationRequested: function(appId) {
@@ -51,11 +53,90 @@ Rectangle {
                 id: surfaceContainer
                 anchors.fill: parent
                 z: 10
-                visible: false  // Start hidden
+                visible: surfaceRegistry.currentRightApp !== 0
+            }
+
+            // Last frame of the incoming app, shown the moment it is switched
+            // to and faded out once the app commits live content
+            Item {
+                id: switchCover
+                anchors.fill: parent
+                z: 20
+                opacity: 0
+                visible: opacity > 0
+
+                property int appId: 0
+
+                Rectangle {
+                    anchors.fill: parent
+                    color: "#1a1a1a"
+                }
+
+                Image {
+                    id: coverImage
+                    anchors.fill: parent
+                    cache: false
+                    smooth: true
+                }
+
+                Text {
+                    anchors.centerIn: parent
+                    visible: coverImage.status !== Image.Ready
+                    text: surfaceRegistry.appName(switchCover.appId)
+                    color: "#808080"
+                    font.pixelSize: 18
+                }
+
+                NumberAnimation on opacity {
+                    id: coverFade
+                    running: false
+                    to: 0
+                    duration: 200
+                    easing.type: Easing.InOutQuad
+                }
+
+                // Static apps may not commit at all once resumed
+                Timer {
+                    id: coverTimeout
+                    interval: coverImage.source != "" ? 500 : 2000
+                    onTriggered: coverFade.start()
+                }
+            }
+
+            NotRespondingOverlay {
+                anchors.fill: parent
+                z: 30
+                appId: surfaceRegistry.currentRightApp
+            }
+
+            Connections {
+                target: surfaceRegistry
+
+                function onCurrentRightAppChanged() {
+                    var appId = surfaceRegistry.currentRightApp
+                    coverFade.stop()
+                    coverTimeout.stop()
+                    if (appId === 0) {
+                        switchCover.opacity = 0
+                        return
+                    }
+                    switchCover.appId = appId
+                    coverImage.source = snapshotCache.url(appId)
+                    switchCover.opacity = 1
+                    coverTimeout.start()
+                }
+
+                function onSurfaceContentReady(iviId) {
+                    if (iviId === switchCover.appId && switchCover.opacity > 0) {
+                        coverTimeout.stop()
+                        coverFade.start()
+                    }
+                }
             }
         }
 
-        /*// Virtual Keyboard with background
+        // Shared virtual keyboard for every client. It is created at startup
+        // so the first open does not pay for loading the layouts.
         Item {
             id: keyboardContainer
             anchors.left: parent.left
@@ -87,9 +168,6 @@ Rectangle {
                 anchors.right: parent.right
                 anchors.bottom: parent.bottom
 
-                // Make it respond to the compositor's window
-                active: Qt.inputMethod.visible
-
                 onActiveChanged: {
                     console.log("InputPanel active changed:", active)
                 }
@@ -101,7 +179,26 @@ Rectangle {
                     easing.type: Easing.InOutQuad
                 }
             }
-        }*/
+        }
+    }
+
+    // Only the locales offered here are loaded, which keeps keyboard memory
+    // and first-open time down
+    Binding {
+        target: VirtualKeyboardSettings
+        property: "activeLocales"
+        value: ["en_US", "de_DE"]
+    }
+
+    // Keyboard open latency: request to first presented frame (stats)
+    Connections {
+        target: Qt.inputMethod
+
+        function onVisibleChanged() {
+            if (Qt.inputMethod.visible) {
+                compositorStats.markKeyboardRequested()
+            }
+        }
     }
 
     // AppSwitcher at bottom (always visible)
@@ -129,32 +226,6 @@ Rectangle {
         console.log("RightPanel: Surface added")
     }
 
-    // Function to show HomeView and hide all surfaces
-    function showHome() {
-        console.log("RightPanel: Showing HomeView")
-
-        // Hide surface container
-        surfaceContainer.visible = false
-
-        // Show HomeView
-        homeView.visible = true
-
-        console.log("RightPanel: HomeView is now visible")
-    }
-
-    // Function to show a specific surface and hide HomeView
-    function showSurface() {
-        console.log("RightPanel: Showing surface container")
-
-        // Hide HomeView
-        homeView.visible = false
-
-        // Show surface container
-        surfaceContainer.visible = true
-
-        console.log("RightPanel: Surface container is now visible")
-    }
-
     Component.onCompleted: {
         console.log("RightPanel initialized with Virtual Keyboard support")
         console.log("HomeView visible:", homeView.visible)
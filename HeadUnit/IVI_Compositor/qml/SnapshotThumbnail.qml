@@ -0,0 +1,17 @@
+import QtQuick
+
+// Last frame of an app, as kept by snapshotCache. Empty until the app has
+// been on screen once.
+Image {
+    id: thumbnail
+
+    property int appId: 0
+
+    source: snapshotCache.revision >= 0 ? snapshotCache.url(appId) : ""
+    visible: status === Image.Ready
+    sourceSize.width: width
+    sourceSize.height: height
+    fillMode: Image.PreserveAspectCrop
+    cache: false
+    smooth: true
+}
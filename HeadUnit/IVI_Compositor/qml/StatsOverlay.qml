@@ -0,0 +1,53 @@
+import QtQuick
+
+// Frame pacing HUD fed by compositorStats (C++). Only created while the HUD
+// is switched on, so it costs nothing otherwise.
+Rectangle {
+    id: statsOverlay
+
+    width: 220
+    height: statsColumn.implicitHeight + 10
+    color: "#80000000"
+    radius: 5
+
+    Column {
+        id: statsColumn
+        anchors.left: parent.left
+        anchors.top: parent.top
+        anchors.margins: 5
+        spacing: 2
+
+        Text {
+            text: "FPS " + compositorStats.fps.toFixed(1)
+                  + "  dropped " + compositorStats.droppedFrames
+                  + "  idle " + compositorStats.idlePercent.toFixed(0) + "%"
+            color: "#00ff00"
+            font.pixelSize: 10
+            font.bold: true
+        }
+
+        Text {
+            text: "frame p50 " + compositorStats.frameP50Ms.toFixed(1)
+                  + " / p99 " + compositorStats.frameP99Ms.toFixed(1) + " ms"
+            color: "white"
+            font.pixelSize: 9
+        }
+
+        Text {
+            text: "render p95 " + compositorStats.renderP95Ms.toFixed(1) + " ms"
+                  + (surfaceRegistry.currentOpaque ? "  [opaque app]" : "")
+            color: "white"
+            font.pixelSize: 9
+        }
+
+        Repeater {
+            model: compositorStats.surfaceLines
+
+            Text {
+                text: modelData
+                color: "#cccccc"
+                font.pixelSize: 9
+            }
+        }
+    }
+}
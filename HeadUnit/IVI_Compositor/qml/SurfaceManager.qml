@@ -1,103 +1,64 @@
 import QtQuick
 import QtWayland.Compositor
 
+// Thin QML front for surfaceRegistry (C++). The registry owns the
+// iviId -> item map, sizes and visibility; this file only creates the
+// ShellSurfaceItems and keeps the API the rest of the QML uses.
 QtObject {
     id: surfaceManager
 
     property var compositor
-    property var activeSurfaces: ({})
-    property int currentRightApp: 0  // Start at 0 = HomeView
-    property int activeSurfaceCount: 0
-    property int pendingLaunchAppId: 0  // NEW: Track app being launched for auto-switch
+    readonly property int currentRightApp: surfaceRegistry.currentRightApp  // 0 = HomeView
+    readonly property int activeSurfaceCount: surfaceRegistry.count
+    readonly property int pendingLaunchAppId: surfaceRegistry.pendingLaunchAppId
 
     signal surfaceCreatedForLeft(var surface, var item)
     signal surfaceCreatedForRight(var surface, var item)
+    signal surfaceCreatedForOutput(string outputName, string region, var item)
     signal surfaceDestroyed(int iviId)
 
+    property Connections registryConnections: Connections {
+        target: surfaceRegistry
+
+        function onSurfaceRemoved(iviId) {
+            surfaceManager.surfaceDestroyed(iviId)
+        }
+    }
+
     property Component shellSurfaceComponent: Component {
         ShellSurfaceItem {
             id: surfaceItem
             property int iviId: shellSurface ? shellSurface.iviId : 0
 
-            // FIXED: Use property bindings to avoid -1 width issue
-            // Adjusted height to account for keyboard appearance (dynamic sizing)
-            width: {
-                if (iviId === 1001) return 200
-                return 820
-            }
-
-            height: {
-                if (iviId === 1001) return 450
-                // Right panel apps: 550 (panel height) - 80 (AppSwitcher)
-                // This gives 470px for content, which will shrink when keyboard appears
-                return 470
-            }
-
-            visible: {
-                if (iviId === 1001) return true  // GearSelector always visible
-                return iviId === surfaceManager.currentRightApp
-            }
-
-            Behavior on opacity {
-                NumberAnimation { duration: 300; easing.type: Easing.InOutQuad }
-            }
-
-            opacity: visible ? 1.0 : 0.0
-            enabled: visible
-            focus: visible
+            // Size, configure, visibility and focus are set by surfaceRegistry.
+            // The switch cross-fade is done by RightPanel's snapshot cover.
+            visible: false
 
             onSurfaceDestroyed: {
                 console.log("Surface destroyed:", iviId)
-                surfaceManager.handleSurfaceDestroyed(iviId)
+                surfaceRegistry.unregisterSurface(iviId)
                 destroy()
             }
-
-            Component.onCompleted: {
-                console.log("ShellSurfaceItem completed for IVI-ID", iviId, "Size:", width, "x", height)
-
-                if (shellSurface && width > 0 && height > 0) {
-                    shellSurface.sendConfigure(Qt.size(width, height))
-                }
-            }
-
-            onWidthChanged: {
-                if (shellSurface && width > 0 && height > 0) {
-                    console.log("Width changed for IVI-ID", iviId, "to", width)
-                    shellSurface.sendConfigure(Qt.size(width, height))
-                }
-            }
-
-            onHeightChanged: {
-                if (shellSurface && height > 0 && width > 0) {
-                    console.log("Height changed for IVI-ID", iviId, "to", height)
-                    shellSurface.sendConfigure(Qt.size(width, height))
-                }
-            }
         }
     }
 
     function isAppRunning(iviId) {
-        return activeSurfaces.hasOwnProperty(iviId)
+        return surfaceRegistry.isAppRunning(iviId)
     }
 
     function getAppSurfaceItem(iviId) {
-        if (activeSurfaces[iviId]) {
-            return activeSurfaces[iviId].item
-        }
-        return null
+        return surfaceRegistry.surfaceItem(iviId)
     }
 
     function getAppSurface(iviId) {
-        if (activeSurfaces[iviId]) {
-            return activeSurfaces[iviId].surface
-        }
-        return null
+        var item = surfaceRegistry.surfaceItem(iviId)
+        return item ? item.shellSurface : null
     }
 
-    // NEW: Mark an app as pending launch for auto-switch
+    // Mark an app as pending launch for auto-switch
     function setPendingLaunch(iviId) {
         console.log("SurfaceManager: Setting pending launch for app:", iviId)
-        pendingLaunchAppId = iviId
+        surfaceRegistry.pendingLaunchAppId = iviId
     }
 
     function handleNewSurface(iviSurface) {
@@ -113,165 +74,36 @@ QtObject {
             return
         }
 
-        activeSurfaces[iviId] = {
-            surface: iviSurface,
-            item: item
-        }
-
-        activeSurfaceCount = Object.keys(activeSurfaces).length
-
-        if (iviId === 1001) {
-            // GearSelector goes to left panel
+        // Reparent into the panel first so the registry's visibility applies in place
+        var outputName = layoutEngine.outputFor(iviId)
+        if (outputName !== layoutEngine.primaryOutput) {
+            surfaceCreatedForOutput(outputName, layoutEngine.regionFor(iviId), item)
+        } else if (surfaceRegistry.isLeftPanelApp(iviId)) {
             surfaceCreatedForLeft(iviSurface, item)
         } else {
-            // Other apps go to right panel
             surfaceCreatedForRight(iviSurface, item)
+        }
 
-            // NEW: Auto-switch if this was the pending app
-            if (iviId === pendingLaunchAppId) {
-                console.log("SurfaceManager: Pending app", iviId, "surface created - auto-switching")
-                Qt.callLater(function() {
-                    switchToApplication(iviId)
-                })
-                pendingLaunchAppId = 0  // Clear pending
-            } else {
-                console.log("Surface ready for app", iviId, "- staying on current view")
-            }
+        if (!surfaceRegistry.registerSurface(item)) {
+            item.destroy()
         }
     }
 
     function switchToApplication(targetAppId) {
         console.log("SurfaceManager: Switching to app:", targetAppId)
-
-        // Special case: 0 means return to HomeView
-        if (targetAppId === 0) {
-            console.log("Switching to HomeView")
-
-            // Hide all app surfaces
-            for (var id in activeSurfaces) {
-                var appId = parseInt(id)
-                if (appId !== 1001 && activeSurfaces[id].item) {
-                    activeSurfaces[id].item.visible = false
-                    activeSurfaces[id].item.focus = false
-                }
-            }
-
-            // Tell RightPanel to show HomeView
-            if (compositor && compositor.defaultOutput && compositor.defaultOutput.window) {
-                var rightPanel = compositor.defaultOutput.window.rightPanel
-                if (rightPanel) {
-                    rightPanel.showHome()
-                }
-            }
-
-            currentRightApp = 0
-            console.log("Now showing: HomeView")
-            return true
-        }
-
-        // Check if already showing this app
-        if (currentRightApp === targetAppId) {
-            console.log("Already showing app:", targetAppId)
-            return true
-        }
-
-        // Check if app is running
-        if (!activeSurfaces[targetAppId]) {
-            console.warn("Cannot switch - app not running:", targetAppId)
-            return false
-        }
-
-        // Hide current app (if not Home)
-        if (currentRightApp !== 0 && activeSurfaces[currentRightApp]) {
-            var currentItem = activeSurfaces[currentRightApp].item
-            if (currentItem) {
-                console.log("Hiding current app:", currentRightApp)
-                currentItem.visible = false
-                currentItem.focus = false
-            }
-        }
-
-        // Show target app
-        var targetItem = activeSurfaces[targetAppId].item
-        if (targetItem) {
-            console.log("Showing target app:", targetAppId)
-
-            // Tell RightPanel to show surface container
-            if (compositor && compositor.defaultOutput && compositor.defaultOutput.window) {
-                var rightPanelWin = compositor.defaultOutput.window.rightPanel
-                if (rightPanelWin) {
-                    rightPanelWin.showSurface()
-                }
-            }
-
-            targetItem.visible = true
-            targetItem.focus = true
-            targetItem.forceActiveFocus()
-
-            if (targetItem.shellSurface) {
-                targetItem.shellSurface.sendConfigure(
-                    Qt.size(targetItem.width, targetItem.height)
-                )
-            }
-        }
-
-        currentRightApp = targetAppId
-        console.log("Switch complete. Current app is now:", currentRightApp)
-        return true
+        surfaceRegistry.currentRightApp = targetAppId
+        return surfaceRegistry.currentRightApp === targetAppId
     }
 
     function handleSurfaceDestroyed(iviId) {
-        if (activeSurfaces[iviId]) {
-            console.log("SurfaceManager: Handling surface destruction for", iviId)
-
-            delete activeSurfaces[iviId]
-            activeSurfaceCount = Object.keys(activeSurfaces).length
-
-            // If the destroyed app was the current one, return to Home
-            if (iviId === currentRightApp) {
-                console.log("Current app destroyed, returning to HomeView")
-                switchToApplication(0)
-            }
-
-            // Clear pending if it was this app
-            if (iviId === pendingLaunchAppId) {
-                pendingLaunchAppId = 0
-            }
-
-            surfaceDestroyed(iviId)
-        }
+        surfaceRegistry.unregisterSurface(iviId)
     }
 
     function findFirstAvailableApp() {
-        var priority = [1002, 1003, 1004, 1005]
-
-        for (var i = 0; i < priority.length; i++) {
-            var iviId = priority[i]
-            if (activeSurfaces[iviId]) {
-                console.log("Found fallback app:", iviId)
-                return iviId
-            }
-        }
-
-        for (var id in activeSurfaces) {
-            var appId = parseInt(id)
-            if (appId !== 1001 && appId !== 0) {
-                console.log("Found any available app:", appId)
-                return appId
-            }
-        }
-
-        return 0
+        return surfaceRegistry.firstAvailableApp()
     }
 
     function getRunningApps() {
-        var running = []
-        for (var id in activeSurfaces) {
-            var appId = parseInt(id)
-            if (appId !== 1001) {
-                running.push(appId)
-            }
-        }
-        return running
+        return surfaceRegistry.runningApps()
     }
 }
@@ -0,0 +1,144 @@
+// snapshot_cache.cpp
+#include "snapshot_cache.h"
+#include "surface_registry.h"
+#include <QDebug>
+#include <QMutexLocker>
+#include <QQuickItem>
+#include <QQuickItemGrabResult>
+
+SnapshotCache::SnapshotCache(SurfaceRegistry *registry, QObject *parent)
+    : QObject(parent)
+    , m_registry(registry)
+    , m_scale(0.5)
+    , m_revision(0)
+{
+    bool ok = false;
+    const int budgetKb = qEnvironmentVariableIntValue("HEADUNIT_SNAPSHOT_BUDGET_KB", &ok);
+    m_images.setMaxCost(qint64(ok && budgetKb > 0 ? budgetKb : 4096) * 1024);
+
+    connect(m_registry, &SurfaceRegistry::surfaceAboutToHide, this, &SnapshotCache::grab);
+    connect(m_registry, &SurfaceRegistry::surfaceRemoved, this, &SnapshotCache::onSurfaceRemoved);
+}
+
+int SnapshotCache::budgetKb() const
+{
+    return int(m_images.maxCost() / 1024);
+}
+
+int SnapshotCache::usedKb() const
+{
+    QMutexLocker locker(&m_mutex);
+    return int(m_images.totalCost() / 1024);
+}
+
+QString SnapshotCache::url(int iviId) const
+{
+    if (!hasSnapshot(iviId)) {
+        return QString();
+    }
+    return QStringLiteral("image://snapshot/%1/%2").arg(iviId).arg(m_serials.value(iviId));
+}
+
+bool SnapshotCache::hasSnapshot(int iviId) const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_images.contains(iviId);
+}
+
+QImage SnapshotCache::image(int iviId) const
+{
+    QMutexLocker locker(&m_mutex);
+    const QImage *image = m_images.object(iviId);
+    return image ? *image : QImage();
+}
+
+void SnapshotCache::onSurfaceRemoved(int iviId)
+{
+    m_pending.remove(iviId);
+    m_serials.remove(iviId);
+    {
+        QMutexLocker locker(&m_mutex);
+        if (!m_images.remove(iviId)) {
+            return;
+        }
+    }
+    m_revision++;
+    emit revisionChanged();
+}
+
+void SnapshotCache::grab(int iviId, QQuickItem *item)
+{
+    if (m_pending.contains(iviId)) {
+        return;
+    }
+    const QSize target = (item->size() * m_scale).toSize();
+    if (target.isEmpty()) {
+        return;
+    }
+
+    // Rendered with the next frame; the grab still sees the item once hidden
+    QSharedPointer<QQuickItemGrabResult> result = item->grabToImage(target);
+    if (!result) {
+        return;
+    }
+
+    m_pending.insert(iviId, result);
+    QQuickItemGrabResult *grabResult = result.data();
+    connect(grabResult, &QQuickItemGrabResult::ready, this, [this, iviId, grabResult]() {
+        if (m_pending.value(iviId).data() != grabResult) {
+            return;     // surface went away while the grab was pending
+        }
+        const QImage image = m_pending.take(iviId)->image();
+        store(iviId, image);
+    });
+}
+
+void SnapshotCache::store(int iviId, const QImage &image)
+{
+    if (image.isNull()) {
+        return;
+    }
+
+    // Surfaces are opaque in practice; RGB32 keeps the upload blend-free
+    auto *copy = new QImage(image.convertToFormat(QImage::Format_RGB32));
+    const qint64 cost = copy->sizeInBytes();
+    {
+        QMutexLocker locker(&m_mutex);
+        if (!m_images.insert(iviId, copy, cost)) {
+            qWarning() << "[SnapshotCache] Snapshot of" << iviId << "exceeds the budget of"
+                       << budgetKb() << "KB";
+            return;
+        }
+    }
+
+    // Unique over all surfaces, so a surface that comes back with the same
+    // id never gets the URL of a dropped snapshot from the image cache
+    m_revision++;
+    m_serials[iviId] = quint32(m_revision);
+    emit revisionChanged();
+}
+
+// ============================================================================
+// SnapshotImageProvider Implementation
+// ============================================================================
+
+SnapshotImageProvider::SnapshotImageProvider(SnapshotCache *cache)
+    : QQuickImageProvider(QQuickImageProvider::Image)
+    , m_cache(cache)
+{
+}
+
+QImage SnapshotImageProvider::requestImage(const QString &id, QSize *size, const QSize &requestedSize)
+{
+    // id is "<iviId>/<serial>"; the serial only defeats URL caching
+    const int iviId = id.section('/', 0, 0).toInt();
+    QImage image = m_cache ? m_cache->image(iviId) : QImage();
+
+    if (!image.isNull() && requestedSize.isValid()) {
+        image = image.scaled(requestedSize, Qt::KeepAspectRatio, Qt::SmoothTransformation);
+    }
+    if (size) {
+        *size = image.size();
+    }
+    return image;
+}
@@ -0,0 +1,76 @@
+// snapshot_cache.h
+#ifndef SNAPSHOT_CACHE_H
+#define SNAPSHOT_CACHE_H
+
+#include <QObject>
+#include <QCache>
+#include <QHash>
+#include <QImage>
+#include <QMutex>
+#include <QPointer>
+#include <QQuickImageProvider>
+#include <QSharedPointer>
+
+class QQuickItem;
+class QQuickItemGrabResult;
+class SurfaceRegistry;
+
+// Keeps a downscaled copy of the last frame of every app surface.
+//
+// A surface is grabbed once, when it is switched away from, so its copy is
+// its last frame on screen and the shown app costs no readbacks. The least
+// recently used snapshots are evicted once the byte budget is exceeded. QML
+// reads them through the "snapshot" image provider; url() changes whenever a
+// snapshot is replaced.
+//
+// HEADUNIT_SNAPSHOT_BUDGET_KB (default 4096) sets the budget.
+class SnapshotCache : public QObject
+{
+    Q_OBJECT
+    Q_PROPERTY(int revision READ revision NOTIFY revisionChanged)
+    Q_PROPERTY(int budgetKb READ budgetKb CONSTANT)
+    Q_PROPERTY(int usedKb READ usedKb NOTIFY revisionChanged)
+
+public:
+    explicit SnapshotCache(SurfaceRegistry *registry, QObject *parent = nullptr);
+
+    int revision() const { return m_revision; }
+    int budgetKb() const;
+    int usedKb() const;
+
+    // "image://snapshot/<iviId>/<serial>", or empty without a snapshot
+    Q_INVOKABLE QString url(int iviId) const;
+    Q_INVOKABLE bool hasSnapshot(int iviId) const;
+
+    QImage image(int iviId) const;
+
+signals:
+    void revisionChanged();
+
+private:
+    void onSurfaceRemoved(int iviId);
+    void grab(int iviId, QQuickItem *item);
+    void store(int iviId, const QImage &image);
+
+    SurfaceRegistry *m_registry;
+    QHash<int, QSharedPointer<QQuickItemGrabResult>> m_pending;
+    QHash<int, quint32> m_serials;
+    qreal m_scale;
+    int m_revision;
+
+    mutable QMutex m_mutex;         // the image provider may run off the GUI thread
+    QCache<int, QImage> m_images;   // cost in bytes
+};
+
+class SnapshotImageProvider : public QQuickImageProvider
+{
+public:
+    explicit SnapshotImageProvider(SnapshotCache *cache);
+
+    QImage requestImage(const QString &id, QSize *size, const QSize &requestedSize) override;
+
+private:
+    QPointer<SnapshotCache> m_cache;
+};
+
+#endif // SNAPSHOT_CACHE_H
@@ -0,0 +1,436 @@
+// surface_registry.cpp
+#include "surface_registry.h"
+#include "layout_engine.h"
+#include <QDebug>
+#include <QQuickItem>
+#include <QWaylandCompositor>
+#include <QWaylandIviSurface>
+#include <QWaylandOutput>
+#include <QWaylandQuickShellSurfaceItem>
+#include <QWaylandSurface>
+
+SurfaceRegistry::SurfaceRegistry(LayoutEngine *layout, QObject *parent)
+    : QAbstractListModel(parent)
+    , m_layout(layout)
+    , m_currentRightApp(0)
+    , m_pendingLaunchAppId(0)
+    , m_currentOpaque(false)
+{
+    connect(&m_configure, &ConfigureScheduler::countersChanged, this, [this](int iviId) {
+        emitRowChanged(iviId, { ConfigureCountRole, ConfigureCoalescedRole });
+    });
+
+    m_rateTimer.setInterval(1000);
+    connect(&m_rateTimer, &QTimer::timeout, this, &SurfaceRegistry::sampleCommitRates);
+}
+
+int SurfaceRegistry::rowCount(const QModelIndex &parent) const
+{
+    if (parent.isValid()) {
+        return 0;
+    }
+    return m_rows.size();
+}
+
+QVariant SurfaceRegistry::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid() || index.row() >= m_rows.size()) {
+        return QVariant();
+    }
+
+    const int iviId = m_rows[index.row()];
+    const Entry &entry = m_entries[iviId];
+
+    switch (role) {
+    case IviIdRole:
+        return iviId;
+    case AppNameRole:
+        return appName(iviId);
+    case PanelRole:
+        if (isLeftPanelApp(iviId)) {
+            return QStringLiteral("left");
+        }
+        return isRightPanelApp(iviId) ? QStringLiteral("right") : m_layout->outputFor(iviId);
+    case VisibleRole:
+        return entry.item && entry.item->isVisible();
+    case SurfaceWidthRole:
+        return entry.surface && entry.surface->surface() ? entry.surface->surface()->destinationSize().width() : 0;
+    case SurfaceHeightRole:
+        return entry.surface && entry.surface->surface() ? entry.surface->surface()->destinationSize().height() : 0;
+    case UptimeMsRole:
+        return entry.since.elapsed();
+    case CommitRateRole:
+        return entry.commitRate;
+    case CommitCountRole:
+        return entry.commits;
+    case ThrottledRole:
+        return entry.throttled;
+    case ConfigureCountRole:
+        return m_configure.counters(iviId).sent;
+    case ConfigureCoalescedRole:
+        return m_configure.counters(iviId).coalesced;
+    default:
+        return QVariant();
+    }
+}
+
+QHash<int, QByteArray> SurfaceRegistry::roleNames() const
+{
+    return {
+        { IviIdRole, "iviId" },
+        { AppNameRole, "appName" },
+        { PanelRole, "panel" },
+        { VisibleRole, "surfaceVisible" },
+        { SurfaceWidthRole, "surfaceWidth" },
+        { SurfaceHeightRole, "surfaceHeight" },
+        { UptimeMsRole, "uptimeMs" },
+        { CommitRateRole, "commitRate" },
+        { CommitCountRole, "commitCount" },
+        { ThrottledRole, "throttled" },
+        { ConfigureCountRole, "configureCount" },
+        { ConfigureCoalescedRole, "configureCoalesced" }
+    };
+}
+
+QSize SurfaceRegistry::surfaceSize(int iviId) const
+{
+    return m_layout->surfaceSize(iviId);
+}
+
+bool SurfaceRegistry::isLeftPanelApp(int iviId) const
+{
+    return m_layout->roleFor(iviId) == QLatin1String("gear");
+}
+
+bool SurfaceRegistry::isRightPanelApp(int iviId) const
+{
+    return m_layout->roleFor(iviId) == QLatin1String("app");
+}
+
+QString SurfaceRegistry::appName(int iviId) const
+{
+    switch (iviId) {
+    case 0: return QStringLiteral("Home");
+    case 1001: return QStringLiteral("GearSelector");
+    case 1002: return QStringLiteral("MediaPlayer");
+    case 1003: return QStringLiteral("ThemeColor");
+    case 1004: return QStringLiteral("Navigation");
+    case 1005: return QStringLiteral("Settings");
+    default: return QStringLiteral("None");
+    }
+}
+
+bool SurfaceRegistry::registerSurface(QQuickItem *item)
+{
+    auto *shellItem = qobject_cast<QWaylandQuickShellSurfaceItem *>(item);
+    auto *surface = shellItem ? qobject_cast<QWaylandIviSurface *>(shellItem->shellSurface()) : nullptr;
+    if (!surface) {
+        qWarning() << "[SurfaceRegistry] Not an IVI ShellSurfaceItem:" << item;
+        return false;
+    }
+
+    const int iviId = static_cast<int>(surface->iviId());
+    if (m_entries.contains(iviId)) {
+        qWarning() << "[SurfaceRegistry] Replacing surface for IVI-ID" << iviId;
+        unregisterSurface(iviId);
+    }
+
+    const bool left = isLeftPanelApp(iviId);
+    const QSize size = surfaceSize(iviId);
+    if (item->width() <= 0 || item->height() <= 0) {
+        // Not laid out by its panel (anchors); use the region size
+        item->setSize(size);
+    }
+
+    beginInsertRows(QModelIndex(), m_rows.size(), m_rows.size());
+    Entry entry;
+    entry.item = item;
+    entry.surface = surface;
+    entry.since.start();
+    m_entries.insert(iviId, entry);
+    m_rows.append(iviId);
+    endInsertRows();
+    emit countChanged();
+
+    if (!m_rateTimer.isActive()) {
+        m_rateClock.start();
+        m_rateTimer.start();
+    }
+
+    const bool shown = !isRightPanelApp(iviId) || iviId == m_currentRightApp;
+    setItemShown(item, shown);
+    m_configure.track(iviId, surface, item);
+    m_configure.sendNow(iviId, item->size().toSize());
+    // Launched in the background: let it draw its first frame, then throttle
+    if (!shown) {
+        QTimer::singleShot(0, this, [this, iviId]() {
+            if (iviId != m_currentRightApp) {
+                setThrottled(iviId, true);
+            }
+        });
+    }
+
+    connect(item, &QObject::destroyed, this, [this, iviId]() {
+        unregisterSurface(iviId);
+    });
+    // Later geometry changes (keyboard, panel resize) follow the item,
+    // coalesced to at most one configure per frame
+    auto reconfigure = [this, iviId, item]() {
+        m_configure.request(iviId, item->size().toSize());
+    };
+    connect(item, &QQuickItem::widthChanged, this, reconfigure);
+    connect(item, &QQuickItem::heightChanged, this, reconfigure);
+    if (surface->surface()) {
+        connect(surface->surface(), &QWaylandSurface::destinationSizeChanged, this, [this, iviId]() {
+            emitRowChanged(iviId, { SurfaceWidthRole, SurfaceHeightRole });
+            if (iviId == m_currentRightApp) {
+                updateCurrentOpaque();
+            }
+        });
+        // redraw is emitted for every commit that carries new content
+        connect(surface->surface(), &QWaylandSurface::redraw, this, [this, iviId]() {
+            auto it = m_entries.find(iviId);
+            if (it == m_entries.end()) {
+                return;
+            }
+            it->commits++;
+            if (it->awaitingContent) {
+                it->awaitingContent = false;
+                emit surfaceContentReady(iviId);
+            }
+            // The opaque region may change with any commit
+            if (iviId == m_currentRightApp) {
+                updateCurrentOpaque();
+            }
+        });
+    }
+
+    qDebug() << "[SurfaceRegistry] Registered" << appName(iviId) << "(" << iviId << ")"
+             << "role" << m_layout->roleFor(iviId) << "size" << size << "surfaces:" << m_rows.size();
+    emit surfaceAdded(iviId, item, left);
+
+    if (isRightPanelApp(iviId) && iviId == m_pendingLaunchAppId) {
+        qDebug() << "[SurfaceRegistry] Pending app" << iviId << "is up - switching";
+        setPendingLaunchAppId(0);
+        QMetaObject::invokeMethod(this, [this, iviId]() {
+            setCurrentRightApp(iviId);
+        }, Qt::QueuedConnection);
+    }
+    return true;
+}
+
+void SurfaceRegistry::unregisterSurface(int iviId)
+{
+    const int row = m_rows.indexOf(iviId);
+    if (row < 0) {
+        return;
+    }
+
+    beginRemoveRows(QModelIndex(), row, row);
+    const Entry entry = m_entries.take(iviId);
+    m_rows.remove(row);
+    endRemoveRows();
+    emit countChanged();
+
+    if (entry.item) {
+        disconnect(entry.item, nullptr, this, nullptr);
+    }
+    m_configure.untrack(iviId);
+    if (entry.surface && entry.surface->surface()) {
+        disconnect(entry.surface->surface(), nullptr, this, nullptr);
+    }
+    if (m_rows.isEmpty()) {
+        m_rateTimer.stop();
+    }
+
+    qDebug() << "[SurfaceRegistry] Unregistered" << appName(iviId) << "(" << iviId << ")";
+
+    if (iviId == m_currentRightApp) {
+        setCurrentRightApp(0);
+    }
+    updateCurrentOpaque();
+    if (iviId == m_pendingLaunchAppId) {
+        setPendingLaunchAppId(0);
+    }
+
+    emit surfaceRemoved(iviId);
+}
+
+void SurfaceRegistry::setCurrentRightApp(int iviId)
+{
+    if (iviId == m_currentRightApp || (iviId != 0 && !isRightPanelApp(iviId))) {
+        return;
+    }
+    if (iviId != 0 && !m_entries.contains(iviId)) {
+        qWarning() << "[SurfaceRegistry] Cannot switch - app not running:" << iviId;
+        return;
+    }
+
+    const int previous = m_currentRightApp;
+    if (QQuickItem *item = surfaceItem(previous)) {
+        emit surfaceAboutToHide(previous, item);
+        setItemShown(item, false);
+        setThrottled(previous, true);
+    }
+
+    m_currentRightApp = iviId;
+    if (QQuickItem *item = surfaceItem(iviId)) {
+        m_entries[iviId].awaitingContent = true;
+        setThrottled(iviId, false);
+        setItemShown(item, true);
+        item->forceActiveFocus();
+        // Releases a resize that was held back while it was hidden
+        m_configure.request(iviId, item->size().toSize());
+    }
+
+    updateCurrentOpaque();
+
+    emitRowChanged(previous, { VisibleRole, ThrottledRole });
+    emitRowChanged(iviId, { VisibleRole, ThrottledRole });
+    emit currentRightAppChanged();
+    qDebug() << "[SurfaceRegistry] Now showing" << appName(iviId);
+}
+
+void SurfaceRegistry::setPendingLaunchAppId(int iviId)
+{
+    if (m_pendingLaunchAppId != iviId) {
+        m_pendingLaunchAppId = iviId;
+        emit pendingLaunchAppIdChanged();
+    }
+}
+
+double SurfaceRegistry::commitRate(int iviId) const
+{
+    auto it = m_entries.constFind(iviId);
+    return it != m_entries.constEnd() ? it->commitRate : 0.0;
+}
+
+QVariantMap SurfaceRegistry::configureStats(int iviId) const
+{
+    const ConfigureScheduler::Counters counters = m_configure.counters(iviId);
+    QVariantMap stats;
+    stats["configureRequested"] = counters.requested;
+    stats["configureSent"] = counters.sent;
+    stats["configureCoalesced"] = counters.coalesced;
+    stats["configureAcked"] = counters.acked;
+    stats["configureTimedOut"] = counters.timedOut;
+    return stats;
+}
+
+bool SurfaceRegistry::isAppRunning(int iviId) const
+{
+    return m_entries.contains(iviId);
+}
+
+QQuickItem *SurfaceRegistry::surfaceItem(int iviId) const
+{
+    auto it = m_entries.constFind(iviId);
+    return it != m_entries.constEnd() ? it->item.data() : nullptr;
+}
+
+QList<int> SurfaceRegistry::runningApps() const
+{
+    QList<int> running;
+    for (int iviId : m_rows) {
+        if (isRightPanelApp(iviId)) {
+            running.append(iviId);
+        }
+    }
+    return running;
+}
+
+int SurfaceRegistry::firstAvailableApp() const
+{
+    static const int priority[] = { 1002, 1003, 1004, 1005 };
+    for (int iviId : priority) {
+        if (m_entries.contains(iviId)) {
+            return iviId;
+        }
+    }
+
+    const QList<int> running = runningApps();
+    return running.isEmpty() ? 0 : running.first();
+}
+
+void SurfaceRegistry::setItemShown(QQuickItem *item, bool shown)
+{
+    item->setVisible(shown);
+    item->setEnabled(shown);
+    item->setFocus(shown);
+}
+
+void SurfaceRegistry::emitRowChanged(int iviId, const QVector<int> &roles)
+{
+    const int row = m_rows.indexOf(iviId);
+    if (row >= 0) {
+        const QModelIndex idx = index(row);
+        emit dataChanged(idx, idx, roles);
+    }
+}
+
+void SurfaceRegistry::setThrottled(int iviId, bool throttled)
+{
+    auto it = m_entries.find(iviId);
+    if (it == m_entries.end() || it->throttled == throttled || !it->item || !it->surface) {
+        return;
+    }
+
+    auto *shellItem = qobject_cast<QWaylandQuickShellSurfaceItem *>(it->item.data());
+    QWaylandSurface *surface = it->surface->surface();
+    if (!shellItem || !surface) {
+        return;
+    }
+
+    // Without an output the view gets no frame callbacks, so the client idles
+    QWaylandOutput *output = nullptr;
+    if (!throttled) {
+        output = surface->compositor()->outputFor(shellItem->window());
+        if (!output) {
+            output = surface->compositor()->defaultOutput();
+        }
+    }
+    shellItem->setOutput(output);
+    it->throttled = throttled;
+
+    qDebug() << "[SurfaceRegistry]" << appName(iviId) << (throttled ? "throttled" : "resumed")
+             << "- commit rate" << it->commitRate << "/s";
+}
+
+void SurfaceRegistry::sampleCommitRates()
+{
+    const qint64 elapsedMs = m_rateClock.restart();
+    if (elapsedMs <= 0) {
+        return;
+    }
+
+    for (auto it = m_entries.begin(); it != m_entries.end(); ++it) {
+        const double rate = (it->commits - it->commitsAtSample) * 1000.0 / elapsedMs;
+        it->commitsAtSample = it->commits;
+        if (it->throttled && rate >= 1.0) {
+            qDebug() << "[SurfaceRegistry]" << appName(it.key()) << "still commits while hidden:" << rate << "/s";
+        }
+        if (!qFuzzyCompare(rate + 1.0, it->commitRate + 1.0)) {
+            it->commitRate = rate;
+            emitRowChanged(it.key(), { CommitRateRole, CommitCountRole });
+        }
+    }
+}
+
+void SurfaceRegistry::updateCurrentOpaque()
+{
+    bool opaque = false;
+    auto it = m_entries.constFind(m_currentRightApp);
+    if (it != m_entries.constEnd() && it->item && it->surface && it->surface->surface()) {
+        QWaylandSurface *surface = it->surface->surface();
+        const QSize size = surface->destinationSize();
+        opaque = surface->hasContent() && surface->isOpaque()
+                 && size.width() >= it->item->width() && size.height() >= it->item->height();
+    }
+
+    if (opaque != m_currentOpaque) {
+        m_currentOpaque = opaque;
+        qDebug() << "[SurfaceRegistry]" << appName(m_currentRightApp)
+                 << (opaque ? "covers its slot opaquely" : "is no longer opaque");
+        emit currentOpaqueChanged();
+    }
+}
@@ -0,0 +1,129 @@
+// surface_registry.h
+#ifndef SURFACE_REGISTRY_H
+#define SURFACE_REGISTRY_H
+
+#include <QAbstractListModel>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QPointer>
+#include <QSize>
+#include <QTimer>
+#include <QVector>
+#include "configure_scheduler.h"
+
+class QQuickItem;
+class QWaylandIviSurface;
+class LayoutEngine;
+
+// Owns the iviId -> ShellSurfaceItem mapping of the compositor.
+//
+// Panel placement, surface size and visibility are decided here rather than
+// in per-item QML bindings; placement and size come from the LayoutEngine.
+// Switching the right panel is a single write to currentRightApp, which only
+// touches the outgoing and incoming item. As a list model, the registry
+// exposes per-surface metrics to QML.
+//
+// Hidden right-panel surfaces are detached from the output, so the compositor
+// stops sending them wl_surface.frame callbacks and Qt clients stop drawing
+// until they are shown again. A per-surface commit rate makes that visible.
+//
+// currentOpaque reports when the shown app's buffer is opaque and covers its
+// whole slot, so QML can drop every layer underneath it.
+class SurfaceRegistry : public QAbstractListModel
+{
+    Q_OBJECT
+    Q_PROPERTY(int currentRightApp READ currentRightApp WRITE setCurrentRightApp NOTIFY currentRightAppChanged)
+    Q_PROPERTY(int pendingLaunchAppId READ pendingLaunchAppId WRITE setPendingLaunchAppId NOTIFY pendingLaunchAppIdChanged)
+    Q_PROPERTY(int count READ count NOTIFY countChanged)
+    Q_PROPERTY(bool currentOpaque READ isCurrentOpaque NOTIFY currentOpaqueChanged)
+
+public:
+    enum Roles {
+        IviIdRole = Qt::UserRole + 1,
+        AppNameRole,
+        PanelRole,
+        VisibleRole,
+        SurfaceWidthRole,
+        SurfaceHeightRole,
+        UptimeMsRole,
+        CommitRateRole,
+        CommitCountRole,
+        ThrottledRole,
+        ConfigureCountRole,
+        ConfigureCoalescedRole
+    };
+
+    explicit SurfaceRegistry(LayoutEngine *layout, QObject *parent = nullptr);
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role) const override;
+    QHash<int, QByteArray> roleNames() const override;
+
+    int currentRightApp() const { return m_currentRightApp; }
+    void setCurrentRightApp(int iviId);
+
+    int pendingLaunchAppId() const { return m_pendingLaunchAppId; }
+    void setPendingLaunchAppId(int iviId);
+
+    int count() const { return m_rows.size(); }
+
+    bool isCurrentOpaque() const { return m_currentOpaque; }
+
+    // Called from QML once a ShellSurfaceItem exists for a new IVI surface
+    Q_INVOKABLE bool registerSurface(QQuickItem *item);
+    Q_INVOKABLE void unregisterSurface(int iviId);
+
+    Q_INVOKABLE bool isAppRunning(int iviId) const;
+    Q_INVOKABLE QQuickItem *surfaceItem(int iviId) const;
+    Q_INVOKABLE QList<int> runningApps() const;
+    Q_INVOKABLE int firstAvailableApp() const;
+    Q_INVOKABLE bool isLeftPanelApp(int iviId) const;
+    // Apps that share the right panel and are switched by currentRightApp
+    Q_INVOKABLE bool isRightPanelApp(int iviId) const;
+    Q_INVOKABLE QSize surfaceSize(int iviId) const;
+    Q_INVOKABLE QString appName(int iviId) const;
+    Q_INVOKABLE double commitRate(int iviId) const;
+    Q_INVOKABLE QVariantMap configureStats(int iviId) const;
+
+signals:
+    void currentRightAppChanged();
+    void pendingLaunchAppIdChanged();
+    void countChanged();
+    void currentOpaqueChanged();
+    void surfaceAdded(int iviId, QQuickItem *item, bool leftPanel);
+    void surfaceRemoved(int iviId);
+    // Right-panel surface about to be switched away from; still shown
+    void surfaceAboutToHide(int iviId, QQuickItem *item);
+    // First commit of a right-panel surface after it was switched to
+    void surfaceContentReady(int iviId);
+
+private:
+    struct Entry {
+        QPointer<QQuickItem> item;
+        QWaylandIviSurface *surface = nullptr;
+        QElapsedTimer since;
+        quint64 commits = 0;
+        quint64 commitsAtSample = 0;
+        double commitRate = 0.0;    // commits per second over the last sample
+        bool throttled = false;
+        bool awaitingContent = false;
+    };
+
+    void setItemShown(QQuickItem *item, bool shown);
+    void emitRowChanged(int iviId, const QVector<int> &roles);
+    void setThrottled(int iviId, bool throttled);
+    void sampleCommitRates();
+    void updateCurrentOpaque();
+
+    LayoutEngine *m_layout;
+    ConfigureScheduler m_configure;
+    QHash<int, Entry> m_entries;
+    QVector<int> m_rows;            // iviIds in model order
+    int m_currentRightApp;
+    int m_pendingLaunchAppId;
+    bool m_currentOpaque;
+    QTimer m_rateTimer;
+    QElapsedTimer m_rateClock;
+};
+
+#endif // SURFACE_REGISTRY_H
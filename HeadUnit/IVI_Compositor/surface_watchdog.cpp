@@ -0,0 +1,184 @@
+// surface_watchdog.cpp
+#include "surface_watchdog.h"
+#include "dbus_manager.h"
+#include "surface_registry.h"
+#include <QDBusConnection>
+#include <QDBusError>
+#include <QDBusMessage>
+#include <QDBusPendingCallWatcher>
+#include <QDBusPendingReply>
+#include <QDebug>
+
+SurfaceWatchdog::SurfaceWatchdog(SurfaceRegistry *registry, DBusManager *dbus, QObject *parent)
+    : QObject(parent)
+    , m_registry(registry)
+    , m_dbus(dbus)
+    , m_hangMs(3000)
+    , m_restartMs(5000)
+    , m_nextSerial(0)
+{
+    bool ok = false;
+    const int hangMs = qEnvironmentVariableIntValue("HEADUNIT_WATCHDOG_HANG_MS", &ok);
+    if (ok && hangMs > 0) {
+        m_hangMs = hangMs;
+    }
+    const int restartMs = qEnvironmentVariableIntValue("HEADUNIT_WATCHDOG_RESTART_MS", &ok);
+    if (ok && restartMs >= 0) {
+        m_restartMs = restartMs;
+    }
+
+    // A few pings per hang period, so detection takes hangMs plus at most
+    // one interval
+    m_timer.setInterval(qBound(100, m_hangMs / 4, 1000));
+    connect(&m_timer, &QTimer::timeout, this, &SurfaceWatchdog::tick);
+
+    connect(m_registry, &SurfaceRegistry::surfaceAdded, this,
+            [this](int iviId, QQuickItem *, bool) { onSurfaceAdded(iviId); });
+    connect(m_registry, &SurfaceRegistry::surfaceRemoved, this, &SurfaceWatchdog::onSurfaceRemoved);
+
+    qInfo() << "[SurfaceWatchdog] Hang after" << m_hangMs << "ms, restart after"
+            << (m_restartMs > 0 ? QString::number(m_restartMs) + " ms" : QStringLiteral("never"));
+}
+
+QVariantList SurfaceWatchdog::hungSurfaces() const
+{
+    QVariantList list;
+    for (auto it = m_watches.constBegin(); it != m_watches.constEnd(); ++it) {
+        if (it->hung) {
+            list.append(it.key());
+        }
+    }
+    return list;
+}
+
+bool SurfaceWatchdog::isResponding(int iviId) const
+{
+    return !m_watches.value(iviId).hung;
+}
+
+void SurfaceWatchdog::restartApp(int iviId)
+{
+    auto it = m_watches.find(iviId);
+    if (it == m_watches.end() || !it->hung || it->restartRequested) {
+        return;
+    }
+    it->restartRequested = true;
+    m_dbus->restartApp(iviId);
+}
+
+void SurfaceWatchdog::onSurfaceAdded(int iviId)
+{
+    Watch &watch = m_watches[iviId];
+    watch = Watch();
+    watch.lastReply.start();
+    ping(iviId, watch);
+
+    if (!m_timer.isActive()) {
+        m_timer.start();
+    }
+}
+
+void SurfaceWatchdog::onSurfaceRemoved(int iviId)
+{
+    // A reply still in flight finds no watch and is dropped
+    const Watch watch = m_watches.take(iviId);
+    if (watch.hung) {
+        emit surfaceRecovered(iviId);
+        emit hungSurfacesChanged();
+    }
+    if (m_watches.isEmpty()) {
+        m_timer.stop();
+    }
+}
+
+void SurfaceWatchdog::tick()
+{
+    for (auto it = m_watches.begin(); it != m_watches.end(); ++it) {
+        Watch &watch = *it;
+        if (!watch.inFlight) {
+            ping(it.key(), watch);
+        }
+
+        if (!watch.hung && watch.lastReply.elapsed() >= m_hangMs) {
+            setHung(it.key(), watch, true);
+        }
+
+        if (watch.hung && !watch.restartRequested && m_restartMs > 0
+            && watch.hungSince.elapsed() >= m_restartMs) {
+            qWarning() << "[SurfaceWatchdog] IVI-ID" << it.key() << "hung for"
+                       << watch.lastReply.elapsed() << "ms - requesting restart";
+            watch.restartRequested = true;
+            m_dbus->restartApp(it.key());
+        }
+    }
+}
+
+void SurfaceWatchdog::ping(int iviId, Watch &watch)
+{
+    QDBusMessage message = QDBusMessage::createMethodCall(
+        QStringLiteral("com.headunit.App%1").arg(iviId),
+        "/com/headunit/App",
+        "com.headunit.AppLiveness",
+        "Ping");
+    // Serials are unique across registrations, so a reply meant for an
+    // earlier client with the same IVI id is ignored
+    watch.serial = ++m_nextSerial;
+    message << watch.serial;
+
+    // The call stays pending while the client is hung; its reply, however
+    // late, is what marks the client as alive again
+    const int timeoutMs = m_hangMs + m_restartMs + 1000;
+    auto *call = new QDBusPendingCallWatcher(
+        QDBusConnection::sessionBus().asyncCall(message, timeoutMs), this);
+    const quint32 serial = watch.serial;
+    connect(call, &QDBusPendingCallWatcher::finished, this,
+            [this, iviId, serial](QDBusPendingCallWatcher *call) { onReply(iviId, serial, call); });
+
+    watch.inFlight = true;
+}
+
+void SurfaceWatchdog::onReply(int iviId, quint32 serial, QDBusPendingCallWatcher *call)
+{
+    call->deleteLater();
+
+    auto it = m_watches.find(iviId);
+    if (it == m_watches.end() || it->serial != serial) {
+        return;     // surface gone or re-registered since
+    }
+    Watch &watch = *it;
+    watch.inFlight = false;
+
+    const QDBusPendingReply<uint> reply = *call;
+    if (reply.isError()) {
+        const QDBusError::ErrorType type = reply.error().type();
+        if (type == QDBusError::ServiceUnknown || type == QDBusError::UnknownObject
+            || type == QDBusError::UnknownInterface || type == QDBusError::UnknownMethod) {
+            // No liveness service (yet): nothing to judge the client by
+            watch.lastReply.start();
+        }
+        // A timeout leaves lastReply alone and the next tick pings again
+        return;
+    }
+
+    watch.lastReply.start();
+    if (watch.hung) {
+        setHung(iviId, watch, false);
+    }
+}
+
+void SurfaceWatchdog::setHung(int iviId, Watch &watch, bool hung)
+{
+    watch.hung = hung;
+    if (hung) {
+        watch.hungSince.start();
+        qWarning() << "[SurfaceWatchdog]" << m_registry->appName(iviId) << "(IVI-ID" << iviId
+                   << ") not responding for" << watch.lastReply.elapsed() << "ms";
+        emit surfaceHung(iviId);
+    } else {
+        watch.restartRequested = false;
+        qInfo() << "[SurfaceWatchdog]" << m_registry->appName(iviId) << "(IVI-ID" << iviId
+                << ") responding again";
+        emit surfaceRecovered(iviId);
+    }
+    emit hungSurfacesChanged();
+}
@@ -0,0 +1,68 @@
+// surface_watchdog.h
+#ifndef SURFACE_WATCHDOG_H
+#define SURFACE_WATCHDOG_H
+
+#include <QObject>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QTimer>
+#include <QVariantList>
+
+class QDBusPendingCallWatcher;
+class DBusManager;
+class SurfaceRegistry;
+
+// Liveness of the clients behind the registered IVI surfaces.
+//
+// Every client is pinged over D-Bus (com.headunit.App<iviId>, see
+// app_liveness.h) with one ping in flight at a time. All calls are async, so
+// a hung client can never stall the compositor. A client that has not
+// answered for HEADUNIT_WATCHDOG_HANG_MS (default 3000) is reported as not
+// responding; if it is still hung HEADUNIT_WATCHDOG_RESTART_MS (default 5000,
+// 0 = never) later the AFM is asked to restart it. Clients without the
+// liveness service are never reported.
+class SurfaceWatchdog : public QObject
+{
+    Q_OBJECT
+    Q_PROPERTY(QVariantList hungSurfaces READ hungSurfaces NOTIFY hungSurfacesChanged)
+
+public:
+    SurfaceWatchdog(SurfaceRegistry *registry, DBusManager *dbus, QObject *parent = nullptr);
+
+    QVariantList hungSurfaces() const;
+    Q_INVOKABLE bool isResponding(int iviId) const;
+    // Restart from the overlay instead of waiting for the automatic one
+    Q_INVOKABLE void restartApp(int iviId);
+
+signals:
+    void hungSurfacesChanged();
+    void surfaceHung(int iviId);
+    void surfaceRecovered(int iviId);
+
+private:
+    struct Watch {
+        QElapsedTimer lastReply;    // or since tracking started
+        QElapsedTimer hungSince;
+        quint32 serial = 0;
+        bool inFlight = false;
+        bool hung = false;
+        bool restartRequested = false;
+    };
+
+    void onSurfaceAdded(int iviId);
+    void onSurfaceRemoved(int iviId);
+    void tick();
+    void ping(int iviId, Watch &watch);
+    void onReply(int iviId, quint32 serial, QDBusPendingCallWatcher *call);
+    void setHung(int iviId, Watch &watch, bool hung);
+
+    SurfaceRegistry *m_registry;
+    DBusManager *m_dbus;
+    QHash<int, Watch> m_watches;
+    QTimer m_timer;
+    int m_hangMs;
+    int m_restartMs;
+    quint32 m_nextSerial;
+};
+
+#endif // SURFACE_WATCHDOG_H
@@ -0,0 +1,359 @@
+#include "audio_engine.h"
+#include "gain_ramp.h"
+#include <QAudioBuffer>
+#include <QAudioDecoder>
+#include <QAudioSink>
+#include <QMediaDevices>
+#include <QDebug>
+#include <QFileInfo>
+#include <QIODevice>
+
+// Pull-mode source for QAudioSink. Runs on whatever thread the audio backend
+// uses, so it only touches the lock-free jitter buffer, the gain ramp and
+// atomics; the one event it may post is the decoder pump request, at most
+// once per pump.
+class PcmOutputDevice : public QIODevice
+{
+public:
+    explicit PcmOutputDevice(AudioEngine *engine)
+        : m_engine(engine)
+    {}
+
+    bool isSequential() const override { return true; }
+
+protected:
+    qint64 readData(char *data, qint64 maxlen) override
+    {
+        const int bytesPerFrame = m_engine->m_format.bytesPerFrame();
+        maxlen -= maxlen % bytesPerFrame;
+        if (maxlen <= 0) {
+            return 0;
+        }
+
+        // Keep the sink clock running with silence while the decoder catches up,
+        // but let it drain naturally at the end of the track.
+        const bool streaming = !m_engine->m_decoderDone.load();
+        const qint64 available = m_engine->m_jitter.fillLevel();
+        const qint64 n = m_engine->m_jitter.read(data, maxlen, streaming);
+
+        const qint64 frames = n / bytesPerFrame;
+        if (frames > 0) {
+            m_engine->m_gainRamp->process(reinterpret_cast<int16_t *>(data),
+                                          static_cast<int>(frames),
+                                          m_engine->m_format.channelCount());
+        }
+
+        const qint64 realFrames = qMin(n, available) / bytesPerFrame;
+        m_engine->onOutputConsumed(realFrames, !streaming && available <= n);
+        return n;
+    }
+
+    qint64 writeData(const char *, qint64) override { return -1; }
+
+private:
+    AudioEngine *m_engine;
+};
+
+AudioEngine::AudioEngine(GainRamp *gainRamp, QObject *parent)
+    : QObject(parent)
+    , m_decoder(nullptr)
+    , m_sink(nullptr)
+    , m_output(nullptr)
+    , m_gainRamp(gainRamp)
+    , m_state("Stopped")
+    , m_duration(0)
+    , m_seekable(false)
+    , m_dataStart(0)
+    , m_pendingSeekMs(-1)
+    , m_lastReportedPosition(-1)
+    , m_volume(50)
+    , m_framesPlayed(0)
+    , m_decoderDone(false)
+    , m_pumpQueued(false)
+{
+    m_format.setSampleRate(kSampleRate);
+    m_format.setChannelCount(kChannels);
+    m_format.setSampleFormat(QAudioFormat::Int16);
+
+    m_gainRamp->setSampleRate(kSampleRate);
+    m_jitter.setCapacity(m_format.bytesForDuration(kJitterMs * 1000));
+
+    m_decoder = new QAudioDecoder(this);
+    m_decoder->setAudioFormat(m_format);
+    connect(m_decoder, &QAudioDecoder::bufferReady, this, &AudioEngine::pumpDecoder);
+    connect(m_decoder, &QAudioDecoder::finished, this, &AudioEngine::onDecoderFinished);
+    connect(m_decoder, QOverload<QAudioDecoder::Error>::of(&QAudioDecoder::error),
+            this, &AudioEngine::onDecoderError);
+    connect(m_decoder, &QAudioDecoder::durationChanged, this, [this](qint64 duration) {
+        // A decoder started mid-file only knows the rest of the stream
+        if (duration > 0 && duration != m_duration && m_reader.origin() == 0) {
+            m_duration = duration;
+            emit durationChanged(m_duration);
+            if (m_pendingSeekMs >= 0) {
+                seek(m_pendingSeekMs);
+            }
+        }
+    });
+
+    connect(&m_reader, &MediaFileReader::ioError, this, &AudioEngine::onReaderError,
+            Qt::QueuedConnection);
+    connect(&m_reader, &MediaFileReader::stallDetected, this, [this](qint64 ms) {
+        qDebug() << "AudioEngine: USB stall" << ms << "ms, readahead"
+                 << m_reader.prefetchedBytes() / 1024 << "KiB, jitter"
+                 << m_jitter.fillLevel() << "bytes, underruns" << m_jitter.underrunCount();
+    }, Qt::QueuedConnection);
+
+    m_output = new PcmOutputDevice(this);
+    m_output->open(QIODevice::ReadOnly);
+
+    m_sink = new QAudioSink(QMediaDevices::defaultAudioOutput(), m_format, this);
+
+    m_positionTimer = new QTimer(this);
+    m_positionTimer->setInterval(250);
+    connect(m_positionTimer, &QTimer::timeout, this, &AudioEngine::onPositionTick);
+}
+
+AudioEngine::~AudioEngine()
+{
+    m_sink->stop();
+    m_decoder->stop();
+    m_reader.close();
+    delete m_output;
+}
+
+bool AudioEngine::load(const QString &path)
+{
+    stop();
+
+    if (!m_reader.openFile(path)) {
+        emit errorOccurred(QString("Cannot open %1").arg(path));
+        return false;
+    }
+
+    m_duration = 0;
+    emit durationChanged(0);
+    m_seekable = canSeek(path);
+    m_dataStart = m_seekable ? audioDataStart() : 0;
+    m_pendingSeekMs = -1;
+    m_decoder->setSourceDevice(&m_reader);
+    restartDecoder(0, 0);
+
+    qDebug() << "AudioEngine: Loaded" << path;
+    return true;
+}
+
+bool AudioEngine::canSeek(const QString &path)
+{
+    static const QStringList streams = {"mp3", "aac"};
+    return streams.contains(QFileInfo(path).suffix().toLower());
+}
+
+qint64 AudioEngine::audioDataStart()
+{
+    // ID3v2: "ID3", version, flags, syncsafe size; footer flag adds 10 bytes
+    m_reader.setOrigin(0);
+    const QByteArray header = m_reader.read(10);
+    m_reader.seek(0);
+    if (header.size() < 10 || !header.startsWith("ID3")) {
+        return 0;
+    }
+    const qint64 tagSize = (qint64(header[6] & 0x7f) << 21) | (qint64(header[7] & 0x7f) << 14)
+                         | (qint64(header[8] & 0x7f) << 7) | qint64(header[9] & 0x7f);
+    return qMin(m_reader.fileSize(), 10 + tagSize + ((header[5] & 0x10) ? 10 : 0));
+}
+
+void AudioEngine::restartDecoder(qint64 startFrame, qint64 byteOffset)
+{
+    m_decoder->stop();
+    m_jitter.clear();
+    m_pending.clear();
+    m_decoderDone = false;
+    m_framesPlayed = startFrame;
+    m_reader.setOrigin(byteOffset);
+    m_decoder->start();
+}
+
+void AudioEngine::play()
+{
+    if (!m_reader.isOpen()) {
+        return;
+    }
+
+    if (m_state == "Paused") {
+        m_sink->resume();
+    } else if (m_state == "Stopped") {
+        m_jitter.resetUnderruns();
+        m_sink->start(m_output);
+    }
+
+    m_sink->setVolume(m_volume / 100.0);
+    m_positionTimer->start();
+    setState("Playing");
+}
+
+void AudioEngine::pause()
+{
+    if (m_state != "Playing") {
+        return;
+    }
+    m_sink->suspend();
+    m_positionTimer->stop();
+    setState("Paused");
+}
+
+void AudioEngine::stop()
+{
+    m_sink->stop();
+    m_positionTimer->stop();
+
+    if (m_reader.isOpen() && m_state != "Stopped") {
+        restartDecoder(0, 0);
+    }
+
+    m_lastReportedPosition = 0;
+    emit positionChanged(0);
+    setState("Stopped");
+}
+
+bool AudioEngine::seek(qint64 positionMs)
+{
+    if (!m_reader.isOpen() || !m_seekable) {
+        return false;
+    }
+
+    m_lastReportedPosition = positionMs;
+    emit positionChanged(positionMs);
+
+    // The offset needs the duration, which the decoder reports once it has
+    // seen the stream
+    if (m_duration <= 0) {
+        m_pendingSeekMs = positionMs;
+        return true;
+    }
+    m_pendingSeekMs = -1;
+
+    // Average bitrate: exact for CBR, close for VBR. The decoder skips to the
+    // next frame header, the position restarts from the estimate.
+    const qint64 target = qBound<qint64>(0, positionMs, m_duration);
+    const qint64 audioBytes = m_reader.fileSize() - m_dataStart;
+    const qint64 offset = m_dataStart + qint64(double(audioBytes) * target / m_duration);
+    restartDecoder(target * kSampleRate / 1000, offset);
+    return true;
+}
+
+void AudioEngine::setVolume(int volume)
+{
+    m_volume = qBound(0, volume, 100);
+    m_sink->setVolume(m_volume / 100.0);
+}
+
+qint64 AudioEngine::position() const
+{
+    return m_framesPlayed.load() * 1000 / kSampleRate;
+}
+
+void AudioEngine::pumpDecoder()
+{
+    m_pumpQueued = false;
+
+    if (!m_pending.isEmpty()) {
+        const qint64 written = m_jitter.write(m_pending.constData(), m_pending.size());
+        m_pending.remove(0, static_cast<int>(written));
+        if (!m_pending.isEmpty()) {
+            return;
+        }
+    }
+
+    while (m_decoder->bufferAvailable() && m_jitter.freeSpace() > 0) {
+        const QAudioBuffer buffer = m_decoder->read();
+        if (!buffer.isValid()) {
+            break;
+        }
+
+        const char *data = buffer.constData<char>();
+        const qint64 len = buffer.byteCount();
+
+        if (len <= 0) {
+            continue;
+        }
+
+        const qint64 written = m_jitter.write(data, len);
+        if (written < len) {
+            m_pending = QByteArray(data + written, static_cast<int>(len - written));
+            break;
+        }
+    }
+}
+
+void AudioEngine::requestPump()
+{
+    bool expected = false;
+    if (m_pumpQueued.compare_exchange_strong(expected, true)) {
+        QMetaObject::invokeMethod(this, &AudioEngine::pumpDecoder, Qt::QueuedConnection);
+    }
+}
+
+void AudioEngine::onOutputConsumed(qint64 frames, bool drained)
+{
+    m_framesPlayed += frames;
+
+    if (drained) {
+        QMetaObject::invokeMethod(this, [this] {
+            if (m_state == "Playing") {
+                qDebug() << "AudioEngine: Track finished, underruns:" << m_jitter.underrunCount()
+                         << "stalls:" << m_reader.stallCount();
+                stop();
+                emit trackFinished();
+            }
+        }, Qt::QueuedConnection);
+        return;
+    }
+
+    if (m_jitter.fillLevel() < m_jitter.capacity() / 2) {
+        requestPump();
+    }
+}
+
+void AudioEngine::onDecoderFinished()
+{
+    pumpDecoder();
+    if (m_pending.isEmpty() && !m_decoder->bufferAvailable()) {
+        m_decoderDone = true;
+    } else {
+        // Flush the tail once the sink made room
+        QTimer::singleShot(20, this, &AudioEngine::onDecoderFinished);
+    }
+}
+
+void AudioEngine::onDecoderError()
+{
+    qWarning() << "AudioEngine: Decoder error:" << m_decoder->errorString();
+    emit errorOccurred(m_decoder->errorString());
+    stop();
+}
+
+void AudioEngine::onReaderError(const QString &message)
+{
+    qWarning() << "AudioEngine:" << message;
+    emit errorOccurred(message);
+    m_sink->stop();
+    m_positionTimer->stop();
+    setState("Stopped");
+}
+
+void AudioEngine::onPositionTick()
+{
+    const qint64 pos = position();
+    if (pos != m_lastReportedPosition) {
+        m_lastReportedPosition = pos;
+        emit positionChanged(pos);
+    }
+}
+
+void AudioEngine::setState(const QString &state)
+{
+    if (m_state != state) {
+        m_state = state;
+        emit stateChanged(state);
+    }
+}
@@ -0,0 +1,107 @@
+#ifndef AUDIO_ENGINE_H
+#define AUDIO_ENGINE_H
+
+#include <QObject>
+#include <QString>
+#include <QByteArray>
+#include <QAudioFormat>
+#include <QTimer>
+#include <atomic>
+#include "media_file_reader.h"
+#include "pcm_jitter_buffer.h"
+
+class QAudioDecoder;
+class QAudioSink;
+class GainRamp;
+class PcmOutputDevice;
+
+// Native playback path for local (USB) media.
+//
+//   MediaFileReader (mmap + readahead) -> QAudioDecoder -> PcmJitterBuffer
+//       -> PcmOutputDevice (GainRamp applied per sample) -> QAudioSink
+//
+// The decoder is only read while the jitter buffer has room, so memory stays
+// bounded and backpressure reaches the decoder instead of piling up PCM.
+//
+// QAudioDecoder cannot seek. Elementary streams (MP3, ADTS AAC) resync on
+// the next frame header, so a seek restarts the decoder at a byte offset
+// estimated from the average bitrate. Containers cannot be entered mid-file;
+// seek() refuses them and the caller uses the MediaPlayer service instead.
+class AudioEngine : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit AudioEngine(GainRamp *gainRamp, QObject *parent = nullptr);
+    ~AudioEngine();
+
+    bool load(const QString &path);
+    void play();
+    void pause();
+    void stop();
+    // false if the file cannot be entered mid-stream (see canSeek())
+    bool seek(qint64 positionMs);
+    void setVolume(int volume);
+
+    QString state() const { return m_state; }
+    QString source() const { return m_reader.fileName(); }
+    qint64 position() const;
+    qint64 duration() const { return m_duration; }
+    bool canSeek() const { return m_seekable; }
+    static bool canSeek(const QString &path);
+
+    int underrunCount() const { return m_jitter.underrunCount(); }
+    int stallCount() const { return m_reader.stallCount(); }
+    qint64 readaheadBytes() const { return m_reader.prefetchedBytes(); }
+
+signals:
+    void stateChanged(const QString &state);
+    void positionChanged(qint64 positionMs);
+    void durationChanged(qint64 durationMs);
+    void errorOccurred(const QString &message);
+    void trackFinished();
+
+private slots:
+    void pumpDecoder();
+    void onDecoderFinished();
+    void onDecoderError();
+    void onReaderError(const QString &message);
+    void onPositionTick();
+
+private:
+    friend class PcmOutputDevice;
+
+    void setState(const QString &state);
+    void restartDecoder(qint64 startFrame, qint64 byteOffset);
+    qint64 audioDataStart();
+    void requestPump();
+    void onOutputConsumed(qint64 frames, bool drained);
+
+    QAudioFormat m_format;
+    MediaFileReader m_reader;
+    PcmJitterBuffer m_jitter;
+    QAudioDecoder *m_decoder;
+    QAudioSink *m_sink;
+    PcmOutputDevice *m_output;
+    GainRamp *m_gainRamp;
+    QTimer *m_positionTimer;
+
+    QString m_state;
+    QByteArray m_pending;           // decoded data that did not fit yet
+    qint64 m_duration;
+    bool m_seekable;
+    qint64 m_dataStart;             // after the ID3v2 tag
+    qint64 m_pendingSeekMs;         // waits for the duration, -1 = none
+    qint64 m_lastReportedPosition;
+    int m_volume;
+
+    std::atomic<qint64> m_framesPlayed;
+    std::atomic<bool> m_decoderDone;
+    std::atomic<bool> m_pumpQueued;
+
+    static constexpr int kSampleRate = 48000;
+    static constexpr int kChannels = 2;
+    static constexpr int kJitterMs = 250;
+};
+
+#endif // AUDIO_ENGINE_H
@@ -0,0 +1,133 @@
+#include "audio_focus_client.h"
+#include "gain_ramp.h"
+#include <QDBusPendingReply>
+#include <QDebug>
+
+AudioFocusClient::AudioFocusClient(const QString &clientId, const QString &stream,
+                                   QObject *parent)
+    : QObject(parent)
+    , m_clientId(clientId)
+    , m_stream(stream)
+    , m_serviceAvailable(false)
+    , m_interface(nullptr)
+{
+    setupDBusConnection();
+}
+
+void AudioFocusClient::setupDBusConnection()
+{
+    QDBusConnection sessionBus = QDBusConnection::sessionBus();
+
+    if (!sessionBus.isConnected()) {
+        qWarning() << "AudioFocus: Cannot connect to D-Bus session bus";
+        return;
+    }
+
+    m_interface = new QDBusInterface(
+        "com.headunit.AudioFocus",
+        "/com/headunit/AudioFocus",
+        "com.headunit.AudioFocus",
+        sessionBus,
+        this
+        );
+
+    // Subscribe even if the AFM is not up yet - the signal match survives restarts
+    sessionBus.connect(
+        "com.headunit.AudioFocus",
+        "/com/headunit/AudioFocus",
+        "com.headunit.AudioFocus",
+        "FocusChanged",
+        this,
+        SLOT(onFocusChanged(QString, QString, double, int, qlonglong))
+        );
+
+    m_serviceAvailable = m_interface->isValid();
+    if (m_serviceAvailable) {
+        qDebug() << "AudioFocus: Connected to focus service as" << m_clientId;
+    } else {
+        qWarning() << "AudioFocus: Focus service not available, playing without arbitration";
+    }
+    emit serviceAvailableChanged();
+}
+
+void AudioFocusClient::requestFocus(const QString &focusType)
+{
+    if (!m_interface || !m_interface->isValid()) {
+        // Without a focus service every client simply owns its output
+        applyState("gain", 1.0, 0, 0);
+        return;
+    }
+
+    const qint64 requestTimeUs = GainRamp::nowNs() / 1000;
+    QDBusPendingCall call = m_interface->asyncCall("RequestFocus", m_clientId, m_stream,
+                                                   focusType, requestTimeUs);
+    auto *watcher = new QDBusPendingCallWatcher(call, this);
+    connect(watcher, &QDBusPendingCallWatcher::finished,
+            this, &AudioFocusClient::onRequestFinished);
+}
+
+void AudioFocusClient::abandonFocus()
+{
+    if (m_focusState.isEmpty()) {
+        return;
+    }
+
+    if (m_interface && m_interface->isValid()) {
+        m_interface->call(QDBus::NoBlock, "AbandonFocus", m_clientId);
+    }
+
+    m_focusState.clear();
+    emit focusStateChanged();
+}
+
+void AudioFocusClient::onRequestFinished(QDBusPendingCallWatcher *watcher)
+{
+    QDBusPendingReply<QString> reply = *watcher;
+
+    if (reply.isError()) {
+        qWarning() << "AudioFocus: RequestFocus failed:" << reply.error().message();
+        applyState("gain", 1.0, 0, 0);
+    } else if (reply.value() == "denied") {
+        // Final: nothing will hand focus back, the user has to play again
+        qDebug() << "AudioFocus: Request denied for" << m_clientId;
+        if (m_focusState == "loss") {
+            emit focusLost(false);
+        } else {
+            applyState("loss", 0.0, 0, 0);
+        }
+    }
+    // Granted states also arrive through FocusChanged, which carries the ramp
+
+    watcher->deleteLater();
+}
+
+void AudioFocusClient::onFocusChanged(const QString &clientId, const QString &state,
+                                      double duckGain, int rampMs, qlonglong requestTimeUs)
+{
+    if (clientId != m_clientId) {
+        return;
+    }
+    applyState(state, duckGain, rampMs, requestTimeUs * 1000);
+}
+
+void AudioFocusClient::applyState(const QString &state, double duckGain, int rampMs, qint64 originNs)
+{
+    const QString previous = m_focusState;
+    if (previous == state) {
+        return;
+    }
+
+    m_focusState = state;
+    emit focusStateChanged();
+    qDebug() << "AudioFocus:" << m_clientId << previous << "->" << state;
+
+    if (state == "gain") {
+        emit focusGained(rampMs, originNs);
+    } else if (state == "duck") {
+        emit duckRequested(duckGain, rampMs, originNs);
+    } else if (state == "loss_transient") {
+        emit focusLost(true);
+    } else if (state == "loss") {
+        emit focusLost(false);
+    }
+}
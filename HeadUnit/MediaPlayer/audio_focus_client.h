@@ -0,0 +1,53 @@
+#ifndef AUDIO_FOCUS_CLIENT_H
+#define AUDIO_FOCUS_CLIENT_H
+
+#include <QObject>
+#include <QString>
+#include <QtDBus/QDBusConnection>
+#include <QtDBus/QDBusInterface>
+#include <QtDBus/QDBusPendingCallWatcher>
+
+class AudioFocusClient : public QObject
+{
+    Q_OBJECT
+    Q_PROPERTY(QString focusState READ focusState NOTIFY focusStateChanged)
+    Q_PROPERTY(bool serviceAvailable READ serviceAvailable NOTIFY serviceAvailableChanged)
+
+public:
+    explicit AudioFocusClient(const QString &clientId, const QString &stream,
+                              QObject *parent = nullptr);
+
+    QString focusState() const { return m_focusState; }
+    bool serviceAvailable() const { return m_serviceAvailable; }
+    bool hasFocus() const { return m_focusState == "gain" || m_focusState == "duck"; }
+
+    // focusType: "gain", "transient" or "transient_may_duck"
+    void requestFocus(const QString &focusType = "gain");
+    void abandonFocus();
+
+signals:
+    void focusStateChanged();
+    void serviceAvailableChanged();
+
+    // originNs is the steady_clock time of the request that caused the change
+    void focusGained(int rampMs, qint64 originNs);
+    void focusLost(bool transient);
+    void duckRequested(double gain, int rampMs, qint64 originNs);
+
+private slots:
+    void onFocusChanged(const QString &clientId, const QString &state,
+                        double duckGain, int rampMs, qlonglong requestTimeUs);
+    void onRequestFinished(QDBusPendingCallWatcher *watcher);
+
+private:
+    void setupDBusConnection();
+    void applyState(const QString &state, double duckGain, int rampMs, qint64 originNs);
+
+    QString m_clientId;
+    QString m_stream;
+    QString m_focusState;
+    bool m_serviceAvailable;
+    QDBusInterface *m_interface;
+};
+
+#endif // AUDIO_FOCUS_CLIENT_H
@@ -0,0 +1,286 @@
+#include "bookmark_store.h"
+#include "usb_monitor.h"
+#include <QCoreApplication>
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDebug>
+#include <QDir>
+#include <QDirIterator>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QUrl>
+#include <unistd.h>
+
+BookmarkStore::BookmarkStore(QObject *parent)
+    : QObject(parent)
+    , m_flushTimer(nullptr)
+    , m_logBytes(0)
+    , m_logRecords(0)
+{
+    const QString dir = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation);
+    QDir().mkpath(dir);
+    m_logPath = dir + "/bookmarks.log";
+
+    m_flushTimer = new QTimer(this);
+    m_flushTimer->setSingleShot(true);
+    m_flushTimer->setInterval(kFlushIntervalMs);
+    connect(m_flushTimer, &QTimer::timeout, this, &BookmarkStore::flush);
+
+    connect(QCoreApplication::instance(), &QCoreApplication::aboutToQuit, this, &BookmarkStore::flush);
+
+    load();
+}
+
+BookmarkStore::~BookmarkStore()
+{
+    flush();
+}
+
+QString BookmarkStore::volumeIdForPath(const QString &filePath, QString *mountPoint)
+{
+    QFile mountInfo("/proc/self/mountinfo");
+    if (!mountInfo.open(QIODevice::ReadOnly)) {
+        return QString();
+    }
+
+    // Longest mount point that contains the file wins
+    QString bestMount;
+    QString bestSource;
+    for (const auto &entry : UsbMonitor::parseMountInfo(mountInfo.readAll())) {
+        const QString &mount = entry.first;
+        const bool contains = mount == "/" || filePath == mount || filePath.startsWith(mount + '/');
+        if (contains && mount.length() > bestMount.length()) {
+            bestMount = mount;
+            bestSource = entry.second;
+        }
+    }
+
+    if (bestMount.isEmpty()) {
+        return QString();
+    }
+    if (mountPoint) {
+        *mountPoint = bestMount;
+    }
+
+    // Device nodes move around between insertions, the filesystem UUID does not
+    const QString device = QFileInfo(bestSource).canonicalFilePath();
+    QDirIterator it("/dev/disk/by-uuid", QDir::System | QDir::Files);
+    while (it.hasNext()) {
+        it.next();
+        if (!device.isEmpty() && QFileInfo(it.filePath()).canonicalFilePath() == device) {
+            return it.fileName();
+        }
+    }
+
+    return bestSource;
+}
+
+const BookmarkStore::FileKey &BookmarkStore::keyFor(const QString &filePath)
+{
+    auto it = m_keyCache.constFind(filePath);
+    if (it != m_keyCache.constEnd()) {
+        return it.value();
+    }
+
+    FileKey key;
+    key.volumeId = volumeIdForPath(filePath, &key.mountPoint);
+    key.relativePath = key.mountPoint.isEmpty()
+        ? filePath
+        : QDir(key.mountPoint).relativeFilePath(filePath);
+
+    // Inode numbers are not stable across re-mounts on FAT/exFAT sticks
+    const QFileInfo info(filePath);
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    hash.addData(key.relativePath.toUtf8());
+    hash.addData(QByteArray::number(info.size()));
+    hash.addData(QByteArray::number(info.lastModified().toSecsSinceEpoch()));
+    key.key = key.volumeId.toUtf8() + '/' + hash.result().toHex().left(24);
+
+    return m_keyCache.insert(filePath, key).value();
+}
+
+void BookmarkStore::forgetMount(const QString &mountPoint)
+{
+    const QString prefix = mountPoint.endsWith('/') ? mountPoint : mountPoint + '/';
+    for (auto it = m_keyCache.begin(); it != m_keyCache.end();) {
+        if (it.value().mountPoint == mountPoint || it.key().startsWith(prefix)) {
+            it = m_keyCache.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+qint64 BookmarkStore::position(const QString &filePath)
+{
+    if (filePath.isEmpty()) {
+        return 0;
+    }
+    return m_positions.value(keyFor(filePath).key, 0);
+}
+
+void BookmarkStore::setPosition(const QString &filePath, qint64 positionMs, qint64 durationMs)
+{
+    if (filePath.isEmpty()) {
+        return;
+    }
+
+    // Second granularity is plenty for resuming and keeps the log small
+    qint64 pos = positionMs / 1000 * 1000;
+    if (durationMs > 0 && positionMs >= durationMs - kFinishedMarginMs) {
+        pos = 0;
+    }
+
+    const QByteArray &key = keyFor(filePath).key;
+    if (m_positions.value(key, 0) == pos) {
+        return;
+    }
+
+    if (pos > 0) {
+        m_positions.insert(key, pos);
+    } else {
+        m_positions.remove(key);
+    }
+    m_dirtyPositions.insert(key);
+    scheduleFlush();
+}
+
+QString BookmarkStore::lastTrack(const QString &anyFileOnVolume)
+{
+    if (anyFileOnVolume.isEmpty()) {
+        return QString();
+    }
+
+    const FileKey &key = keyFor(anyFileOnVolume);
+    const QString relative = m_lastTracks.value(key.volumeId);
+    if (relative.isEmpty() || key.mountPoint.isEmpty()) {
+        return QString();
+    }
+    return QDir(key.mountPoint).filePath(relative);
+}
+
+void BookmarkStore::setLastTrack(const QString &filePath)
+{
+    if (filePath.isEmpty()) {
+        return;
+    }
+
+    const FileKey &key = keyFor(filePath);
+    if (key.volumeId.isEmpty() || m_lastTracks.value(key.volumeId) == key.relativePath) {
+        return;
+    }
+
+    m_lastTracks.insert(key.volumeId, key.relativePath);
+    m_dirtyVolumes.insert(key.volumeId);
+    scheduleFlush();
+}
+
+void BookmarkStore::scheduleFlush()
+{
+    // Never restart a running timer: that bounds syncs to one per interval
+    if (!m_flushTimer->isActive()) {
+        m_flushTimer->start();
+    }
+}
+
+void BookmarkStore::load()
+{
+    QFile log(m_logPath);
+    if (!log.open(QIODevice::ReadOnly)) {
+        return;
+    }
+
+    // Later records override earlier ones; a torn last line is ignored
+    while (!log.atEnd()) {
+        const QByteArray line = log.readLine();
+        m_logBytes += line.size();
+        if (!line.endsWith('\n')) {
+            break;
+        }
+
+        const QList<QByteArray> fields = line.trimmed().split('\t');
+        if (fields.size() != 3) {
+            continue;
+        }
+        m_logRecords++;
+
+        if (fields[0] == "P") {
+            const qint64 pos = fields[2].toLongLong();
+            if (pos > 0) {
+                m_positions.insert(fields[1], pos);
+            } else {
+                m_positions.remove(fields[1]);
+            }
+        } else if (fields[0] == "T") {
+            m_lastTracks.insert(QString::fromUtf8(fields[1]),
+                                QUrl::fromPercentEncoding(fields[2]));
+        }
+    }
+
+    qDebug() << "BookmarkStore: Loaded" << m_positions.size() << "bookmarks from"
+             << m_logRecords << "records";
+}
+
+void BookmarkStore::flush()
+{
+    m_flushTimer->stop();
+
+    if (m_dirtyPositions.isEmpty() && m_dirtyVolumes.isEmpty()) {
+        return;
+    }
+
+    QByteArray records;
+    for (const QByteArray &key : std::as_const(m_dirtyPositions)) {
+        records += "P\t" + key + '\t' + QByteArray::number(m_positions.value(key, 0)) + '\n';
+    }
+    for (const QString &volume : std::as_const(m_dirtyVolumes)) {
+        records += "T\t" + volume.toUtf8() + '\t'
+                   + QUrl::toPercentEncoding(m_lastTracks.value(volume)) + '\n';
+    }
+    const int count = m_dirtyPositions.size() + m_dirtyVolumes.size();
+    m_dirtyPositions.clear();
+    m_dirtyVolumes.clear();
+
+    QFile log(m_logPath);
+    if (!log.open(QIODevice::WriteOnly | QIODevice::Append)) {
+        qWarning() << "BookmarkStore: Cannot open" << m_logPath << ":" << log.errorString();
+        return;
+    }
+    log.write(records);
+    log.flush();
+    ::fdatasync(log.handle());
+    log.close();
+
+    m_logBytes += records.size();
+    m_logRecords += count;
+
+    const int live = m_positions.size() + m_lastTracks.size();
+    if (m_logBytes > kCompactMinBytes && m_logRecords > 4 * live) {
+        compact();
+    }
+}
+
+void BookmarkStore::compact()
+{
+    QByteArray records;
+    for (auto it = m_positions.constBegin(); it != m_positions.constEnd(); ++it) {
+        records += "P\t" + it.key() + '\t' + QByteArray::number(it.value()) + '\n';
+    }
+    for (auto it = m_lastTracks.constBegin(); it != m_lastTracks.constEnd(); ++it) {
+        records += "T\t" + it.key().toUtf8() + '\t' + QUrl::toPercentEncoding(it.value()) + '\n';
+    }
+
+    // QSaveFile syncs and renames, so a power cut leaves either log intact
+    QSaveFile file(m_logPath);
+    if (!file.open(QIODevice::WriteOnly) || file.write(records) != records.size() || !file.commit()) {
+        qWarning() << "BookmarkStore: Compaction failed:" << file.errorString();
+        return;
+    }
+
+    qDebug() << "BookmarkStore: Compacted" << m_logRecords << "records into"
+             << (m_positions.size() + m_lastTracks.size());
+    m_logBytes = records.size();
+    m_logRecords = m_positions.size() + m_lastTracks.size();
+}
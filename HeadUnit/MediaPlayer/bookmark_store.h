@@ -0,0 +1,69 @@
+#ifndef BOOKMARK_STORE_H
+#define BOOKMARK_STORE_H
+
+#include <QObject>
+#include <QString>
+#include <QHash>
+#include <QSet>
+#include <QByteArray>
+#include <QTimer>
+
+// Persistent playback bookmarks.
+//
+// Entries are keyed by the volume UUID plus a file identity (path on the
+// volume, size and mtime), so they survive re-mounts under another mount point
+// and relaunches of the app. Lookups are served from an in-memory hash; updates
+// are appended to a log that is flushed at most once per flush interval and
+// rewritten (compacted) once it carries mostly stale records.
+class BookmarkStore : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit BookmarkStore(QObject *parent = nullptr);
+    ~BookmarkStore();
+
+    qint64 position(const QString &filePath);
+    void setPosition(const QString &filePath, qint64 positionMs, qint64 durationMs);
+
+    // Last track played from the volume holding filePath, as an absolute path
+    QString lastTrack(const QString &anyFileOnVolume);
+    void setLastTrack(const QString &filePath);
+
+    void flush();
+
+    // Drops the cached keys of files under a mount point that went away; a
+    // stick mounted there next may hold other files under the same paths
+    void forgetMount(const QString &mountPoint);
+
+    static QString volumeIdForPath(const QString &filePath, QString *mountPoint = nullptr);
+
+private:
+    struct FileKey {
+        QString volumeId;
+        QString mountPoint;
+        QByteArray key;         // volumeId + file identity
+        QString relativePath;
+    };
+
+    const FileKey &keyFor(const QString &filePath);
+    void load();
+    void scheduleFlush();
+    void compact();
+
+    QString m_logPath;
+    QHash<QByteArray, qint64> m_positions;          // key -> position (ms)
+    QHash<QString, QString> m_lastTracks;           // volumeId -> relative path
+    QHash<QString, FileKey> m_keyCache;             // absolute path -> key
+    QSet<QByteArray> m_dirtyPositions;              // not yet on disk
+    QSet<QString> m_dirtyVolumes;
+    QTimer *m_flushTimer;
+    qint64 m_logBytes;
+    int m_logRecords;
+
+    static constexpr int kFlushIntervalMs = 10000;
+    static constexpr qint64 kFinishedMarginMs = 5000;
+    static constexpr qint64 kCompactMinBytes = 64 * 1024;
+};
+
+#endif // BOOKMARK_STORE_H
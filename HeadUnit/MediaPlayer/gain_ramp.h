@@ -0,0 +1,133 @@
+#ifndef GAIN_RAMP_H
+#define GAIN_RAMP_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+
+// Sample-accurate gain ramp for the PCM output stage.
+//
+// rampTo() is called from the GUI thread (audio focus changes), process()
+// from the audio thread. The command is packed into a single atomic word so
+// the audio thread never takes a lock. Each frame gets its own gain value,
+// so a duck is a smooth line instead of a staircase of volume steps.
+class GainRamp
+{
+public:
+    explicit GainRamp(int sampleRate = 48000)
+        : m_sampleRate(sampleRate)
+    {}
+
+    void setSampleRate(int sampleRate) { m_sampleRate = sampleRate > 0 ? sampleRate : 48000; }
+
+    // originNs: steady_clock time of the event that caused this ramp, used to
+    // measure request -> first ramped sample latency. 0 disables measurement.
+    void rampTo(float target, int durationMs, int64_t originNs = 0)
+    {
+        if (target < 0.0f) target = 0.0f;
+        if (target > 1.0f) target = 1.0f;
+        if (durationMs < 0) durationMs = 0;
+
+        uint32_t bits;
+        std::memcpy(&bits, &target, sizeof(bits));
+        const uint64_t frames = static_cast<uint64_t>(durationMs) * static_cast<uint64_t>(m_sampleRate) / 1000u;
+
+        m_targetGain.store(target, std::memory_order_relaxed);
+        m_commandOriginNs.store(originNs, std::memory_order_relaxed);
+        m_command.store(kValid | (static_cast<uint64_t>(bits) << 31) | (frames & kFramesMask),
+                        std::memory_order_release);
+    }
+
+    void process(float *interleaved, int frames, int channels)
+    {
+        fetchCommand();
+        for (int f = 0; f < frames; ++f) {
+            const float g = nextGain();
+            for (int c = 0; c < channels; ++c) {
+                interleaved[f * channels + c] *= g;
+            }
+        }
+    }
+
+    void process(int16_t *interleaved, int frames, int channels)
+    {
+        fetchCommand();
+        for (int f = 0; f < frames; ++f) {
+            const float g = nextGain();
+            for (int c = 0; c < channels; ++c) {
+                interleaved[f * channels + c] = static_cast<int16_t>(interleaved[f * channels + c] * g);
+            }
+        }
+    }
+
+    float targetGain() const { return m_targetGain.load(std::memory_order_relaxed); }
+    bool isRamping() const { return m_remaining > 0; }
+
+    // Latency between the originating request and the first ramped sample
+    int64_t lastLatencyNs() const { return m_lastLatencyNs.load(std::memory_order_relaxed); }
+
+    static int64_t nowNs()
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                   std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+private:
+    static constexpr uint64_t kValid = 1ull << 63;
+    static constexpr uint64_t kFramesMask = (1ull << 31) - 1;
+
+    void fetchCommand()
+    {
+        const uint64_t cmd = m_command.exchange(0, std::memory_order_acquire);
+        if (!(cmd & kValid)) {
+            return;
+        }
+
+        const uint32_t bits = static_cast<uint32_t>((cmd >> 31) & 0xffffffffu);
+        float target;
+        std::memcpy(&target, &bits, sizeof(target));
+        const int64_t frames = static_cast<int64_t>(cmd & kFramesMask);
+
+        if (frames == 0) {
+            m_gain = target;
+            m_step = 0.0f;
+            m_remaining = 0;
+        } else {
+            m_step = (target - m_gain) / static_cast<float>(frames);
+            m_remaining = frames;
+        }
+        m_end = target;
+
+        const int64_t origin = m_commandOriginNs.load(std::memory_order_relaxed);
+        if (origin > 0) {
+            m_lastLatencyNs.store(nowNs() - origin, std::memory_order_relaxed);
+        }
+    }
+
+    float nextGain()
+    {
+        if (m_remaining > 0) {
+            m_gain += m_step;
+            if (--m_remaining == 0) {
+                m_gain = m_end;
+            }
+        }
+        return m_gain;
+    }
+
+    int m_sampleRate;
+
+    // Audio thread state
+    float m_gain = 1.0f;
+    float m_step = 0.0f;
+    float m_end = 1.0f;
+    int64_t m_remaining = 0;
+
+    std::atomic<uint64_t> m_command{0};
+    std::atomic<float> m_targetGain{1.0f};
+    std::atomic<int64_t> m_commandOriginNs{0};
+    std::atomic<int64_t> m_lastLatencyNs{0};
+};
+
+#endif // GAIN_RAMP_H
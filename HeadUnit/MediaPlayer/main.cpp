@@ -6,13 +6,11 @@
 #include <QDebug>
 #include "mp_handler.h"
 #include "../theme_client.h"
+#include "../app_liveness.h"
 
 
 int main(int argc, char *argv[])
 {
-    // IMPORTANT: Enable virtual keyboard BEFORE creating QGuiApplication
-    //qputenv("QT_IM_MODULE", QByteArray("qtvirtualkeyboard"));
-
     // Initialize QtWebView
     QtWebView::initialize();
 
@@ -21,6 +19,9 @@ int main(int argc, char *argv[])
 
     ThemeClient themeClient;
 
+    // Answers the compositor's watchdog
+    AppLiveness liveness;
+
     app.setApplicationName("MediaPlayer");
     app.setOrganizationName("HeadUnit");
 
@@ -0,0 +1,358 @@
+#include "media_file_reader.h"
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QMutexLocker>
+#include <cerrno>
+#include <csetjmp>
+#include <csignal>
+#include <cstring>
+#include <fcntl.h>
+#include <mutex>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+// A yanked USB stick turns accesses to the mapping into SIGBUS. Copies from
+// the mapping run under a per-thread jump buffer so that becomes an I/O
+// error instead of killing the player.
+thread_local sigjmp_buf *t_busJump = nullptr;
+struct sigaction g_previousBusAction;
+std::once_flag g_busHandlerOnce;
+
+void busHandler(int sig, siginfo_t *, void *)
+{
+    if (t_busJump) {
+        siglongjmp(*t_busJump, 1);
+    }
+    sigaction(SIGBUS, &g_previousBusAction, nullptr);
+    raise(sig);
+}
+
+void installBusHandler()
+{
+    std::call_once(g_busHandlerOnce, [] {
+        struct sigaction action;
+        std::memset(&action, 0, sizeof(action));
+        action.sa_sigaction = busHandler;
+        action.sa_flags = SA_SIGINFO | SA_NODEFER;
+        sigemptyset(&action.sa_mask);
+        sigaction(SIGBUS, &action, &g_previousBusAction);
+    });
+}
+
+bool guardedCopy(char *dst, const uchar *src, qint64 len)
+{
+    sigjmp_buf jump;
+    if (sigsetjmp(jump, 1) != 0) {
+        t_busJump = nullptr;
+        return false;
+    }
+    t_busJump = &jump;
+    std::memcpy(dst, src, static_cast<size_t>(len));
+    t_busJump = nullptr;
+    return true;
+}
+
+bool guardedTouch(const uchar *src, qint64 len, long pageSize)
+{
+    sigjmp_buf jump;
+    if (sigsetjmp(jump, 1) != 0) {
+        t_busJump = nullptr;
+        return false;
+    }
+    t_busJump = &jump;
+    volatile uchar sink = 0;
+    for (qint64 off = 0; off < len; off += pageSize) {
+        sink = sink + src[off];
+    }
+    t_busJump = nullptr;
+    return true;
+}
+
+} // namespace
+
+MediaFileReader::MediaFileReader(QObject *parent)
+    : QIODevice(parent)
+    , m_fd(-1)
+    , m_map(nullptr)
+    , m_size(0)
+    , m_origin(0)
+    , m_pageSize(sysconf(_SC_PAGESIZE))
+    , m_readPos(0)
+    , m_frontier(0)
+    , m_window(kMinWindow)
+    , m_releasedUpTo(0)
+    , m_stalls(0)
+    , m_ioError(false)
+    , m_stopPrefetch(false)
+    , m_rateBytesPerSec(0)
+    , m_rateSamplePos(0)
+    , m_rateSampleNs(0)
+    , m_prefetcher(nullptr)
+{
+    installBusHandler();
+}
+
+MediaFileReader::~MediaFileReader()
+{
+    close();
+}
+
+bool MediaFileReader::openFile(const QString &path)
+{
+    close();
+
+    m_fd = ::open(QFile::encodeName(path).constData(), O_RDONLY | O_CLOEXEC);
+    if (m_fd < 0) {
+        qWarning() << "MediaFileReader: Cannot open" << path << ":" << strerror(errno);
+        return false;
+    }
+
+    struct stat st;
+    if (fstat(m_fd, &st) != 0 || st.st_size <= 0) {
+        qWarning() << "MediaFileReader: Cannot stat" << path;
+        ::close(m_fd);
+        m_fd = -1;
+        return false;
+    }
+    m_size = st.st_size;
+
+    void *map = mmap(nullptr, static_cast<size_t>(m_size), PROT_READ, MAP_SHARED, m_fd, 0);
+    if (map == MAP_FAILED) {
+        qWarning() << "MediaFileReader: mmap failed for" << path << ":" << strerror(errno);
+        ::close(m_fd);
+        m_fd = -1;
+        m_size = 0;
+        return false;
+    }
+    m_map = static_cast<uchar *>(map);
+
+    // Tell the kernel the access pattern; the prefetcher drives the actual readahead
+    posix_fadvise(m_fd, 0, m_size, POSIX_FADV_SEQUENTIAL);
+    madvise(m_map, static_cast<size_t>(m_size), MADV_SEQUENTIAL);
+
+    m_path = path;
+    m_origin = 0;
+    m_readPos = 0;
+    m_frontier = 0;
+    m_window = kMinWindow;
+    m_releasedUpTo = 0;
+    m_stalls = 0;
+    m_ioError = false;
+    m_stopPrefetch = false;
+    m_rateBytesPerSec = 0;
+    m_rateSamplePos = 0;
+    m_rateSampleNs = 0;
+
+    QIODevice::open(QIODevice::ReadOnly | QIODevice::Unbuffered);
+
+    m_prefetcher = QThread::create([this] { prefetchLoop(); });
+    m_prefetcher->setObjectName("MediaPrefetch");
+    m_prefetcher->start(QThread::LowPriority);
+
+    qDebug() << "MediaFileReader: Opened" << path << "(" << m_size << "bytes )";
+    return true;
+}
+
+void MediaFileReader::close()
+{
+    if (m_prefetcher) {
+        m_stopPrefetch = true;
+        {
+            QMutexLocker locker(&m_wakeMutex);
+            m_wake.wakeAll();
+        }
+        m_prefetcher->wait();
+        delete m_prefetcher;
+        m_prefetcher = nullptr;
+    }
+
+    unmap();
+
+    if (isOpen()) {
+        QIODevice::close();
+    }
+}
+
+void MediaFileReader::unmap()
+{
+    if (m_map) {
+        munmap(m_map, static_cast<size_t>(m_size));
+        m_map = nullptr;
+    }
+    if (m_fd >= 0) {
+        posix_fadvise(m_fd, 0, m_size, POSIX_FADV_DONTNEED);
+        ::close(m_fd);
+        m_fd = -1;
+    }
+    m_size = 0;
+    m_origin = 0;
+}
+
+void MediaFileReader::setOrigin(qint64 offset)
+{
+    m_origin = qBound<qint64>(0, offset, m_size);
+    seek(0);
+}
+
+bool MediaFileReader::seek(qint64 pos)
+{
+    if (pos < 0 || pos > size() || !QIODevice::seek(pos)) {
+        return false;
+    }
+
+    // The prefetcher works in file offsets
+    const qint64 filePos = pos + m_origin;
+    m_readPos = filePos;
+    // Jumping outside the prefetched range restarts readahead from there
+    if (filePos > m_frontier.load() || filePos < m_releasedUpTo.load()) {
+        m_frontier = filePos;
+        m_releasedUpTo = filePos - (filePos % m_pageSize);
+    }
+
+    QMutexLocker locker(&m_wakeMutex);
+    m_wake.wakeAll();
+    return true;
+}
+
+qint64 MediaFileReader::prefetchedBytes() const
+{
+    return qMax<qint64>(0, m_frontier.load() - m_readPos.load());
+}
+
+qint64 MediaFileReader::readData(char *data, qint64 maxlen)
+{
+    if (!m_map || m_ioError.load()) {
+        return -1;
+    }
+
+    const qint64 pos = QIODevice::pos() + m_origin;
+    const qint64 len = qMin(maxlen, m_size - pos);
+    if (len <= 0) {
+        return 0;
+    }
+
+    const qint64 frontier = m_frontier.load();
+    if (m_pageInHook && pos + len > frontier) {
+        const qint64 from = qMax(pos, frontier);
+        m_pageInHook(from, pos + len - from);
+    }
+
+    if (!guardedCopy(data, m_map + pos, len)) {
+        m_ioError = true;
+        qWarning() << "MediaFileReader: I/O error reading" << m_path << "at" << pos;
+        emit ioError(QString("I/O error reading %1").arg(m_path));
+        return -1;
+    }
+
+    m_readPos = pos + len;
+    if (prefetchedBytes() < m_window.load() / 2) {
+        QMutexLocker locker(&m_wakeMutex);
+        m_wake.wakeAll();
+    }
+    return len;
+}
+
+qint64 MediaFileReader::writeData(const char *, qint64)
+{
+    return -1;
+}
+
+void MediaFileReader::prefetchLoop()
+{
+    QElapsedTimer clock;
+    clock.start();
+
+    while (!m_stopPrefetch.load()) {
+        const qint64 pos = m_readPos.load();
+        const qint64 frontier = qMax(m_frontier.load(), pos);
+        const qint64 target = qMin(m_size, pos + m_window.load());
+
+        releaseBehind(pos);
+
+        if (frontier >= target || m_ioError.load()) {
+            QMutexLocker locker(&m_wakeMutex);
+            m_wake.wait(&m_wakeMutex, 50);
+            continue;
+        }
+
+        const qint64 start = frontier - (frontier % m_pageSize);
+        const qint64 chunk = qMin(kChunkSize, target - start);
+
+        posix_fadvise(m_fd, start, chunk, POSIX_FADV_WILLNEED);
+
+        const qint64 t0 = clock.nsecsElapsed();
+        if (m_pageInHook) {
+            m_pageInHook(start, chunk);
+        }
+        if (!guardedTouch(m_map + start, chunk, m_pageSize)) {
+            m_ioError = true;
+            emit ioError(QString("I/O error prefetching %1").arg(m_path));
+            continue;
+        }
+        const qint64 chunkMs = (clock.nsecsElapsed() - t0) / 1000000;
+
+        // A concurrent seek may have moved the frontier; only advance it forward
+        qint64 expected = m_frontier.load();
+        const qint64 newFrontier = start + chunk;
+        while (expected < newFrontier && !m_frontier.compare_exchange_weak(expected, newFrontier)) {
+        }
+
+        if (chunkMs >= kStallThresholdMs) {
+            m_stalls++;
+            qDebug() << "MediaFileReader: Stall of" << chunkMs << "ms, readahead ahead:"
+                     << prefetchedBytes() / 1024 << "KiB";
+            emit stallDetected(chunkMs);
+        }
+        adaptWindow(chunkMs);
+
+        // Rate sampling
+        const qint64 now = clock.nsecsElapsed();
+        if (m_rateSampleNs == 0) {
+            m_rateSampleNs = now;
+            m_rateSamplePos = pos;
+        } else if (now - m_rateSampleNs >= 250000000LL) {
+            const qint64 consumed = qMax<qint64>(0, m_readPos.load() - m_rateSamplePos);
+            m_rateBytesPerSec = consumed * 1000000000LL / (now - m_rateSampleNs);
+            m_rateSampleNs = now;
+            m_rateSamplePos = m_readPos.load();
+        }
+    }
+}
+
+void MediaFileReader::adaptWindow(qint64 chunkMs)
+{
+    qint64 window = m_window.load();
+    const qint64 wanted = qBound(kMinWindow, m_rateBytesPerSec * kTargetSeconds, kMaxWindow);
+
+    if (chunkMs >= kStallThresholdMs) {
+        // Bursty device: keep more in flight from now on
+        window = qMin(kMaxWindow, qMax(wanted, window * 2));
+    } else if (wanted > window) {
+        window = wanted;
+    }
+
+    m_window = window;
+}
+
+void MediaFileReader::releaseBehind(qint64 pos)
+{
+    const qint64 releaseEnd = pos - kKeepBehind;
+    const qint64 released = m_releasedUpTo.load();
+    if (releaseEnd - released < 4 * kChunkSize) {
+        return;
+    }
+
+    const qint64 start = released - (released % m_pageSize);
+    const qint64 end = releaseEnd - (releaseEnd % m_pageSize);
+    if (end <= start) {
+        return;
+    }
+
+    madvise(m_map + start, static_cast<size_t>(end - start), MADV_DONTNEED);
+    posix_fadvise(m_fd, start, end - start, POSIX_FADV_DONTNEED);
+    m_releasedUpTo = end;
+}
@@ -0,0 +1,102 @@
+#ifndef MEDIA_FILE_READER_H
+#define MEDIA_FILE_READER_H
+
+#include <QIODevice>
+#include <QMutex>
+#include <QString>
+#include <QThread>
+#include <QWaitCondition>
+#include <atomic>
+#include <functional>
+
+// Read-only QIODevice over an mmap'ed media file.
+//
+// A prefetch thread keeps a window of pages ahead of the decoder resident
+// (posix_fadvise WILLNEED + touching each page), so a slow or stalling USB
+// stick blocks the prefetcher instead of the decoder. The window adapts to
+// the measured consumption rate and grows after every stall. Pages behind
+// the read position are released again to keep the page cache small.
+//
+// setOrigin() makes a later part of the file look like the whole device, so
+// a decoder that always starts reading at 0 can be started mid-file.
+class MediaFileReader : public QIODevice
+{
+    Q_OBJECT
+
+public:
+    explicit MediaFileReader(QObject *parent = nullptr);
+    ~MediaFileReader();
+
+    bool openFile(const QString &path);
+    void close() override;
+
+    bool isSequential() const override { return false; }
+    qint64 size() const override { return m_size - m_origin; }
+    bool seek(qint64 pos) override;
+
+    // File offset of device position 0; seeks to it. Only while nobody reads.
+    void setOrigin(qint64 offset);
+    qint64 origin() const { return m_origin; }
+    qint64 fileSize() const { return m_size; }
+
+    // Fault injection for tests: runs before a range of the file is paged in,
+    // on the thread paging it in (the prefetcher, or a read of data not
+    // prefetched yet). A hook that sleeps acts as a stalling device. Set
+    // before openFile().
+    using PageInHook = std::function<void(qint64 offset, qint64 length)>;
+    void setPageInHook(const PageInHook &hook) { m_pageInHook = hook; }
+
+    QString fileName() const { return m_path; }
+    qint64 prefetchedBytes() const;
+    qint64 readaheadWindow() const { return m_window.load(); }
+    int stallCount() const { return m_stalls.load(); }
+    bool hasIoError() const { return m_ioError.load(); }
+
+signals:
+    void stallDetected(qint64 durationMs);
+    void ioError(const QString &message);
+
+protected:
+    qint64 readData(char *data, qint64 maxlen) override;
+    qint64 writeData(const char *data, qint64 len) override;
+
+private:
+    void prefetchLoop();
+    void adaptWindow(qint64 chunkMs);
+    void releaseBehind(qint64 pos);
+    void unmap();
+
+    QString m_path;
+    int m_fd;
+    uchar *m_map;
+    qint64 m_size;
+    qint64 m_origin;
+    long m_pageSize;
+
+    std::atomic<qint64> m_readPos;
+    std::atomic<qint64> m_frontier;
+    std::atomic<qint64> m_window;
+    std::atomic<qint64> m_releasedUpTo;
+    std::atomic<int> m_stalls;
+    std::atomic<bool> m_ioError;
+    std::atomic<bool> m_stopPrefetch;
+
+    // Consumption rate estimate (bytes/s), owned by the prefetch thread
+    qint64 m_rateBytesPerSec;
+    qint64 m_rateSamplePos;
+    qint64 m_rateSampleNs;
+
+    PageInHook m_pageInHook;
+    QThread *m_prefetcher;
+    QMutex m_wakeMutex;
+    QWaitCondition m_wake;
+
+    static constexpr qint64 kChunkSize = 256 * 1024;
+    static constexpr qint64 kMinWindow = 1 * 1024 * 1024;
+    static constexpr qint64 kMaxWindow = 64 * 1024 * 1024;
+    static constexpr qint64 kKeepBehind = 512 * 1024;
+    static constexpr int kTargetSeconds = 4;     // > 8x the 500 ms stall budget
+    static constexpr int kStallThresholdMs = 100;
+};
+
+#endif // MEDIA_FILE_READER_H
@@ -0,0 +1,160 @@
+#include "media_indexer.h"
+#include "media_tags.h"
+#include <QDebug>
+#include <QDirIterator>
+#include <QElapsedTimer>
+#include <QFileInfo>
+
+MediaIndexer::MediaIndexer(QObject *parent)
+    : QObject(parent)
+    , m_worker(new QObject)
+    , m_generation(0)
+    , m_scanning(false)
+{
+    qRegisterMetaType<MediaSearchIndexPtr>();
+
+    m_worker->moveToThread(&m_thread);
+    connect(&m_thread, &QThread::finished, m_worker, &QObject::deleteLater);
+
+    // Runs in the worker's thread context
+    connect(this, &MediaIndexer::scanRequested, m_worker, [this](const QString &rootPath, int generation) {
+        scan(rootPath, generation);
+    });
+    connect(this, &MediaIndexer::indexRequested, m_worker,
+            [this](const QString &rootPath, const QStringList &paths, int generation) {
+        buildIndex(rootPath, paths, generation);
+    });
+
+    m_thread.setObjectName("MediaIndexer");
+    m_thread.start(QThread::LowPriority);
+}
+
+MediaIndexer::~MediaIndexer()
+{
+    cancel();
+    m_thread.quit();
+    m_thread.wait();
+}
+
+void MediaIndexer::index(const QString &rootPath)
+{
+    ++m_generation;
+    m_scanning = true;
+    emit scanRequested(rootPath, m_generation.load());
+}
+
+void MediaIndexer::buildSearchIndex(const QString &rootPath, const QStringList &paths)
+{
+    ++m_generation;
+    emit indexRequested(rootPath, paths, m_generation.load());
+}
+
+void MediaIndexer::cancel()
+{
+    ++m_generation;
+    m_scanning = false;
+}
+
+bool MediaIndexer::isMediaFile(const QString &fileName)
+{
+    static const QStringList extensions = {
+        "mp3", "mp4", "avi", "mkv", "mov", "wav",
+        "flac", "m4a", "webm", "ogg", "aac", "wma"
+    };
+    return extensions.contains(QFileInfo(fileName).suffix(), Qt::CaseInsensitive);
+}
+
+void MediaIndexer::scan(const QString &rootPath, int generation)
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    QStringList names;
+    QStringList paths;
+    QStringList allPaths;
+    int total = 0;
+    bool firstSent = false;
+
+    QDirIterator it(rootPath, QDir::Files | QDir::Readable, QDirIterator::Subdirectories);
+    while (it.hasNext() && total < kMaxFiles) {
+        if (m_generation.load() != generation) {
+            qDebug() << "MediaIndexer: Scan of" << rootPath << "cancelled";
+            return;  // the newer request owns m_scanning
+        }
+
+        const QString path = it.next();
+        if (!isMediaFile(path)) {
+            continue;
+        }
+
+        names.append(it.fileName());
+        paths.append(path);
+        allPaths.append(path);
+        total++;
+
+        if (!firstSent || names.size() >= kBatchSize) {
+            if (!firstSent) {
+                qDebug() << "MediaIndexer: First file in" << rootPath << "after" << timer.elapsed() << "ms";
+            }
+            firstSent = true;
+            emit filesFound(rootPath, names, paths, false);
+            names.clear();
+            paths.clear();
+        }
+    }
+
+    if (m_generation.load() == generation) {
+        m_scanning = false;
+        emit filesFound(rootPath, names, paths, true);
+        qDebug() << "MediaIndexer: Indexed" << total << "files in" << rootPath << "in" << timer.elapsed() << "ms";
+        buildIndex(rootPath, allPaths, generation);
+    }
+}
+
+void MediaIndexer::buildIndex(const QString &rootPath, const QStringList &paths, int generation)
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    // File names only: available immediately
+    {
+        auto index = QSharedPointer<MediaSearchIndex>::create();
+        for (int i = 0; i < paths.size(); ++i) {
+            MediaSearchIndex::Track track;
+            track.fileName = QFileInfo(paths[i]).fileName();
+            track.title = QFileInfo(paths[i]).completeBaseName();
+            track.listIndex = i;
+            index->addTrack(track);
+        }
+        index->build();
+        if (m_generation.load() != generation) {
+            return;
+        }
+        emit searchIndexReady(rootPath, index);
+        qDebug() << "MediaIndexer: Name index of" << paths.size() << "tracks built in" << timer.elapsed() << "ms";
+    }
+
+    // Then with tags
+    auto index = QSharedPointer<MediaSearchIndex>::create();
+    for (int i = 0; i < paths.size(); ++i) {
+        if (m_generation.load() != generation) {
+            return;
+        }
+
+        const MediaTags tags = MediaTags::read(paths[i]);
+        MediaSearchIndex::Track track;
+        track.title = tags.title;
+        track.artist = tags.artist;
+        track.album = tags.album;
+        track.fileName = QFileInfo(paths[i]).fileName();
+        track.listIndex = i;
+        index->addTrack(track);
+    }
+    index->build();
+
+    if (m_generation.load() == generation) {
+        emit searchIndexReady(rootPath, index);
+        qDebug() << "MediaIndexer: Tag index of" << paths.size() << "tracks," << index->tokenCount()
+                 << "tokens, built in" << timer.elapsed() << "ms";
+    }
+}
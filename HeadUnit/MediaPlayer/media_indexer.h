@@ -0,0 +1,59 @@
+#ifndef MEDIA_INDEXER_H
+#define MEDIA_INDEXER_H
+
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <QThread>
+#include <atomic>
+#include "media_search_index.h"
+
+// Walks a mounted volume for media files on a worker thread.
+//
+// The first file found is published immediately so the playlist can show a
+// track while the rest of the tree is still being walked; after that results
+// go out in batches. Starting a new scan cancels the one in progress.
+//
+// Once the walk is done a search index is built twice: over file names right
+// away, then again with the ID3 tags, which needs to open every file.
+class MediaIndexer : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit MediaIndexer(QObject *parent = nullptr);
+    ~MediaIndexer();
+
+    void index(const QString &rootPath);
+    // Index an already known file list (service playback path)
+    void buildSearchIndex(const QString &rootPath, const QStringList &paths);
+    void cancel();
+    bool isScanning() const { return m_scanning.load(); }
+
+    static bool isMediaFile(const QString &fileName);
+
+signals:
+    // names/paths are the files found since the previous batch
+    void filesFound(const QString &rootPath, const QStringList &names, const QStringList &paths,
+                    bool finished);
+
+    void searchIndexReady(const QString &rootPath, const MediaSearchIndexPtr &index);
+
+    // Internal: hand requests to the worker thread
+    void scanRequested(const QString &rootPath, int generation);
+    void indexRequested(const QString &rootPath, const QStringList &paths, int generation);
+
+private:
+    void scan(const QString &rootPath, int generation);
+    void buildIndex(const QString &rootPath, const QStringList &paths, int generation);
+
+    QThread m_thread;
+    QObject *m_worker;
+    std::atomic<int> m_generation;
+    std::atomic<bool> m_scanning;
+
+    static constexpr int kBatchSize = 64;
+    static constexpr int kMaxFiles = 50000;
+};
+
+#endif // MEDIA_INDEXER_H
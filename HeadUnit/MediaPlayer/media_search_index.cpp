@@ -0,0 +1,303 @@
+#include "media_search_index.h"
+#include <QFileInfo>
+#include <QMutexLocker>
+#include <algorithm>
+#include <vector>
+
+namespace {
+
+// Score per match kind (Exact, Prefix, Fuzzy1, Fuzzy2) and field (Title,
+// Artist, Album, FileName)
+const int kMatchWeight[] = { 6, 4, 2, 1 };
+const int kFieldWeight[] = { 3, 2, 2, 1 };
+
+} // namespace
+
+struct MediaSearchIndex::Scratch
+{
+    explicit Scratch(int tracks, int tokens)
+        : query(0)
+        , seen(tracks, 0)
+        , score(tracks, 0)
+        , termBest(tracks, 0)
+        , lastTerm(tracks, -1)
+        , hits(tracks, 0)
+        , trigramHits(tokens, 0)
+    {}
+
+    // Starts a query; the per-track values are stale until touch()
+    void begin()
+    {
+        touched.clear();
+        if (++query == 0) {
+            std::fill(seen.begin(), seen.end(), 0);
+            query = 1;
+        }
+    }
+
+    void touch(int track)
+    {
+        if (seen[track] != query) {
+            seen[track] = query;
+            score[track] = 0;
+            lastTerm[track] = -1;
+            hits[track] = 0;
+            touched.push_back(track);
+        }
+    }
+
+    quint32 query;
+    std::vector<quint32> seen;      // query that last touched the track
+    std::vector<int> touched;       // tracks of the current query
+    std::vector<int> score;
+    std::vector<int> termBest;      // best weight of the current term per track
+    std::vector<int> lastTerm;
+    std::vector<quint8> hits;       // number of terms matched per track
+    std::vector<quint8> trigramHits; // all zero between queries
+};
+
+MediaSearchIndex::MediaSearchIndex() = default;
+
+MediaSearchIndex::~MediaSearchIndex() = default;
+
+QString MediaSearchIndex::normalize(const QString &text)
+{
+    const QString decomposed = text.normalized(QString::NormalizationForm_KD);
+
+    QString out;
+    out.reserve(decomposed.size());
+    for (const QChar c : decomposed) {
+        if (c.category() == QChar::Mark_NonSpacing) {
+            continue;
+        }
+        if (c.isLetterOrNumber()) {
+            out.append(c.toCaseFolded());
+        } else if (!out.isEmpty() && !out.endsWith(' ')) {
+            out.append(' ');
+        }
+    }
+    if (out.endsWith(' ')) {
+        out.chop(1);
+    }
+    return out;
+}
+
+quint64 MediaSearchIndex::trigramKey(const QChar *c)
+{
+    return (quint64(c[0].unicode()) << 32) | (quint64(c[1].unicode()) << 16) | quint64(c[2].unicode());
+}
+
+void MediaSearchIndex::addTrack(const Track &track)
+{
+    const int id = m_tracks.size();
+    m_tracks.append(track);
+
+    addField(id, Title, track.title);
+    addField(id, Artist, track.artist);
+    addField(id, Album, track.album);
+    addField(id, FileName, QFileInfo(track.fileName).completeBaseName());
+}
+
+void MediaSearchIndex::addField(int trackId, Field field, const QString &text)
+{
+    const QStringList words = normalize(text).split(' ', Qt::SkipEmptyParts);
+    for (const QString &word : words) {
+        m_pending.append(qMakePair(word, (quint32(trackId) << 2) | quint32(field)));
+    }
+}
+
+void MediaSearchIndex::build()
+{
+    std::sort(m_pending.begin(), m_pending.end());
+    m_pending.erase(std::unique(m_pending.begin(), m_pending.end()), m_pending.end());
+
+    m_tokens.clear();
+    m_postingStart.clear();
+    m_postings.clear();
+    m_postings.reserve(m_pending.size());
+
+    for (const auto &entry : std::as_const(m_pending)) {
+        if (m_tokens.isEmpty() || m_tokens.last() != entry.first) {
+            m_tokens.append(entry.first);
+            m_postingStart.append(m_postings.size());
+        }
+        m_postings.append(entry.second);
+    }
+    m_postingStart.append(m_postings.size());
+    m_pending.clear();
+    m_scratch.reset();
+    m_pending.squeeze();
+
+    m_trigrams.clear();
+    for (int id = 0; id < m_tokens.size(); ++id) {
+        const QString &token = m_tokens[id];
+        for (int i = 0; i + 3 <= token.size(); ++i) {
+            QVector<int> &ids = m_trigrams[trigramKey(token.constData() + i)];
+            if (ids.isEmpty() || ids.last() != id) {
+                ids.append(id);
+            }
+        }
+    }
+}
+
+QVector<MediaSearchIndex::Result> MediaSearchIndex::search(const QString &query, int limit) const
+{
+    QStringList terms = normalize(query).split(' ', Qt::SkipEmptyParts);
+    terms.removeDuplicates();
+    if (terms.isEmpty() || m_tracks.isEmpty()) {
+        return {};
+    }
+    if (terms.size() > kMaxTerms) {
+        terms = terms.mid(0, kMaxTerms);
+    }
+
+    QMutexLocker locker(&m_scratchMutex);
+    if (!m_scratch) {
+        m_scratch = std::make_unique<Scratch>(m_tracks.size(), m_tokens.size());
+    }
+    Scratch &scratch = *m_scratch;
+    scratch.begin();
+
+    for (int t = 0; t < terms.size(); ++t) {
+        const QString &term = terms[t];
+
+        // Prefix range in the sorted token table
+        auto it = std::lower_bound(m_tokens.cbegin(), m_tokens.cend(), term);
+        for (; it != m_tokens.cend() && it->startsWith(term); ++it) {
+            const int id = int(it - m_tokens.cbegin());
+            addTokenMatches(id, it->size() == term.size() ? Exact : Prefix, t, scratch);
+        }
+
+        if (term.size() >= 3 && term.size() <= kMaxFuzzyLength) {
+            addFuzzyMatches(term, t, scratch);
+        }
+    }
+
+    QVector<Result> results;
+    const quint8 required = quint8(terms.size());
+    for (int id : scratch.touched) {
+        if (scratch.hits[id] == required) {
+            results.append({ id, scratch.score[id] });
+        }
+    }
+
+    auto better = [this](const Result &a, const Result &b) {
+        if (a.score != b.score) {
+            return a.score > b.score;
+        }
+        if (m_tracks[a.track].listIndex != m_tracks[b.track].listIndex) {
+            return m_tracks[a.track].listIndex < m_tracks[b.track].listIndex;
+        }
+        return a.track < b.track;
+    };
+    if (results.size() > limit) {
+        std::partial_sort(results.begin(), results.begin() + limit, results.end(), better);
+        results.resize(limit);
+    } else {
+        std::sort(results.begin(), results.end(), better);
+    }
+    return results;
+}
+
+void MediaSearchIndex::addTokenMatches(int tokenId, Match match, int term, Scratch &scratch) const
+{
+    for (int p = m_postingStart[tokenId]; p < m_postingStart[tokenId + 1]; ++p) {
+        const int track = int(m_postings[p] >> 2);
+        const int weight = kMatchWeight[match] * kFieldWeight[m_postings[p] & 3];
+        scratch.touch(track);
+
+        // A term counts once per track, with its best match
+        if (scratch.lastTerm[track] != term) {
+            scratch.lastTerm[track] = term;
+            scratch.hits[track]++;
+            scratch.termBest[track] = weight;
+            scratch.score[track] += weight;
+        } else if (weight > scratch.termBest[track]) {
+            scratch.score[track] += weight - scratch.termBest[track];
+            scratch.termBest[track] = weight;
+        }
+    }
+}
+
+void MediaSearchIndex::addFuzzyMatches(const QString &term, int termIndex, Scratch &scratch) const
+{
+    const int maxDistance = term.size() >= 6 ? 2 : 1;
+    const int trigrams = term.size() - 2;
+
+    // Each edit destroys at most three trigrams; keep at least one in common
+    const int required = qMax(1, trigrams - 3 * maxDistance);
+
+    QVector<int> candidates;
+    for (int i = 0; i < trigrams; ++i) {
+        auto it = m_trigrams.constFind(trigramKey(term.constData() + i));
+        if (it == m_trigrams.constEnd()) {
+            continue;
+        }
+        for (int id : it.value()) {
+            quint8 &count = scratch.trigramHits[id];
+            if (count == 0) {
+                candidates.append(id);
+            }
+            if (count < 255) {
+                count++;
+            }
+        }
+    }
+
+    for (int id : std::as_const(candidates)) {
+        const bool enough = scratch.trigramHits[id] >= required;
+        scratch.trigramHits[id] = 0;
+
+        const QString &token = m_tokens[id];
+        if (!enough || token.startsWith(term)) {
+            continue;   // already matched as a prefix
+        }
+
+        const int distance = prefixDistance(term, token, maxDistance);
+        if (distance == 1) {
+            addTokenMatches(id, Fuzzy1, termIndex, scratch);
+        } else if (distance == 2) {
+            addTokenMatches(id, Fuzzy2, termIndex, scratch);
+        }
+    }
+}
+
+// Optimal string alignment distance between term and the closest prefix of
+// token, or maxDistance + 1 when it is larger than maxDistance
+int MediaSearchIndex::prefixDistance(const QString &term, const QString &token, int maxDistance)
+{
+    constexpr int kSize = kMaxFuzzyLength + 3;
+    const int m = term.size();
+    const int n = qMin(int(token.size()), m + maxDistance);
+    if (m >= kSize || n >= kSize) {
+        return maxDistance + 1;
+    }
+
+    int d[kSize][kSize];
+    for (int j = 0; j <= n; ++j) {
+        d[0][j] = j;
+    }
+
+    for (int i = 1; i <= m; ++i) {
+        d[i][0] = i;
+        int rowMin = d[i][0];
+        for (int j = 1; j <= n; ++j) {
+            const int cost = term[i - 1] == token[j - 1] ? 0 : 1;
+            int v = qMin(qMin(d[i - 1][j] + 1, d[i][j - 1] + 1), d[i - 1][j - 1] + cost);
+            if (i > 1 && j > 1 && term[i - 1] == token[j - 2] && term[i - 2] == token[j - 1]) {
+                v = qMin(v, d[i - 2][j - 2] + 1);
+            }
+            d[i][j] = v;
+            rowMin = qMin(rowMin, v);
+        }
+        if (rowMin > maxDistance) {
+            return maxDistance + 1;
+        }
+    }
+
+    int best = maxDistance + 1;
+    for (int j = qMax(0, m - maxDistance); j <= n; ++j) {
+        best = qMin(best, d[m][j]);
+    }
+    return best;
+}
@@ -0,0 +1,87 @@
+#ifndef MEDIA_SEARCH_INDEX_H
+#define MEDIA_SEARCH_INDEX_H
+
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <QHash>
+#include <QSharedPointer>
+#include <QMetaType>
+#include <QMutex>
+#include <memory>
+
+// Immutable search index over the tracks of one volume.
+//
+// Words of title, artist, album and file name are normalised (case folded,
+// accents stripped) and stored once in a sorted token table with compact
+// posting lists, so a prefix query is a binary search plus a linear walk.
+// Typos are handled by a trigram index over the tokens that picks candidates
+// for a bounded Damerau-Levenshtein comparison. Every query term must match;
+// results are ranked by match quality and the field that matched.
+//
+// The per-track working state of a query is kept between queries and only
+// the tracks a query touches are reset, so a keystroke costs the matches,
+// not the library size. Queries from several threads take turns on it.
+class MediaSearchIndex
+{
+public:
+    MediaSearchIndex();
+    ~MediaSearchIndex();
+
+    struct Track {
+        QString title;
+        QString artist;
+        QString album;
+        QString fileName;
+        int listIndex = -1;     // position in MP_Handler's media file list
+    };
+
+    struct Result {
+        int track;
+        int score;
+    };
+
+    void addTrack(const Track &track);
+    void build();
+
+    QVector<Result> search(const QString &query, int limit) const;
+
+    const Track &track(int id) const { return m_tracks[id]; }
+    int trackCount() const { return m_tracks.size(); }
+    int tokenCount() const { return m_tokens.size(); }
+
+    static QString normalize(const QString &text);
+
+private:
+    enum Field { Title = 0, Artist = 1, Album = 2, FileName = 3 };
+    enum Match { Exact, Prefix, Fuzzy1, Fuzzy2 };
+
+    struct Scratch;
+
+    void addField(int trackId, Field field, const QString &text);
+    void addTokenMatches(int tokenId, Match match, int term, Scratch &scratch) const;
+    void addFuzzyMatches(const QString &term, int termIndex, Scratch &scratch) const;
+    static int prefixDistance(const QString &term, const QString &token, int maxDistance);
+    static quint64 trigramKey(const QChar *c);
+
+    QVector<Track> m_tracks;
+
+    // Build input: (token, posting) pairs, dropped once build() has run
+    QVector<QPair<QString, quint32>> m_pending;
+
+    QStringList m_tokens;                   // sorted, unique
+    QVector<int> m_postingStart;            // token id -> first posting, size tokens + 1
+    QVector<quint32> m_postings;            // (track id << 2) | field
+    QHash<quint64, QVector<int>> m_trigrams; // trigram -> token ids
+
+    mutable QMutex m_scratchMutex;
+    mutable std::unique_ptr<Scratch> m_scratch; // sized on the first search
+
+    static constexpr int kMaxTerms = 8;
+    static constexpr int kMaxFuzzyLength = 32;
+};
+
+using MediaSearchIndexPtr = QSharedPointer<const MediaSearchIndex>;
+Q_DECLARE_METATYPE(MediaSearchIndexPtr)
+
+#endif // MEDIA_SEARCH_INDEX_H
@@ -0,0 +1,137 @@
+#include "media_tags.h"
+#include <QFile>
+#include <QFileInfo>
+#include <QStringDecoder>
+
+namespace {
+
+constexpr qint64 kMaxTagBytes = 256 * 1024;
+
+quint32 syncSafe(const uchar *p)
+{
+    return (quint32(p[0] & 0x7f) << 21) | (quint32(p[1] & 0x7f) << 14)
+           | (quint32(p[2] & 0x7f) << 7) | quint32(p[3] & 0x7f);
+}
+
+quint32 bigEndian(const uchar *p)
+{
+    return (quint32(p[0]) << 24) | (quint32(p[1]) << 16) | (quint32(p[2]) << 8) | quint32(p[3]);
+}
+
+QString decodeText(const QByteArray &frame)
+{
+    if (frame.isEmpty()) {
+        return QString();
+    }
+
+    const QByteArray body = frame.mid(1);
+    QString text;
+    switch (frame[0]) {
+    case 1: {   // UTF-16 with BOM
+        QStringDecoder decoder(QStringDecoder::Utf16);
+        text = decoder(body);
+        break;
+    }
+    case 2: {   // UTF-16BE
+        QStringDecoder decoder(QStringDecoder::Utf16BE);
+        text = decoder(body);
+        break;
+    }
+    case 3:
+        text = QString::fromUtf8(body);
+        break;
+    default:
+        text = QString::fromLatin1(body);
+        break;
+    }
+
+    // Multiple values are NUL separated; the first one is enough here
+    const int nul = text.indexOf(QChar(0));
+    if (nul >= 0) {
+        text.truncate(nul);
+    }
+    return text.trimmed();
+}
+
+bool readId3v2(QFile &file, MediaTags &tags)
+{
+    const QByteArray header = file.read(10);
+    if (header.size() < 10 || !header.startsWith("ID3")) {
+        return false;
+    }
+
+    const int version = header[3];
+    if (version != 3 && version != 4) {
+        return false;
+    }
+
+    const qint64 tagSize = syncSafe(reinterpret_cast<const uchar *>(header.constData()) + 6);
+    const QByteArray tag = file.read(qMin(tagSize, kMaxTagBytes));
+    const uchar *data = reinterpret_cast<const uchar *>(tag.constData());
+
+    int pos = 0;
+    while (pos + 10 <= tag.size() && data[pos] != 0) {
+        const QByteArray id = tag.mid(pos, 4);
+        const quint32 size = version == 4 ? syncSafe(data + pos + 4) : bigEndian(data + pos + 4);
+        pos += 10;
+        if (size == 0 || pos + qint64(size) > tag.size()) {
+            break;
+        }
+
+        if (id == "TIT2") {
+            tags.title = decodeText(tag.mid(pos, int(size)));
+        } else if (id == "TPE1") {
+            tags.artist = decodeText(tag.mid(pos, int(size)));
+        } else if (id == "TALB") {
+            tags.album = decodeText(tag.mid(pos, int(size)));
+        }
+        pos += int(size);
+    }
+    return true;
+}
+
+void readId3v1(QFile &file, MediaTags &tags)
+{
+    if (file.size() < 128 || !file.seek(file.size() - 128)) {
+        return;
+    }
+
+    const QByteArray tag = file.read(128);
+    if (!tag.startsWith("TAG")) {
+        return;
+    }
+
+    auto field = [&tag](int offset) {
+        return QString::fromLatin1(tag.mid(offset, 30).constData()).trimmed();
+    };
+    if (tags.title.isEmpty()) {
+        tags.title = field(3);
+    }
+    if (tags.artist.isEmpty()) {
+        tags.artist = field(33);
+    }
+    if (tags.album.isEmpty()) {
+        tags.album = field(63);
+    }
+}
+
+} // namespace
+
+MediaTags MediaTags::read(const QString &filePath)
+{
+    MediaTags tags;
+
+    QFile file(filePath);
+    if (file.open(QIODevice::ReadOnly)) {
+        readId3v2(file, tags);
+        if (filePath.endsWith(".mp3", Qt::CaseInsensitive)
+            && (tags.title.isEmpty() || tags.artist.isEmpty())) {
+            readId3v1(file, tags);
+        }
+    }
+
+    if (tags.title.isEmpty()) {
+        tags.title = QFileInfo(filePath).completeBaseName();
+    }
+    return tags;
+}
@@ -0,0 +1,19 @@
+#ifndef MEDIA_TAGS_H
+#define MEDIA_TAGS_H
+
+#include <QString>
+
+// Title/artist/album of a media file.
+//
+// Only ID3v2.3/2.4 and ID3v1 are understood; that covers the MP3s that make
+// up nearly all USB libraries. Anything else falls back to the file name.
+struct MediaTags
+{
+    QString title;
+    QString artist;
+    QString album;
+
+    static MediaTags read(const QString &filePath);
+};
+
+#endif // MEDIA_TAGS_H
@@ -1,4 +1,10 @@
 #include "mp_handler.h"
+#include "audio_engine.h"
+#include "bookmark_store.h"
+#include "media_indexer.h"
+#include "usb_monitor.h"
+#include "search_result_model.h"
+#include "playlist_model.h"
 #include <QDBusReply>
 #include <QDebug>
 #include <QFileInfo>
@@ -16,12 +22,62 @@ MP_Handler::MP_Handler(QObject *parent)
     , m_currentTrack("No Track Playing")
     , m_currentArtist("Unknown Artist")
     , m_serviceInterface(nullptr)
+    , m_audioFocus(nullptr)
+    , m_duckGain(1.0)
+    , m_duckLatencyUs(0)
+    , m_resumeOnFocusGain(false)
+    , m_engine(nullptr)
+    , m_engineActive(false)
+    , m_bookmarks(nullptr)
+    , m_resumePositionMs(0)
+    , m_usbMonitor(nullptr)
+    , m_indexer(nullptr)
+    , m_nativeUsb(false)
+    , m_usbListLatencyMs(-1)
+    , m_playlist(nullptr)
+    , m_searchResults(nullptr)
+    , m_lastSearchUs(0)
 {
     m_positionPollTimer = new QTimer(this);
     m_positionPollTimer->setInterval(500);
     connect(m_positionPollTimer, &QTimer::timeout, this, &MP_Handler::pollPosition);
 
+    m_audioFocus = new AudioFocusClient("MediaPlayer", "media", this);
+    connect(m_audioFocus, &AudioFocusClient::focusStateChanged, this, &MP_Handler::audioFocusChanged);
+    connect(m_audioFocus, &AudioFocusClient::focusGained, this, &MP_Handler::handleFocusGained);
+    connect(m_audioFocus, &AudioFocusClient::focusLost, this, &MP_Handler::handleFocusLost);
+    connect(m_audioFocus, &AudioFocusClient::duckRequested, this, &MP_Handler::handleDuckRequested);
+
+    m_bookmarks = new BookmarkStore(this);
+
+    m_engine = new AudioEngine(&m_gainRamp, this);
+    connect(m_engine, &AudioEngine::stateChanged, this, &MP_Handler::handleServicePlaybackStateChanged);
+    connect(m_engine, &AudioEngine::positionChanged, this, &MP_Handler::handleServicePositionChanged);
+    connect(m_engine, &AudioEngine::durationChanged, this, &MP_Handler::handleServiceDurationChanged);
+    connect(m_engine, &AudioEngine::errorOccurred, this, &MP_Handler::handleEngineError);
+    connect(m_engine, &AudioEngine::trackFinished, this, &MP_Handler::next);
+
+    m_indexer = new MediaIndexer(this);
+    connect(m_indexer, &MediaIndexer::filesFound, this, &MP_Handler::handleIndexedFiles);
+    connect(m_indexer, &MediaIndexer::searchIndexReady, this, &MP_Handler::handleSearchIndexReady);
+
+    m_playlist = new PlaylistModel(this);
+    m_searchResults = new SearchResultModel(this);
+
+    m_usbMonitor = new UsbMonitor(this);
+    m_nativeUsb = m_usbMonitor->isAvailable();
+    connect(m_usbMonitor, &UsbMonitor::deviceInserted, this, &MP_Handler::handleNativeUsbInserted);
+    connect(m_usbMonitor, &UsbMonitor::deviceRemoved, this, &MP_Handler::handleNativeUsbRemoved);
+
     setupDBusConnection();
+
+    if (m_nativeUsb) {
+        m_usbDevices = m_usbMonitor->mountedDevices();
+        emit usbDevicesChanged();
+        if (!m_usbDevices.isEmpty()) {
+            selectNativeDevice(m_usbDevices.first());
+        }
+    }
 }
 
 MP_Handler::~MP_Handler()
@@ -140,7 +196,7 @@ void MP_Handler::setupDBusConnection()
 
 void MP_Handler::syncUsbDataFromService()
 {
-    if (!m_serviceConnected || !m_serviceInterface) {
+    if (m_nativeUsb || !m_serviceConnected || !m_serviceInterface) {
         return;
     }
 
@@ -164,6 +220,98 @@ void MP_Handler::syncUsbDataFromService()
         buildPlaylist();
         qDebug() << "Synced media files:" << m_mediaFiles.count() << "files";
     }
+
+    fetchMediaFilePaths();
+}
+
+void MP_Handler::fetchMediaFilePaths()
+{
+    m_mediaFilePaths.clear();
+    m_searchIndex.reset();
+    runSearch();
+
+    if (!m_serviceConnected || !m_serviceInterface) {
+        return;
+    }
+
+    // Absolute paths let the native engine read the files straight off the volume
+    QDBusReply<QStringList> pathsReply = m_serviceInterface->call("GetMediaFilePaths");
+    if (pathsReply.isValid() && pathsReply.value().count() == m_mediaFiles.count()) {
+        m_mediaFilePaths = pathsReply.value();
+        m_indexer->buildSearchIndex(m_currentDevice, m_mediaFilePaths);
+    } else if (!pathsReply.isValid()) {
+        qDebug() << "Service has no GetMediaFilePaths, using service playback";
+    }
+
+    if (m_currentTrackIndex < 0) {
+        restoreLastTrack();
+    }
+}
+
+QString MP_Handler::currentFilePath() const
+{
+    if (m_currentTrackIndex >= 0 && m_currentTrackIndex < m_mediaFilePaths.count()) {
+        return m_mediaFilePaths[m_currentTrackIndex];
+    }
+    return QString();
+}
+
+void MP_Handler::saveBookmark()
+{
+    // Stop and track changes report 0 before the new track starts; finished
+    // tracks are cleared by the store once they get close to the end
+    if (m_position <= 0) {
+        return;
+    }
+    m_bookmarks->setPosition(currentFilePath(), m_position, m_duration);
+}
+
+void MP_Handler::restoreLastTrack()
+{
+    if (m_mediaFilePaths.isEmpty()) {
+        return;
+    }
+
+    const int index = m_mediaFilePaths.indexOf(m_bookmarks->lastTrack(m_mediaFilePaths.first()));
+    if (index < 0) {
+        return;
+    }
+
+    // Cue the track at its bookmark without starting playback
+    m_currentTrackIndex = index;
+    emit currentMediaIndexChanged();
+    loadTrack(index);
+    updateTrackInfo();
+
+    qDebug() << "Restored last track:" << m_mediaFiles.value(index) << "at" << m_resumePositionMs << "ms";
+}
+
+void MP_Handler::loadTrack(int index)
+{
+    const QString path = currentFilePath();
+    m_resumePositionMs = m_bookmarks->position(path);
+    m_bookmarks->setLastTrack(path);
+
+    // A resume point inside a container needs the service's seek
+    const bool engineCanResume = m_resumePositionMs <= 0 || AudioEngine::canSeek(path);
+    if (m_sourceType == "usb" && !path.isEmpty() && engineCanResume && m_engine->load(path)) {
+        // The service keeps VLC idle while the native engine owns the file
+        if (!m_engineActive) {
+            callService("Stop");
+        }
+        setEngineActive(true);
+        if (m_resumePositionMs > 0) {
+            m_engine->seek(m_resumePositionMs);
+            m_resumePositionMs = 0;
+        }
+    } else if (!path.isEmpty()) {
+        // Natively indexed lists need not match the service's own file order
+        setEngineActive(false);
+        callService("SetSource", {path, m_sourceType});
+    } else {
+        setEngineActive(false);
+        callService("SelectMediaFile", {index});
+    }
 }
 
 void MP_Handler::callService(const QString &method, const QVariantList &args)
@@ -196,28 +344,23 @@ QStringList MP_Handler::mediaFileList() const { return m_mediaFiles; }
 QString MP_Handler::currentDevice() const { return m_currentDevice; }
 int MP_Handler::currentMediaIndex() const { return m_currentTrackIndex; }
 QString MP_Handler::currentFileName() const { return m_currentFileName; }
+QString MP_Handler::audioFocus() const { return m_audioFocus ? m_audioFocus->focusState() : QString(); }
+double MP_Handler::duckGain() const { return m_duckGain; }
+qint64 MP_Handler::duckLatencyUs() const { return m_duckLatencyUs; }
 
-QVariantList MP_Handler::playlist() const
-{
-    QVariantList list;
-    for (int i = 0; i < m_mediaFiles.count(); ++i) {
-        QVariantMap track;
-        QFileInfo fileInfo(m_mediaFiles[i]);
-        QString fileName = fileInfo.completeBaseName(); // Remove extension
+qint64 MP_Handler::usbListLatencyMs() const { return m_usbListLatencyMs; }
 
-        track["title"] = fileName;
-        track["artist"] = "Unknown Artist";
-        track["duration"] = "0:00";
-        track["isPlaying"] = (i == m_currentTrackIndex && m_isPlaying);
+QObject *MP_Handler::searchResults() const { return m_searchResults; }
 
-        list.append(track);
-    }
-    return list;
-}
+QString MP_Handler::searchQuery() const { return m_searchQuery; }
+
+qint64 MP_Handler::lastSearchUs() const { return m_lastSearchUs; }
+
+QObject *MP_Handler::playlist() const { return m_playlist; }
 
 void MP_Handler::buildPlaylist()
 {
-    emit playlistChanged();
+    m_playlist->setFiles(m_mediaFiles);
 }
 
 void MP_Handler::updateTrackInfo()
@@ -248,6 +391,7 @@ void MP_Handler::setSource(const QString &src)
         m_currentFileName = fileInfo.fileName();
         emit currentFileNameChanged();
 
+        setEngineActive(false);
         callService("SetSource", {src, m_sourceType});
 
         m_position = 0;
@@ -278,7 +422,7 @@ void MP_Handler::setVolume(int vol)
     if (m_volume != vol) {
         m_volume = vol;
         emit volumeChanged();
-        callService("SetVolume", {vol});
+        applyOutputGain();
         qDebug() << "Volume changed to:" << vol;
     }
 }
@@ -301,22 +445,26 @@ void MP_Handler::updateState(const QString &state)
 
 void MP_Handler::play()
 {
-    callService("Play");
-    m_positionPollTimer->start();
+    m_resumeOnFocusGain = false;
+    if (!m_audioFocus->hasFocus()) {
+        m_audioFocus->requestFocus("gain");
+    }
+    transportPlay();
     qDebug() << "Play command sent";
 }
 
 void MP_Handler::pause()
 {
-    callService("Pause");
-    m_positionPollTimer->stop();
+    transportPause();
+    saveBookmark();
     qDebug() << "Pause command sent";
 }
 
 void MP_Handler::stop()
 {
-    callService("Stop");
-    m_positionPollTimer->stop();
+    transportStop();
+    m_resumeOnFocusGain = false;
+    m_audioFocus->abandonFocus();
     m_position = 0;
     emit currentPositionChanged();
     qDebug() << "Stop command sent";
@@ -366,7 +514,18 @@ void MP_Handler::previous()
 void MP_Handler::seek(qint64 position)
 {
     if (position >= 0 && position <= m_duration) {
-        callService("Seek", {position});
+        if (m_engineActive && !m_engine->seek(position)) {
+            // The engine cannot enter this file mid-stream; VLC can
+            const bool wasPlaying = m_isPlaying;
+            setEngineActive(false);
+            callService("SetSource", {currentFilePath(), m_sourceType});
+            m_resumePositionMs = position;
+            if (wasPlaying) {
+                transportPlay();
+            }
+        } else if (!m_engineActive) {
+            callService("Seek", {position});
+        }
         m_position = position;
         emit currentPositionChanged();
         qDebug() << "Seek to position:" << position;
@@ -375,6 +534,10 @@ void MP_Handler::seek(qint64 position)
 
 void MP_Handler::selectUsbDevice(const QString &devicePath)
 {
+    if (m_nativeUsb) {
+        selectNativeDevice(devicePath);
+        return;
+    }
     callService("SelectUsbDevice", {devicePath});
     m_currentTrackIndex = -1;
     emit currentMediaIndexChanged();
@@ -388,11 +551,12 @@ void MP_Handler::selectMediaFile(int index)
         return;
     }
 
+    saveBookmark();
+
     m_currentTrackIndex = index;
     emit currentMediaIndexChanged();
-    emit playlistChanged();
 
-    callService("SelectMediaFile", {index});
+    loadTrack(index);
 
     updateTrackInfo();
 
@@ -409,12 +573,25 @@ void MP_Handler::playTrack(int index)
 
 void MP_Handler::refreshUsbDevices()
 {
+    if (m_nativeUsb) {
+        m_usbDevices = m_usbMonitor->mountedDevices();
+        emit usbDevicesChanged();
+        return;
+    }
     callService("RefreshUsbDevices");
     qDebug() << "Refreshing USB devices";
 }
 
 void MP_Handler::refreshMediaFiles()
 {
+    if (m_nativeUsb) {
+        // The native list is event driven; only rescan a volume that came up empty
+        if (!m_currentDevice.isEmpty() && m_mediaFiles.isEmpty() && !m_indexer->isScanning()) {
+            selectNativeDevice(m_currentDevice);
+        }
+        return;
+    }
+
     // Request media files refresh from service
     syncUsbDataFromService();
     qDebug() << "Refreshing media files";
@@ -429,7 +606,9 @@ void MP_Handler::handleServicePlaybackStateChanged(const QString &state)
 
     if (state == "Playing") {
         m_isPlaying = true;
-        m_positionPollTimer->start();
+        if (!m_engineActive) {
+            m_positionPollTimer->start();
+        }
     } else {
         m_isPlaying = false;
         if (state == "Stopped") {
@@ -439,7 +618,6 @@ void MP_Handler::handleServicePlaybackStateChanged(const QString &state)
 
     if (wasPlaying != m_isPlaying) {
         emit isPlayingChanged();
-        emit playlistChanged(); // Update playlist to show playing state
     }
 }
 
@@ -447,6 +625,7 @@ void MP_Handler::handleServicePositionChanged(qint64 pos)
 {
     m_position = pos;
     emit currentPositionChanged();
+    saveBookmark();
 }
 
 void MP_Handler::handleServiceDurationChanged(qint64 dur)
@@ -458,6 +637,10 @@ void MP_Handler::handleServiceDurationChanged(qint64 dur)
 
 void MP_Handler::handleUsbDevicesChanged(const QStringList &devices)
 {
+    if (m_nativeUsb) {
+        return;
+    }
+
     m_usbDevices = devices;
     emit usbDevicesChanged();
     qDebug() << "USB devices updated:" << devices;
@@ -465,8 +648,14 @@ void MP_Handler::handleUsbDevicesChanged(const QStringList &devices)
 
 void MP_Handler::handleMediaFilesChanged(const QStringList &files)
 {
+    if (m_nativeUsb) {
+        return;
+    }
+
+    saveBookmark();
     m_mediaFiles = files;
     m_currentTrackIndex = -1;
+    fetchMediaFilePaths();
     emit mediaFileListChanged();
     emit currentMediaIndexChanged();
     buildPlaylist();
@@ -475,6 +664,10 @@ void MP_Handler::handleMediaFilesChanged(const QStringList &files)
 
 void MP_Handler::handleCurrentDeviceChanged(const QString &device)
 {
+    if (m_nativeUsb) {
+        return;
+    }
+
     m_currentDevice = device;
     emit currentDeviceChanged();
     qDebug() << "Current device changed:" << device;
@@ -482,6 +675,10 @@ void MP_Handler::handleCurrentDeviceChanged(const QString &device)
 
 void MP_Handler::handleUsbInserted(const QString &devicePath)
 {
+    if (m_nativeUsb) {
+        return;
+    }
+
     qDebug() << "USB device inserted:" << devicePath;
     emit usbDeviceInserted(devicePath);
     setSourceType("usb");
@@ -489,7 +686,12 @@ void MP_Handler::handleUsbInserted(const QString &devicePath)
 
 void MP_Handler::handleUsbRemoved(const QString &devicePath)
 {
+    if (m_nativeUsb) {
+        return;
+    }
+
     qDebug() << "USB device removed:" << devicePath;
+    m_bookmarks->forgetMount(devicePath);
     emit usbDeviceRemoved(devicePath);
 }
 
@@ -500,6 +702,274 @@ void MP_Handler::pollPosition()
         if (reply.isValid()) {
             m_position = reply.value();
             emit currentPositionChanged();
+            saveBookmark();
         }
     }
 }
+
+void MP_Handler::handleFocusGained(int rampMs, qint64 originNs)
+{
+    setDuckGain(1.0, rampMs, originNs);
+
+    if (m_resumeOnFocusGain) {
+        m_resumeOnFocusGain = false;
+        qDebug() << "Audio focus regained - resuming playback";
+        transportPlay();
+    }
+}
+
+void MP_Handler::handleFocusLost(bool transient)
+{
+    if (!m_isPlaying) {
+        return;
+    }
+
+    qDebug() << "Audio focus lost" << (transient ? "(transient)" : "(permanent)") << "- pausing";
+    m_resumeOnFocusGain = transient;
+    transportPause();
+}
+
+void MP_Handler::handleDuckRequested(double gain, int rampMs, qint64 originNs)
+{
+    setDuckGain(gain, rampMs, originNs);
+}
+
+void MP_Handler::setDuckGain(double gain, int rampMs, qint64 originNs)
+{
+    m_gainRamp.rampTo(static_cast<float>(gain), rampMs, originNs);
+
+    if (originNs > 0 && m_engineActive && m_isPlaying) {
+        // The audio thread stamps the first ramped sample; pick it up after a period
+        QTimer::singleShot(50, this, [this]() {
+            const qint64 latencyNs = m_gainRamp.lastLatencyNs();
+            if (latencyNs > 0) {
+                m_duckLatencyUs = latencyNs / 1000;
+                emit duckLatencyUsChanged();
+                qDebug() << "Duck reached the output" << m_duckLatencyUs << "us after request";
+            }
+        });
+    } else if (originNs > 0) {
+        m_duckLatencyUs = (GainRamp::nowNs() - originNs) / 1000;
+        emit duckLatencyUsChanged();
+        qDebug() << "Duck" << gain << "applied" << m_duckLatencyUs << "us after request, ramp" << rampMs << "ms";
+    }
+
+    if (!qFuzzyCompare(m_duckGain, gain)) {
+        m_duckGain = gain;
+        emit duckGainChanged();
+        applyOutputGain();
+    }
+}
+
+void MP_Handler::applyOutputGain()
+{
+    if (m_engineActive) {
+        // Ducking is applied per sample by the gain ramp on the native path
+        m_engine->setVolume(m_volume);
+        return;
+    }
+
+    // The VLC service has no PCM hook, so it only gets the ducked target level
+    callService("SetVolume", {qRound(m_volume * m_duckGain)});
+}
+
+void MP_Handler::handleEngineError(const QString &message)
+{
+    qWarning() << "Native playback error:" << message;
+    emit mediaError(message);
+}
+
+void MP_Handler::setEngineActive(bool active)
+{
+    if (m_engineActive == active) {
+        return;
+    }
+
+    if (!active) {
+        m_engine->stop();
+    }
+    m_engineActive = active;
+    m_positionPollTimer->stop();
+    applyOutputGain();
+    qDebug() << "Playback path:" << (active ? "native engine" : "MediaPlayer service");
+}
+
+void MP_Handler::selectNativeDevice(const QString &mountPoint)
+{
+    saveBookmark();
+    if (m_engineActive) {
+        m_engine->stop();
+    }
+
+    m_currentDevice = mountPoint;
+    m_mediaFiles.clear();
+    m_mediaFilePaths.clear();
+    m_currentTrackIndex = -1;
+    emit currentDeviceChanged();
+    emit mediaFileListChanged();
+    emit currentMediaIndexChanged();
+    buildPlaylist();
+
+    m_searchIndex.reset();
+    runSearch();
+    m_listUpdateTimer.invalidate();
+
+    m_indexer->index(mountPoint);
+    qDebug() << "Indexing USB device:" << mountPoint;
+}
+
+void MP_Handler::handleNativeUsbInserted(const QString &mountPoint)
+{
+    qDebug() << "USB device inserted:" << mountPoint;
+    if (!m_usbDevices.contains(mountPoint)) {
+        m_usbDevices.append(mountPoint);
+        emit usbDevicesChanged();
+    }
+    emit usbDeviceInserted(mountPoint);
+    setSourceType("usb");
+
+    if (m_currentDevice.isEmpty()) {
+        selectNativeDevice(mountPoint);
+    }
+}
+
+void MP_Handler::handleNativeUsbRemoved(const QString &mountPoint)
+{
+    qDebug() << "USB device removed:" << mountPoint;
+    m_bookmarks->forgetMount(mountPoint);
+    m_usbDevices.removeAll(mountPoint);
+    emit usbDevicesChanged();
+    emit usbDeviceRemoved(mountPoint);
+
+    if (mountPoint != m_currentDevice) {
+        return;
+    }
+
+    // Files are gone; drop the native path without touching them again
+    m_indexer->cancel();
+    setEngineActive(false);
+    m_currentDevice.clear();
+    m_mediaFiles.clear();
+    m_mediaFilePaths.clear();
+    m_currentTrackIndex = -1;
+    emit currentDeviceChanged();
+    emit mediaFileListChanged();
+    emit currentMediaIndexChanged();
+    buildPlaylist();
+    updateTrackInfo();
+    m_searchIndex.reset();
+    runSearch();
+
+    if (!m_usbDevices.isEmpty()) {
+        selectNativeDevice(m_usbDevices.first());
+    }
+}
+
+void MP_Handler::handleIndexedFiles(const QString &rootPath, const QStringList &names,
+                                    const QStringList &paths, bool finished)
+{
+    if (rootPath != m_currentDevice) {
+        return;
+    }
+
+    if (m_mediaFiles.isEmpty() && !names.isEmpty()) {
+        m_usbListLatencyMs = m_usbMonitor->elapsedSinceInsert(rootPath);
+        emit usbListLatencyMsChanged();
+        qDebug() << "First track listed" << m_usbListLatencyMs << "ms after USB insert";
+    }
+
+    m_mediaFiles.append(names);
+    m_mediaFilePaths.append(paths);
+
+    // Large libraries arrive in many batches; refresh the view a few times a
+    // second rather than per batch
+    const bool refresh = finished || !m_listUpdateTimer.isValid() || m_listUpdateTimer.elapsed() >= 500;
+    if (!refresh) {
+        return;
+    }
+    m_listUpdateTimer.start();
+
+    emit mediaFileListChanged();
+    buildPlaylist();
+
+    if (m_currentTrackIndex < 0) {
+        restoreLastTrack();
+    }
+
+    if (finished) {
+        qDebug() << "Indexed media files:" << m_mediaFiles.count() << "files";
+    }
+}
+
+void MP_Handler::handleSearchIndexReady(const QString &rootPath, const MediaSearchIndexPtr &index)
+{
+    if (rootPath != m_currentDevice) {
+        return;
+    }
+
+    m_searchIndex = index;
+    runSearch();
+}
+
+void MP_Handler::search(const QString &query)
+{
+    if (m_searchQuery == query) {
+        return;
+    }
+    m_searchQuery = query;
+    emit searchQueryChanged();
+    runSearch();
+}
+
+void MP_Handler::runSearch()
+{
+    if (!m_searchIndex || m_searchQuery.trimmed().isEmpty()) {
+        m_searchResults->clear();
+        return;
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+    const QVector<MediaSearchIndex::Result> results = m_searchIndex->search(m_searchQuery, 100);
+    m_lastSearchUs = timer.nsecsElapsed() / 1000;
+    emit lastSearchUsChanged();
+
+    m_searchResults->setResults(m_searchIndex, results);
+    qDebug() << "Search" << m_searchQuery << ":" << results.size() << "results in" << m_lastSearchUs << "us over"
+             << m_searchIndex->trackCount() << "tracks";
+}
+
+void MP_Handler::transportPlay()
+{
+    if (m_engineActive) {
+        m_engine->play();
+        return;
+    }
+    callService("Play");
+    if (m_resumePositionMs > 0) {
+        // VLC only seeks once the media is playing
+        callService("Seek", {m_resumePositionMs});
+        m_resumePositionMs = 0;
+    }
+    m_positionPollTimer->start();
+}
+
+void MP_Handler::transportPause()
+{
+    if (m_engineActive) {
+        m_engine->pause();
+        return;
+    }
+    callService("Pause");
+    m_positionPollTimer->stop();
+}
+
+void MP_Handler::transportStop()
+{
+    if (m_engineActive) {
+        m_engine->stop();
+        return;
+    }
+    callService("Stop");
+    m_positionPollTimer->stop();
+}
@@ -9,6 +9,17 @@
 #include <QtDBus/QDBusInterface>
 #include <QtDBus/QDBusMessage>
 #include <QTimer>
+#include <QElapsedTimer>
+#include "audio_focus_client.h"
+#include "gain_ramp.h"
+#include "media_search_index.h"
+
+class AudioEngine;
+class BookmarkStore;
+class UsbMonitor;
+class MediaIndexer;
+class SearchResultModel;
+class PlaylistModel;
 
 class MP_Handler : public QObject
 {
@@ -31,10 +42,21 @@ class MP_Handler : public QObject
     Q_PROPERTY(QStringList mediaFileList READ mediaFileList NOTIFY mediaFileListChanged)
     Q_PROPERTY(QString currentDevice READ currentDevice NOTIFY currentDeviceChanged)
     Q_PROPERTY(int currentMediaIndex READ currentMediaIndex NOTIFY currentMediaIndexChanged)
+    Q_PROPERTY(qint64 usbListLatencyMs READ usbListLatencyMs NOTIFY usbListLatencyMsChanged)
+
+    // Library search
+    Q_PROPERTY(QObject *searchResults READ searchResults CONSTANT)
+    Q_PROPERTY(QString searchQuery READ searchQuery NOTIFY searchQueryChanged)
+    Q_PROPERTY(qint64 lastSearchUs READ lastSearchUs NOTIFY lastSearchUsChanged)
     Q_PROPERTY(QString currentFileName READ currentFileName NOTIFY currentFileNameChanged)
 
     // Playlist-related properties
-    Q_PROPERTY(QVariantList playlist READ playlist NOTIFY playlistChanged)
+    Q_PROPERTY(QObject *playlist READ playlist CONSTANT)
+
+    // Audio focus properties
+    Q_PROPERTY(QString audioFocus READ audioFocus NOTIFY audioFocusChanged)
+    Q_PROPERTY(double duckGain READ duckGain NOTIFY duckGainChanged)
+    Q_PROPERTY(qint64 duckLatencyUs READ duckLatencyUs NOTIFY duckLatencyUsChanged)
 
 public:
     explicit MP_Handler(QObject *parent = nullptr);
@@ -66,10 +88,21 @@ public:
     QStringList mediaFileList() const;
     QString currentDevice() const;
     int currentMediaIndex() const;
+    qint64 usbListLatencyMs() const;
+
+    // Search
+    QObject *searchResults() const;
+    QString searchQuery() const;
+    qint64 lastSearchUs() const;
     QString currentFileName() const;
 
     // Playlist
-    QVariantList playlist() const;
+    QObject *playlist() const;
+
+    // Audio focus
+    QString audioFocus() const;
+    double duckGain() const;
+    qint64 duckLatencyUs() const;
 
     Q_INVOKABLE void play();
     Q_INVOKABLE void pause();
@@ -88,6 +121,9 @@ public:
     Q_INVOKABLE void refreshMediaFiles();
     Q_INVOKABLE void playTrack(int index);
 
+    // Search methods
+    Q_INVOKABLE void search(const QString &query);
+
 signals:
     void sourceChanged();
     void sourceTypeChanged();
@@ -108,10 +144,17 @@ signals:
     void mediaFileListChanged();
     void currentDeviceChanged();
     void currentMediaIndexChanged();
+    void usbListLatencyMsChanged();
+    void searchQueryChanged();
+    void lastSearchUsChanged();
     void currentFileNameChanged();
     void usbDeviceInserted(const QString &devicePath);
     void usbDeviceRemoved(const QString &devicePath);
-    void playlistChanged();
+
+    // Audio focus signals
+    void audioFocusChanged();
+    void duckGainChanged();
+    void duckLatencyUsChanged();
 
 private slots:
     void handleServicePlaybackStateChanged(const QString &state);
@@ -123,6 +166,15 @@ private slots:
     void handleUsbInserted(const QString &devicePath);
     void handleUsbRemoved(const QString &devicePath);
     void pollPosition();
+    void handleFocusGained(int rampMs, qint64 originNs);
+    void handleFocusLost(bool transient);
+    void handleDuckRequested(double gain, int rampMs, qint64 originNs);
+    void handleEngineError(const QString &message);
+    void handleNativeUsbInserted(const QString &mountPoint);
+    void handleNativeUsbRemoved(const QString &mountPoint);
+    void handleIndexedFiles(const QString &rootPath, const QStringList &names,
+                            const QStringList &paths, bool finished);
+    void handleSearchIndexReady(const QString &rootPath, const MediaSearchIndexPtr &index);
 
 private:
     QString m_source;
@@ -146,12 +198,53 @@ private:
     QDBusInterface *m_serviceInterface;
     QTimer *m_positionPollTimer;
 
+    AudioFocusClient *m_audioFocus;
+    GainRamp m_gainRamp;
+    double m_duckGain;
+    qint64 m_duckLatencyUs;
+    bool m_resumeOnFocusGain;
+
+    // Native playback for files on mounted USB volumes
+    AudioEngine *m_engine;
+    QStringList m_mediaFilePaths;
+    bool m_engineActive;
+
+    BookmarkStore *m_bookmarks;
+    qint64 m_resumePositionMs;
+
+    // Native hotplug; the service's USB signals are ignored while it is active
+    UsbMonitor *m_usbMonitor;
+    MediaIndexer *m_indexer;
+    bool m_nativeUsb;
+    qint64 m_usbListLatencyMs;
+    QElapsedTimer m_listUpdateTimer;
+
+    PlaylistModel *m_playlist;
+
+    MediaSearchIndexPtr m_searchIndex;
+    SearchResultModel *m_searchResults;
+    QString m_searchQuery;
+    qint64 m_lastSearchUs;
+
     void setupDBusConnection();
     void callService(const QString &method, const QVariantList &args = QVariantList());
     void updateState(const QString &state);
     void syncUsbDataFromService();
     void updateTrackInfo();
     void buildPlaylist();
+    void setDuckGain(double gain, int rampMs, qint64 originNs);
+    void applyOutputGain();
+    void fetchMediaFilePaths();
+    void setEngineActive(bool active);
+    void transportPlay();
+    void transportPause();
+    void transportStop();
+    QString currentFilePath() const;
+    void saveBookmark();
+    void restoreLastTrack();
+    void loadTrack(int index);
+    void selectNativeDevice(const QString &mountPoint);
+    void runSearch();
 };
 
 #endif // MP_HANDLER_H
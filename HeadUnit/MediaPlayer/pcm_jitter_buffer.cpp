@@ -0,0 +1,94 @@
+#include "pcm_jitter_buffer.h"
+#include <cstring>
+
+PcmJitterBuffer::PcmJitterBuffer(qint64 capacityBytes)
+    : m_written(0)
+    , m_read(0)
+    , m_discardTo(0)
+    , m_underruns(0)
+{
+    setCapacity(capacityBytes);
+}
+
+void PcmJitterBuffer::setCapacity(qint64 capacityBytes)
+{
+    m_ring = QByteArray(static_cast<int>(qMax<qint64>(0, capacityBytes)), '\0');
+    m_written.store(0, std::memory_order_relaxed);
+    m_read.store(0, std::memory_order_relaxed);
+    m_discardTo.store(0, std::memory_order_relaxed);
+}
+
+void PcmJitterBuffer::clear()
+{
+    // The consumer may still be copying from the old bytes, so their space
+    // is only reused once it has moved past them
+    m_discardTo.store(m_written.load(std::memory_order_relaxed), std::memory_order_release);
+}
+
+qint64 PcmJitterBuffer::write(const char *data, qint64 len)
+{
+    const qint64 size = m_ring.size();
+    const quint64 written = m_written.load(std::memory_order_relaxed);
+    const qint64 n = qMin(len, freeSpace());
+    if (n <= 0) {
+        return 0;
+    }
+
+    const qint64 writePos = static_cast<qint64>(written % static_cast<quint64>(size));
+    const qint64 first = qMin(n, size - writePos);
+    char *ring = m_ring.data();
+    std::memcpy(ring + writePos, data, static_cast<size_t>(first));
+    if (n > first) {
+        std::memcpy(ring, data + first, static_cast<size_t>(n - first));
+    }
+
+    m_written.store(written + static_cast<quint64>(n), std::memory_order_release);
+    return n;
+}
+
+qint64 PcmJitterBuffer::read(char *data, qint64 len, bool fillSilence)
+{
+    const qint64 size = m_ring.size();
+
+    // discardTo first: it is never ahead of the written count seen after it
+    quint64 readPos = m_read.load(std::memory_order_relaxed);
+    readPos = qMax(readPos, m_discardTo.load(std::memory_order_acquire));
+    const quint64 written = m_written.load(std::memory_order_acquire);
+    const quint64 available = written > readPos ? written - readPos : 0;
+    const qint64 n = qMin(len, static_cast<qint64>(available));
+
+    if (n > 0) {
+        const qint64 ringPos = static_cast<qint64>(readPos % static_cast<quint64>(size));
+        const qint64 first = qMin(n, size - ringPos);
+        const char *ring = m_ring.constData();
+        std::memcpy(data, ring + ringPos, static_cast<size_t>(first));
+        if (n > first) {
+            std::memcpy(data + first, ring, static_cast<size_t>(n - first));
+        }
+    }
+    m_read.store(readPos + static_cast<quint64>(n), std::memory_order_release);
+
+    if (n < len && fillSilence) {
+        std::memset(data + n, 0, static_cast<size_t>(len - n));
+        m_underruns.fetch_add(1, std::memory_order_relaxed);
+        return len;
+    }
+    return n;
+}
+
+qint64 PcmJitterBuffer::fillLevel() const
+{
+    const quint64 readPos = qMax(m_read.load(std::memory_order_acquire),
+                                 m_discardTo.load(std::memory_order_acquire));
+    const quint64 written = m_written.load(std::memory_order_acquire);
+    return written > readPos ? static_cast<qint64>(written - readPos) : 0;
+}
+
+qint64 PcmJitterBuffer::freeSpace() const
+{
+    // Against the consumer's own count: bytes it skips after a clear() are
+    // not free until it has actually moved past them
+    const quint64 written = m_written.load(std::memory_order_relaxed);
+    const quint64 read = m_read.load(std::memory_order_acquire);
+    return m_ring.size() - static_cast<qint64>(written - read);
+}
@@ -0,0 +1,44 @@
+#ifndef PCM_JITTER_BUFFER_H
+#define PCM_JITTER_BUFFER_H
+
+#include <QByteArray>
+#include <atomic>
+
+// Small ring of decoded PCM between the decoder and the audio sink.
+//
+// Single producer (the decoder, GUI thread), single consumer (the sink's
+// audio thread), no locks: each side owns one running byte count and only
+// reads the other's, so the audio thread never waits for the GUI thread. A
+// short read while the stream is still running is an underrun: the gap is
+// filled with silence and counted.
+class PcmJitterBuffer
+{
+public:
+    explicit PcmJitterBuffer(qint64 capacityBytes = 0);
+
+    // Only while the consumer is not running
+    void setCapacity(qint64 capacityBytes);
+    // Producer side: drops what is buffered; the consumer skips it on its
+    // next read
+    void clear();
+
+    // Producer side
+    qint64 write(const char *data, qint64 len);
+    qint64 freeSpace() const;
+    // Consumer side
+    qint64 read(char *data, qint64 len, bool fillSilence);
+
+    qint64 capacity() const { return m_ring.size(); }
+    qint64 fillLevel() const;
+    int underrunCount() const { return m_underruns.load(std::memory_order_relaxed); }
+    void resetUnderruns() { m_underruns.store(0, std::memory_order_relaxed); }
+
+private:
+    QByteArray m_ring;
+    std::atomic<quint64> m_written;     // bytes ever written, producer owned
+    std::atomic<quint64> m_read;        // bytes ever read, consumer owned
+    std::atomic<quint64> m_discardTo;   // set by clear(), read skips up to it
+    std::atomic<int> m_underruns;
+};
+
+#endif // PCM_JITTER_BUFFER_H
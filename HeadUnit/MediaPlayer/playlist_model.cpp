@@ -0,0 +1,73 @@
+#include "playlist_model.h"
+#include <algorithm>
+
+PlaylistModel::PlaylistModel(QObject *parent)
+    : QAbstractListModel(parent)
+{
+}
+
+int PlaylistModel::rowCount(const QModelIndex &parent) const
+{
+    if (parent.isValid()) {
+        return 0;
+    }
+    return m_fileNames.size();
+}
+
+QVariant PlaylistModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid() || index.row() >= m_fileNames.size()) {
+        return QVariant();
+    }
+
+    // Names may carry a directory from the service; the dot must be in the last part
+    const QString &fileName = m_fileNames[index.row()];
+    const int slash = fileName.lastIndexOf('/');
+    const int dot = fileName.lastIndexOf('.');
+    const bool hasExtension = dot > slash + 1;
+
+    switch (role) {
+    case FileNameRole:
+        return fileName;
+    case TitleRole:
+        return fileName.mid(slash + 1, hasExtension ? dot - slash - 1 : -1);
+    case ExtensionRole:
+        return hasExtension ? fileName.mid(dot + 1) : QString();
+    default:
+        return QVariant();
+    }
+}
+
+QHash<int, QByteArray> PlaylistModel::roleNames() const
+{
+    return {
+        { FileNameRole, "fileName" },
+        { TitleRole, "title" },
+        { ExtensionRole, "extension" }
+    };
+}
+
+void PlaylistModel::setFiles(const QStringList &fileNames)
+{
+    const int oldCount = m_fileNames.size();
+
+    // Indexing only appends; keep the rows the view already has
+    const bool extends = fileNames.size() >= oldCount
+        && std::equal(m_fileNames.cbegin(), m_fileNames.cend(), fileNames.cbegin());
+    if (extends && fileNames.size() == oldCount) {
+        return;
+    }
+    if (extends) {
+        beginInsertRows(QModelIndex(), oldCount, fileNames.size() - 1);
+        m_fileNames = fileNames;
+        endInsertRows();
+    } else {
+        beginResetModel();
+        m_fileNames = fileNames;
+        endResetModel();
+    }
+
+    if (oldCount != m_fileNames.size()) {
+        emit countChanged();
+    }
+}
@@ -0,0 +1,38 @@
+#ifndef PLAYLIST_MODEL_H
+#define PLAYLIST_MODEL_H
+
+#include <QAbstractListModel>
+#include <QStringList>
+
+// Track list of the current source for the playlist view. Titles and
+// extensions are split off the file name only for the rows the view asks
+// for, and a list that grows while indexing is appended as inserted rows,
+// so a large library is never walked as a whole.
+class PlaylistModel : public QAbstractListModel
+{
+    Q_OBJECT
+    Q_PROPERTY(int count READ rowCount NOTIFY countChanged)
+
+public:
+    enum Roles {
+        FileNameRole = Qt::UserRole + 1,
+        TitleRole,
+        ExtensionRole
+    };
+
+    explicit PlaylistModel(QObject *parent = nullptr);
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role) const override;
+    QHash<int, QByteArray> roleNames() const override;
+
+    void setFiles(const QStringList &fileNames);
+
+signals:
+    void countChanged();
+
+private:
+    QStringList m_fileNames;
+};
+
+#endif // PLAYLIST_MODEL_H
@@ -1,6 +1,5 @@
 import QtQuick
 import QtQuick.Controls
-import QtQuick.VirtualKeyboard
 
 ApplicationWindow {
     id: mainWindow
@@ -75,7 +74,7 @@ ApplicationWindow {
                         border.width: 1
                         border.color: theme.accentColor
 
-                        Behavior on color { ColorAnimation { duration: 200 } }
+                        Behavior on color { enabled: !theme.transitioning; ColorAnimation { duration: 200 } }
                     }
 
                     contentItem: Row {
@@ -137,7 +136,7 @@ ApplicationWindow {
                     color: mpHandler.isPlaying ? theme.themeColor : "#334155"
                     anchors.verticalCenter: parent.verticalCenter
 
-                    Behavior on color { ColorAnimation { duration: 300 } }
+                    Behavior on color { enabled: !theme.transitioning; ColorAnimation { duration: 300 } }
 
                     Text {
                         anchors.centerIn: parent
@@ -167,7 +166,7 @@ ApplicationWindow {
                         border.width: showPlaylist ? 2 : 1
                         border.color: showPlaylist ? theme.accentColor : "#334155"
 
-                        Behavior on color { ColorAnimation { duration: 200 } }
+                        Behavior on color { enabled: !theme.transitioning; ColorAnimation { duration: 200 } }
                     }
 
                     contentItem: Text {
@@ -258,13 +257,6 @@ ApplicationWindow {
         }
     }
 
-    // Virtual Keyboard - appears at bottom when text input is focused
-    InputPanel {
-        id: inputPanel
-        z: 99
-        x: 0
-        y: mainWindow.height - inputPanel.height
-        width: mainWindow.width
-        visible: active
-    }
+    // Text input goes through the compositor's shared keyboard
+    // (wayland text-input); the window is resized while it is shown
 }
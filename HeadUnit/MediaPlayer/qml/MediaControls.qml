@@ -24,7 +24,7 @@ Item {
                 border.width: 1
                 border.color: theme.accentColor
 
-                Behavior on color { ColorAnimation { duration: 200 } }
+                Behavior on color { enabled: !theme.transitioning; ColorAnimation { duration: 200 } }
             }
 
             contentItem: Text {
@@ -55,7 +55,7 @@ Item {
                 border.width: 2
                 border.color: theme.accentColor
 
-                Behavior on color { ColorAnimation { duration: 200 } }
+                Behavior on color { enabled: !theme.transitioning; ColorAnimation { duration: 200 } }
             }
 
             contentItem: Text {
@@ -86,7 +86,7 @@ Item {
                 border.width: 3
                 border.color: theme.accentColor
 
-                Behavior on color { ColorAnimation { duration: 200 } }
+                Behavior on color { enabled: !theme.transitioning; ColorAnimation { duration: 200 } }
 
                 // Glow effect
                 Rectangle {
@@ -129,7 +129,7 @@ Item {
                 border.width: 2
                 border.color: theme.accentColor
 
-                Behavior on color { ColorAnimation { duration: 200 } }
+                Behavior on color { enabled: !theme.transitioning; ColorAnimation { duration: 200 } }
             }
 
             contentItem: Text {
@@ -160,7 +160,7 @@ Item {
                 border.width: 1
                 border.color: theme.accentColor
 
-                Behavior on color { ColorAnimation { duration: 200 } }
+                Behavior on color { enabled: !theme.transitioning; ColorAnimation { duration: 200 } }
             }
 
             contentItem: Text {
@@ -20,7 +20,7 @@ Rectangle {
             color: theme.themeColor
             anchors.horizontalCenter: parent.horizontalCenter
 
-            Behavior on color { ColorAnimation { duration: 300 } }
+            Behavior on color { enabled: !theme.transitioning; ColorAnimation { duration: 300 } }
 
             Text {
                 anchors.centerIn: parent
@@ -49,7 +49,7 @@ Rectangle {
                 font.pixelSize: 14
                 anchors.horizontalCenter: parent.horizontalCenter
 
-                Behavior on color { ColorAnimation { duration: 300 } }
+                Behavior on color { enabled: !theme.transitioning; ColorAnimation { duration: 300 } }
             }
         }
     }
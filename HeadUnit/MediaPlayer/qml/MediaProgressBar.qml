@@ -34,7 +34,7 @@ Item {
                     color: theme.themeColor
                     radius: 5
 
-                    Behavior on color { ColorAnimation { duration: 300 } }
+                    Behavior on color { enabled: !theme.transitioning; ColorAnimation { duration: 300 } }
                 }
             }
 
@@ -48,7 +48,7 @@ Item {
                 border.color: theme.themeColor
                 border.width: 3
 
-                Behavior on color { ColorAnimation { duration: 200 } }
+                Behavior on color { enabled: !theme.transitioning; ColorAnimation { duration: 200 } }
             }
 
             onMoved: {
@@ -68,7 +68,7 @@ Item {
                 color: theme.accentColor
                 font.pixelSize: 12
 
-                Behavior on color { ColorAnimation { duration: 300 } }
+                Behavior on color { enabled: !theme.transitioning; ColorAnimation { duration: 300 } }
             }
 
             Item {
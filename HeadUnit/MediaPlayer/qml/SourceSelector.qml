@@ -26,8 +26,8 @@ Row {
                 border.width: modelData === currentSource ? 2 : 1
                 border.color: modelData === currentSource ? theme.accentColor : "#334155"
 
-                Behavior on color { ColorAnimation { duration: 200 } }
-                Behavior on border.color { ColorAnimation { duration: 200 } }
+                Behavior on color { enabled: !theme.transitioning; ColorAnimation { duration: 200 } }
+                Behavior on border.color { enabled: !theme.transitioning; ColorAnimation { duration: 200 } }
             }
 
             contentItem: Row {
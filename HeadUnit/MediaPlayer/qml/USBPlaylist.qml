@@ -8,6 +8,8 @@ Rectangle {
     // Signal to notify when a song is selected
     signal songSelected()
 
+    readonly property bool searching: searchField.text.length > 0
+
     // Timer to refresh playlist periodically
     Timer {
         id: refreshTimer
@@ -37,7 +39,7 @@ Rectangle {
                 color: theme.themeColor
                 anchors.verticalCenter: parent.verticalCenter
 
-                Behavior on color { ColorAnimation { duration: 300 } }
+                Behavior on color { enabled: !theme.transitioning; ColorAnimation { duration: 300 } }
             }
 
             Item { width: parent.width - 400 }
@@ -58,7 +60,7 @@ Rectangle {
                     border.width: 1
                     border.color: theme.accentColor
 
-                    Behavior on color { ColorAnimation { duration: 200 } }
+                    Behavior on color { enabled: !theme.transitioning; ColorAnimation { duration: 200 } }
                 }
 
                 contentItem: Text {
@@ -78,13 +80,39 @@ Rectangle {
             }
 
             Text {
-                text: playlistView.count + " tracks"
+                text: root.searching ? searchView.count + " matches" : playlistView.count + " tracks"
                 font.pixelSize: 14
                 color: "#94a3b8"
                 anchors.verticalCenter: parent.verticalCenter
             }
         }
 
+        // Search field (title, artist, album, file name)
+        TextField {
+            id: searchField
+            width: parent.width
+            height: 44
+            visible: playlistView.count > 0
+            placeholderText: "Search title, artist, album..."
+            placeholderTextColor: "#64748b"
+            font.pixelSize: 16
+            color: "white"
+            inputMethodHints: Qt.ImhNoPredictiveText | Qt.ImhNoAutoUppercase
+
+            background: Rectangle {
+                color: "#1e293b"
+                radius: 8
+                border.width: searchField.activeFocus ? 2 : 1
+                border.color: searchField.activeFocus ? theme.accentColor : "#334155"
+            }
+
+            onTextChanged: {
+                if (mpHandler) {
+                    mpHandler.search(text)
+                }
+            }
+        }
+
         // Empty state
         Rectangle {
             width: parent.width
@@ -141,7 +169,7 @@ Rectangle {
                         border.width: 2
                         border.color: theme.accentColor
 
-                        Behavior on color { ColorAnimation { duration: 200 } }
+                        Behavior on color { enabled: !theme.transitioning; ColorAnimation { duration: 200 } }
                     }
 
                     contentItem: Text {
@@ -163,18 +191,82 @@ Rectangle {
             }
         }
 
+        ListView {
+            id: searchView
+            width: parent.width
+            height: parent.height - 110
+            visible: root.searching
+            clip: true
+            spacing: 8
+
+            model: mpHandler ? mpHandler.searchResults : null
+
+            delegate: Rectangle {
+                required property string title
+                required property string artist
+                required property string album
+                required property int trackIndex
+
+                width: searchView.width
+                height: 60
+                radius: 8
+                color: searchMouseArea.containsMouse ? "#334155" : "#1e293b"
+                border.width: 1
+                border.color: "#334155"
+
+                Column {
+                    anchors.fill: parent
+                    anchors.margins: 12
+                    spacing: 4
+
+                    Text {
+                        text: title
+                        font.pixelSize: 16
+                        color: "white"
+                        elide: Text.ElideRight
+                        width: parent.width
+                    }
+
+                    Text {
+                        text: [artist, album].filter(function(s) { return s.length > 0 }).join(" • ") || "USB"
+                        font.pixelSize: 12
+                        color: "#94a3b8"
+                        elide: Text.ElideRight
+                        width: parent.width
+                    }
+                }
+
+                MouseArea {
+                    id: searchMouseArea
+                    anchors.fill: parent
+                    hoverEnabled: true
+                    cursorShape: Qt.PointingHandCursor
+
+                    onClicked: {
+                        if (mpHandler) {
+                            mpHandler.playTrack(trackIndex)
+                        }
+                        searchField.text = ""
+                        root.songSelected()
+                    }
+                }
+            }
+        }
+
         ListView {
             id: playlistView
             width: parent.width
-            height: parent.height - 50
-            visible: count > 0
+            height: parent.height - 110
+            visible: count > 0 && !root.searching
             clip: true
             spacing: 8
 
-            model: mpHandler ? mpHandler.mediaFileList : []
+            model: mpHandler ? mpHandler.playlist : null
 
             delegate: Rectangle {
-                required property string modelData
+                required property string fileName
+                required property string title
+                required property string extension
                 required property int index
 
                 width: playlistView.width
@@ -189,7 +281,7 @@ Rectangle {
                 border.width: mpHandler && mpHandler.currentMediaIndex === index ? 2 : 1
                 border.color: mpHandler && mpHandler.currentMediaIndex === index ? theme.accentColor : "#334155"
 
-                Behavior on color { ColorAnimation { duration: 200 } }
+                Behavior on color { enabled: !theme.transitioning; ColorAnimation { duration: 200 } }
 
                 Row {
                     anchors.fill: parent
@@ -205,7 +297,7 @@ Rectangle {
                         visible: mpHandler && mpHandler.currentMediaIndex === index && mpHandler.isPlaying
                         anchors.verticalCenter: parent.verticalCenter
 
-                        Behavior on color { ColorAnimation { duration: 300 } }
+                        Behavior on color { enabled: !theme.transitioning; ColorAnimation { duration: 300 } }
 
                         SequentialAnimation on opacity {
                             running: mpHandler && mpHandler.currentMediaIndex === index && mpHandler.isPlaying
@@ -224,12 +316,12 @@ Rectangle {
                         width: 40
                         anchors.verticalCenter: parent.verticalCenter
 
-                        Behavior on color { ColorAnimation { duration: 200 } }
+                        Behavior on color { enabled: !theme.transitioning; ColorAnimation { duration: 200 } }
                     }
 
                     // Track icon
                     Text {
-                        text: getFileIcon(modelData)
+                        text: getFileIcon(extension)
                         font.pixelSize: 24
                         color: mpHandler && mpHandler.currentMediaIndex === index ? "white" : "#94a3b8"
                         anchors.verticalCenter: parent.verticalCenter
@@ -244,7 +336,7 @@ Rectangle {
                         width: parent.width - 200
 
                         Text {
-                            text: extractFileName(modelData)
+                            text: title
                             font.pixelSize: 16
                             font.bold: mpHandler && mpHandler.currentMediaIndex === index
                             color: "white"
@@ -253,7 +345,7 @@ Rectangle {
                         }
 
                         Text {
-                            text: extractFileExtension(modelData).toUpperCase() + " • USB"
+                            text: extension.toUpperCase() + " • USB"
                             font.pixelSize: 12
                             color: mpHandler && mpHandler.currentMediaIndex === index ? "#ffffff" : "#94a3b8"
                             elide: Text.ElideRight
@@ -271,7 +363,7 @@ Rectangle {
                     cursorShape: Qt.PointingHandCursor
 
                     onClicked: {
-                        console.log("Playing track:", modelData)
+                        console.log("Playing track:", fileName)
                         if (mpHandler) {
                             mpHandler.playTrack(index)
                         }
@@ -290,34 +382,15 @@ Rectangle {
                     color: theme.themeColor
                     opacity: parent.pressed ? 1.0 : 0.6
 
-                    Behavior on color { ColorAnimation { duration: 300 } }
+                    Behavior on color { enabled: !theme.transitioning; ColorAnimation { duration: 300 } }
                 }
             }
         }
     }
 
     // Helper functions
-    function extractFileName(filePath) {
-        var fileName = filePath.split('/').pop()
-        // Remove extension
-        var lastDot = fileName.lastIndexOf('.')
-        if (lastDot > 0) {
-            return fileName.substring(0, lastDot)
-        }
-        return fileName
-    }
-
-    function extractFileExtension(filePath) {
-        var fileName = filePath.split('/').pop()
-        var lastDot = fileName.lastIndexOf('.')
-        if (lastDot > 0) {
-            return fileName.substring(lastDot + 1)
-        }
-        return ""
-    }
-
-    function getFileIcon(filePath) {
-        var ext = extractFileExtension(filePath).toLowerCase()
+    function getFileIcon(extension) {
+        var ext = extension.toLowerCase()
 
         // Video files
         if (ext === "mp4" || ext === "avi" || ext === "mkv" || ext === "mov" || ext === "webm") {
@@ -331,7 +404,7 @@ Rectangle {
     Component.onCompleted: {
         console.log("USBPlaylist loaded")
         if (mpHandler) {
-            console.log("Media files count:", mpHandler.mediaFileList.length)
+            console.log("Media files count:", mpHandler.playlist.count)
         }
     }
 }
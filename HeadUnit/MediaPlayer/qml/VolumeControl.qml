@@ -13,7 +13,7 @@ Row {
         color: theme.themeColor
         anchors.verticalCenter: parent.verticalCenter
 
-        Behavior on color { ColorAnimation { duration: 300 } }
+        Behavior on color { enabled: !theme.transitioning; ColorAnimation { duration: 300 } }
     }
 
     Slider {
@@ -40,7 +40,7 @@ Row {
                 color: theme.themeColor
                 radius: 3
 
-                Behavior on color { ColorAnimation { duration: 300 } }
+                Behavior on color { enabled: !theme.transitioning; ColorAnimation { duration: 300 } }
             }
         }
 
@@ -54,7 +54,7 @@ Row {
             border.color: theme.accentColor
             border.width: 2
 
-            Behavior on color { ColorAnimation { duration: 200 } }
+            Behavior on color { enabled: !theme.transitioning; ColorAnimation { duration: 200 } }
         }
 
         onValueChanged: {
@@ -69,6 +69,6 @@ Row {
         anchors.verticalCenter: parent.verticalCenter
         width: 50
 
-        Behavior on color { ColorAnimation { duration: 300 } }
+        Behavior on color { enabled: !theme.transitioning; ColorAnimation { duration: 300 } }
     }
 }
@@ -0,0 +1,68 @@
+#include "search_result_model.h"
+
+SearchResultModel::SearchResultModel(QObject *parent)
+    : QAbstractListModel(parent)
+{
+}
+
+int SearchResultModel::rowCount(const QModelIndex &parent) const
+{
+    if (parent.isValid()) {
+        return 0;
+    }
+    return m_results.size();
+}
+
+QVariant SearchResultModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid() || index.row() >= m_results.size() || !m_index) {
+        return QVariant();
+    }
+
+    const MediaSearchIndex::Track &track = m_index->track(m_results[index.row()].track);
+    switch (role) {
+    case TitleRole:
+        return track.title;
+    case ArtistRole:
+        return track.artist;
+    case AlbumRole:
+        return track.album;
+    case FileNameRole:
+        return track.fileName;
+    case TrackIndexRole:
+        return track.listIndex;
+    default:
+        return QVariant();
+    }
+}
+
+QHash<int, QByteArray> SearchResultModel::roleNames() const
+{
+    return {
+        { TitleRole, "title" },
+        { ArtistRole, "artist" },
+        { AlbumRole, "album" },
+        { FileNameRole, "fileName" },
+        { TrackIndexRole, "trackIndex" }
+    };
+}
+
+void SearchResultModel::setResults(const MediaSearchIndexPtr &index,
+                                   const QVector<MediaSearchIndex::Result> &results)
+{
+    const int oldCount = m_results.size();
+
+    beginResetModel();
+    m_index = index;
+    m_results = results;
+    endResetModel();
+
+    if (oldCount != m_results.size()) {
+        emit countChanged();
+    }
+}
+
+void SearchResultModel::clear()
+{
+    setResults(MediaSearchIndexPtr(), {});
+}
@@ -0,0 +1,41 @@
+#ifndef SEARCH_RESULT_MODEL_H
+#define SEARCH_RESULT_MODEL_H
+
+#include <QAbstractListModel>
+#include <QVector>
+#include "media_search_index.h"
+
+// Ranked search hits for the playlist view. Rows refer into the index they
+// were produced from, so the model keeps that index alive.
+class SearchResultModel : public QAbstractListModel
+{
+    Q_OBJECT
+    Q_PROPERTY(int count READ rowCount NOTIFY countChanged)
+
+public:
+    enum Roles {
+        TitleRole = Qt::UserRole + 1,
+        ArtistRole,
+        AlbumRole,
+        FileNameRole,
+        TrackIndexRole
+    };
+
+    explicit SearchResultModel(QObject *parent = nullptr);
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role) const override;
+    QHash<int, QByteArray> roleNames() const override;
+
+    void setResults(const MediaSearchIndexPtr &index, const QVector<MediaSearchIndex::Result> &results);
+    void clear();
+
+signals:
+    void countChanged();
+
+private:
+    MediaSearchIndexPtr m_index;
+    QVector<MediaSearchIndex::Result> m_results;
+};
+
+#endif // SEARCH_RESULT_MODEL_H
@@ -0,0 +1,287 @@
+#include "usb_monitor.h"
+#include <QDebug>
+#include <QFile>
+#include <QFileInfo>
+#include <QSocketNotifier>
+#include <fcntl.h>
+#include <unistd.h>
+
+#ifdef HEADUNIT_HAVE_LIBUDEV
+#include <libudev.h>
+#endif
+
+namespace {
+
+// mountinfo escapes blanks and backslashes as octal sequences
+QString unescapeMountField(const QByteArray &field)
+{
+    QByteArray out;
+    out.reserve(field.size());
+    for (int i = 0; i < field.size(); ++i) {
+        if (field[i] == '\\' && i + 3 < field.size()) {
+            out.append(static_cast<char>(field.mid(i + 1, 3).toInt(nullptr, 8)));
+            i += 3;
+        } else {
+            out.append(field[i]);
+        }
+    }
+    return QFile::decodeName(out);
+}
+
+} // namespace
+
+UsbMonitor::UsbMonitor(QObject *parent)
+    : UsbMonitor(SystemEvents, parent)
+{
+}
+
+UsbMonitor::UsbMonitor(Source source, QObject *parent)
+    : QObject(parent)
+    , m_udev(nullptr)
+    , m_udevMonitor(nullptr)
+    , m_udevNotifier(nullptr)
+    , m_mountInfoFd(-1)
+    , m_mountNotifier(nullptr)
+{
+    if (source == SystemEvents) {
+        setupUdev();
+        watchMountInfo();
+    }
+}
+
+UsbMonitor::~UsbMonitor()
+{
+    delete m_udevNotifier;
+    delete m_mountNotifier;
+
+#ifdef HEADUNIT_HAVE_LIBUDEV
+    if (m_udevMonitor) {
+        udev_monitor_unref(m_udevMonitor);
+    }
+    if (m_udev) {
+        udev_unref(m_udev);
+    }
+#endif
+
+    if (m_mountInfoFd >= 0) {
+        ::close(m_mountInfoFd);
+    }
+}
+
+void UsbMonitor::setupUdev()
+{
+#ifdef HEADUNIT_HAVE_LIBUDEV
+    m_udev = udev_new();
+    if (!m_udev) {
+        qWarning() << "UsbMonitor: udev_new failed";
+        return;
+    }
+
+    m_udevMonitor = udev_monitor_new_from_netlink(m_udev, "udev");
+    if (!m_udevMonitor) {
+        qWarning() << "UsbMonitor: Cannot create udev monitor";
+        return;
+    }
+
+    udev_monitor_filter_add_match_subsystem_devtype(m_udevMonitor, "block", "partition");
+    udev_monitor_filter_add_match_subsystem_devtype(m_udevMonitor, "block", "disk");
+    if (udev_monitor_enable_receiving(m_udevMonitor) < 0) {
+        qWarning() << "UsbMonitor: Cannot enable udev monitor";
+        udev_monitor_unref(m_udevMonitor);
+        m_udevMonitor = nullptr;
+        return;
+    }
+
+    m_udevNotifier = new QSocketNotifier(udev_monitor_get_fd(m_udevMonitor), QSocketNotifier::Read, this);
+    connect(m_udevNotifier, &QSocketNotifier::activated, this, &UsbMonitor::handleUdevEvent);
+#endif
+}
+
+void UsbMonitor::watchMountInfo()
+{
+    // mountinfo raises POLLPRI on every mount table change
+    m_mountInfoFd = ::open("/proc/self/mountinfo", O_RDONLY | O_CLOEXEC);
+    if (m_mountInfoFd < 0) {
+        qWarning() << "UsbMonitor: Cannot open /proc/self/mountinfo";
+        return;
+    }
+    m_mountNotifier = new QSocketNotifier(m_mountInfoFd, QSocketNotifier::Exception, this);
+    connect(m_mountNotifier, &QSocketNotifier::activated, this, &UsbMonitor::handleMountsChanged);
+
+    // Already mounted at startup: known, not inserted
+    const QHash<QString, QString> mounts = removableMounts(readMountInfo());
+    for (auto it = mounts.constBegin(); it != mounts.constEnd(); ++it) {
+        Mount mount;
+        mount.device = it.value();
+        mount.sinceInsert.start();
+        m_mounts.insert(it.key(), mount);
+    }
+
+    qDebug() << "UsbMonitor: Watching mounts, udev" << (m_udevMonitor ? "enabled" : "unavailable")
+             << "- mounted:" << m_mounts.keys();
+}
+
+void UsbMonitor::handleUdevEvent()
+{
+#ifdef HEADUNIT_HAVE_LIBUDEV
+    while (struct udev_device *device = udev_monitor_receive_device(m_udevMonitor)) {
+        const QString action = QString::fromLatin1(udev_device_get_action(device));
+        const char *node = udev_device_get_devnode(device);
+        const char *bus = udev_device_get_property_value(device, "ID_BUS");
+        const QString devPath = QString::fromLatin1(udev_device_get_devpath(device));
+
+        if (node && ((bus && qstrcmp(bus, "usb") == 0) || devPath.contains("usb"))) {
+            applyUdevEvent(action, QString::fromLocal8Bit(node));
+        }
+
+        udev_device_unref(device);
+    }
+#endif
+}
+
+void UsbMonitor::applyUdevEvent(const QString &action, const QString &devNode)
+{
+    if (action == "add") {
+        QElapsedTimer timer;
+        timer.start();
+        m_pendingAdds.insert(devNode, timer);
+        qDebug() << "UsbMonitor: USB block device added:" << devNode;
+    } else if (action == "remove") {
+        m_pendingAdds.remove(devNode);
+        // Lazy unmounts may trail the removal; report it right away
+        for (auto it = m_mounts.begin(); it != m_mounts.end();) {
+            if (it.value().device == devNode) {
+                const QString mountPoint = it.key();
+                it = m_mounts.erase(it);
+                // Not a new mount when mountinfo still lists it
+                m_pendingRemovals.insert(mountPoint, devNode);
+                qDebug() << "UsbMonitor: USB device removed:" << devNode << mountPoint;
+                emit deviceRemoved(mountPoint);
+            } else {
+                ++it;
+            }
+        }
+    }
+}
+
+void UsbMonitor::handleMountsChanged()
+{
+    applyMountInfo(readMountInfo());
+}
+
+void UsbMonitor::applyMountInfo(const QByteArray &data)
+{
+    const QHash<QString, QString> mounts = removableMounts(data);
+
+    for (auto it = m_mounts.begin(); it != m_mounts.end();) {
+        if (!mounts.contains(it.key())) {
+            const QString mountPoint = it.key();
+            it = m_mounts.erase(it);
+            qDebug() << "UsbMonitor: Unmounted:" << mountPoint;
+            emit deviceRemoved(mountPoint);
+        } else {
+            ++it;
+        }
+    }
+
+    for (auto it = m_pendingRemovals.begin(); it != m_pendingRemovals.end();) {
+        if (!mounts.contains(it.key())) {
+            it = m_pendingRemovals.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+    for (auto it = mounts.constBegin(); it != mounts.constEnd(); ++it) {
+        if (m_mounts.contains(it.key())) {
+            continue;
+        }
+        // Reported removed, waiting for the lazy unmount; a new udev add
+        // of the same node means the stick was plugged in again
+        const auto removed = m_pendingRemovals.constFind(it.key());
+        if (removed != m_pendingRemovals.constEnd()) {
+            if (removed.value() == it.value() && !m_pendingAdds.contains(it.value())) {
+                continue;
+            }
+            m_pendingRemovals.erase(removed);
+        }
+
+        Mount mount;
+        mount.device = it.value();
+        mount.sinceInsert = m_pendingAdds.take(mount.device);
+        if (!mount.sinceInsert.isValid()) {
+            mount.sinceInsert.start();
+        }
+        m_mounts.insert(it.key(), mount);
+
+        qDebug() << "UsbMonitor: Mounted:" << mount.device << "at" << it.key()
+                 << mount.sinceInsert.elapsed() << "ms after insert";
+        emit deviceInserted(it.key());
+    }
+}
+
+QByteArray UsbMonitor::readMountInfo() const
+{
+    // Re-read from the start; reading to EOF also re-arms the POLLPRI event
+    QByteArray data;
+    char buffer[4096];
+    ssize_t n;
+    if (lseek(m_mountInfoFd, 0, SEEK_SET) < 0) {
+        return data;
+    }
+    while ((n = ::read(m_mountInfoFd, buffer, sizeof(buffer))) > 0) {
+        data.append(buffer, static_cast<int>(n));
+    }
+    return data;
+}
+
+QHash<QString, QString> UsbMonitor::removableMounts(const QByteArray &data)
+{
+    QHash<QString, QString> mounts;
+    for (const auto &entry : parseMountInfo(data)) {
+        if (isRemovableMount(entry.second, entry.first)) {
+            mounts.insert(entry.first, entry.second);
+        }
+    }
+    return mounts;
+}
+
+QList<QPair<QString, QString>> UsbMonitor::parseMountInfo(const QByteArray &data)
+{
+    QList<QPair<QString, QString>> mounts;
+    for (const QByteArray &line : data.split('\n')) {
+        const QList<QByteArray> fields = line.split(' ');
+        const int sep = fields.indexOf("-");
+        if (fields.size() < 5 || sep < 0 || sep + 2 >= fields.size()) {
+            continue;
+        }
+        mounts.append(qMakePair(unescapeMountField(fields[4]), unescapeMountField(fields[sep + 2])));
+    }
+    return mounts;
+}
+
+bool UsbMonitor::isRemovableMount(const QString &device, const QString &mountPoint)
+{
+    // Same rule as the Python service: sd*/mmcblk* under the usual automount roots
+    if (!device.startsWith("/dev/sd") && !device.startsWith("/dev/mmcblk")) {
+        return false;
+    }
+    return mountPoint.startsWith("/media/") || mountPoint.startsWith("/mnt/")
+           || mountPoint.startsWith("/run/media/");
+}
+
+QStringList UsbMonitor::mountedDevices() const
+{
+    QStringList devices = m_mounts.keys();
+    devices.sort();
+    return devices;
+}
+
+qint64 UsbMonitor::elapsedSinceInsert(const QString &mountPoint) const
+{
+    auto it = m_mounts.constFind(mountPoint);
+    if (it == m_mounts.constEnd()) {
+        return -1;
+    }
+    return it.value().sinceInsert.elapsed();
+}
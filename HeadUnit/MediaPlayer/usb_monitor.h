@@ -0,0 +1,87 @@
+#ifndef USB_MONITOR_H
+#define USB_MONITOR_H
+
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <QHash>
+#include <QPair>
+#include <QList>
+#include <QElapsedTimer>
+
+class QSocketNotifier;
+struct udev;
+struct udev_monitor;
+
+// Native USB storage hotplug detection.
+//
+// udev partition events arrive on a netlink socket watched by a
+// QSocketNotifier. The mount itself is picked up from /proc/self/mountinfo,
+// which the kernel flags with POLLPRI whenever the mount table changes, so a
+// new volume is reported the moment the automounter is done instead of after
+// a fixed delay. Without libudev the mountinfo watch alone still works.
+//
+// Both sources end up in applyUdevEvent() and applyMountInfo(). A monitor
+// created with FedEvents watches nothing and only sees what it is given
+// there, so a test can play an insert or a yank step by step.
+class UsbMonitor : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum Source {
+        SystemEvents,   // udev netlink and /proc/self/mountinfo
+        FedEvents,      // only applyUdevEvent() and applyMountInfo()
+    };
+
+    explicit UsbMonitor(QObject *parent = nullptr);
+    explicit UsbMonitor(Source source, QObject *parent = nullptr);
+    ~UsbMonitor();
+
+    bool isAvailable() const { return m_mountInfoFd >= 0; }
+    QStringList mountedDevices() const;
+
+    // Milliseconds since the udev add event for the device behind mountPoint,
+    // or since the mount appeared when udev did not report it
+    qint64 elapsedSinceInsert(const QString &mountPoint) const;
+
+    // (mount point, source device) for every line of a mountinfo dump
+    static QList<QPair<QString, QString>> parseMountInfo(const QByteArray &data);
+
+    // A USB block device event: "add" or "remove" of a device node
+    void applyUdevEvent(const QString &action, const QString &devNode);
+    // The whole mount table, as read from mountinfo after it changed
+    void applyMountInfo(const QByteArray &data);
+
+signals:
+    void deviceInserted(const QString &mountPoint);
+    void deviceRemoved(const QString &mountPoint);
+
+private slots:
+    void handleUdevEvent();
+    void handleMountsChanged();
+
+private:
+    struct Mount {
+        QString device;
+        QElapsedTimer sinceInsert;
+    };
+
+    void setupUdev();
+    void watchMountInfo();
+    QByteArray readMountInfo() const;
+    static QHash<QString, QString> removableMounts(const QByteArray &data);   // mount point -> device
+    static bool isRemovableMount(const QString &device, const QString &mountPoint);
+
+    struct udev *m_udev;
+    struct udev_monitor *m_udevMonitor;
+    QSocketNotifier *m_udevNotifier;
+    int m_mountInfoFd;
+    QSocketNotifier *m_mountNotifier;
+
+    QHash<QString, Mount> m_mounts;                 // mount point -> mount
+    QHash<QString, QElapsedTimer> m_pendingAdds;    // device node -> since udev add
+    QHash<QString, QString> m_pendingRemovals;      // mount point -> device, removed but still mounted
+};
+
+#endif // USB_MONITOR_H
@@ -1,6 +1,5 @@
 import QtQuick
 import QtQuick.Controls
-import QtQuick.VirtualKeyboard
 
 ApplicationWindow {
     id: mainWindow
@@ -44,14 +43,7 @@ ApplicationWindow {
         }
     }
 
-    // Virtual Keyboard - appears at bottom when text input is focused
-    InputPanel {
-        id: inputPanel
-        z: 99
-        x: 0
-        y: mainWindow.height - inputPanel.height
-        width: mainWindow.width
-        visible: active
-    }
+    // Text input goes through the compositor's shared keyboard
+    // (wayland text-input); the window is resized while it is shown
 }
 
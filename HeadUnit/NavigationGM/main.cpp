@@ -1,9 +1,11 @@
 #include <QGuiApplication>
 #include <QQmlApplicationEngine>
+#include "../app_liveness.h"
 
 int main(int argc, char *argv[])
 {
     QGuiApplication app(argc, argv);
+    AppLiveness liveness;
 
     QQmlApplicationEngine engine;
     QObject::connect(
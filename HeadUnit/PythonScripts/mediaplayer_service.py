@@ -353,6 +353,11 @@ class MediaPlayerService(dbus.service.Object):
         """Get list of media files"""
         return dbus.Array(self.media_files, signature='s')
     
+    @dbus.service.method(INTERFACE_NAME, in_signature='', out_signature='as')
+    def GetMediaFilePaths(self):
+        """Get full paths of media files (same order as GetMediaFiles)"""
+        return dbus.Array(self.media_file_paths, signature='s')
+    
     @dbus.service.method(INTERFACE_NAME, in_signature='s', out_signature='')
     def SelectUsbDevice(self, device_path):
         """Select USB device"""
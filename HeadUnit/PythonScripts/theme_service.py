@@ -6,8 +6,17 @@ from dbus.mainloop.glib import DBusGMainLoop
 from gi.repository import GLib
 import json
 import os
+import signal
+import struct
+import tempfile
 from pathlib import Path
 
+# Snapshot of the current color that ThemeClient (theme_client.cpp) reads
+# at startup: magic "HUTH", version, 0xAARRGGBB, native byte order
+SNAPSHOT_MAGIC = 0x48555448
+SNAPSHOT_VERSION = 1
+SNAPSHOT_FORMAT = '=III'
+
 class ThemeColorService(dbus.service.Object):
     def __init__(self):
         DBusGMainLoop(set_as_default=True)
@@ -20,8 +29,11 @@ class ThemeColorService(dbus.service.Object):
         self.config_file = self.config_dir / 'theme_color.json'
         self.config_dir.mkdir(parents=True, exist_ok=True)
         
+        self.snapshot_file = Path(os.environ.get('XDG_RUNTIME_DIR', '/tmp')) / 'headunit-theme'
+
         # Load saved color or use default
         self._color = self.load_color()
+        self.write_snapshot()
         print(f"Initialized with color: {self._color}")
     
     def load_color(self):
@@ -48,6 +60,37 @@ class ThemeColorService(dbus.service.Object):
         except Exception as e:
             print(f"Error saving color: {e}")
     
+    def write_snapshot(self):
+        """Publish the color for apps that are starting"""
+        hex_digits = self._color.lstrip('#')
+        try:
+            argb = int(hex_digits, 16)
+        except ValueError:
+            print(f"Not writing snapshot, invalid color: {self._color}")
+            return
+        if len(hex_digits) == 6:
+            argb |= 0xFF000000
+        elif len(hex_digits) != 8:
+            print(f"Not writing snapshot, invalid color: {self._color}")
+            return
+
+        # Renamed into place, readers see the old or the new file, never half
+        try:
+            fd, tmp_path = tempfile.mkstemp(dir=self.snapshot_file.parent, prefix='.headunit-theme')
+            with os.fdopen(fd, 'wb') as f:
+                f.write(struct.pack(SNAPSHOT_FORMAT, SNAPSHOT_MAGIC, SNAPSHOT_VERSION, argb))
+            os.chmod(tmp_path, 0o644)
+            os.replace(tmp_path, self.snapshot_file)
+        except OSError as e:
+            print(f"Error writing snapshot: {e}")
+
+    def remove_snapshot(self):
+        """Without the service, apps ask over D-Bus instead of trusting a stale color"""
+        try:
+            self.snapshot_file.unlink()
+        except OSError:
+            pass
+
     @dbus.service.method('com.piracer.dashboard',
                         in_signature='s', out_signature='')
     def SetColor(self, color):
@@ -55,6 +98,7 @@ class ThemeColorService(dbus.service.Object):
         self._color = color
         print(f"Color changed to: {color}")
         self.save_color()  # Persist to disk
+        self.write_snapshot()  # Before the signal, see ThemeClient
         self.ColorChanged(color)  # Broadcast to all apps
     
     @dbus.service.method('com.piracer.dashboard',
@@ -80,10 +124,21 @@ if __name__ == '__main__':
     
     print(f"Initial color: {service._color}")
     print("Service is ready!")
+
+    # kill and service managers stop it with SIGTERM, which would skip the
+    # finally below; quitting the loop lets it remove the snapshot
+    def on_sigterm():
+        print("\nService stopped (SIGTERM)")
+        loop.quit()
+        return GLib.SOURCE_REMOVE
+
+    GLib.unix_signal_add(GLib.PRIORITY_DEFAULT, signal.SIGTERM, on_sigterm)
     
     try:
         loop.run()
     except KeyboardInterrupt:
         print("\nService stopped")
         loop.quit()
+    finally:
+        service.remove_snapshot()
 
@@ -3,6 +3,7 @@
 #include <QQmlContext>
 #include <QDebug>
 #include "../theme_client.h"
+#include "../app_liveness.h"
 #include "dbus_handler.h"
 
 int main(int argc, char *argv[])
@@ -15,6 +16,7 @@ int main(int argc, char *argv[])
     // Only need D-Bus handler and theme
     DBusHandler dbusHandler;
     ThemeClient themeClient;
+    AppLiveness liveness;
 
     QQmlApplicationEngine engine;
 
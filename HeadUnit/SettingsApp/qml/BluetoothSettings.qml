@@ -82,7 +82,7 @@ Rectangle {
                 font.pixelSize: 22
                 font.bold: true
                 color: theme.themeColor
-                Behavior on color { ColorAnimation { duration: 200 } }
+                Behavior on color { enabled: !theme.transitioning; ColorAnimation { duration: 200 } }
             }
 
             // Status Card with Toggle
@@ -138,7 +138,7 @@ Rectangle {
                             border.color: bluetoothToggle.checked ? theme.accentColor : "#475569"
                             border.width: 2
 
-                            Behavior on color { ColorAnimation { duration: 200 } }
+                            Behavior on color { enabled: !theme.transitioning; ColorAnimation { duration: 200 } }
 
                             Rectangle {
                                 x: bluetoothToggle.checked ? parent.width - width - 3 : 3
@@ -189,7 +189,7 @@ Rectangle {
                     radius: 10
                     border.color: scanButton.enabled ? theme.accentColor : "#475569"
                     border.width: 2
-                    Behavior on color { ColorAnimation { duration: 200 } }
+                    Behavior on color { enabled: !theme.transitioning; ColorAnimation { duration: 200 } }
                 }
 
                 contentItem: Text {
@@ -281,7 +281,7 @@ Rectangle {
                     border.color: model.paired ? theme.themeColor : theme.accentColor
                     border.width: model.paired ? 2 : 1
 
-                    Behavior on color { ColorAnimation { duration: 150 } }
+                    Behavior on color { enabled: !theme.transitioning; ColorAnimation { duration: 150 } }
 
                     Row {
                         anchors.fill: parent
@@ -23,8 +23,8 @@ Button {
         border.width: root.selected ? 2 : 0
         border.color: theme.accentColor
 
-        Behavior on color { ColorAnimation { duration: 150 } }
-        Behavior on border.color { ColorAnimation { duration: 150 } }
+        Behavior on color { enabled: !theme.transitioning; ColorAnimation { duration: 150 } }
+        Behavior on border.color { enabled: !theme.transitioning; ColorAnimation { duration: 150 } }
     }
 
     contentItem: Row {
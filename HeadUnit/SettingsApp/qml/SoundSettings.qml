@@ -16,7 +16,7 @@ Rectangle {
             font.pixelSize: 22
             font.bold: true
             color: theme.themeColor
-            Behavior on color { ColorAnimation { duration: 200 } }
+            Behavior on color { enabled: !theme.transitioning; ColorAnimation { duration: 200 } }
         }
 
         Text {
@@ -55,7 +55,7 @@ Rectangle {
                         height: parent.height
                         radius: 3
                         color: theme.themeColor
-                        Behavior on color { ColorAnimation { duration: 200 } }
+                        Behavior on color { enabled: !theme.transitioning; ColorAnimation { duration: 200 } }
                     }
                 }
 
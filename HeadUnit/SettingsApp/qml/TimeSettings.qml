@@ -37,7 +37,7 @@ Rectangle {
                 font.pixelSize: 22
                 font.bold: true
                 color: theme.themeColor
-                Behavior on color { ColorAnimation { duration: 200 } }
+                Behavior on color { enabled: !theme.transitioning; ColorAnimation { duration: 200 } }
             }
 
             // Current Time Display
@@ -59,7 +59,7 @@ Rectangle {
                         font.bold: true
                         color: theme.themeColor
                         anchors.horizontalCenter: parent.horizontalCenter
-                        Behavior on color { ColorAnimation { duration: 200 } }
+                        Behavior on color { enabled: !theme.transitioning; ColorAnimation { duration: 200 } }
                     }
 
                     Text {
@@ -256,7 +256,7 @@ Rectangle {
                     radius: 8
                     border.color: theme.accentColor
                     border.width: 2
-                    Behavior on color { ColorAnimation { duration: 200 } }
+                    Behavior on color { enabled: !theme.transitioning; ColorAnimation { duration: 200 } }
                 }
 
                 contentItem: Text {
@@ -361,7 +361,7 @@ Rectangle {
                         radius: 8
                         border.color: theme.accentColor
                         border.width: 2
-                        Behavior on color { ColorAnimation { duration: 200 } }
+                        Behavior on color { enabled: !theme.transitioning; ColorAnimation { duration: 200 } }
                     }
 
                     contentItem: Text {
@@ -69,7 +69,7 @@ Rectangle {
                 font.pixelSize: 22
                 font.bold: true
                 color: theme.themeColor
-                Behavior on color { ColorAnimation { duration: 200 } }
+                Behavior on color { enabled: !theme.transitioning; ColorAnimation { duration: 200 } }
             }
 
             // Status Card
@@ -165,7 +165,7 @@ Rectangle {
                     radius: 10
                     border.color: theme.accentColor
                     border.width: 2
-                    Behavior on color { ColorAnimation { duration: 200 } }
+                    Behavior on color { enabled: !theme.transitioning; ColorAnimation { duration: 200 } }
                 }
 
                 contentItem: Text {
@@ -214,7 +214,7 @@ Rectangle {
                     border.color: theme.accentColor
                     border.width: 1
 
-                    Behavior on color { ColorAnimation { duration: 150 } }
+                    Behavior on color { enabled: !theme.transitioning; ColorAnimation { duration: 150 } }
 
                     Row {
                         anchors.fill: parent
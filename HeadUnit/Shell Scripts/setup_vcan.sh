@@ -0,0 +1,47 @@
+#!/bin/sh
+
+# Creates a virtual CAN interface for running the vehicle data service
+# without the car, e.g.:
+#
+#   sudo sh setup_vcan.sh vcan0
+#   CAN_IFACE=vcan0 ./headunit-vehicledata &
+#   ./can-replay --interface vcan0 --speed 1 sample_drive.log
+#
+# Drives recorded in the car with can-record replay the same way:
+#
+#   ./can-record --interface can0 drive.hutr
+#   ./can-replay --interface vcan0 --speed 10 drive.hutr
+
+set -e
+
+IFACE="${1:-vcan0}"
+
+GREEN='\033[0;32m'
+RED='\033[0;31m'
+NC='\033[0m'
+
+log_info() {
+    printf "${GREEN}[VCAN]${NC} %s\n" "$1"
+}
+
+log_error() {
+    printf "${RED}[VCAN]${NC} %s\n" "$1"
+}
+
+if ! modprobe vcan 2>/dev/null; then
+    log_error "Cannot load the vcan module (run as root?)"
+    exit 1
+fi
+
+if ip link show "$IFACE" >/dev/null 2>&1; then
+    log_info "$IFACE already exists"
+else
+    ip link add dev "$IFACE" type vcan
+    log_info "Created $IFACE"
+fi
+
+# A longer TX queue keeps max-speed replays from failing with ENOBUFS
+ip link set "$IFACE" txqueuelen 1000
+ip link set up "$IFACE"
+
+log_info "$IFACE is up"
@@ -2,6 +2,7 @@
 #include <QQmlApplicationEngine>
 #include <QQmlContext>
 #include "ThemeColorClient.h"
+#include "../app_liveness.h"
 
 int main(int argc, char *argv[])
 {
@@ -10,6 +11,9 @@ int main(int argc, char *argv[])
     app.setApplicationName("ThemeColor");
     app.setOrganizationName("HeadUnit");
 
+    // Answers the compositor's watchdog
+    AppLiveness liveness;
+
     QQmlApplicationEngine engine;
 
     // Create ThemeColorClient instance
@@ -0,0 +1,137 @@
+// battery_monitor.cpp
+#include "battery_monitor.h"
+#include <QMutexLocker>
+#include <cerrno>
+#include <ctime>
+
+namespace vehicle {
+
+namespace {
+
+constexpr qint64 kNsPerSecond = 1000000000;
+
+// Ah/km of a new window against the running value
+constexpr double kConsumptionSmoothing = 0.2;
+
+qint64 clockNs(clockid_t clock)
+{
+    timespec ts;
+    clock_gettime(clock, &ts);
+    return qint64(ts.tv_sec) * kNsPerSecond + ts.tv_nsec;
+}
+
+void sleepUntil(qint64 deadlineNs)
+{
+    timespec ts;
+    ts.tv_sec = deadlineNs / kNsPerSecond;
+    ts.tv_nsec = deadlineNs % kNsPerSecond;
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, nullptr) == EINTR) {
+    }
+}
+
+} // namespace
+
+BatteryMonitor::BatteryMonitor(PowerSensor *sensor, const SocEstimator::Params &params, QObject *parent)
+    : QThread(parent)
+    , m_sensor(sensor)
+    , m_stopping(false)
+    , m_speed(0.0)
+    , m_estimator(params)
+    , m_windowMeters(0.0)
+    , m_windowAh(0.0)
+    , m_ahPerKm(0.0)
+{
+}
+
+BatteryMonitor::~BatteryMonitor()
+{
+    stop();
+    delete m_sensor;
+}
+
+void BatteryMonitor::stop()
+{
+    if (!isRunning()) {
+        return;
+    }
+    // Seen within one sample period
+    m_stopping = true;
+    wait();
+    m_stopping = false;
+}
+
+BatteryState BatteryMonitor::state() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_state;
+}
+
+void BatteryMonitor::updateRange(double current, double dt)
+{
+    const double speed = m_speed.load(std::memory_order_relaxed);
+    if (speed <= 0.0) {
+        return;
+    }
+
+    m_windowMeters += speed / 100.0 * dt;
+    m_windowAh += qMax(0.0, current) * dt / 3600.0;
+    if (m_windowMeters < kRangeWindowM) {
+        return;
+    }
+
+    const double ahPerKm = m_windowAh / (m_windowMeters / 1000.0);
+    m_ahPerKm = m_ahPerKm > 0.0 ? m_ahPerKm + kConsumptionSmoothing * (ahPerKm - m_ahPerKm) : ahPerKm;
+    m_windowMeters = 0.0;
+    m_windowAh = 0.0;
+}
+
+void BatteryMonitor::run()
+{
+    constexpr qint64 periodNs = kNsPerSecond / kSampleHz;
+    constexpr double dt = 1.0 / kSampleHz;
+    constexpr int samplesPerReport = kSampleHz / kReportHz;
+
+    // Stepped here without the lock, published once per report
+    BatteryState local = state();
+    int sinceReport = 0;
+    qint64 deadline = clockNs(CLOCK_MONOTONIC);
+
+    while (!m_stopping) {
+        PowerSample sample;
+        if (m_sensor->read(&sample)) {
+            m_estimator.step(sample.voltage, sample.current, dt);
+            updateRange(sample.current, dt);
+            local.valid = true;
+            local.soc = m_estimator.soc();
+            local.voltage = sample.voltage;
+            local.current = sample.current;
+            local.remainingAh = m_estimator.remainingAh();
+            local.rangeKm = m_ahPerKm > 0.0 ? local.remainingAh / m_ahPerKm : -1.0;
+            local.samples++;
+        } else {
+            local.readErrors++;
+        }
+
+        if (++sinceReport == samplesPerReport) {
+            sinceReport = 0;
+            local.cpuTimeMs = clockNs(CLOCK_THREAD_CPUTIME_ID) / 1e6;
+            {
+                QMutexLocker locker(&m_mutex);
+                m_state = local;
+            }
+            emit estimateUpdated();
+        }
+
+        deadline += periodNs;
+        const qint64 now = clockNs(CLOCK_MONOTONIC);
+        if (now >= deadline) {
+            // Too late for this period: skip it rather than catch up in a burst
+            local.overruns++;
+            deadline = now;
+            continue;
+        }
+        sleepUntil(deadline);
+    }
+}
+
+} // namespace vehicle
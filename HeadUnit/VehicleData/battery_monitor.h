@@ -0,0 +1,85 @@
+// battery_monitor.h
+#ifndef BATTERY_MONITOR_H
+#define BATTERY_MONITOR_H
+
+#include <QThread>
+#include <QMutex>
+#include <QString>
+#include <atomic>
+#include "power_sensor.h"
+#include "soc_estimator.h"
+
+namespace vehicle {
+
+struct BatteryState {
+    bool valid = false;         // false until the first sample
+    double soc = 0.0;           // 0..1
+    double voltage = 0.0;       // last sample
+    double current = 0.0;
+    double remainingAh = 0.0;
+    double rangeKm = -1.0;      // -1 until enough has been driven to know the consumption
+    quint64 samples = 0;
+    quint64 readErrors = 0;
+    quint64 overruns = 0;       // periods the loop came too late for
+    double cpuTimeMs = 0.0;     // monitor thread
+};
+
+// Samples the pack at kSampleHz on its own thread and keeps the state of
+// charge and the remaining range.
+//
+// The loop sleeps to absolute deadlines (clock_nanosleep, TIMER_ABSTIME), so
+// the estimator always steps with the nominal dt and a late wakeup does not
+// shift the following samples. State is copied out under the mutex once
+// per report, and estimateUpdated() is emitted then.
+//
+// Range is the remaining charge over the consumption while driving, an
+// average of Ah/km over kRangeWindowM windows. Speed comes from the publish
+// path through setSpeed(); charge used while standing is left out.
+class BatteryMonitor : public QThread
+{
+    Q_OBJECT
+
+public:
+    static constexpr int kSampleHz = 100;
+    static constexpr int kReportHz = 1;
+    static constexpr double kRangeWindowM = 100.0;
+
+    // Takes ownership of the sensor
+    BatteryMonitor(PowerSensor *sensor, const SocEstimator::Params &params, QObject *parent = nullptr);
+    ~BatteryMonitor();
+
+    bool open() { return m_sensor->open(); }
+    QString sensorName() const { return m_sensor->name(); }
+    void stop();
+
+    BatteryState state() const;
+
+    // cm/s, any thread
+    void setSpeed(double speed) { m_speed.store(speed, std::memory_order_relaxed); }
+
+signals:
+    void estimateUpdated();
+
+protected:
+    void run() override;
+
+private:
+    void updateRange(double current, double dt);
+
+    PowerSensor *m_sensor;
+    std::atomic<bool> m_stopping;
+    std::atomic<double> m_speed;
+
+    // Monitor thread only
+    SocEstimator m_estimator;
+    double m_windowMeters;
+    double m_windowAh;
+    double m_ahPerKm;           // 0 = unknown
+
+    mutable QMutex m_mutex;
+    BatteryState m_state;
+};
+
+} // namespace vehicle
+
+#endif // BATTERY_MONITOR_H
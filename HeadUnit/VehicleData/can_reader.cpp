@@ -0,0 +1,324 @@
+// can_reader.cpp
+#include "can_reader.h"
+#include "../telemetry_channel.h"
+#include <QDebug>
+#include <QMutexLocker>
+#include <cerrno>
+#include <cstring>
+#include <ctime>
+#include <linux/can.h>
+#include <linux/can/raw.h>
+#include <net/if.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace vehicle {
+
+namespace {
+
+// Decoder signal -> telemetry channel signal
+const telemetry::Signal kTelemetrySignal[SignalCount] = {
+    telemetry::Speed,
+    telemetry::Gear,
+    telemetry::TurnSignal,
+    telemetry::Battery,
+};
+
+// SO_TIMESTAMPNS receive time of a frame, 0 without one. Realtime clock:
+// only differences are used.
+qint64 frameStampNs(const msghdr &header)
+{
+    auto *hdr = const_cast<msghdr *>(&header);
+    for (cmsghdr *cmsg = CMSG_FIRSTHDR(hdr); cmsg; cmsg = CMSG_NXTHDR(hdr, cmsg)) {
+        if (cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_TIMESTAMPNS) {
+            timespec ts;
+            memcpy(&ts, CMSG_DATA(cmsg), sizeof(ts));
+            return qint64(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+        }
+    }
+    return 0;
+}
+
+} // namespace
+
+CanReader::CanReader(QObject *parent)
+    : QThread(parent)
+    , m_decoder(kSignalTable, kSignalTableSize)
+    , m_socket(-1)
+    , m_epoll(-1)
+    , m_wakeup(-1)
+    , m_stopping(false)
+    , m_telemetry(nullptr)
+    , m_lastSpeedNs(0)
+{
+}
+
+CanReader::~CanReader()
+{
+    stop();
+    close();
+}
+
+bool CanReader::open(const QString &interface)
+{
+    close();
+
+    const QByteArray name = interface.toLocal8Bit();
+    if (name.isEmpty() || name.size() >= IFNAMSIZ) {
+        return false;
+    }
+
+    const int fd = ::socket(PF_CAN, SOCK_RAW | SOCK_NONBLOCK | SOCK_CLOEXEC, CAN_RAW);
+    if (fd < 0) {
+        qWarning() << "[CanReader] socket:" << strerror(errno);
+        return false;
+    }
+
+    ifreq ifr;
+    memset(&ifr, 0, sizeof(ifr));
+    strncpy(ifr.ifr_name, name.constData(), IFNAMSIZ - 1);
+    if (ioctl(fd, SIOCGIFINDEX, &ifr) < 0) {
+        ::close(fd);
+        return false;
+    }
+
+    // Only the ids the decoder knows reach user space
+    QVector<can_filter> filters;
+    for (quint32 id : m_decoder.canIds()) {
+        can_filter filter;
+        filter.can_id = id > CAN_SFF_MASK ? id | CAN_EFF_FLAG : id;
+        filter.can_mask = id > CAN_SFF_MASK ? CAN_EFF_MASK | CAN_EFF_FLAG : CAN_SFF_MASK | CAN_EFF_FLAG;
+        filters.append(filter);
+    }
+    setsockopt(fd, SOL_CAN_RAW, CAN_RAW_FILTER, filters.constData(),
+               socklen_t(filters.size() * sizeof(can_filter)));
+
+    // CAN_RAW_RECV_OWN_MSGS stays off: a gear or turn signal counts once the
+    // vehicle reports it, never because our own request was read back
+
+    // Receive time of each frame, for the speed filter's dt
+    const int timestamps = 1;
+    setsockopt(fd, SOL_SOCKET, SO_TIMESTAMPNS, &timestamps, sizeof(timestamps));
+
+    sockaddr_can addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.can_family = AF_CAN;
+    addr.can_ifindex = ifr.ifr_ifindex;
+    if (bind(fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) < 0) {
+        qWarning() << "[CanReader] bind" << interface << ":" << strerror(errno);
+        ::close(fd);
+        return false;
+    }
+
+    m_epoll = epoll_create1(EPOLL_CLOEXEC);
+    m_wakeup = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (m_epoll < 0 || m_wakeup < 0) {
+        qWarning() << "[CanReader] epoll/eventfd:" << strerror(errno);
+        ::close(fd);
+        close();
+        return false;
+    }
+
+    epoll_event event;
+    memset(&event, 0, sizeof(event));
+    event.events = EPOLLIN;
+    event.data.fd = fd;
+    epoll_ctl(m_epoll, EPOLL_CTL_ADD, fd, &event);
+    event.data.fd = m_wakeup;
+    epoll_ctl(m_epoll, EPOLL_CTL_ADD, m_wakeup, &event);
+
+    m_socket = fd;
+    m_interface = interface;
+    qInfo() << "[CanReader] Listening on" << interface << "- ids:" << m_decoder.canIds().size();
+    return true;
+}
+
+void CanReader::close()
+{
+    if (m_socket >= 0) {
+        ::close(m_socket);
+        m_socket = -1;
+    }
+    if (m_epoll >= 0) {
+        ::close(m_epoll);
+        m_epoll = -1;
+    }
+    if (m_wakeup >= 0) {
+        ::close(m_wakeup);
+        m_wakeup = -1;
+    }
+    m_interface.clear();
+}
+
+void CanReader::stop()
+{
+    if (!isRunning()) {
+        return;
+    }
+    m_stopping = true;
+    const quint64 one = 1;
+    if (::write(m_wakeup, &one, sizeof(one)) < 0) {
+        qWarning() << "[CanReader] wakeup:" << strerror(errno);
+    }
+    wait();
+    m_stopping = false;
+
+    quint64 value;
+    if (::read(m_wakeup, &value, sizeof(value)) < 0 && errno != EAGAIN) {
+        qWarning() << "[CanReader] wakeup:" << strerror(errno);
+    }
+}
+
+VehicleState CanReader::state() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_state;
+}
+
+CanReader::Counters CanReader::counters() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_counters;
+}
+
+bool CanReader::send(const can_frame &frame)
+{
+    if (m_socket < 0) {
+        return false;
+    }
+    const ssize_t written = ::write(m_socket, &frame, sizeof(frame));
+    if (written != ssize_t(sizeof(frame))) {
+        qWarning() << "[CanReader] send" << Qt::hex << frame.can_id << ":" << strerror(errno);
+        return false;
+    }
+    return true;
+}
+
+double CanReader::filterSpeed(double measured, qint64 stampNs)
+{
+    qint64 dtNs = m_lastSpeedNs ? stampNs - m_lastSpeedNs : 0;
+    if (!m_lastSpeedNs || dtNs > kMaxSpeedDtNs) {
+        m_speedFilter.reset();
+        dtNs = kNominalSpeedDtNs;
+    } else if (dtNs <= 0) {
+        dtNs = kNominalSpeedDtNs;   // no or out-of-order timestamp
+    }
+    m_lastSpeedNs = stampNs;
+    return double(m_speedFilter.update(SpeedFilter::Scalar(measured),
+                                       SpeedFilter::Scalar(dtNs * 1e-9)));
+}
+
+void CanReader::run()
+{
+    union Control {
+        cmsghdr header;
+        char buffer[CMSG_SPACE(sizeof(timespec))];
+    };
+
+    can_frame frames[kBatch];
+    iovec iov[kBatch];
+    Control control[kBatch];
+    mmsghdr msgs[kBatch];
+    memset(msgs, 0, sizeof(msgs));
+    for (int i = 0; i < kBatch; ++i) {
+        iov[i].iov_base = &frames[i];
+        iov[i].iov_len = sizeof(can_frame);
+        msgs[i].msg_hdr.msg_iov = &iov[i];
+        msgs[i].msg_hdr.msg_iovlen = 1;
+        msgs[i].msg_hdr.msg_control = control[i].buffer;
+    }
+
+    // Decoded here without the lock, published once per batch
+    VehicleState local = state();
+
+    while (!m_stopping) {
+        epoll_event events[2];
+        const int ready = epoll_wait(m_epoll, events, 2, -1);
+        if (ready < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            emit readFailed(QString::fromLocal8Bit(strerror(errno)));
+            return;
+        }
+
+        for (;;) {
+            for (int i = 0; i < kBatch; ++i) {
+                msgs[i].msg_hdr.msg_controllen = sizeof(Control);   // updated by the kernel
+            }
+            const int count = recvmmsg(m_socket, msgs, kBatch, MSG_DONTWAIT, nullptr);
+            if (count < 0) {
+                if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR) {
+                    break;
+                }
+                const QString error = QString::fromLocal8Bit(strerror(errno));
+                {
+                    QMutexLocker locker(&m_mutex);
+                    m_counters.errors++;
+                }
+                if (errno == ENETDOWN || errno == ENODEV) {
+                    emit readFailed(error);
+                    return;
+                }
+                break;
+            }
+            if (count == 0) {
+                break;
+            }
+
+            const qint64 now = telemetry::monotonicNs();
+            bool discreteChange = false;
+            quint64 decoded = 0;
+            for (int i = 0; i < count; ++i) {
+                if (msgs[i].msg_len < CAN_MTU) {
+                    continue;
+                }
+                double before[SignalCount];
+                memcpy(before, local.values, sizeof(before));
+                const quint32 mask = m_decoder.decode(frames[i], local.values);
+                if (!mask) {
+                    continue;
+                }
+                decoded++;
+                if (mask & (1u << SpeedSignal)) {
+                    const qint64 stamp = frameStampNs(msgs[i].msg_hdr);
+                    local.values[SpeedSignal] = filterSpeed(local.values[SpeedSignal],
+                                                            stamp ? stamp : now);
+                }
+                for (int id = 0; id < SignalCount; ++id) {
+                    if (!(mask & (1u << id))) {
+                        continue;
+                    }
+                    local.updatedNs[id] = now;
+                    if (m_telemetry) {
+                        m_telemetry->publish(kTelemetrySignal[id], local.values[id], now);
+                    }
+                    if (m_decoder.isDiscrete(SignalId(id)) && local.values[id] != before[id]) {
+                        discreteChange = true;
+                    }
+                }
+            }
+            local.sequence++;
+
+            {
+                QMutexLocker locker(&m_mutex);
+                m_state = local;
+                m_counters.frames += quint64(count);
+                m_counters.batches++;
+                m_counters.decoded += decoded;
+            }
+
+            if (discreteChange) {
+                emit discreteChanged();
+            }
+            if (count < kBatch) {
+                break;      // drained
+            }
+        }
+    }
+}
+
+} // namespace vehicle
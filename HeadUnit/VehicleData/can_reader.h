@@ -0,0 +1,110 @@
+// can_reader.h
+#ifndef CAN_READER_H
+#define CAN_READER_H
+
+#include <QThread>
+#include <QMutex>
+#include <QString>
+#include <atomic>
+#include "kalman_speed_filter.h"
+#include "signal_decoder.h"
+
+struct can_frame;
+
+namespace telemetry {
+class Writer;
+}
+
+namespace vehicle {
+
+// Latest decoded value of every signal
+struct VehicleState {
+    double values[SignalCount] = {};
+    qint64 updatedNs[SignalCount] = {};     // monotonic receive time, 0 = never
+    quint64 sequence = 0;                   // bumped once per batch
+};
+
+// Reads a SocketCAN interface on its own thread.
+//
+// The socket only passes the table's CAN ids (CAN_RAW_FILTER). The thread
+// sleeps in epoll_wait and drains the socket with recvmmsg, up to kBatch
+// frames per syscall. Each batch is decoded into a private state and copied
+// out under the mutex once, so the reader never waits on a consumer for
+// longer than that copy. A change of a discrete signal (gear, turn signal)
+// is reported right away through discreteChanged().
+//
+// Speed goes through a Kalman filter before it is stored or published; dt
+// comes from the kernel receive timestamp of each frame, so frames that
+// arrive in one batch still get their own spacing.
+class CanReader : public QThread
+{
+    Q_OBJECT
+
+public:
+    struct Counters {
+        quint64 frames = 0;
+        quint64 batches = 0;
+        quint64 decoded = 0;        // frames that carried a table signal
+        quint64 errors = 0;         // read errors
+    };
+
+    // float on the Pi; KalmanSpeedFilter<FixedPoint<>> for FPU-less targets
+    using SpeedFilter = KalmanSpeedFilter<float>;
+
+    static constexpr int kBatch = 32;
+    // Interval of the dashboard script, used when a frame has no timestamp
+    static constexpr qint64 kNominalSpeedDtNs = 50000000;
+    // A longer gap restarts the filter from the next measurement
+    static constexpr qint64 kMaxSpeedDtNs = 500000000;
+
+    explicit CanReader(QObject *parent = nullptr);
+    ~CanReader();
+
+    bool open(const QString &interface);
+    void close();
+    bool isOpen() const { return m_socket >= 0; }
+    QString interfaceName() const { return m_interface; }
+
+    void stop();
+
+    // Copy of the latest state; cheap enough to call at publish rate
+    VehicleState state() const;
+    Counters counters() const;
+
+    // Sent frames come back through the read path once they are on the bus
+    bool send(const can_frame &frame);
+
+    // Every decoded sample is also written to the shared-memory channel.
+    // Set before start().
+    void setTelemetry(telemetry::Writer *writer) { m_telemetry = writer; }
+
+signals:
+    void discreteChanged();
+    void readFailed(const QString &error);
+
+protected:
+    void run() override;
+
+private:
+    double filterSpeed(double measured, qint64 stampNs);
+
+    SignalDecoder m_decoder;
+    int m_socket;
+    int m_epoll;
+    int m_wakeup;                   // eventfd, ends epoll_wait on stop()
+    QString m_interface;
+    std::atomic<bool> m_stopping;
+    telemetry::Writer *m_telemetry;
+
+    // Reader thread only
+    SpeedFilter m_speedFilter;
+    qint64 m_lastSpeedNs;           // 0 = filter not primed
+
+    mutable QMutex m_mutex;
+    VehicleState m_state;
+    Counters m_counters;
+};
+
+} // namespace vehicle
+
+#endif // CAN_READER_H
@@ -0,0 +1,120 @@
+// fixed_point.h
+#ifndef FIXED_POINT_H
+#define FIXED_POINT_H
+
+#include <QtGlobal>
+
+// Signed fixed-point number with FracBits fractional bits in 64-bit storage.
+//
+// Products and quotients keep the full 128-bit intermediate, so Q31.32
+// (the default) keeps about 1e-10 resolution over +/-2e9, enough for
+// filter variances that span dt^4 to 1e4. For targets without an FPU, or
+// where results must be bit-exact across machines. The intermediate is
+// built from 32-bit partial products, as 32-bit ARM has no 128-bit type.
+namespace fixedpoint {
+
+struct Wide {
+    quint64 hi;
+    quint64 lo;
+};
+
+constexpr quint64 magnitude(qint64 value)
+{
+    return value < 0 ? quint64(0) - quint64(value) : quint64(value);
+}
+
+// Full product of two 64-bit magnitudes
+constexpr Wide multiply(quint64 a, quint64 b)
+{
+    const quint64 aLo = a & 0xffffffffu, aHi = a >> 32;
+    const quint64 bLo = b & 0xffffffffu, bHi = b >> 32;
+    const quint64 ll = aLo * bLo;
+    const quint64 lh = aLo * bHi;
+    const quint64 hl = aHi * bLo;
+    const quint64 mid = (ll >> 32) + (lh & 0xffffffffu) + (hl & 0xffffffffu);
+    return { aHi * bHi + (lh >> 32) + (hl >> 32) + (mid >> 32),
+             (mid << 32) | (ll & 0xffffffffu) };
+}
+
+// Low 64 bits of the quotient, remainder dropped; divisor is not zero
+constexpr quint64 divide(Wide n, quint64 d)
+{
+    quint64 rem = n.hi % d;
+    quint64 q = 0;
+    for (int bit = 63; bit >= 0; --bit) {
+        const bool carry = rem >> 63;
+        rem = (rem << 1) | ((n.lo >> bit) & 1);
+        q <<= 1;
+        if (carry || rem >= d) {
+            rem -= d;
+            q |= 1;
+        }
+    }
+    return q;
+}
+
+} // namespace fixedpoint
+
+template <int FracBits = 32>
+class FixedPoint
+{
+    static_assert(FracBits > 0 && FracBits < 62, "FracBits out of range");
+
+public:
+    constexpr FixedPoint() : m_raw(0) {}
+    constexpr explicit FixedPoint(double value)
+        : m_raw(qint64(value * double(qint64(1) << FracBits) + (value < 0 ? -0.5 : 0.5)))
+    {}
+    constexpr explicit FixedPoint(int value) : m_raw(qint64(value) * (qint64(1) << FracBits)) {}
+
+    static constexpr FixedPoint fromRaw(qint64 raw)
+    {
+        FixedPoint value;
+        value.m_raw = raw;
+        return value;
+    }
+
+    constexpr qint64 raw() const { return m_raw; }
+    constexpr double toDouble() const { return double(m_raw) / double(qint64(1) << FracBits); }
+    constexpr explicit operator double() const { return toDouble(); }
+
+    constexpr FixedPoint operator-() const { return fromRaw(-m_raw); }
+    constexpr FixedPoint operator+(FixedPoint other) const { return fromRaw(m_raw + other.m_raw); }
+    constexpr FixedPoint operator-(FixedPoint other) const { return fromRaw(m_raw - other.m_raw); }
+    constexpr FixedPoint operator*(FixedPoint other) const
+    {
+        // Two's complement of the product, then the low word of the shift
+        fixedpoint::Wide p = fixedpoint::multiply(fixedpoint::magnitude(m_raw),
+                                                  fixedpoint::magnitude(other.m_raw));
+        if ((m_raw < 0) != (other.m_raw < 0)) {
+            p.lo = quint64(0) - p.lo;
+            p.hi = ~p.hi + (p.lo == 0 ? 1 : 0);
+        }
+        return fromRaw(qint64((p.lo >> FracBits) | (p.hi << (64 - FracBits))));
+    }
+    constexpr FixedPoint operator/(FixedPoint other) const
+    {
+        // Truncates toward zero, like the integer division it replaces
+        const quint64 n = fixedpoint::magnitude(m_raw);
+        const quint64 q = fixedpoint::divide({ n >> (64 - FracBits), n << FracBits },
+                                             fixedpoint::magnitude(other.m_raw));
+        return fromRaw(qint64((m_raw < 0) != (other.m_raw < 0) ? quint64(0) - q : q));
+    }
+
+    FixedPoint &operator+=(FixedPoint other) { m_raw += other.m_raw; return *this; }
+    FixedPoint &operator-=(FixedPoint other) { m_raw -= other.m_raw; return *this; }
+    FixedPoint &operator*=(FixedPoint other) { return *this = *this * other; }
+    FixedPoint &operator/=(FixedPoint other) { return *this = *this / other; }
+
+    constexpr bool operator==(FixedPoint other) const { return m_raw == other.m_raw; }
+    constexpr bool operator!=(FixedPoint other) const { return m_raw != other.m_raw; }
+    constexpr bool operator<(FixedPoint other) const { return m_raw < other.m_raw; }
+    constexpr bool operator>(FixedPoint other) const { return m_raw > other.m_raw; }
+    constexpr bool operator<=(FixedPoint other) const { return m_raw <= other.m_raw; }
+    constexpr bool operator>=(FixedPoint other) const { return m_raw >= other.m_raw; }
+
+private:
+    qint64 m_raw;
+};
+
+#endif // FIXED_POINT_H
@@ -0,0 +1,89 @@
+// kalman_speed_filter.h
+#ifndef KALMAN_SPEED_FILTER_H
+#define KALMAN_SPEED_FILTER_H
+
+// Constant-acceleration Kalman filter for a speed measurement.
+//
+// State is [speed, acceleration], the measurement is speed. This is the
+// filter of Dashboard_Service_HeadUnit_IC.py with the 2x2 matrix products
+// written out: the covariance is kept as its three distinct terms and the
+// 1x1 innovation needs a division, not an inverse. No allocation, and dt
+// may change on every update.
+//
+// Scalar is float, double or FixedPoint<>: anything with + - * /,
+// comparisons and construction from double.
+template <typename T>
+class KalmanSpeedFilter
+{
+public:
+    using Scalar = T;
+
+    explicit KalmanSpeedFilter(Scalar processVar = Scalar(4.0),
+                               Scalar measVar = Scalar(3.0),
+                               Scalar initialVar = Scalar(100.0))
+        : m_processVar(processVar)
+        , m_measVar(measVar)
+        , m_initialVar(initialVar)
+    {
+        reset();
+    }
+
+    void reset()
+    {
+        m_speed = Scalar(0.0);
+        m_accel = Scalar(0.0);
+        m_p00 = m_initialVar;
+        m_p01 = Scalar(0.0);
+        m_p11 = m_initialVar;
+    }
+
+    // Feeds one measurement taken dt seconds after the previous one and
+    // returns the filtered speed, clamped at 0
+    Scalar update(Scalar measured, Scalar dt)
+    {
+        // Predict: x = F x, P = F P F' + Q with F = [1 dt; 0 1] and
+        // Q = q [dt^4/4 dt^3/2; dt^3/2 dt^2]
+        const Scalar dt2 = dt * dt;
+        const Scalar qdt2 = m_processVar * dt2;
+
+        m_speed += dt * m_accel;
+        m_p00 += dt * (m_p01 + m_p01) + dt2 * m_p11 + qdt2 * dt2 / Scalar(4.0);
+        m_p01 += dt * m_p11 + qdt2 * dt / Scalar(2.0);
+        m_p11 += qdt2;
+
+        // Update with H = [1 0]: S = P00 + R, K = [P00 P01]' / S
+        const Scalar innovation = measured - m_speed;
+        const Scalar s = m_p00 + m_measVar;
+        const Scalar k0 = m_p00 / s;
+        const Scalar k1 = m_p01 / s;
+
+        m_speed += k0 * innovation;
+        m_accel += k1 * innovation;
+
+        // P = (I - K H) P
+        m_p11 -= k1 * m_p01;
+        m_p01 -= k0 * m_p01;
+        m_p00 -= k0 * m_p00;
+
+        if (m_speed < Scalar(0.0)) {
+            m_speed = Scalar(0.0);
+        }
+        return m_speed;
+    }
+
+    Scalar speed() const { return m_speed; }
+    Scalar acceleration() const { return m_accel; }
+
+private:
+    Scalar m_processVar;
+    Scalar m_measVar;
+    Scalar m_initialVar;
+
+    Scalar m_speed;
+    Scalar m_accel;
+    Scalar m_p00;       // covariance, symmetric
+    Scalar m_p01;
+    Scalar m_p11;
+};
+
+#endif // KALMAN_SPEED_FILTER_H
@@ -0,0 +1,60 @@
+// main.cpp (vehicle data daemon)
+#include "vehicle_data_service.h"
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QDebug>
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    app.setApplicationName("headunit-vehicledata");
+    app.setOrganizationName("HeadUnit");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("HeadUnit vehicle data service (SocketCAN)");
+    parser.addHelpOption();
+    QCommandLineOption canOption("can", "CAN interface (can0, vcan0, ... or auto)", "iface", "auto");
+    QCommandLineOption rateOption("rate", "Speed publish rate in Hz", "hz");
+    QCommandLineOption batteryOption("battery", "INA219 i2c device, recorded trace file or none", "source");
+    parser.addOption(canOption);
+    parser.addOption(rateOption);
+    parser.addOption(batteryOption);
+    parser.process(app);
+
+    // Same lookup order as the Python dashboard service
+    QStringList interfaces;
+    const QString envInterface = qEnvironmentVariable("CAN_IFACE");
+    if (!envInterface.isEmpty()) {
+        interfaces << envInterface;
+    }
+    if (parser.value(canOption) != "auto") {
+        interfaces << parser.value(canOption);
+    }
+    interfaces << "can0" << "can1";
+    interfaces.removeDuplicates();
+
+    bool ok = false;
+    int publishHz = parser.value(rateOption).toInt(&ok);
+    if (!ok) {
+        publishHz = qEnvironmentVariableIntValue("HEADUNIT_VEHICLE_PUBLISH_HZ", &ok);
+    }
+    if (!ok || publishHz <= 0) {
+        publishHz = 20;
+    }
+
+    QString batterySource = parser.value(batteryOption);
+    if (batterySource.isEmpty()) {
+        batterySource = qEnvironmentVariable("HEADUNIT_BATTERY_SOURCE", "/dev/i2c-1");
+    }
+
+    qInfo() << "================================================";
+    qInfo() << " HeadUnit Vehicle Data Service";
+    qInfo() << "================================================";
+
+    VehicleDataService service(interfaces, publishHz, batterySource);
+
+    qInfo() << "[VehicleData] Service name: com.headunit.VehicleData";
+    qInfo() << "[VehicleData] Object path: /com/headunit/VehicleData";
+
+    return app.exec();
+}
@@ -0,0 +1,195 @@
+// power_sensor.cpp
+#include "power_sensor.h"
+#include <QDebug>
+#include <QFile>
+#include <QTextStream>
+#include <cerrno>
+#include <cmath>
+#include <cstring>
+#include <fcntl.h>
+#include <linux/i2c.h>
+#include <linux/i2c-dev.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+
+namespace vehicle {
+
+namespace {
+
+// INA219 registers
+constexpr quint8 kConfigRegister = 0x00;
+constexpr quint8 kShuntRegister = 0x01;
+constexpr quint8 kBusRegister = 0x02;
+
+// 32 V range, +/-320 mV shunt range, 8-sample averaging on both ADCs
+// (4.26 ms per conversion, inside a 10 ms sample period), continuous
+constexpr quint16 kConfig = (1 << 13) | (3 << 11) | (0xB << 7) | (0xB << 3) | 0x7;
+
+constexpr double kShuntLsbV = 10e-6;
+constexpr double kBusLsbV = 4e-3;
+
+} // namespace
+
+// ============================================================================
+// Ina219Sensor Implementation
+// ============================================================================
+
+Ina219Sensor::Ina219Sensor(const QString &device, int address, double shuntOhm)
+    : m_device(device)
+    , m_address(address)
+    , m_shuntOhm(shuntOhm)
+    , m_fd(-1)
+{
+}
+
+Ina219Sensor::~Ina219Sensor()
+{
+    if (m_fd >= 0) {
+        ::close(m_fd);
+    }
+}
+
+QString Ina219Sensor::name() const
+{
+    return QStringLiteral("INA219 %1@0x%2").arg(m_device).arg(m_address, 0, 16);
+}
+
+bool Ina219Sensor::open()
+{
+    m_fd = ::open(m_device.toLocal8Bit().constData(), O_RDWR | O_CLOEXEC);
+    if (m_fd < 0) {
+        qWarning() << "[Battery] Cannot open" << m_device << ":" << strerror(errno);
+        return false;
+    }
+    if (ioctl(m_fd, I2C_SLAVE, m_address) < 0 || !writeRegister(kConfigRegister, kConfig)) {
+        qWarning() << "[Battery] No INA219 at" << Qt::hex << m_address << "on" << m_device
+                   << ":" << strerror(errno);
+        ::close(m_fd);
+        m_fd = -1;
+        return false;
+    }
+    return true;
+}
+
+bool Ina219Sensor::writeRegister(quint8 reg, quint16 value)
+{
+    const quint8 buffer[3] = { reg, quint8(value >> 8), quint8(value) };
+    return ::write(m_fd, buffer, sizeof(buffer)) == ssize_t(sizeof(buffer));
+}
+
+bool Ina219Sensor::readRegister(quint8 reg, quint16 *value)
+{
+    // Pointer write and read in one transaction (repeated start)
+    quint8 buffer[2];
+    i2c_msg messages[2];
+    messages[0].addr = quint16(m_address);
+    messages[0].flags = 0;
+    messages[0].len = 1;
+    messages[0].buf = &reg;
+    messages[1].addr = quint16(m_address);
+    messages[1].flags = I2C_M_RD;
+    messages[1].len = sizeof(buffer);
+    messages[1].buf = buffer;
+
+    i2c_rdwr_ioctl_data transfer;
+    transfer.msgs = messages;
+    transfer.nmsgs = 2;
+    if (ioctl(m_fd, I2C_RDWR, &transfer) < 0) {
+        return false;
+    }
+    *value = quint16((buffer[0] << 8) | buffer[1]);
+    return true;
+}
+
+bool Ina219Sensor::read(PowerSample *sample)
+{
+    quint16 bus;
+    quint16 shunt;
+    if (m_fd < 0 || !readRegister(kBusRegister, &bus) || !readRegister(kShuntRegister, &shunt)) {
+        return false;
+    }
+    sample->voltage = (bus >> 3) * kBusLsbV;
+    sample->current = qint16(shunt) * kShuntLsbV / m_shuntOhm;
+    return true;
+}
+
+// ============================================================================
+// TraceSensor Implementation
+// ============================================================================
+
+TraceSensor::TraceSensor(const QString &fileName, double periodS)
+    : m_fileName(fileName)
+    , m_periodS(periodS)
+    , m_samples(0)
+    , m_row(0)
+{
+}
+
+QString TraceSensor::name() const
+{
+    return QStringLiteral("trace %1").arg(m_fileName);
+}
+
+bool TraceSensor::open()
+{
+    QFile file(m_fileName);
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        qWarning() << "[Battery] Cannot open" << m_fileName << ":" << file.errorString();
+        return false;
+    }
+
+    m_rows.clear();
+    QTextStream in(&file);
+    while (!in.atEnd()) {
+        const QString line = in.readLine().trimmed();
+        if (line.isEmpty() || line.startsWith('#')) {
+            continue;
+        }
+        const QStringList fields = line.split(',');
+        bool okTime = false;
+        bool okVoltage = false;
+        bool okCurrent = false;
+        Row row;
+        if (fields.size() >= 3) {
+            row.timeS = fields[0].toDouble(&okTime);
+            row.sample.voltage = fields[1].toDouble(&okVoltage);
+            row.sample.current = fields[2].toDouble(&okCurrent);
+        }
+        if (!okTime || !okVoltage || !okCurrent || (!m_rows.isEmpty() && row.timeS < m_rows.last().timeS)) {
+            qWarning() << "[Battery] Skipping trace line:" << line;
+            continue;
+        }
+        m_rows.append(row);
+    }
+
+    m_samples = 0;
+    m_row = 0;
+    if (m_rows.isEmpty()) {
+        qWarning() << "[Battery] No samples in" << m_fileName;
+        return false;
+    }
+    return true;
+}
+
+bool TraceSensor::read(PowerSample *sample)
+{
+    if (m_rows.isEmpty()) {
+        return false;
+    }
+
+    const double start = m_rows.first().timeS;
+    const double span = m_rows.last().timeS - start + m_periodS;
+    const double t = start + std::fmod(m_samples * m_periodS, span);
+    if (m_row > 0 && t < m_rows[m_row].timeS) {
+        m_row = 0;      // looped
+    }
+    while (m_row + 1 < m_rows.size() && m_rows[m_row + 1].timeS <= t) {
+        m_row++;
+    }
+
+    *sample = m_rows[m_row].sample;
+    m_samples++;
+    return true;
+}
+
+} // namespace vehicle
@@ -0,0 +1,81 @@
+// power_sensor.h
+#ifndef POWER_SENSOR_H
+#define POWER_SENSOR_H
+
+#include <QString>
+#include <QVector>
+
+namespace vehicle {
+
+struct PowerSample {
+    double voltage = 0.0;       // bus voltage, V
+    double current = 0.0;       // A, > 0 discharging
+};
+
+// Source of pack voltage and current for the battery monitor
+class PowerSensor
+{
+public:
+    virtual ~PowerSensor() = default;
+
+    virtual bool open() = 0;
+    // Called once per sample period from the monitor thread
+    virtual bool read(PowerSample *sample) = 0;
+    virtual QString name() const = 0;
+};
+
+// INA219 on the PiRacer's battery board, read through i2c-dev.
+//
+// Bus voltage and shunt voltage registers are read directly (current =
+// shunt voltage / shunt resistance), so the calibration register the
+// Python driver programs does not matter.
+class Ina219Sensor : public PowerSensor
+{
+public:
+    Ina219Sensor(const QString &device, int address, double shuntOhm);
+    ~Ina219Sensor() override;
+
+    bool open() override;
+    bool read(PowerSample *sample) override;
+    QString name() const override;
+
+private:
+    bool readRegister(quint8 reg, quint16 *value);
+    bool writeRegister(quint8 reg, quint16 value);
+
+    QString m_device;
+    int m_address;
+    double m_shuntOhm;
+    int m_fd;
+};
+
+// Recorded INA219 trace as a stand-in for the sensor.
+//
+// CSV lines "seconds,volts,amps" ('#' comments); the row that is current at
+// sample n * period is returned, so a replay only depends on the file and
+// the period, not on timing. The trace loops.
+class TraceSensor : public PowerSensor
+{
+public:
+    TraceSensor(const QString &fileName, double periodS);
+
+    bool open() override;
+    bool read(PowerSample *sample) override;
+    QString name() const override;
+
+private:
+    struct Row {
+        double timeS;
+        PowerSample sample;
+    };
+
+    QString m_fileName;
+    double m_periodS;
+    QVector<Row> m_rows;
+    quint64 m_samples;
+    int m_row;
+};
+
+} // namespace vehicle
+
+#endif // POWER_SENSOR_H
@@ -0,0 +1,111 @@
+// signal_decoder.cpp
+#include "signal_decoder.h"
+#include <algorithm>
+#include <linux/can.h>
+
+namespace vehicle {
+
+const SignalSpec kSignalTable[] = {
+    //  id           canId  start len  bigEnd signed factor offset discrete
+    { SpeedSignal,   0x100,  7,   16,  true,  false, 1.0,   0.0,   false },
+    { GearSignal,    0x102,  0,   8,   false, false, 1.0,   0.0,   true  },
+    { TurnSignal,    0x103,  0,   8,   false, false, 1.0,   0.0,   true  },
+};
+const int kSignalTableSize = int(sizeof(kSignalTable) / sizeof(kSignalTable[0]));
+
+SignalDecoder::SignalDecoder(const SignalSpec *specs, int count)
+    : m_discrete(0)
+{
+    m_specs.reserve(count);
+    for (int i = 0; i < count; ++i) {
+        m_specs.append(specs[i]);
+        if (specs[i].discrete) {
+            m_discrete |= 1u << specs[i].id;
+        }
+    }
+    std::stable_sort(m_specs.begin(), m_specs.end(),
+                     [](const SignalSpec &a, const SignalSpec &b) { return a.canId < b.canId; });
+
+    for (int i = 0; i < m_specs.size(); ++i) {
+        if (m_index.isEmpty() || m_index.last().canId != m_specs[i].canId) {
+            Entry entry;
+            entry.canId = m_specs[i].canId;
+            entry.first = i;
+            entry.count = 0;
+            m_index.append(entry);
+        }
+        m_index.last().count++;
+    }
+}
+
+QVector<quint32> SignalDecoder::canIds() const
+{
+    QVector<quint32> ids;
+    for (const Entry &entry : m_index) {
+        ids.append(entry.canId);
+    }
+    return ids;
+}
+
+bool SignalDecoder::extract(const SignalSpec &spec, const quint8 *data, int len, quint64 *raw)
+{
+    quint64 value = 0;
+
+    if (spec.bigEndian) {
+        // Motorola: start at the MSB, walk down each byte, then on to the
+        // MSB of the next byte
+        int bit = spec.startBit;
+        for (int i = 0; i < spec.length; ++i) {
+            const int byte = bit / 8;
+            if (byte >= len) {
+                return false;
+            }
+            value = (value << 1) | ((data[byte] >> (bit % 8)) & 1u);
+            bit = (bit % 8 == 0) ? bit + 15 : bit - 1;
+        }
+    } else {
+        if ((spec.startBit + spec.length + 7) / 8 > len) {
+            return false;
+        }
+        for (int i = spec.length - 1; i >= 0; --i) {
+            const int bit = spec.startBit + i;
+            value = (value << 1) | ((data[bit / 8] >> (bit % 8)) & 1u);
+        }
+    }
+
+    *raw = value;
+    return true;
+}
+
+quint32 SignalDecoder::decode(const can_frame &frame, double *values) const
+{
+    const quint32 canId = frame.can_id & CAN_EFF_MASK;
+    const auto it = std::lower_bound(m_index.cbegin(), m_index.cend(), canId,
+                                     [](const Entry &entry, quint32 id) { return entry.canId < id; });
+    if (it == m_index.cend() || it->canId != canId) {
+        return 0;
+    }
+
+    quint32 updated = 0;
+    for (int i = it->first; i < it->first + it->count; ++i) {
+        const SignalSpec &spec = m_specs[i];
+        quint64 raw = 0;
+        if (!extract(spec, frame.data, frame.can_dlc, &raw)) {
+            continue;   // frame shorter than the signal
+        }
+
+        double physical;
+        if (spec.isSigned && spec.length < 64 && (raw & (quint64(1) << (spec.length - 1)))) {
+            physical = double(qint64(raw | (~quint64(0) << spec.length)));
+        } else if (spec.isSigned) {
+            physical = double(qint64(raw));
+        } else {
+            physical = double(raw);
+        }
+        values[spec.id] = physical * spec.factor + spec.offset;
+        updated |= 1u << spec.id;
+    }
+    return updated;
+}
+
+} // namespace vehicle
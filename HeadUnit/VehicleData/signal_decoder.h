@@ -0,0 +1,72 @@
+// signal_decoder.h
+#ifndef SIGNAL_DECODER_H
+#define SIGNAL_DECODER_H
+
+#include <QtGlobal>
+#include <QVector>
+
+struct can_frame;
+
+namespace vehicle {
+
+enum SignalId {
+    SpeedSignal = 0,        // cm/s
+    GearSignal,             // ASCII P/R/N/D, 0 = P
+    TurnSignal,             // 0 off, 1 left, 2 right, 3 hazard
+    BatterySignal,          // percent, from the battery monitor, not on CAN
+    SignalCount
+};
+
+// One signal in a CAN frame, as a DBC file would describe it:
+// physical = raw * factor + offset
+struct SignalSpec {
+    SignalId id;
+    quint32 canId;
+    quint8 startBit;        // DBC numbering: LSB (Intel) or MSB (Motorola)
+    quint8 length;          // bits, 1..64
+    bool bigEndian;         // Motorola byte order
+    bool isSigned;
+    double factor;
+    double offset;
+    bool discrete;          // state, published on change rather than at rate
+};
+
+// The vehicle's CAN matrix (see Dashboard_Service_HeadUnit_IC.py)
+extern const SignalSpec kSignalTable[];
+extern const int kSignalTableSize;
+
+// Decodes frames through a signal table.
+//
+// Frames are looked up by CAN id in a small sorted index, so adding a signal
+// is a table entry rather than code. No allocation per frame.
+class SignalDecoder
+{
+public:
+    SignalDecoder(const SignalSpec *specs, int count);
+
+    // Writes the physical value of every signal carried by the frame into
+    // values[id]; returns a mask of (1 << id) for the signals updated
+    quint32 decode(const can_frame &frame, double *values) const;
+
+    // CAN ids in the table, e.g. for CAN_RAW_FILTER
+    QVector<quint32> canIds() const;
+
+    bool isDiscrete(SignalId id) const { return m_discrete & (1u << id); }
+
+    static bool extract(const SignalSpec &spec, const quint8 *data, int len, quint64 *raw);
+
+private:
+    struct Entry {
+        quint32 canId;
+        int first;          // index into m_specs
+        int count;
+    };
+
+    QVector<SignalSpec> m_specs;    // sorted by canId
+    QVector<Entry> m_index;
+    quint32 m_discrete;
+};
+
+} // namespace vehicle
+
+#endif // SIGNAL_DECODER_H
@@ -0,0 +1,83 @@
+// soc_estimator.cpp
+#include "soc_estimator.h"
+#include <cmath>
+
+namespace vehicle {
+
+namespace {
+
+// Resting cell voltage at 0%, 10%, ... 100% (typical 18650)
+const double kOcvCurve[] = {
+    3.00, 3.45, 3.55, 3.62, 3.68, 3.74, 3.80, 3.87, 3.95, 4.05, 4.20,
+};
+constexpr int kOcvPoints = sizeof(kOcvCurve) / sizeof(kOcvCurve[0]);
+
+// Voltage based SoC is good to about 5% at rest, and worth a lot less under
+// load, when R is only a rough value
+constexpr double kRestVariance = 0.05 * 0.05;
+constexpr double kLoadVariancePerAmp = 0.25;
+
+// Current sensor gain error, relative
+constexpr double kCurrentError = 0.05;
+
+} // namespace
+
+SocEstimator::SocEstimator()
+    : SocEstimator(Params())
+{
+}
+
+SocEstimator::SocEstimator(const Params &params)
+    : m_params(params)
+    , m_initialized(false)
+    , m_soc(0.0)
+    , m_variance(1.0)
+{
+}
+
+void SocEstimator::reset()
+{
+    m_initialized = false;
+    m_soc = 0.0;
+    m_variance = 1.0;
+}
+
+double SocEstimator::socFromCellVoltage(double cellVoltage)
+{
+    if (cellVoltage <= kOcvCurve[0]) {
+        return 0.0;
+    }
+    for (int i = 1; i < kOcvPoints; ++i) {
+        if (cellVoltage < kOcvCurve[i]) {
+            const double fraction = (cellVoltage - kOcvCurve[i - 1]) / (kOcvCurve[i] - kOcvCurve[i - 1]);
+            return (i - 1 + fraction) / (kOcvPoints - 1);
+        }
+    }
+    return 1.0;
+}
+
+void SocEstimator::step(double voltage, double current, double dt)
+{
+    const double ocvSoc = socFromCellVoltage((voltage + current * m_params.resistanceOhm) / m_params.cells);
+    if (!m_initialized) {
+        m_soc = ocvSoc;
+        m_variance = kRestVariance + kLoadVariancePerAmp * std::fabs(current);
+        m_initialized = true;
+        return;
+    }
+
+    // Predict: coulomb counting
+    const double delta = current * dt / (m_params.capacityAh * 3600.0);
+    m_soc -= delta;
+    m_variance += delta * kCurrentError * delta * kCurrentError + 1e-10;
+
+    // Correct with the OCV estimate
+    const double measurementVariance = kRestVariance + kLoadVariancePerAmp * std::fabs(current);
+    const double gain = m_variance / (m_variance + measurementVariance);
+    m_soc += gain * (ocvSoc - m_soc);
+    m_variance *= 1.0 - gain;
+
+    m_soc = qBound(0.0, m_soc, 1.0);
+}
+
+} // namespace vehicle
@@ -0,0 +1,50 @@
+// soc_estimator.h
+#ifndef SOC_ESTIMATOR_H
+#define SOC_ESTIMATOR_H
+
+#include <QtGlobal>
+
+namespace vehicle {
+
+// Battery state of charge from pack voltage and current.
+//
+// Coulomb counting carries the estimate from step to step; the open circuit
+// voltage (terminal voltage plus the I*R drop) read through the cell's OCV
+// curve corrects its drift. Both are fused by a one-state Kalman filter
+// whose measurement noise grows with the current, so the voltage mostly
+// counts at rest and load sag does not move the estimate. Fixed step, no
+// allocation; a step is a table lookup and a few multiplications.
+class SocEstimator
+{
+public:
+    struct Params {
+        int cells = 3;                  // in series
+        double capacityAh = 2.6;
+        double resistanceOhm = 0.15;    // pack internal resistance
+    };
+
+    SocEstimator();
+    explicit SocEstimator(const Params &params);
+
+    // current > 0 discharges
+    void step(double voltage, double current, double dt);
+    void reset();
+
+    bool isValid() const { return m_initialized; }
+    double soc() const { return m_soc; }            // 0..1
+    double remainingAh() const { return m_soc * m_params.capacityAh; }
+    const Params &params() const { return m_params; }
+
+    // Li-ion cell OCV curve, inverted: cell volts -> 0..1
+    static double socFromCellVoltage(double cellVoltage);
+
+private:
+    Params m_params;
+    bool m_initialized;
+    double m_soc;
+    double m_variance;
+};
+
+} // namespace vehicle
+
+#endif // SOC_ESTIMATOR_H
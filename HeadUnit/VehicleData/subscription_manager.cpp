@@ -0,0 +1,227 @@
+// subscription_manager.cpp
+#include "subscription_manager.h"
+#include <QDBusConnection>
+#include <QDBusMessage>
+#include <QDBusServiceWatcher>
+#include <QDBusVariant>
+#include <QDebug>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace vehicle {
+
+namespace {
+
+struct SignalInfo {
+    const char *member;
+    bool discrete;
+    double low;     // range of continuous values; reaching a limit is always sent
+    double high;
+};
+
+constexpr double kUnbounded = std::numeric_limits<double>::infinity();
+
+// Indexed by SignalId; members match the broadcast signals
+const SignalInfo kSignals[SignalCount] = {
+    { "SpeedChanged", false, 0.0, kUnbounded },
+    { "GearChanged", true, 0.0, 0.0 },
+    { "TurnSignalChanged", true, 0.0, 0.0 },
+    { "BatteryChanged", false, 0.0, 100.0 },
+};
+
+// Settling time of subscriptions without a rate limit
+constexpr qint64 kMinSettleNs = 100000000;
+
+} // namespace
+
+SubscriptionManager::SubscriptionManager(const QString &path, const QString &interface, QObject *parent)
+    : QObject(parent)
+    , m_path(path)
+    , m_interface(interface)
+    , m_watcher(new QDBusServiceWatcher(QString(), QDBusConnection::sessionBus(),
+                                        QDBusServiceWatcher::WatchForUnregistration, this))
+{
+    m_clock.start();
+
+    connect(m_watcher, &QDBusServiceWatcher::serviceUnregistered,
+            this, &SubscriptionManager::removeClient);
+
+    m_flushTimer.setSingleShot(true);
+    m_flushTimer.setTimerType(Qt::PreciseTimer);
+    connect(&m_flushTimer, &QTimer::timeout, this, &SubscriptionManager::flushPending);
+}
+
+SignalId SubscriptionManager::signalForMember(const QString &member)
+{
+    for (int id = 0; id < SignalCount; ++id) {
+        if (member == QLatin1String(kSignals[id].member)) {
+            return SignalId(id);
+        }
+    }
+    return SignalCount;
+}
+
+void SubscriptionManager::subscribe(const QString &client, SignalId signal, double maxRateHz,
+                                    double deadband, const QVariant &current)
+{
+    unsubscribe(client, signal);
+
+    Subscription subscription;
+    subscription.client = client;
+    subscription.signal = signal;
+    subscription.intervalNs = maxRateHz > 0 ? qint64(1e9 / maxRateHz) : 0;
+    subscription.deadband = kSignals[signal].discrete ? 0.0 : qMax(0.0, deadband);
+    subscription.lastSentNs = m_clock.nsecsElapsed() - subscription.intervalNs;
+    m_subscriptions.append(subscription);
+    m_watcher->addWatchedService(client);
+
+    qInfo() << "[Subscriptions]" << client << "->" << kSignals[signal].member
+            << "max" << maxRateHz << "Hz, deadband" << subscription.deadband;
+
+    if (current.isValid()) {
+        deliver(m_subscriptions.last(), current, m_clock.nsecsElapsed());
+    }
+}
+
+bool SubscriptionManager::unsubscribe(const QString &client, SignalId signal)
+{
+    const qsizetype removed = m_subscriptions.removeIf([&](const Subscription &subscription) {
+        return subscription.client == client && subscription.signal == signal;
+    });
+    const bool stillSubscribed = std::any_of(m_subscriptions.cbegin(), m_subscriptions.cend(),
+                                             [&](const Subscription &subscription) {
+        return subscription.client == client;
+    });
+    if (!stillSubscribed) {
+        m_watcher->removeWatchedService(client);
+    }
+    return removed > 0;
+}
+
+void SubscriptionManager::removeClient(const QString &client)
+{
+    const qsizetype removed = m_subscriptions.removeIf([&](const Subscription &subscription) {
+        return subscription.client == client;
+    });
+    m_watcher->removeWatchedService(client);
+    if (removed > 0) {
+        qInfo() << "[Subscriptions]" << client << "left, dropped" << removed << "subscriptions";
+    }
+}
+
+bool SubscriptionManager::qualifies(const Subscription &subscription, const QVariant &value) const
+{
+    if (!subscription.lastValue.isValid()) {
+        return true;
+    }
+    const SignalInfo &info = kSignals[subscription.signal];
+    if (info.discrete) {
+        return value != subscription.lastValue;
+    }
+    const double current = value.toDouble();
+    const double last = subscription.lastValue.toDouble();
+    if ((current <= info.low || current >= info.high) && current != last) {
+        return true;
+    }
+    return std::fabs(current - last) > subscription.deadband;
+}
+
+void SubscriptionManager::hold(Subscription &subscription, const QVariant &value, qint64 dueNs)
+{
+    if (subscription.pending) {
+        m_counters.coalesced++;
+    }
+    subscription.pending = true;
+    subscription.pendingValue = value;
+    subscription.dueNs = dueNs;
+}
+
+void SubscriptionManager::offer(SignalId signal, const QVariant &value)
+{
+    const qint64 now = m_clock.nsecsElapsed();
+    bool held = false;
+
+    for (Subscription &subscription : m_subscriptions) {
+        if (subscription.signal != signal) {
+            continue;
+        }
+        m_counters.offered++;
+
+        if (!qualifies(subscription, value)) {
+            if (value == subscription.lastValue) {
+                // Back at what the client has: nothing left to send
+                subscription.pending = false;
+                m_counters.suppressed++;
+            } else if (!subscription.pending || subscription.pendingValue != value) {
+                // Inside the deadband: sent if the signal stays here, every
+                // further change restarts the wait
+                hold(subscription, value, now + qMax(subscription.intervalNs, kMinSettleNs));
+                held = true;
+            }
+            continue;
+        }
+        if (now - subscription.lastSentNs >= subscription.intervalNs) {
+            subscription.pending = false;
+            deliver(subscription, value, now);
+            continue;
+        }
+
+        hold(subscription, value, subscription.lastSentNs + subscription.intervalNs);
+        held = true;
+    }
+
+    if (held) {
+        armFlushTimer(now);
+    }
+}
+
+void SubscriptionManager::deliver(Subscription &subscription, const QVariant &value, qint64 now)
+{
+    QDBusMessage message = QDBusMessage::createTargetedSignal(subscription.client, m_path,
+                                                              m_interface, QStringLiteral("Updated"));
+    message << QString::fromLatin1(kSignals[subscription.signal].member)
+            << QVariant::fromValue(QDBusVariant(value));
+    QDBusConnection::sessionBus().send(message);
+
+    subscription.lastValue = value;
+    subscription.lastSentNs = now;
+    m_counters.delivered++;
+}
+
+void SubscriptionManager::flushPending()
+{
+    const qint64 now = m_clock.nsecsElapsed();
+    for (Subscription &subscription : m_subscriptions) {
+        if (subscription.pending && now >= subscription.dueNs) {
+            subscription.pending = false;
+            deliver(subscription, subscription.pendingValue, now);
+        }
+    }
+    armFlushTimer(now);
+}
+
+void SubscriptionManager::armFlushTimer(qint64 now)
+{
+    qint64 nextNs = -1;
+    for (const Subscription &subscription : std::as_const(m_subscriptions)) {
+        if (!subscription.pending) {
+            continue;
+        }
+        if (nextNs < 0 || subscription.dueNs < nextNs) {
+            nextNs = subscription.dueNs;
+        }
+    }
+
+    if (nextNs < 0) {
+        m_flushTimer.stop();
+        return;
+    }
+    // Rounded up, so the timer never fires just before the interval is over
+    const int delayMs = int(qMax<qint64>(0, (nextNs - now + 999999) / 1000000));
+    if (!m_flushTimer.isActive() || m_flushTimer.remainingTime() > delayMs) {
+        m_flushTimer.start(delayMs);
+    }
+}
+
+} // namespace vehicle
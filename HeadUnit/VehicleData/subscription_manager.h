@@ -0,0 +1,89 @@
+// subscription_manager.h
+#ifndef SUBSCRIPTION_MANAGER_H
+#define SUBSCRIPTION_MANAGER_H
+
+#include <QObject>
+#include <QElapsedTimer>
+#include <QString>
+#include <QTimer>
+#include <QVariant>
+#include <QVector>
+#include "signal_decoder.h"
+
+class QDBusServiceWatcher;
+
+namespace vehicle {
+
+// Per-client delivery of vehicle signals over D-Bus.
+//
+// A client subscribes to a signal with a maximum rate and a deadband and
+// then receives targeted Updated(signal, value) messages instead of
+// listening to the broadcast. A continuous value is delivered when it moved
+// more than the deadband from the last delivered one or reached a limit of
+// its range (speed 0, battery 0 or 100); discrete values (gear, turn
+// signal) on every change. Inside the rate limit the latest qualifying
+// value is held back and sent when the interval has passed. A change that
+// stays inside the deadband is sent once the signal has settled, i.e. held
+// still for one interval, so the final state always arrives. Subscriptions
+// end with the client's bus connection.
+class SubscriptionManager : public QObject
+{
+    Q_OBJECT
+
+public:
+    struct Counters {
+        quint64 offered = 0;        // value x subscription pairs
+        quint64 delivered = 0;
+        quint64 suppressed = 0;     // same as the last delivered value
+        quint64 coalesced = 0;      // held back value replaced by a newer one
+    };
+
+    SubscriptionManager(const QString &path, const QString &interface, QObject *parent = nullptr);
+
+    // Replaces an existing subscription of the client to the signal and
+    // delivers the current value right away. maxRateHz <= 0: no limit.
+    void subscribe(const QString &client, SignalId signal, double maxRateHz, double deadband,
+                   const QVariant &current);
+    bool unsubscribe(const QString &client, SignalId signal);
+
+    // New value of a signal, from the publish path
+    void offer(SignalId signal, const QVariant &value);
+
+    int subscriptionCount() const { return m_subscriptions.size(); }
+    Counters counters() const { return m_counters; }
+
+    // "SpeedChanged" -> SpeedSignal etc., SignalCount if unknown
+    static SignalId signalForMember(const QString &member);
+
+private:
+    struct Subscription {
+        QString client;             // unique bus name
+        SignalId signal = SpeedSignal;
+        qint64 intervalNs = 0;
+        double deadband = 0.0;
+        QVariant lastValue;         // last delivered
+        qint64 lastSentNs = 0;
+        QVariant pendingValue;
+        qint64 dueNs = 0;           // when the pending value goes out
+        bool pending = false;
+    };
+
+    bool qualifies(const Subscription &subscription, const QVariant &value) const;
+    void hold(Subscription &subscription, const QVariant &value, qint64 dueNs);
+    void deliver(Subscription &subscription, const QVariant &value, qint64 now);
+    void flushPending();
+    void armFlushTimer(qint64 now);
+    void removeClient(const QString &client);
+
+    QString m_path;
+    QString m_interface;
+    QVector<Subscription> m_subscriptions;
+    QDBusServiceWatcher *m_watcher;
+    QElapsedTimer m_clock;
+    QTimer m_flushTimer;
+    Counters m_counters;
+};
+
+} // namespace vehicle
+
+#endif // SUBSCRIPTION_MANAGER_H
@@ -0,0 +1,264 @@
+// can_record.cpp
+//
+// Records a drive into a trace file (see trace_log.h) for can-replay:
+// every frame on a CAN interface plus the vehicle signals on the session
+// bus (native vehicle data service and dashboard script).
+//
+//   can-record --interface can0 drive.hutr
+//
+// Frames carry their kernel receive time, signals the time they reached the
+// recorder, both on the realtime clock. The open block is flushed every
+// second; SIGINT or SIGTERM closes the file.
+#include "../trace_log.h"
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QDBusConnection>
+#include <QDBusMessage>
+#include <QDebug>
+#include <QSet>
+#include <QSocketNotifier>
+#include <QTimer>
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+#include <ctime>
+#include <net/if.h>
+#include <sys/ioctl.h>
+#include <sys/signalfd.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace {
+
+struct VehicleInterface {
+    const char *path;
+    const char *interface;
+};
+
+// Service and interface share the name in both services
+const VehicleInterface kVehicleInterfaces[] = {
+    { "/com/headunit/VehicleData", "com.headunit.VehicleData" },
+    { "/com/piracer/dashboard", "com.piracer.dashboard" },
+};
+
+qint64 realtimeNs()
+{
+    timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    return qint64(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+}
+
+int openSocket(const QString &interface)
+{
+    const int fd = ::socket(PF_CAN, SOCK_RAW | SOCK_NONBLOCK | SOCK_CLOEXEC, CAN_RAW);
+    if (fd < 0) {
+        qCritical() << "socket:" << strerror(errno);
+        return -1;
+    }
+
+    ifreq ifr;
+    memset(&ifr, 0, sizeof(ifr));
+    strncpy(ifr.ifr_name, interface.toLocal8Bit().constData(), IFNAMSIZ - 1);
+    if (ioctl(fd, SIOCGIFINDEX, &ifr) < 0) {
+        qCritical() << "Unknown interface" << interface << ":" << strerror(errno);
+        ::close(fd);
+        return -1;
+    }
+
+    const int timestamps = 1;
+    setsockopt(fd, SOL_SOCKET, SO_TIMESTAMPNS, &timestamps, sizeof(timestamps));
+
+    sockaddr_can addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.can_family = AF_CAN;
+    addr.can_ifindex = ifr.ifr_ifindex;
+    if (bind(fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) < 0) {
+        qCritical() << "bind" << interface << ":" << strerror(errno);
+        ::close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+} // namespace
+
+class Recorder : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit Recorder(trace::Writer *writer, QObject *parent = nullptr)
+        : QObject(parent)
+        , m_writer(writer)
+        , m_socket(-1)
+        , m_frames(0)
+        , m_signals(0)
+    {
+    }
+
+    ~Recorder()
+    {
+        if (m_socket >= 0) {
+            ::close(m_socket);
+        }
+    }
+
+    bool recordCan(const QString &interface)
+    {
+        m_socket = openSocket(interface);
+        if (m_socket < 0) {
+            return false;
+        }
+        auto *notifier = new QSocketNotifier(m_socket, QSocketNotifier::Read, this);
+        connect(notifier, &QSocketNotifier::activated, this, &Recorder::readFrames);
+        return true;
+    }
+
+    bool recordDBus()
+    {
+        QDBusConnection bus = QDBusConnection::sessionBus();
+        if (!bus.isConnected()) {
+            qCritical() << "Cannot connect to the D-Bus session bus";
+            return false;
+        }
+        // Any sender, so recording survives a service restart
+        for (const VehicleInterface &vehicle : kVehicleInterfaces) {
+            bus.connect(QString(), vehicle.path, vehicle.interface, QString(),
+                        this, SLOT(onSignal(QDBusMessage)));
+        }
+        return true;
+    }
+
+    quint64 frames() const { return m_frames; }
+    quint64 signalCount() const { return m_signals; }
+
+private slots:
+    void onSignal(const QDBusMessage &message)
+    {
+        // The vehicle signals carry one argument
+        const QVariant value = message.arguments().value(0);
+        if (m_writer->writeSignal(realtimeNs(), message.path(), message.interface(),
+                                  message.member(), value)) {
+            m_signals++;
+        } else if (!m_skippedMembers.contains(message.member())) {
+            m_skippedMembers.insert(message.member());
+            qWarning() << "Not recording" << message.member() << "- cannot replay a"
+                       << value.typeName() << "argument";
+        }
+    }
+
+private:
+    void readFrames()
+    {
+        can_frame frame;
+        iovec iov = { &frame, sizeof(frame) };
+        union {
+            cmsghdr header;
+            char buffer[CMSG_SPACE(sizeof(timespec))];
+        } control;
+
+        for (;;) {
+            msghdr msg;
+            memset(&msg, 0, sizeof(msg));
+            msg.msg_iov = &iov;
+            msg.msg_iovlen = 1;
+            msg.msg_control = control.buffer;
+            msg.msg_controllen = sizeof(control);
+
+            const ssize_t size = recvmsg(m_socket, &msg, MSG_DONTWAIT);
+            if (size < 0) {
+                if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+                    qWarning() << "recvmsg:" << strerror(errno);
+                }
+                return;
+            }
+            if (size < ssize_t(CAN_MTU)) {
+                continue;
+            }
+
+            qint64 stampNs = 0;
+            for (cmsghdr *cmsg = CMSG_FIRSTHDR(&msg); cmsg; cmsg = CMSG_NXTHDR(&msg, cmsg)) {
+                if (cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_TIMESTAMPNS) {
+                    timespec ts;
+                    memcpy(&ts, CMSG_DATA(cmsg), sizeof(ts));
+                    stampNs = qint64(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+                }
+            }
+            m_writer->writeFrame(stampNs ? stampNs : realtimeNs(), frame);
+            m_frames++;
+        }
+    }
+
+    trace::Writer *m_writer;
+    int m_socket;
+    quint64 m_frames;
+    quint64 m_signals;
+    QSet<QString> m_skippedMembers;     // warned about once
+};
+
+int main(int argc, char *argv[])
+{
+    // Blocked before any thread starts, delivered through a signalfd so the
+    // file is closed from the event loop
+    sigset_t mask;
+    sigemptyset(&mask);
+    sigaddset(&mask, SIGINT);
+    sigaddset(&mask, SIGTERM);
+    pthread_sigmask(SIG_BLOCK, &mask, nullptr);
+
+    QCoreApplication app(argc, argv);
+    app.setApplicationName("can-record");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Record CAN frames and vehicle D-Bus signals into a trace file");
+    parser.addHelpOption();
+    QCommandLineOption interfaceOption({"i", "interface"}, "CAN interface", "iface", "can0");
+    QCommandLineOption noCanOption("no-can", "Do not record CAN frames");
+    QCommandLineOption noDBusOption("no-dbus", "Do not record D-Bus signals");
+    parser.addOption(interfaceOption);
+    parser.addOption(noCanOption);
+    parser.addOption(noDBusOption);
+    parser.addPositionalArgument("trace", "Output file");
+    parser.process(app);
+
+    if (parser.positionalArguments().size() != 1
+        || (parser.isSet(noCanOption) && parser.isSet(noDBusOption))) {
+        parser.showHelp(1);
+    }
+
+    trace::Writer writer;
+    if (!writer.open(parser.positionalArguments().first())) {
+        qCritical() << "Cannot open" << parser.positionalArguments().first() << ":" << writer.errorString();
+        return 1;
+    }
+
+    Recorder recorder(&writer);
+    if (!parser.isSet(noCanOption) && !recorder.recordCan(parser.value(interfaceOption))) {
+        return 1;
+    }
+    if (!parser.isSet(noDBusOption) && !recorder.recordDBus()) {
+        return 1;
+    }
+
+    const int signalFd = signalfd(-1, &mask, SFD_NONBLOCK | SFD_CLOEXEC);
+    QSocketNotifier stopNotifier(signalFd, QSocketNotifier::Read);
+    QObject::connect(&stopNotifier, &QSocketNotifier::activated, &app, &QCoreApplication::quit);
+
+    QTimer flushTimer;
+    QObject::connect(&flushTimer, &QTimer::timeout, &app, [&writer]() { writer.flush(); });
+    flushTimer.start(1000);
+
+    qInfo() << "Recording to" << parser.positionalArguments().first() << "- Ctrl+C to stop";
+    const int result = app.exec();
+
+    writer.close();
+    ::close(signalFd);
+
+    const quint64 records = writer.records();
+    qInfo() << "Recorded" << recorder.frames() << "frames and" << recorder.signalCount() << "signals in"
+            << writer.bytesWritten() << "bytes"
+            << "(" << (records ? double(writer.bytesWritten()) / records : 0.0) << "bytes/record )";
+    return result;
+}
+
+#include "can_record.moc"
@@ -0,0 +1,323 @@
+// can_replay.cpp
+//
+// Replays a candump log (candump -l / -L format) onto a CAN interface:
+//
+//   (1712000000.000000) can0 100#0064
+//
+// or a can-record trace (see trace_log.h), whose D-Bus vehicle signals are
+// emitted on the session bus as a stand-in for the service that sent them.
+// The replayer owns that service name, so the real service must not run
+// while signals are replayed.
+//
+// Frames keep their recorded spacing, scaled by --speed (0 = as fast as the
+// socket takes them). With a vcan interface this drives the vehicle data
+// service without hardware:
+//
+//   can-replay --interface vcan0 --speed 1 drive.log
+//   can-replay --speed 10 --no-can drive.hutr
+#include "../trace_log.h"
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QDBusConnection>
+#include <QDBusConnectionInterface>
+#include <QDBusMessage>
+#include <QFile>
+#include <QSet>
+#include <QTextStream>
+#include <QVector>
+#include <QDebug>
+#include <cerrno>
+#include <cstring>
+#include <ctime>
+#include <net/if.h>
+#include <poll.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace {
+
+bool parseLine(const QString &line, trace::Record *out)
+{
+    // "(sec.usec) iface id#data"
+    const QStringList parts = line.split(' ', Qt::SkipEmptyParts);
+    if (parts.size() < 3 || !parts[0].startsWith('(') || !parts[0].endsWith(')')) {
+        return false;
+    }
+
+    const QString stamp = parts[0].mid(1, parts[0].size() - 2);
+    const QStringList secUsec = stamp.split('.');
+    if (secUsec.size() != 2) {
+        return false;
+    }
+    out->timestampNs = secUsec[0].toLongLong() * 1000000000LL
+                       + secUsec[1].leftJustified(9, '0').left(9).toLongLong();
+
+    const QStringList idData = parts[2].split('#');
+    if (idData.size() != 2) {
+        return false;
+    }
+
+    bool ok = false;
+    memset(&out->frame, 0, sizeof(out->frame));
+    out->frame.can_id = idData[0].toUInt(&ok, 16);
+    if (!ok) {
+        return false;
+    }
+    if (idData[0].size() > 3) {
+        out->frame.can_id |= CAN_EFF_FLAG;
+    }
+
+    const QString data = idData[1];
+    if (data.startsWith('R')) {
+        out->frame.can_id |= CAN_RTR_FLAG;
+        return true;
+    }
+    if (data.size() % 2 != 0 || data.size() / 2 > CAN_MAX_DLEN) {
+        return false;
+    }
+    out->frame.can_dlc = quint8(data.size() / 2);
+    for (int i = 0; i < out->frame.can_dlc; ++i) {
+        out->frame.data[i] = quint8(data.mid(i * 2, 2).toUInt(&ok, 16));
+        if (!ok) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool loadCandump(const QString &fileName, QVector<trace::Record> *records)
+{
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        qCritical() << "Cannot open" << fileName << ":" << file.errorString();
+        return false;
+    }
+
+    QTextStream in(&file);
+    int lineNumber = 0;
+    while (!in.atEnd()) {
+        const QString line = in.readLine().trimmed();
+        lineNumber++;
+        if (line.isEmpty() || line.startsWith('#')) {
+            continue;
+        }
+        trace::Record record;
+        if (!parseLine(line, &record)) {
+            qWarning() << "Skipping line" << lineNumber << ":" << line;
+            continue;
+        }
+        records->append(record);
+    }
+    return true;
+}
+
+bool loadTrace(const QString &fileName, QVector<trace::Record> *records)
+{
+    trace::Reader reader;
+    if (!reader.open(fileName)) {
+        qCritical() << "Cannot open" << fileName << ":" << reader.errorString();
+        return false;
+    }
+
+    trace::Record record;
+    while (reader.next(&record)) {
+        records->append(record);
+    }
+    // A recorder that was killed leaves a short last block; keep what was read
+    if (!reader.errorString().isEmpty()) {
+        qWarning() << "Trace ends early after" << records->size() << "records:" << reader.errorString();
+    }
+    return true;
+}
+
+int openSocket(const QString &interface)
+{
+    const int fd = ::socket(PF_CAN, SOCK_RAW | SOCK_CLOEXEC, CAN_RAW);
+    if (fd < 0) {
+        qCritical() << "socket:" << strerror(errno);
+        return -1;
+    }
+
+    ifreq ifr;
+    memset(&ifr, 0, sizeof(ifr));
+    strncpy(ifr.ifr_name, interface.toLocal8Bit().constData(), IFNAMSIZ - 1);
+    if (ioctl(fd, SIOCGIFINDEX, &ifr) < 0) {
+        qCritical() << "Unknown interface" << interface << ":" << strerror(errno);
+        ::close(fd);
+        return -1;
+    }
+
+    sockaddr_can addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.can_family = AF_CAN;
+    addr.can_ifindex = ifr.ifr_ifindex;
+    if (bind(fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) < 0) {
+        qCritical() << "bind" << interface << ":" << strerror(errno);
+        ::close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+qint64 monotonicNs()
+{
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return qint64(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+}
+
+void sleepUntil(qint64 deadlineNs)
+{
+    timespec ts;
+    ts.tv_sec = deadlineNs / 1000000000;
+    ts.tv_nsec = deadlineNs % 1000000000;
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, nullptr) == EINTR) {
+    }
+}
+
+// Writes one frame, retrying while the TX queue is full (ENOBUFS at max
+// speed). SocketCAN may poll as writable while the queue is still full, so
+// a ready poll is followed by a short back-off instead of a busy retry.
+bool writeFrame(int fd, const can_frame &frame)
+{
+    for (;;) {
+        if (::write(fd, &frame, sizeof(can_frame)) == ssize_t(sizeof(can_frame))) {
+            return true;
+        }
+        if (errno == ENOBUFS || errno == EAGAIN) {
+            pollfd pfd = { fd, POLLOUT, 0 };
+            if (poll(&pfd, 1, 1) > 0) {
+                usleep(100);
+            }
+        } else if (errno != EINTR) {
+            return false;
+        }
+    }
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    app.setApplicationName("can-replay");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Replay a candump log or trace onto CAN and D-Bus");
+    parser.addHelpOption();
+    QCommandLineOption interfaceOption({"i", "interface"}, "Target interface", "iface", "vcan0");
+    QCommandLineOption speedOption({"s", "speed"}, "Time scale, e.g. 1 or 10; 0 = no delays", "factor", "1");
+    QCommandLineOption loopOption({"l", "loop"}, "Replay until interrupted");
+    QCommandLineOption noCanOption("no-can", "Skip CAN frames");
+    QCommandLineOption noDBusOption("no-dbus", "Skip D-Bus signals of a trace");
+    parser.addOption(interfaceOption);
+    parser.addOption(speedOption);
+    parser.addOption(loopOption);
+    parser.addOption(noCanOption);
+    parser.addOption(noDBusOption);
+    parser.addPositionalArgument("log", "candump log or can-record trace");
+    parser.process(app);
+
+    if (parser.positionalArguments().size() != 1) {
+        parser.showHelp(1);
+    }
+
+    const QString fileName = parser.positionalArguments().first();
+    QVector<trace::Record> records;
+    if (!(trace::Reader::isTrace(fileName) ? loadTrace(fileName, &records)
+                                           : loadCandump(fileName, &records))) {
+        return 1;
+    }
+    if (records.isEmpty()) {
+        qCritical() << "No frames or signals in" << fileName;
+        return 1;
+    }
+
+    int frameCount = 0;
+    QSet<QString> signalServices;
+    for (const trace::Record &record : std::as_const(records)) {
+        if (record.type == trace::FrameRecord) {
+            frameCount++;
+        } else {
+            signalServices.insert(record.interface);
+        }
+    }
+
+    int fd = -1;
+    if (frameCount > 0 && !parser.isSet(noCanOption)) {
+        fd = openSocket(parser.value(interfaceOption));
+        if (fd < 0) {
+            return 1;
+        }
+    }
+
+    // Signals are only emitted under a service name we own
+    QDBusConnection bus = QDBusConnection::sessionBus();
+    QSet<QString> ownedServices;
+    if (!signalServices.isEmpty() && !parser.isSet(noDBusOption)) {
+        if (!bus.isConnected()) {
+            qCritical() << "Cannot connect to the D-Bus session bus";
+            return 1;
+        }
+        for (const QString &service : std::as_const(signalServices)) {
+            if (bus.registerService(service)) {
+                ownedServices.insert(service);
+            } else {
+                qWarning() << service << "is running - its signals are not replayed";
+            }
+        }
+    }
+
+    const double speed = parser.value(speedOption).toDouble();
+    const QString target = fd >= 0 ? "onto " + parser.value(interfaceOption) : QString("(skipped)");
+    qInfo() << "Replaying" << frameCount << "frames" << target
+            << "and" << records.size() - frameCount << "signals"
+            << "at" << (speed > 0 ? QString::number(speed) + "x" : QString("max speed"));
+
+    do {
+        const qint64 startNs = monotonicNs();
+        const qint64 firstNs = records.first().timestampNs;
+        quint64 sentFrames = 0;
+        quint64 sentSignals = 0;
+
+        for (const trace::Record &record : std::as_const(records)) {
+            const bool isFrame = record.type == trace::FrameRecord;
+            if (isFrame ? fd < 0 : !ownedServices.contains(record.interface)) {
+                continue;
+            }
+            if (speed > 0) {
+                sleepUntil(startNs + qint64((record.timestampNs - firstNs) / speed));
+            }
+
+            if (!isFrame) {
+                QDBusMessage message = QDBusMessage::createSignal(record.path, record.interface, record.member);
+                if (record.value.isValid()) {
+                    message << record.value;
+                }
+                bus.send(message);
+                sentSignals++;
+                continue;
+            }
+
+            if (!writeFrame(fd, record.frame)) {
+                qCritical() << "write:" << strerror(errno);
+                ::close(fd);
+                return 1;
+            }
+            sentFrames++;
+        }
+
+        const double elapsedS = (monotonicNs() - startNs) / 1e9;
+        qInfo() << "Sent" << sentFrames << "frames and" << sentSignals << "signals in" << elapsedS << "s"
+                << "(" << (elapsedS > 0 ? (sentFrames + sentSignals) / elapsedS : 0.0) << "events/s )";
+    } while (parser.isSet(loopOption));
+
+    if (fd >= 0) {
+        ::close(fd);
+    }
+    for (const QString &service : std::as_const(ownedServices)) {
+        bus.unregisterService(service);
+    }
+    return 0;
+}
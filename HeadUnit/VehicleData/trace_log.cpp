@@ -0,0 +1,395 @@
+// trace_log.cpp
+#include "trace_log.h"
+#include <QtEndian>
+#include <climits>
+#include <cstring>
+
+namespace trace {
+
+namespace {
+
+void putVarint(QByteArray &out, quint64 value)
+{
+    while (value >= 0x80) {
+        out.append(char(quint8(value) | 0x80));
+        value >>= 7;
+    }
+    out.append(char(value));
+}
+
+void putZigzag(QByteArray &out, qint64 value)
+{
+    putVarint(out, (quint64(value) << 1) ^ quint64(value >> 63));
+}
+
+void putString(QByteArray &out, const QString &value)
+{
+    const QByteArray utf8 = value.toUtf8();
+    putVarint(out, quint64(utf8.size()));
+    out.append(utf8);
+}
+
+bool getVarint(const QByteArray &in, int *pos, quint64 *value)
+{
+    *value = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        if (*pos >= in.size()) {
+            return false;
+        }
+        const quint8 byte = quint8(in[(*pos)++]);
+        *value |= quint64(byte & 0x7f) << shift;
+        if (!(byte & 0x80)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool getZigzag(const QByteArray &in, int *pos, qint64 *value)
+{
+    quint64 raw;
+    if (!getVarint(in, pos, &raw)) {
+        return false;
+    }
+    *value = qint64(raw >> 1) ^ -qint64(raw & 1);
+    return true;
+}
+
+bool getString(const QByteArray &in, int *pos, QString *value)
+{
+    quint64 size;
+    if (!getVarint(in, pos, &size) || size > quint64(in.size() - *pos)) {
+        return false;
+    }
+    *value = QString::fromUtf8(in.constData() + *pos, int(size));
+    *pos += int(size);
+    return true;
+}
+
+} // namespace
+
+// ============================================================================
+// Writer Implementation
+// ============================================================================
+
+Writer::Writer()
+    : m_lastNs(0)
+    , m_records(0)
+    , m_bytesWritten(0)
+{
+}
+
+Writer::~Writer()
+{
+    close();
+}
+
+bool Writer::open(const QString &fileName)
+{
+    close();
+    m_file.setFileName(fileName);
+    if (!m_file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        return false;
+    }
+
+    QByteArray header(kMagic, sizeof(kMagic));
+    header.append(char(kVersion));
+    m_file.write(header);
+    m_bytesWritten = quint64(header.size());
+    m_block.reserve(kBlockSize + 256);
+    m_lastNs = 0;
+    m_records = 0;
+    return true;
+}
+
+void Writer::close()
+{
+    if (!m_file.isOpen()) {
+        return;
+    }
+    flush();
+    m_file.close();
+}
+
+void Writer::beginRecord(qint64 timestampNs, RecordType type)
+{
+    putZigzag(m_block, timestampNs - m_lastNs);
+    m_block.append(char(type));
+    m_lastNs = timestampNs;
+}
+
+void Writer::endRecord()
+{
+    m_records++;
+    if (m_block.size() >= kBlockSize) {
+        flush();
+    }
+}
+
+void Writer::writeFrame(qint64 timestampNs, const can_frame &frame)
+{
+    if (!m_file.isOpen()) {
+        return;
+    }
+    const quint8 dlc = qMin<quint8>(frame.can_dlc, CAN_MAX_DLEN);
+    beginRecord(timestampNs, FrameRecord);
+    putVarint(m_block, frame.can_id);
+    m_block.append(char(dlc));
+    m_block.append(reinterpret_cast<const char *>(frame.data), dlc);
+    endRecord();
+}
+
+bool Writer::writeSignal(qint64 timestampNs, const QString &path, const QString &interface,
+                         const QString &member, const QVariant &value)
+{
+    if (!m_file.isOpen()) {
+        return false;
+    }
+
+    // The tag is the D-Bus type code the value was received with
+    char tag;
+    switch (value.metaType().id()) {
+    case QMetaType::Double:
+    case QMetaType::Float:      tag = 'd'; break;
+    case QMetaType::Bool:       tag = 'b'; break;
+    case QMetaType::UChar:      tag = 'y'; break;
+    case QMetaType::Short:      tag = 'n'; break;
+    case QMetaType::UShort:     tag = 'q'; break;
+    case QMetaType::Int:        tag = 'i'; break;
+    case QMetaType::UInt:       tag = 'u'; break;
+    case QMetaType::LongLong:   tag = 'x'; break;
+    case QMetaType::ULongLong:  tag = 't'; break;
+    case QMetaType::QString:    tag = 's'; break;
+    default:
+        return false;
+    }
+
+    beginRecord(timestampNs, SignalRecord);
+    putString(m_block, path);
+    putString(m_block, interface);
+    putString(m_block, member);
+    m_block.append(tag);
+
+    switch (tag) {
+    case 'd': {
+        double number = value.toDouble();
+        quint64 raw;
+        memcpy(&raw, &number, sizeof(raw));
+        raw = qToLittleEndian(raw);
+        m_block.append(reinterpret_cast<const char *>(&raw), sizeof(raw));
+        break;
+    }
+    case 'b':
+        m_block.append(char(value.toBool() ? 1 : 0));
+        break;
+    case 'n':
+    case 'i':
+    case 'x':
+        putZigzag(m_block, value.toLongLong());
+        break;
+    case 'y':
+    case 'q':
+    case 'u':
+    case 't':
+        putVarint(m_block, value.toULongLong());
+        break;
+    default:
+        putString(m_block, value.toString());
+        break;
+    }
+    endRecord();
+    return true;
+}
+
+bool Writer::flush()
+{
+    if (!m_file.isOpen() || m_block.isEmpty()) {
+        return true;
+    }
+
+    const QByteArray compressed = qCompress(m_block);
+    const quint32 length = qToBigEndian(quint32(compressed.size()));
+    const bool ok = m_file.write(reinterpret_cast<const char *>(&length), sizeof(length)) == sizeof(length)
+                    && m_file.write(compressed) == compressed.size()
+                    && m_file.flush();
+    m_bytesWritten += sizeof(length) + quint64(compressed.size());
+    m_block.clear();
+    return ok;
+}
+
+// ============================================================================
+// Reader Implementation
+// ============================================================================
+
+Reader::Reader()
+    : m_pos(0)
+    , m_lastNs(0)
+{
+}
+
+bool Reader::isTrace(const QString &fileName)
+{
+    QFile file(fileName);
+    return file.open(QIODevice::ReadOnly) && file.read(sizeof(kMagic)) == QByteArray(kMagic, sizeof(kMagic));
+}
+
+bool Reader::open(const QString &fileName)
+{
+    m_file.close();
+    m_file.setFileName(fileName);
+    m_block.clear();
+    m_pos = 0;
+    m_lastNs = 0;
+    m_error.clear();
+
+    if (!m_file.open(QIODevice::ReadOnly)) {
+        m_error = m_file.errorString();
+        return false;
+    }
+    const QByteArray header = m_file.read(sizeof(kMagic) + 1);
+    if (header.size() != int(sizeof(kMagic)) + 1 || !header.startsWith(QByteArray(kMagic, sizeof(kMagic)))) {
+        m_error = QStringLiteral("not a trace file");
+        return false;
+    }
+    // Newer versions only added value tags
+    if (quint8(header.back()) == 0 || quint8(header.back()) > kVersion) {
+        m_error = QStringLiteral("unsupported trace version %1").arg(quint8(header.back()));
+        return false;
+    }
+    return true;
+}
+
+bool Reader::readBlock()
+{
+    quint32 length;
+    const qint64 got = m_file.read(reinterpret_cast<char *>(&length), sizeof(length));
+    if (got == 0) {
+        return false;   // end of file
+    }
+    if (got != sizeof(length)) {
+        m_error = QStringLiteral("truncated block header");
+        return false;
+    }
+
+    const QByteArray compressed = m_file.read(qFromBigEndian(length));
+    if (compressed.size() != int(qFromBigEndian(length))) {
+        m_error = QStringLiteral("truncated block");
+        return false;
+    }
+    m_block = qUncompress(compressed);
+    m_pos = 0;
+    if (m_block.isEmpty()) {
+        m_error = QStringLiteral("damaged block");
+        return false;
+    }
+    return true;
+}
+
+bool Reader::next(Record *record)
+{
+    if (m_pos >= m_block.size() && !readBlock()) {
+        return false;
+    }
+
+    qint64 delta;
+    if (!getZigzag(m_block, &m_pos, &delta) || m_pos >= m_block.size()) {
+        m_error = QStringLiteral("damaged record");
+        return false;
+    }
+    m_lastNs += delta;
+    record->timestampNs = m_lastNs;
+    record->type = RecordType(quint8(m_block[m_pos++]));
+
+    if (record->type == FrameRecord) {
+        quint64 id;
+        if (!getVarint(m_block, &m_pos, &id) || m_pos >= m_block.size()) {
+            m_error = QStringLiteral("damaged frame record");
+            return false;
+        }
+        memset(&record->frame, 0, sizeof(record->frame));
+        record->frame.can_id = canid_t(id);
+        record->frame.can_dlc = quint8(m_block[m_pos++]);
+        if (record->frame.can_dlc > CAN_MAX_DLEN || m_pos + record->frame.can_dlc > m_block.size()) {
+            m_error = QStringLiteral("damaged frame record");
+            return false;
+        }
+        memcpy(record->frame.data, m_block.constData() + m_pos, record->frame.can_dlc);
+        m_pos += record->frame.can_dlc;
+        return true;
+    }
+
+    if (record->type != SignalRecord
+        || !getString(m_block, &m_pos, &record->path)
+        || !getString(m_block, &m_pos, &record->interface)
+        || !getString(m_block, &m_pos, &record->member)
+        || m_pos >= m_block.size()) {
+        m_error = QStringLiteral("damaged signal record");
+        return false;
+    }
+
+    const char tag = m_block[m_pos++];
+    switch (tag) {
+    case 'd': {
+        if (m_pos + 8 > m_block.size()) {
+            break;
+        }
+        quint64 raw;
+        memcpy(&raw, m_block.constData() + m_pos, sizeof(raw));
+        raw = qFromLittleEndian(raw);
+        double number;
+        memcpy(&number, &raw, sizeof(number));
+        m_pos += 8;
+        record->value = number;
+        return true;
+    }
+    case 'b':
+        if (m_pos >= m_block.size()) {
+            break;
+        }
+        record->value = m_block[m_pos++] != 0;
+        return true;
+    case 'n':
+    case 'i':
+    case 'x': {
+        qint64 number;
+        if (!getZigzag(m_block, &m_pos, &number)
+            || (tag == 'n' && (number < -32768 || number > 32767))
+            || (tag == 'i' && (number < INT_MIN || number > INT_MAX))) {
+            break;
+        }
+        record->value = tag == 'n' ? QVariant::fromValue(qint16(number))
+                      : tag == 'i' ? QVariant(int(number))
+                                   : QVariant(number);
+        return true;
+    }
+    case 'y':
+    case 'q':
+    case 'u':
+    case 't': {
+        quint64 number;
+        const quint64 max = tag == 'y' ? 0xffu : tag == 'q' ? 0xffffu : tag == 'u' ? 0xffffffffu : ~quint64(0);
+        if (!getVarint(m_block, &m_pos, &number) || number > max) {
+            break;
+        }
+        record->value = tag == 'y' ? QVariant::fromValue(uchar(number))
+                      : tag == 'q' ? QVariant::fromValue(quint16(number))
+                      : tag == 'u' ? QVariant(quint32(number))
+                                   : QVariant(number);
+        return true;
+    }
+    case 's': {
+        QString text;
+        if (!getString(m_block, &m_pos, &text)) {
+            break;
+        }
+        record->value = text;
+        return true;
+    }
+    default:
+        break;
+    }
+    m_error = QStringLiteral("damaged signal value");
+    return false;
+}
+
+} // namespace trace
@@ -0,0 +1,113 @@
+// trace_log.h
+#ifndef TRACE_LOG_H
+#define TRACE_LOG_H
+
+#include <QByteArray>
+#include <QFile>
+#include <QString>
+#include <QVariant>
+#include <linux/can.h>
+
+// Binary drive recording: CAN frames and D-Bus vehicle signals on one
+// timeline, written by can-record and played back by can-replay.
+//
+// File: "HUTR", version byte, then blocks of [u32 big endian length]
+// [qCompress'ed records]. A block is closed at kBlockSize bytes or when
+// flush() is called, so a crashed recorder loses at most the open block.
+//
+// Record: zigzag varint delta to the previous record's timestamp (ns,
+// realtime), a type byte, then
+//   Frame:  varint can_id (with EFF/RTR flags), dlc, dlc data bytes
+//   Signal: path, interface, member (varint length + UTF-8), then the
+//           value's D-Bus type code as tag and the value:
+//           'd' (8 byte little endian double), 'b' (byte), 'n' / 'i' / 'x'
+//           (int16 / int32 / int64, zigzag varint), 'y' / 'q' / 'u' / 't'
+//           (byte / uint16 / uint32 / uint64, varint) or 's' (varint
+//           length + UTF-8). 'u' is new in version 2, 'y', 'n', 'q' and
+//           't' in version 3.
+namespace trace {
+
+constexpr char kMagic[4] = {'H', 'U', 'T', 'R'};
+constexpr quint8 kVersion = 3;
+constexpr int kBlockSize = 64 * 1024;
+
+enum RecordType : quint8 {
+    FrameRecord = 0,
+    SignalRecord = 1,
+};
+
+struct Record {
+    qint64 timestampNs = 0;
+    RecordType type = FrameRecord;
+    can_frame frame = {};
+    QString path;
+    QString interface;
+    QString member;
+    QVariant value;
+};
+
+class Writer
+{
+public:
+    Writer();
+    ~Writer();
+
+    bool open(const QString &fileName);
+    void close();
+    bool isOpen() const { return m_file.isOpen(); }
+    QString errorString() const { return m_file.errorString(); }
+
+    void writeFrame(qint64 timestampNs, const can_frame &frame);
+    // False, and nothing written, for a value without one of the tags
+    // above: it could not be replayed with its D-Bus signature
+    bool writeSignal(qint64 timestampNs, const QString &path, const QString &interface,
+                     const QString &member, const QVariant &value);
+
+    // Compresses and writes the open block
+    bool flush();
+
+    quint64 records() const { return m_records; }
+    quint64 bytesWritten() const { return m_bytesWritten; }
+
+private:
+    Q_DISABLE_COPY(Writer)
+
+    void beginRecord(qint64 timestampNs, RecordType type);
+    void endRecord();
+
+    QFile m_file;
+    QByteArray m_block;
+    qint64 m_lastNs;
+    quint64 m_records;
+    quint64 m_bytesWritten;
+};
+
+class Reader
+{
+public:
+    Reader();
+
+    bool open(const QString &fileName);
+    QString errorString() const { return m_error; }
+
+    // False at the end of the file or on a damaged block (see errorString())
+    bool next(Record *record);
+
+    // True if the file starts with the trace magic
+    static bool isTrace(const QString &fileName);
+
+private:
+    Q_DISABLE_COPY(Reader)
+
+    bool readBlock();
+
+    QFile m_file;
+    QByteArray m_block;
+    int m_pos;
+    qint64 m_lastNs;
+    QString m_error;
+};
+
+} // namespace trace
+
+#endif // TRACE_LOG_H
@@ -0,0 +1,456 @@
+// vehicle_data_service.cpp
+#include "vehicle_data_service.h"
+#include <QDBusConnection>
+#include <QDBusError>
+#include <QDebug>
+#include <QFileInfo>
+#include <cmath>
+#include <cstring>
+#include <ctime>
+#include <linux/can.h>
+
+namespace {
+
+// INA219 of the PiRacer battery board
+constexpr int kIna219Address = 0x41;
+constexpr double kDefaultShuntMilliOhm = 10.0;
+
+double envDouble(const char *name, double fallback)
+{
+    bool ok = false;
+    const double value = qEnvironmentVariable(name).toDouble(&ok);
+    return (ok && value > 0.0) ? value : fallback;
+}
+
+double processCpuMs()
+{
+    timespec ts;
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1e6;
+}
+
+} // namespace
+
+// ============================================================================
+// VehicleDataService Implementation
+// ============================================================================
+
+VehicleDataService::VehicleDataService(const QStringList &canInterfaces, int publishHz,
+                                       const QString &batterySource, QObject *parent)
+    : QObject(parent)
+    , m_dbusAdaptor(nullptr)
+    , m_subscriptions("/com/headunit/VehicleData", "com.headunit.VehicleData")
+    , m_battery(nullptr)
+    , m_canInterfaces(canInterfaces)
+    , m_speed(0.0)
+    , m_gear("P")
+    , m_turnSignal("off")
+    , m_batteryLevel(-1.0)
+    , m_batteryRange(-1.0)
+    , m_published(0)
+    , m_sampleAgeTotalUs(0)
+    , m_sampleAgeSamples(0)
+    , m_sampleAgeMaxUs(0)
+{
+    if (m_telemetry.create()) {
+        m_reader.setTelemetry(&m_telemetry);
+    } else {
+        qWarning() << "[VehicleData] Telemetry channel unavailable, D-Bus signals only";
+    }
+
+    registerDBusService();
+
+    connect(&m_reader, &vehicle::CanReader::discreteChanged,
+            this, &VehicleDataService::publishDiscrete);
+    connect(&m_reader, &vehicle::CanReader::readFailed,
+            this, &VehicleDataService::onReadFailed);
+
+    m_publishTimer.setTimerType(Qt::PreciseTimer);
+    m_publishTimer.setInterval(1000 / qBound(1, publishHz, 1000));
+    connect(&m_publishTimer, &QTimer::timeout, this, &VehicleDataService::publish);
+
+    // Interfaces may come up after us (vcan setup, USB adapters)
+    m_retryTimer.setSingleShot(true);
+    m_retryTimer.setInterval(2000);
+    connect(&m_retryTimer, &QTimer::timeout, this, &VehicleDataService::openCan);
+
+    qInfo() << "[VehicleData] Publishing speed at" << 1000 / m_publishTimer.interval() << "Hz";
+    openBattery(batterySource);
+    openCan();
+}
+
+VehicleDataService::~VehicleDataService()
+{
+    if (m_battery) {
+        m_battery->stop();
+    }
+    m_reader.stop();
+}
+
+void VehicleDataService::registerDBusService()
+{
+    m_dbusAdaptor = new VehicleDataDBus(this);
+    QDBusConnection sessionBus = QDBusConnection::sessionBus();
+
+    if (!sessionBus.registerService("com.headunit.VehicleData")) {
+        qCritical() << "[VehicleData] Failed to register D-Bus service:"
+                    << sessionBus.lastError().message();
+        return;
+    }
+
+    if (!sessionBus.registerObject("/com/headunit/VehicleData", this)) {
+        qCritical() << "[VehicleData] Failed to register D-Bus object:"
+                    << sessionBus.lastError().message();
+        return;
+    }
+
+    qInfo() << "[VehicleData] D-Bus service registered: com.headunit.VehicleData";
+}
+
+void VehicleDataService::openCan()
+{
+    for (const QString &interface : std::as_const(m_canInterfaces)) {
+        if (m_reader.open(interface)) {
+            m_reader.start(QThread::HighPriority);
+            m_publishTimer.start();
+            publishDiscrete();
+            return;
+        }
+    }
+
+    qWarning() << "[VehicleData] No CAN interface among" << m_canInterfaces << "- retrying";
+    m_retryTimer.start();
+}
+
+void VehicleDataService::openBattery(const QString &source)
+{
+    if (source.isEmpty() || source == "none") {
+        qInfo() << "[VehicleData] No battery sensor";
+        return;
+    }
+
+    vehicle::SocEstimator::Params params;
+    params.cells = int(envDouble("HEADUNIT_BATTERY_CELLS", params.cells));
+    params.capacityAh = envDouble("HEADUNIT_BATTERY_CAPACITY_MAH", params.capacityAh * 1000.0) / 1000.0;
+    params.resistanceOhm = envDouble("HEADUNIT_BATTERY_RESISTANCE_MOHM", params.resistanceOhm * 1000.0) / 1000.0;
+
+    // A regular file is a recorded trace, anything else the i2c bus
+    vehicle::PowerSensor *sensor = nullptr;
+    if (QFileInfo(source).isFile()) {
+        sensor = new vehicle::TraceSensor(source, 1.0 / vehicle::BatteryMonitor::kSampleHz);
+    } else {
+        const double shuntOhm = envDouble("HEADUNIT_BATTERY_SHUNT_MOHM", kDefaultShuntMilliOhm) / 1000.0;
+        sensor = new vehicle::Ina219Sensor(source, kIna219Address, shuntOhm);
+    }
+
+    m_battery = new vehicle::BatteryMonitor(sensor, params, this);
+    if (!m_battery->open()) {
+        qWarning() << "[VehicleData] Battery sensor unavailable:" << m_battery->sensorName();
+        delete m_battery;
+        m_battery = nullptr;
+        return;
+    }
+
+    connect(m_battery, &vehicle::BatteryMonitor::estimateUpdated,
+            this, &VehicleDataService::publishBattery);
+    m_battery->start();
+    qInfo() << "[VehicleData] Battery:" << m_battery->sensorName() << params.cells << "cells,"
+            << params.capacityAh << "Ah";
+}
+
+void VehicleDataService::onReadFailed(const QString &error)
+{
+    qWarning() << "[VehicleData] CAN read failed on" << m_reader.interfaceName() << ":" << error;
+    m_publishTimer.stop();
+    m_reader.wait();
+    m_reader.close();
+    m_retryTimer.start();
+}
+
+void VehicleDataService::publish()
+{
+    const vehicle::VehicleState state = m_reader.state();
+    const qint64 now = telemetry::monotonicNs();
+    const qint64 updated = state.updatedNs[vehicle::SpeedSignal];
+
+    double speed = state.values[vehicle::SpeedSignal];
+    if (updated == 0 || now - updated > qint64(kSpeedTimeoutMs) * 1000000) {
+        speed = 0.0;    // no sample for a while: the car is not reporting motion
+    }
+    speed = qMax(0.0, speed);
+    if (m_battery) {
+        m_battery->setSpeed(speed);
+    }
+
+    // Subscribers apply their own deadband and rate
+    m_subscriptions.offer(vehicle::SpeedSignal, speed);
+
+    if (std::fabs(speed - m_speed) <= 0.1) {
+        return;
+    }
+    if (speed == 0.0 && updated != 0 && state.values[vehicle::SpeedSignal] != 0.0) {
+        // Timed out: channel readers see the stop as well
+        m_telemetry.publish(telemetry::Speed, 0.0, now);
+    }
+    m_speed = speed;
+
+    if (updated != 0) {
+        const quint64 ageUs = quint64(now - updated) / 1000;
+        m_sampleAgeTotalUs += ageUs;
+        m_sampleAgeSamples++;
+        m_sampleAgeMaxUs = qMax(m_sampleAgeMaxUs, ageUs);
+    }
+    m_published++;
+    emit m_dbusAdaptor->SpeedChanged(m_speed);
+}
+
+void VehicleDataService::publishDiscrete()
+{
+    const vehicle::VehicleState state = m_reader.state();
+
+    if (state.updatedNs[vehicle::GearSignal] != 0) {
+        const QString gear = gearName(state.values[vehicle::GearSignal]);
+        if (gear != m_gear) {
+            qInfo() << "[VehicleData] Gear ->" << gear;
+            m_gear = gear;
+            m_published++;
+            emit m_dbusAdaptor->GearChanged(m_gear);
+            m_subscriptions.offer(vehicle::GearSignal, m_gear);
+        }
+    }
+
+    if (state.updatedNs[vehicle::TurnSignal] != 0) {
+        const QString mode = turnSignalName(state.values[vehicle::TurnSignal]);
+        if (mode != m_turnSignal) {
+            qInfo() << "[VehicleData] TurnSignal ->" << mode;
+            m_turnSignal = mode;
+            m_published++;
+            emit m_dbusAdaptor->TurnSignalChanged(m_turnSignal);
+            m_subscriptions.offer(vehicle::TurnSignal, m_turnSignal);
+        }
+    }
+}
+
+void VehicleDataService::publishBattery()
+{
+    const vehicle::BatteryState state = m_battery->state();
+    if (!state.valid) {
+        return;
+    }
+
+    const double level = state.soc * 100.0;
+    if (std::fabs(level - m_batteryLevel) > 0.1) {
+        m_batteryLevel = level;
+        m_published++;
+        m_telemetry.publish(telemetry::Battery, m_batteryLevel, telemetry::monotonicNs());
+        emit m_dbusAdaptor->BatteryChanged(m_batteryLevel);
+        m_subscriptions.offer(vehicle::BatterySignal, m_batteryLevel);
+    }
+
+    if (std::fabs(state.rangeKm - m_batteryRange) > 0.1) {
+        m_batteryRange = state.rangeKm;
+        m_published++;
+        emit m_dbusAdaptor->RangeChanged(m_batteryRange);
+    }
+}
+
+bool VehicleDataService::sendByte(quint32 canId, quint8 value)
+{
+    can_frame frame;
+    memset(&frame, 0, sizeof(frame));
+    frame.can_id = canId;
+    frame.can_dlc = 1;
+    frame.data[0] = value;
+    return m_reader.send(frame);
+}
+
+bool VehicleDataService::setGear(const QString &gear)
+{
+    const QString upper = gear.toUpper();
+    static const QStringList validGears = {"P", "R", "N", "D"};
+    if (!validGears.contains(upper)) {
+        qWarning() << "[VehicleData] Invalid gear requested:" << gear;
+        return false;
+    }
+
+    // A request only: GearChanged follows when the vehicle reports the gear
+    // on 0x102 (our own frames are not read back)
+    return sendByte(0x102, quint8(upper.at(0).toLatin1()));
+}
+
+bool VehicleDataService::setTurnSignal(const QString &mode)
+{
+    static const QStringList modes = {"off", "left", "right", "hazard"};
+    const int value = modes.indexOf(mode);
+    if (value < 0) {
+        qWarning() << "[VehicleData] Invalid turn signal mode:" << mode;
+        return false;
+    }
+    return sendByte(0x103, quint8(value));
+}
+
+bool VehicleDataService::subscribe(const QString &client, const QString &signal,
+                                   double maxRateHz, double deadband)
+{
+    const vehicle::SignalId id = vehicle::SubscriptionManager::signalForMember(signal);
+    if (id == vehicle::SignalCount || client.isEmpty()) {
+        qWarning() << "[VehicleData] Cannot subscribe" << client << "to" << signal;
+        return false;
+    }
+
+    QVariant current;
+    switch (id) {
+    case vehicle::SpeedSignal:
+        current = m_speed;
+        break;
+    case vehicle::GearSignal:
+        current = m_gear;
+        break;
+    case vehicle::BatterySignal:
+        // Nothing to deliver until the first estimate
+        if (m_batteryLevel >= 0.0) {
+            current = m_batteryLevel;
+        }
+        break;
+    default:
+        current = m_turnSignal;
+        break;
+    }
+    m_subscriptions.subscribe(client, id, maxRateHz, deadband, current);
+    return true;
+}
+
+bool VehicleDataService::unsubscribe(const QString &client, const QString &signal)
+{
+    const vehicle::SignalId id = vehicle::SubscriptionManager::signalForMember(signal);
+    return id != vehicle::SignalCount && m_subscriptions.unsubscribe(client, id);
+}
+
+QVariantMap VehicleDataService::stats() const
+{
+    const vehicle::CanReader::Counters counters = m_reader.counters();
+    const vehicle::SubscriptionManager::Counters subscriptions = m_subscriptions.counters();
+
+    QVariantMap stats;
+    stats["interface"] = m_reader.interfaceName();
+    stats["frames"] = counters.frames;
+    stats["decodedFrames"] = counters.decoded;
+    stats["batches"] = counters.batches;
+    stats["framesPerBatch"] = counters.batches ? double(counters.frames) / counters.batches : 0.0;
+    stats["readErrors"] = counters.errors;
+    stats["published"] = m_published;
+    stats["telemetrySamples"] = m_telemetry.written();
+    // Receive-to-publish age of the speed samples sent on the bus
+    stats["sampleAgeMeanUs"] = m_sampleAgeSamples ? m_sampleAgeTotalUs / m_sampleAgeSamples : 0;
+    stats["sampleAgeMaxUs"] = m_sampleAgeMaxUs;
+    stats["subscriptions"] = m_subscriptions.subscriptionCount();
+    stats["subscriptionUpdates"] = subscriptions.delivered;
+    stats["subscriptionSuppressed"] = subscriptions.suppressed;
+    stats["subscriptionCoalesced"] = subscriptions.coalesced;
+    if (m_battery) {
+        const vehicle::BatteryState battery = m_battery->state();
+        stats["batterySensor"] = m_battery->sensorName();
+        stats["batterySamples"] = battery.samples;
+        stats["batteryReadErrors"] = battery.readErrors;
+        stats["batteryOverruns"] = battery.overruns;
+        stats["batteryVoltage"] = battery.voltage;
+        stats["batteryCurrent"] = battery.current;
+        stats["batteryRemainingAh"] = battery.remainingAh;
+        stats["batteryCpuTimeMs"] = battery.cpuTimeMs;
+    }
+    stats["cpuTimeMs"] = processCpuMs();
+    return stats;
+}
+
+QString VehicleDataService::gearName(double raw)
+{
+    const int value = int(raw);
+    if (value == 0) {
+        return "P";
+    }
+    const QString gear(QChar::fromLatin1(char(value)));
+    return QStringList({"P", "R", "N", "D"}).contains(gear) ? gear : QString("P");
+}
+
+QString VehicleDataService::turnSignalName(double raw)
+{
+    static const QStringList modes = {"off", "left", "right", "hazard"};
+    const int value = int(raw);
+    return (value >= 0 && value < modes.size()) ? modes.at(value) : modes.first();
+}
+
+// ============================================================================
+// VehicleDataDBus Implementation
+// ============================================================================
+
+VehicleDataDBus::VehicleDataDBus(QObject *parent)
+    : QDBusAbstractAdaptor(parent)
+{
+    m_service = qobject_cast<VehicleDataService*>(parent);
+    setAutoRelaySignals(true);
+}
+
+double VehicleDataDBus::GetSpeed()
+{
+    return m_service ? m_service->speed() : 0.0;
+}
+
+QString VehicleDataDBus::GetGear()
+{
+    return m_service ? m_service->gear() : QString("P");
+}
+
+QString VehicleDataDBus::GetTurnSignal()
+{
+    return m_service ? m_service->turnSignal() : QString("off");
+}
+
+double VehicleDataDBus::GetBatteryLevel()
+{
+    return m_service ? m_service->batteryLevel() : -1.0;
+}
+
+double VehicleDataDBus::GetBatteryRange()
+{
+    return m_service ? m_service->batteryRange() : -1.0;
+}
+
+bool VehicleDataDBus::SetGear(const QString &gear)
+{
+    return m_service && m_service->setGear(gear);
+}
+
+bool VehicleDataDBus::SetTurnSignal(const QString &mode)
+{
+    return m_service && m_service->setTurnSignal(mode);
+}
+
+bool VehicleDataDBus::IsCanConnected()
+{
+    return m_service && m_service->isCanConnected();
+}
+
+QVariantMap VehicleDataDBus::GetStats()
+{
+    return m_service ? m_service->stats() : QVariantMap();
+}
+
+QDBusUnixFileDescriptor VehicleDataDBus::GetTelemetryChannel()
+{
+    // The descriptor is duplicated into the reply; the memfd stays ours
+    if (!m_service || m_service->telemetryFd() < 0) {
+        return QDBusUnixFileDescriptor();
+    }
+    return QDBusUnixFileDescriptor(m_service->telemetryFd());
+}
+
+bool VehicleDataDBus::Subscribe(const QString &signal, double maxRateHz, double deadband,
+                                const QDBusMessage &message)
+{
+    return m_service && m_service->subscribe(message.service(), signal, maxRateHz, deadband);
+}
+
+bool VehicleDataDBus::Unsubscribe(const QString &signal, const QDBusMessage &message)
+{
+    return m_service && m_service->unsubscribe(message.service(), signal);
+}
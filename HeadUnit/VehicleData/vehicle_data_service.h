@@ -0,0 +1,143 @@
+// vehicle_data_service.h
+#ifndef VEHICLE_DATA_SERVICE_H
+#define VEHICLE_DATA_SERVICE_H
+
+#include <QObject>
+#include <QDBusAbstractAdaptor>
+#include <QDBusMessage>
+#include <QDBusUnixFileDescriptor>
+#include <QDBusVariant>
+#include <QString>
+#include <QStringList>
+#include <QTimer>
+#include <QVariantMap>
+#include "battery_monitor.h"
+#include "can_reader.h"
+#include "subscription_manager.h"
+#include "../telemetry_channel.h"
+
+/**
+ * D-Bus Adaptor for the Vehicle Data Interface
+ *
+ * Method and signal names match com.piracer.dashboard, so clients can use
+ * either service.
+ */
+class VehicleDataDBus : public QDBusAbstractAdaptor
+{
+    Q_OBJECT
+    Q_CLASSINFO("D-Bus Interface", "com.headunit.VehicleData")
+
+public:
+    explicit VehicleDataDBus(QObject *parent);
+
+public Q_SLOTS:
+    double GetSpeed();
+    QString GetGear();
+    QString GetTurnSignal();
+    // Percent, -1 without a battery sensor
+    double GetBatteryLevel();
+    // km at the recent consumption, -1 while unknown
+    double GetBatteryRange();
+    bool SetGear(const QString &gear);
+    bool SetTurnSignal(const QString &mode);
+    bool IsCanConnected();
+    QVariantMap GetStats();
+    // Shared-memory channel with every sample (see telemetry_channel.h)
+    QDBusUnixFileDescriptor GetTelemetryChannel();
+    // Rate limited, deadbanded delivery of one signal ("SpeedChanged", ...)
+    // to the caller through Updated (see subscription_manager.h)
+    bool Subscribe(const QString &signal, double maxRateHz, double deadband, const QDBusMessage &message);
+    bool Unsubscribe(const QString &signal, const QDBusMessage &message);
+
+Q_SIGNALS:
+    void SpeedChanged(double speed);
+    void GearChanged(const QString &gear);
+    void TurnSignalChanged(const QString &mode);
+    void BatteryChanged(double level);
+    void RangeChanged(double km);
+    // Only sent to subscribers, never broadcast
+    void Updated(const QString &signal, const QDBusVariant &value);
+
+private:
+    class VehicleDataService *m_service;
+};
+
+/**
+ * Native vehicle data service
+ *
+ * Replaces the CAN half of Dashboard_Service_HeadUnit_IC.py. Frames come
+ * from CanReader; continuous signals (speed) are published at a fixed rate,
+ * discrete ones (gear, turn signal) as soon as they change. A speed that
+ * has not been received for kSpeedTimeoutMs is published as 0.
+ *
+ * Battery level and range come from BatteryMonitor (INA219 on the battery
+ * board, or a recorded trace) and are published once a second when they
+ * moved.
+ *
+ * Every sample also goes into the telemetry channel, so consumers that need
+ * more than the published rate read it from shared memory instead of the bus.
+ * Consumers that need less subscribe with a rate and a deadband and are only
+ * woken by updates that matter to them.
+ */
+class VehicleDataService : public QObject
+{
+    Q_OBJECT
+
+public:
+    static constexpr int kSpeedTimeoutMs = 500;
+
+    // batterySource: i2c-dev device of the INA219, a trace file (see
+    // TraceSensor) or "none"
+    VehicleDataService(const QStringList &canInterfaces, int publishHz, const QString &batterySource,
+                       QObject *parent = nullptr);
+    ~VehicleDataService();
+
+    double speed() const { return m_speed; }
+    QString gear() const { return m_gear; }
+    QString turnSignal() const { return m_turnSignal; }
+    double batteryLevel() const { return m_batteryLevel; }
+    double batteryRange() const { return m_batteryRange; }
+    bool isCanConnected() const { return m_reader.isOpen(); }
+    int telemetryFd() const { return m_telemetry.fd(); }
+
+    bool setGear(const QString &gear);
+    bool setTurnSignal(const QString &mode);
+    bool subscribe(const QString &client, const QString &signal, double maxRateHz, double deadband);
+    bool unsubscribe(const QString &client, const QString &signal);
+    QVariantMap stats() const;
+
+private:
+    void registerDBusService();
+    void openCan();
+    void openBattery(const QString &source);
+    void onReadFailed(const QString &error);
+    void publish();
+    void publishDiscrete();
+    void publishBattery();
+    bool sendByte(quint32 canId, quint8 value);
+
+    static QString gearName(double raw);
+    static QString turnSignalName(double raw);
+
+    telemetry::Writer m_telemetry;
+    vehicle::CanReader m_reader;
+    VehicleDataDBus *m_dbusAdaptor;
+    vehicle::SubscriptionManager m_subscriptions;
+    vehicle::BatteryMonitor *m_battery;     // nullptr without a sensor
+    QStringList m_canInterfaces;
+    QTimer m_publishTimer;
+    QTimer m_retryTimer;
+
+    double m_speed;
+    QString m_gear;
+    QString m_turnSignal;
+    double m_batteryLevel;
+    double m_batteryRange;
+
+    quint64 m_published;
+    quint64 m_sampleAgeTotalUs;
+    quint64 m_sampleAgeSamples;
+    quint64 m_sampleAgeMaxUs;
+};
+
+#endif // VEHICLE_DATA_SERVICE_H
@@ -0,0 +1,54 @@
+#include "app_liveness.h"
+#include <QDBusConnection>
+#include <QDBusError>
+#include <QDebug>
+
+AppLiveness::AppLiveness(QObject *parent)
+    : QObject(parent)
+    , m_iviId(qEnvironmentVariableIntValue("QT_IVI_SURFACE_ID"))
+{
+    if (m_iviId <= 0) {
+        qDebug() << "AppLiveness: QT_IVI_SURFACE_ID not set, not answering pings";
+        return;
+    }
+
+    new AppLivenessDBus(this);
+
+    QDBusConnection bus = QDBusConnection::sessionBus();
+    const QString serviceName = QStringLiteral("com.headunit.App%1").arg(m_iviId);
+    if (!bus.registerService(serviceName)) {
+        qWarning() << "AppLiveness: Failed to register" << serviceName << ":"
+                   << bus.lastError().message();
+        return;
+    }
+    if (!bus.registerObject("/com/headunit/App", this)) {
+        qWarning() << "AppLiveness: Failed to register object:" << bus.lastError().message();
+        bus.unregisterService(serviceName);
+        return;
+    }
+
+    m_serviceName = serviceName;
+    qDebug() << "AppLiveness: Answering pings as" << m_serviceName;
+}
+
+AppLiveness::~AppLiveness()
+{
+    if (!m_serviceName.isEmpty()) {
+        QDBusConnection::sessionBus().unregisterObject("/com/headunit/App");
+        QDBusConnection::sessionBus().unregisterService(m_serviceName);
+    }
+}
+
+// ============================================================================
+// AppLivenessDBus Implementation
+// ============================================================================
+
+AppLivenessDBus::AppLivenessDBus(AppLiveness *parent)
+    : QDBusAbstractAdaptor(parent)
+{
+}
+
+uint AppLivenessDBus::Ping(uint serial)
+{
+    return serial;
+}
@@ -0,0 +1,41 @@
+#ifndef APP_LIVENESS_H
+#define APP_LIVENESS_H
+
+#include <QObject>
+#include <QString>
+#include <QDBusAbstractAdaptor>
+
+// Answers the compositor's liveness pings.
+//
+// Registers com.headunit.App<iviId> (iviId from QT_IVI_SURFACE_ID, set by the
+// AFM) on the session bus. Ping is served by the GUI thread's event loop, so
+// an unanswered ping means the app is stuck, not merely slow to draw.
+class AppLiveness : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit AppLiveness(QObject *parent = nullptr);
+    ~AppLiveness();
+
+    int iviId() const { return m_iviId; }
+
+private:
+    int m_iviId;
+    QString m_serviceName;
+};
+
+class AppLivenessDBus : public QDBusAbstractAdaptor
+{
+    Q_OBJECT
+    Q_CLASSINFO("D-Bus Interface", "com.headunit.AppLiveness")
+
+public:
+    explicit AppLivenessDBus(AppLiveness *parent);
+
+public Q_SLOTS:
+    // Echoes the serial back
+    uint Ping(uint serial);
+};
+
+#endif // APP_LIVENESS_H
@@ -0,0 +1,72 @@
+#include "latency_histogram.h"
+#include <cmath>
+
+int LatencyHistogram::bucketFor(quint64 us)
+{
+    if (us < 4) {
+        return int(us);
+    }
+    const int msb = 63 - qCountLeadingZeroBits(us);
+    const int bucket = ((msb - 1) << 2) | int((us >> (msb - 2)) & 3);
+    return qMin(bucket, kBuckets - 1);
+}
+
+quint64 LatencyHistogram::bucketUpperUs(int bucket)
+{
+    const int next = bucket + 1;
+    if (next < 4) {
+        return quint64(next);
+    }
+    const int msb = (next >> 2) + 1;
+    return quint64(4 | (next & 3)) << (msb - 2);
+}
+
+void LatencyHistogram::record(quint64 us)
+{
+    m_buckets[bucketFor(us)].fetch_add(1, std::memory_order_relaxed);
+    m_count.fetch_add(1, std::memory_order_relaxed);
+    m_sum.fetch_add(us, std::memory_order_relaxed);
+
+    quint64 max = m_max.load(std::memory_order_relaxed);
+    while (us > max && !m_max.compare_exchange_weak(max, us, std::memory_order_relaxed)) {
+    }
+}
+
+void LatencyHistogram::reset()
+{
+    for (auto &bucket : m_buckets) {
+        bucket.store(0, std::memory_order_relaxed);
+    }
+    m_count.store(0, std::memory_order_relaxed);
+    m_sum.store(0, std::memory_order_relaxed);
+    m_max.store(0, std::memory_order_relaxed);
+}
+
+double LatencyHistogram::meanUs() const
+{
+    const quint64 n = count();
+    return n ? double(m_sum.load(std::memory_order_relaxed)) / n : 0.0;
+}
+
+quint64 LatencyHistogram::percentileUs(double p) const
+{
+    quint32 counts[kBuckets];
+    quint64 total = 0;
+    for (int i = 0; i < kBuckets; ++i) {
+        counts[i] = m_buckets[i].load(std::memory_order_relaxed);
+        total += counts[i];
+    }
+    if (total == 0) {
+        return 0;
+    }
+
+    const quint64 target = qMax<quint64>(1, quint64(std::ceil(p * total)));
+    quint64 seen = 0;
+    for (int i = 0; i < kBuckets; ++i) {
+        seen += counts[i];
+        if (seen >= target) {
+            return qMin(bucketUpperUs(i), maxUs());
+        }
+    }
+    return maxUs();
+}
@@ -0,0 +1,35 @@
+#ifndef LATENCY_HISTOGRAM_H
+#define LATENCY_HISTOGRAM_H
+
+#include <QtGlobal>
+#include <atomic>
+
+// Latency histogram that can be recorded from any thread without locking.
+//
+// Buckets are log2 with four linear steps per octave (about 19% relative
+// resolution), counted in microseconds. Readers take a relaxed snapshot, so
+// a percentile may be off by the samples recorded while it is computed.
+class LatencyHistogram
+{
+public:
+    static constexpr int kBuckets = 128;
+
+    void record(quint64 us);
+    void reset();
+
+    quint64 count() const { return m_count.load(std::memory_order_relaxed); }
+    quint64 maxUs() const { return m_max.load(std::memory_order_relaxed); }
+    double meanUs() const;
+    quint64 percentileUs(double p) const;
+
+    static int bucketFor(quint64 us);
+    static quint64 bucketUpperUs(int bucket);
+
+private:
+    std::atomic<quint32> m_buckets[kBuckets] = {};
+    std::atomic<quint64> m_count{0};
+    std::atomic<quint64> m_sum{0};
+    std::atomic<quint64> m_max{0};
+};
+
+#endif // LATENCY_HISTOGRAM_H
@@ -0,0 +1,267 @@
+#include "telemetry_channel.h"
+#include <QDebug>
+#include <QMutexLocker>
+#include <cerrno>
+#include <cstring>
+#include <ctime>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace telemetry {
+
+namespace {
+
+constexpr int kReadRetries = 8;
+constexpr unsigned kRequiredSeals = F_SEAL_SHRINK | F_SEAL_GROW;
+
+quint64 toBits(double value)
+{
+    quint64 bits;
+    memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+double fromBits(quint64 bits)
+{
+    double value;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+} // namespace
+
+qint64 monotonicNs()
+{
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return qint64(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+}
+
+// ============================================================================
+// Writer Implementation
+// ============================================================================
+
+Writer::Writer()
+    : m_layout(nullptr)
+    , m_fd(-1)
+{
+}
+
+Writer::~Writer()
+{
+    if (m_layout) {
+        munmap(m_layout, sizeof(Layout));
+    }
+    if (m_fd >= 0) {
+        ::close(m_fd);
+    }
+}
+
+bool Writer::create()
+{
+    m_fd = memfd_create("headunit-telemetry", MFD_CLOEXEC | MFD_ALLOW_SEALING);
+    if (m_fd < 0) {
+        qWarning() << "[Telemetry] memfd_create:" << strerror(errno);
+        return false;
+    }
+    if (ftruncate(m_fd, sizeof(Layout)) < 0) {
+        qWarning() << "[Telemetry] ftruncate:" << strerror(errno);
+        return false;
+    }
+
+    void *memory = mmap(nullptr, sizeof(Layout), PROT_READ | PROT_WRITE, MAP_SHARED, m_fd, 0);
+    if (memory == MAP_FAILED) {
+        qWarning() << "[Telemetry] mmap:" << strerror(errno);
+        return false;
+    }
+
+    // The size is fixed for good, so a reader's mapping can never be cut
+    // short under it (SIGBUS)
+    if (fcntl(m_fd, F_ADD_SEALS, kRequiredSeals | F_SEAL_SEAL) < 0) {
+        qWarning() << "[Telemetry] sealing:" << strerror(errno);
+        munmap(memory, sizeof(Layout));
+        return false;
+    }
+
+    // A fresh memfd is zero filled, which is a valid empty state
+    m_layout = static_cast<Layout *>(memory);
+    m_layout->capacity = kCapacity;
+    m_layout->signalCount = SignalCount;
+    m_layout->version = kVersion;
+    std::atomic_thread_fence(std::memory_order_release);
+    m_layout->magic = kMagic;
+    return true;
+}
+
+void Writer::publish(Signal signal, double value, qint64 timestampNs)
+{
+    if (!m_layout || signal >= SignalCount) {
+        return;
+    }
+    const quint64 bits = toBits(value);
+
+    QMutexLocker locker(&m_mutex);
+
+    const quint64 n = m_layout->written.load(std::memory_order_relaxed);
+    Slot &slot = m_layout->slots[n & (kCapacity - 1)];
+    slot.sequence.store(2 * n + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    slot.timestampNs.store(timestampNs, std::memory_order_relaxed);
+    slot.valueBits.store(bits, std::memory_order_relaxed);
+    slot.signal.store(signal, std::memory_order_relaxed);
+    slot.sequence.store(2 * n + 2, std::memory_order_release);
+
+    Latest &latest = m_layout->latest[signal];
+    const quint64 sequence = latest.sequence.load(std::memory_order_relaxed);
+    latest.sequence.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    latest.timestampNs.store(timestampNs, std::memory_order_relaxed);
+    latest.valueBits.store(bits, std::memory_order_relaxed);
+    latest.sequence.store(sequence + 2, std::memory_order_release);
+
+    m_layout->written.store(n + 1, std::memory_order_release);
+}
+
+quint64 Writer::written() const
+{
+    return m_layout ? m_layout->written.load(std::memory_order_relaxed) : 0;
+}
+
+// ============================================================================
+// Reader Implementation
+// ============================================================================
+
+Reader::Reader()
+    : m_layout(nullptr)
+{
+}
+
+Reader::~Reader()
+{
+    detach();
+}
+
+bool Reader::attach(int fd)
+{
+    detach();
+
+    struct stat info;
+    if (fstat(fd, &info) < 0 || info.st_size < qint64(sizeof(Layout))) {
+        qWarning() << "[Telemetry] Channel fd is too small";
+        return false;
+    }
+    const int seals = fcntl(fd, F_GET_SEALS);
+    if (seals < 0 || (unsigned(seals) & kRequiredSeals) != kRequiredSeals) {
+        qWarning() << "[Telemetry] Channel fd is not sealed";
+        return false;
+    }
+
+    void *memory = mmap(nullptr, sizeof(Layout), PROT_READ, MAP_SHARED, fd, 0);
+    if (memory == MAP_FAILED) {
+        qWarning() << "[Telemetry] mmap:" << strerror(errno);
+        return false;
+    }
+
+    const auto *layout = static_cast<const Layout *>(memory);
+    if (layout->magic != kMagic || layout->version != kVersion
+        || layout->capacity != kCapacity || layout->signalCount != SignalCount) {
+        qWarning() << "[Telemetry] Unknown channel layout, version" << layout->version;
+        munmap(memory, sizeof(Layout));
+        return false;
+    }
+    std::atomic_thread_fence(std::memory_order_acquire);
+
+    m_layout = layout;
+    return true;
+}
+
+void Reader::detach()
+{
+    if (m_layout) {
+        munmap(const_cast<Layout *>(m_layout), sizeof(Layout));
+        m_layout = nullptr;
+    }
+}
+
+quint64 Reader::latestSequence(Signal signal) const
+{
+    if (!m_layout || signal >= SignalCount) {
+        return 0;
+    }
+    return m_layout->latest[signal].sequence.load(std::memory_order_acquire);
+}
+
+bool Reader::latest(Signal signal, Sample *out) const
+{
+    if (!m_layout || signal >= SignalCount) {
+        return false;
+    }
+    const Latest &latest = m_layout->latest[signal];
+
+    for (int attempt = 0; attempt < kReadRetries; ++attempt) {
+        const quint64 before = latest.sequence.load(std::memory_order_acquire);
+        if (before == 0) {
+            return false;
+        }
+        if (before & 1) {
+            continue;   // being written
+        }
+        const qint64 timestampNs = latest.timestampNs.load(std::memory_order_relaxed);
+        const quint64 bits = latest.valueBits.load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (latest.sequence.load(std::memory_order_relaxed) == before) {
+            out->timestampNs = timestampNs;
+            out->signal = signal;
+            out->value = fromBits(bits);
+            return true;
+        }
+    }
+    return false;
+}
+
+int Reader::read(quint64 *cursor, Sample *out, int max, quint64 *lost) const
+{
+    if (!m_layout || max <= 0) {
+        return 0;
+    }
+
+    const quint64 written = m_layout->written.load(std::memory_order_acquire);
+    quint64 n = *cursor;
+    if (written > kCapacity && n < written - kCapacity) {
+        if (lost) {
+            *lost += written - kCapacity - n;
+        }
+        n = written - kCapacity;
+    }
+
+    int count = 0;
+    for (; n < written && count < max; ++n) {
+        const Slot &slot = m_layout->slots[n & (kCapacity - 1)];
+        const quint64 expected = 2 * n + 2;
+        if (slot.sequence.load(std::memory_order_acquire) != expected) {
+            if (lost) {
+                (*lost)++;      // already overwritten by a later sample
+            }
+            continue;
+        }
+        Sample sample;
+        sample.timestampNs = slot.timestampNs.load(std::memory_order_relaxed);
+        sample.value = fromBits(slot.valueBits.load(std::memory_order_relaxed));
+        sample.signal = slot.signal.load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot.sequence.load(std::memory_order_relaxed) != expected) {
+            if (lost) {
+                (*lost)++;
+            }
+            continue;
+        }
+        out[count++] = sample;
+    }
+
+    *cursor = n;
+    return count;
+}
+
+} // namespace telemetry
@@ -0,0 +1,119 @@
+#ifndef TELEMETRY_CHANNEL_H
+#define TELEMETRY_CHANNEL_H
+
+#include <QtGlobal>
+#include <QMutex>
+#include <atomic>
+
+// Shared-memory channel for high-rate vehicle signals.
+//
+// The vehicle data service writes every sample into a memfd and hands the
+// fd out once over D-Bus (GetTelemetryChannel). Consumers map it read-only
+// and read the latest value of a signal whenever they draw, instead of
+// receiving one D-Bus signal per sample.
+//
+// The memory holds a ring of the last kCapacity samples plus the latest
+// sample per signal. Both are seqlocks: the writer makes a slot's sequence
+// odd while it writes, and a reader retries or drops a slot whose sequence
+// changed under it. Readers never block the writer and take no locks.
+namespace telemetry {
+
+enum Signal : quint32 {
+    Speed = 0,          // cm/s
+    Battery,            // percent
+    Gear,               // ASCII P/R/N/D
+    TurnSignal,         // 0 off, 1 left, 2 right, 3 hazard
+    SignalCount
+};
+
+struct Sample {
+    qint64 timestampNs = 0;     // CLOCK_MONOTONIC
+    quint32 signal = 0;
+    double value = 0.0;
+};
+
+constexpr quint32 kMagic = 0x48555431;      // "HUT1"
+constexpr quint32 kVersion = 1;
+constexpr quint32 kCapacity = 1024;         // power of two
+
+struct Slot {
+    std::atomic<quint64> sequence;          // 2n+1 while sample n is written, 2n+2 after
+    std::atomic<qint64> timestampNs;
+    std::atomic<quint64> valueBits;
+    std::atomic<quint32> signal;
+};
+
+struct Latest {
+    std::atomic<quint64> sequence;          // odd while written
+    std::atomic<qint64> timestampNs;
+    std::atomic<quint64> valueBits;
+};
+
+struct Layout {
+    quint32 magic;
+    quint32 version;
+    quint32 capacity;
+    quint32 signalCount;
+    std::atomic<quint64> written;           // samples published so far
+    Latest latest[SignalCount];
+    Slot slots[kCapacity];
+};
+
+// The layout is shared between processes, so the atomics must not need a lock
+static_assert(std::atomic<quint64>::is_always_lock_free, "64-bit atomics must be lock free");
+
+qint64 monotonicNs();
+
+class Writer
+{
+public:
+    Writer();
+    ~Writer();
+
+    // Creates and seals the memfd
+    bool create();
+    int fd() const { return m_fd; }
+    bool isValid() const { return m_layout != nullptr; }
+
+    // Thread safe; producers are serialised, readers are not affected
+    void publish(Signal signal, double value, qint64 timestampNs);
+
+    quint64 written() const;
+
+private:
+    Q_DISABLE_COPY(Writer)
+
+    Layout *m_layout;
+    int m_fd;
+    QMutex m_mutex;
+};
+
+class Reader
+{
+public:
+    Reader();
+    ~Reader();
+
+    // Maps the fd read-only; the fd itself may be closed afterwards
+    bool attach(int fd);
+    void detach();
+    bool isAttached() const { return m_layout != nullptr; }
+
+    // Latest sample of a signal; false if none was written yet
+    bool latest(Signal signal, Sample *out) const;
+    // Changes whenever a new sample of the signal is written
+    quint64 latestSequence(Signal signal) const;
+
+    // Samples after *cursor, oldest first; advances *cursor. Samples the
+    // writer overwrote before they were read are counted in *lost.
+    int read(quint64 *cursor, Sample *out, int max, quint64 *lost = nullptr) const;
+
+private:
+    Q_DISABLE_COPY(Reader)
+
+    const Layout *m_layout;
+};
+
+} // namespace telemetry
+
+#endif // TELEMETRY_CHANNEL_H
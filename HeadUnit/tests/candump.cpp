@@ -0,0 +1,46 @@
+// candump.cpp
+#include "candump.h"
+#include <QFile>
+#include <QStringList>
+#include <QTextStream>
+#include <cstring>
+
+QVector<TimedFrame> loadCandump(const QString &fileName)
+{
+    QVector<TimedFrame> frames;
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        return frames;
+    }
+
+    QTextStream in(&file);
+    while (!in.atEnd()) {
+        const QString line = in.readLine().trimmed();
+        if (line.isEmpty() || line.startsWith('#')) {
+            continue;
+        }
+        const QStringList fields = line.split(' ', Qt::SkipEmptyParts);
+        if (fields.size() < 3 || !fields[0].startsWith('(') || !fields[0].endsWith(')')) {
+            continue;
+        }
+        const int hash = fields[2].indexOf('#');
+        if (hash < 0) {
+            continue;
+        }
+
+        bool okTime = false;
+        bool okId = false;
+        TimedFrame timed;
+        std::memset(&timed.frame, 0, sizeof(timed.frame));
+        timed.timeS = fields[0].mid(1, fields[0].size() - 2).toDouble(&okTime);
+        timed.frame.can_id = fields[2].left(hash).toUInt(&okId, 16);
+        const QByteArray data = QByteArray::fromHex(fields[2].mid(hash + 1).toLatin1());
+        if (!okTime || !okId || data.size() > CAN_MAX_DLEN) {
+            continue;
+        }
+        timed.frame.can_dlc = quint8(data.size());
+        std::memcpy(timed.frame.data, data.constData(), size_t(data.size()));
+        frames.append(timed);
+    }
+    return frames;
+}
@@ -0,0 +1,18 @@
+// candump.h
+#ifndef CANDUMP_H
+#define CANDUMP_H
+
+#include <QString>
+#include <QVector>
+#include <linux/can.h>
+
+struct TimedFrame {
+    double timeS = 0.0;
+    can_frame frame;
+};
+
+// Reads a candump -l log ("(seconds) iface id#data", '#' comments) as
+// can-replay does; an empty result means the file was missing or empty
+QVector<TimedFrame> loadCandump(const QString &fileName);
+
+#endif // CANDUMP_H
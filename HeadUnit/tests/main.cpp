@@ -0,0 +1,34 @@
+// main.cpp
+#include <QGuiApplication>
+#include <QTest>
+#include "test_suites.h"
+
+// All suites in one binary, so ctest has one target for the whole tree.
+// GUI suites need a GUI application (QT_QPA_PLATFORM=offscreen).
+int main(int argc, char *argv[])
+{
+    QGuiApplication app(argc, argv);
+
+    QObject *(*const suites[])() = {
+        createKalmanSpeedFilterTest,
+        createSignalDecoderTest,
+        createSocEstimatorTest,
+        createSubscriptionManagerTest,
+        createTelemetryChannelTest,
+        createConfigureSchedulerTest,
+        createMediaFileReaderTest,
+        createTraceLogTest,
+        createThemePaletteTest,
+        createMediaSearchIndexTest,
+        createUsbMonitorTest,
+        createSurfaceWatchdogTest,
+    };
+
+    int failed = 0;
+    for (auto create : suites) {
+        QObject *suite = create();
+        failed += QTest::qExec(suite, argc, argv);
+        delete suite;
+    }
+    return failed > 0 ? 1 : 0;
+}
@@ -0,0 +1,21 @@
+// test_suites.h
+#ifndef TEST_SUITES_H
+#define TEST_SUITES_H
+
+#include <QObject>
+
+// One per tst_*.cpp; main() runs them in this order
+QObject *createKalmanSpeedFilterTest();
+QObject *createSignalDecoderTest();
+QObject *createSocEstimatorTest();
+QObject *createSubscriptionManagerTest();
+QObject *createTelemetryChannelTest();
+QObject *createConfigureSchedulerTest();
+QObject *createMediaFileReaderTest();
+QObject *createTraceLogTest();
+QObject *createThemePaletteTest();
+QObject *createMediaSearchIndexTest();
+QObject *createUsbMonitorTest();
+QObject *createSurfaceWatchdogTest();
+
+#endif // TEST_SUITES_H
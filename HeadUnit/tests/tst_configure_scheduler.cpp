@@ -0,0 +1,135 @@
+// tst_configure_scheduler.cpp
+#include <QElapsedTimer>
+#include <QQuickItem>
+#include <QQuickWindow>
+#include <QTest>
+#include <memory>
+#include "configure_scheduler.h"
+#include "test_suites.h"
+
+namespace {
+
+constexpr int kIviId = 1002;
+const QSize kFull(800, 480);
+
+} // namespace
+
+// Configure counts of a surface without a client: the scheduler only counts
+// what it would send, and commits are reported by the test. Frames come from
+// an offscreen window.
+class ConfigureSchedulerTest : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase()
+    {
+        m_window.reset(new QQuickWindow);
+        m_window->resize(kFull);
+        m_window->show();
+        QVERIFY(QTest::qWaitForWindowExposed(m_window.get()));
+    }
+
+    void init()
+    {
+        m_item.reset(new QQuickItem(m_window->contentItem()));
+        m_item->setSize(kFull);
+        m_scheduler.reset(new ConfigureScheduler);
+        m_scheduler->track(kIviId, nullptr, m_item.get());
+    }
+
+    void cleanup()
+    {
+        m_scheduler.reset();
+        m_item.reset();
+    }
+
+    void oneConfigurePerFrame()
+    {
+        m_scheduler->sendNow(kIviId, kFull);
+        m_scheduler->committed(kIviId, kFull);
+        QCOMPARE(counters().acked, quint64(1));
+
+        // A keyboard slide: one request per animation step within a frame
+        for (int step = 1; step <= 30; ++step) {
+            m_scheduler->request(kIviId, QSize(800, 480 - 10 * step));
+        }
+        QTRY_COMPARE(counters().sent, quint64(2));
+        QTest::qWait(50);
+
+        const ConfigureScheduler::Counters result = counters();
+        QCOMPARE(result.requested, quint64(31));
+        QCOMPARE(result.sent, quint64(2));
+        QCOMPARE(result.coalesced, quint64(29));
+    }
+
+    void waitsForCommitAtConfiguredSize()
+    {
+        m_scheduler->sendNow(kIviId, kFull);
+        m_scheduler->request(kIviId, QSize(800, 300));
+        m_scheduler->request(kIviId, QSize(800, 200));
+
+        // One configure in flight; a frame at the old size is no ack
+        QTest::qWait(50);
+        m_scheduler->committed(kIviId, QSize(640, 480));
+        QTest::qWait(20);
+        QCOMPARE(counters().sent, quint64(1));
+        QCOMPARE(counters().acked, quint64(0));
+
+        m_scheduler->committed(kIviId, kFull);
+        QTRY_COMPARE_WITH_TIMEOUT(counters().sent, quint64(2), ConfigureScheduler::kAckTimeoutMs - 100);
+
+        const ConfigureScheduler::Counters result = counters();
+        QCOMPARE(result.acked, quint64(1));
+        QCOMPARE(result.coalesced, quint64(1));
+        QCOMPARE(result.timedOut, quint64(0));
+    }
+
+    void stalledClientTimesOut()
+    {
+        QElapsedTimer timer;
+        timer.start();
+        m_scheduler->sendNow(kIviId, kFull);
+        m_scheduler->request(kIviId, QSize(800, 300));
+
+        // The client never commits; the request goes out after the timeout
+        QTRY_COMPARE_WITH_TIMEOUT(counters().sent, quint64(2), 4 * ConfigureScheduler::kAckTimeoutMs);
+        QVERIFY(timer.elapsed() >= ConfigureScheduler::kAckTimeoutMs);
+
+        const ConfigureScheduler::Counters result = counters();
+        QCOMPARE(result.timedOut, quint64(1));
+        QCOMPARE(result.acked, quint64(0));
+    }
+
+    void hiddenSurfaceKeepsRequest()
+    {
+        m_scheduler->sendNow(kIviId, kFull);
+        m_scheduler->committed(kIviId, kFull);
+
+        m_item->setVisible(false);
+        m_scheduler->request(kIviId, QSize(800, 300));
+        m_window->update();
+        QTest::qWait(100);
+        QCOMPARE(counters().sent, quint64(1));
+
+        // Shown again, the registry repeats the request
+        m_item->setVisible(true);
+        m_scheduler->request(kIviId, QSize(800, 300));
+        QTRY_COMPARE(counters().sent, quint64(2));
+        QCOMPARE(counters().coalesced, quint64(0));
+    }
+
+private:
+    ConfigureScheduler::Counters counters() const { return m_scheduler->counters(kIviId); }
+
+    std::unique_ptr<QQuickWindow> m_window;
+    std::unique_ptr<QQuickItem> m_item;
+    std::unique_ptr<ConfigureScheduler> m_scheduler;
+};
+
+QObject *createConfigureSchedulerTest()
+{
+    return new ConfigureSchedulerTest;
+}
+
+#include "tst_configure_scheduler.moc"
@@ -0,0 +1,184 @@
+// tst_kalman_speed_filter.cpp
+#include <QElapsedTimer>
+#include <QTest>
+#include <cmath>
+#include "candump.h"
+#include "fixed_point.h"
+#include "kalman_speed_filter.h"
+#include "signal_decoder.h"
+#include "test_suites.h"
+
+using namespace vehicle;
+
+namespace {
+
+// As CanReader::filterSpeed: nominal dt for the first frame and after a gap
+constexpr double kNominalDtS = 0.05;
+constexpr double kMaxDtS = 0.5;
+
+struct SpeedTrace {
+    QVector<double> speeds;     // cm/s, as decoded
+    QVector<double> dts;        // s
+};
+
+template <typename T>
+QVector<double> runFilter(const SpeedTrace &trace)
+{
+    KalmanSpeedFilter<T> filter;
+    QVector<double> out;
+    out.reserve(trace.speeds.size());
+    for (int i = 0; i < trace.speeds.size(); ++i) {
+        if (trace.dts[i] > kMaxDtS) {
+            filter.reset();
+        }
+        const double dt = trace.dts[i] > kMaxDtS ? kNominalDtS : trace.dts[i];
+        out.append(double(filter.update(T(trace.speeds[i]), T(dt))));
+    }
+    return out;
+}
+
+// Sum of |second difference|: how much a signal jitters
+double roughness(const QVector<double> &values)
+{
+    double sum = 0.0;
+    for (int i = 1; i + 1 < values.size(); ++i) {
+        sum += std::fabs(values[i + 1] - 2.0 * values[i] + values[i - 1]);
+    }
+    return sum;
+}
+
+template <typename T>
+double nsPerUpdate(const SpeedTrace &trace)
+{
+    constexpr int kRounds = 5000;
+    KalmanSpeedFilter<T> filter;
+    volatile double sink = 0.0;
+
+    QElapsedTimer timer;
+    timer.start();
+    for (int round = 0; round < kRounds; ++round) {
+        for (int i = 0; i < trace.speeds.size(); ++i) {
+            sink = double(filter.update(T(trace.speeds[i]), T(kNominalDtS)));
+        }
+    }
+    Q_UNUSED(sink);
+    return double(timer.nsecsElapsed()) / (double(kRounds) * trace.speeds.size());
+}
+
+} // namespace
+
+// The speed filter over the speed frames of tools/sample_drive.log, decoded
+// as the CAN reader does
+class KalmanSpeedFilterTest : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase()
+    {
+        const QVector<TimedFrame> frames = loadCandump(QStringLiteral(HEADUNIT_TRACE_DIR "/sample_drive.log"));
+        QVERIFY(!frames.isEmpty());
+
+        const SignalDecoder decoder(kSignalTable, kSignalTableSize);
+        double values[SignalCount] = {};
+        double lastTimeS = -1.0;
+        for (const TimedFrame &timed : frames) {
+            if (!(decoder.decode(timed.frame, values) & (1u << SpeedSignal))) {
+                continue;
+            }
+            m_trace.speeds.append(values[SpeedSignal]);
+            m_trace.dts.append(lastTimeS < 0.0 ? kMaxDtS + 1.0 : timed.timeS - lastTimeS);
+            lastTimeS = timed.timeS;
+        }
+        QVERIFY(m_trace.speeds.size() > 100);
+    }
+
+    void smoothsRecordedTrace()
+    {
+        const QVector<double> filtered = runFilter<double>(m_trace);
+
+        double measuredPeak = 0.0;
+        double filteredPeak = 0.0;
+        for (int i = 0; i < filtered.size(); ++i) {
+            QVERIFY2(filtered[i] >= 0.0, qPrintable(QStringLiteral("negative speed at %1").arg(i)));
+            measuredPeak = qMax(measuredPeak, m_trace.speeds[i]);
+            filteredPeak = qMax(filteredPeak, filtered[i]);
+        }
+
+        // Follows the drive: peak close to the measured one, back to rest
+        QVERIFY2(std::fabs(filteredPeak - measuredPeak) < 0.15 * measuredPeak,
+                 qPrintable(QStringLiteral("peak %1, measured %2").arg(filteredPeak).arg(measuredPeak)));
+        QCOMPARE(m_trace.speeds.last(), 0.0);
+        QVERIFY2(filtered.last() < 1.0, qPrintable(QString::number(filtered.last())));
+
+        // ...and takes out most of the jitter
+        const double roughIn = roughness(m_trace.speeds);
+        const double roughOut = roughness(filtered);
+        QVERIFY2(roughOut * 5.0 < roughIn,
+                 qPrintable(QStringLiteral("roughness %1 -> %2").arg(roughIn).arg(roughOut)));
+    }
+
+    void scalarsAgree()
+    {
+        const QVector<double> reference = runFilter<double>(m_trace);
+        const QVector<double> single = runFilter<float>(m_trace);
+        const QVector<double> fixed = runFilter<FixedPoint<>>(m_trace);
+
+        for (int i = 0; i < reference.size(); ++i) {
+            QVERIFY2(std::fabs(single[i] - reference[i]) < 0.5,
+                     qPrintable(QStringLiteral("float %1 vs %2 at %3").arg(single[i]).arg(reference[i]).arg(i)));
+            QVERIFY2(std::fabs(fixed[i] - reference[i]) < 0.5,
+                     qPrintable(QStringLiteral("fixed %1 vs %2 at %3").arg(fixed[i]).arg(reference[i]).arg(i)));
+        }
+    }
+
+    // Products past 64 bits and negative operands, against exact results
+    void fixedPointArithmetic()
+    {
+        using Fixed = FixedPoint<>;
+
+        QCOMPARE((Fixed(10000) * Fixed(10000)).toDouble(), 1e8);
+        QCOMPARE((Fixed(-3.25) * Fixed(2.5)).toDouble(), -8.125);
+        QCOMPARE((Fixed(-46340) * Fixed(-46340)).toDouble(), 2147395600.0);
+        QCOMPARE((Fixed(7) / Fixed(-2)).toDouble(), -3.5);
+        QCOMPARE((Fixed(100000000) / Fixed(10000)).toDouble(), 1e4);
+
+        // Quotients truncate toward zero, products round toward -infinity
+        QCOMPARE((Fixed(1) / Fixed(3)).raw(), qint64(1431655765));
+        QCOMPARE((Fixed(-1) / Fixed(3)).raw(), qint64(-1431655765));
+        QCOMPARE((Fixed::fromRaw(1) * Fixed::fromRaw(1)).raw(), qint64(0));
+        QCOMPARE((Fixed::fromRaw(-1) * Fixed::fromRaw(1)).raw(), qint64(-1));
+
+        // Filter-sized extremes: dt^4 against a large variance
+        const Fixed dt4 = Fixed(0.05) * Fixed(0.05) * Fixed(0.05) * Fixed(0.05);
+        QVERIFY(std::fabs((dt4 * Fixed(10000)).toDouble() - 0.0625) < 1e-5);
+    }
+
+    void benchmarkUpdate_data()
+    {
+        QTest::addColumn<int>("scalar");
+        QTest::newRow("float") << 0;
+        QTest::newRow("double") << 1;
+        QTest::newRow("FixedPoint") << 2;
+    }
+
+    void benchmarkUpdate()
+    {
+        QFETCH(int, scalar);
+        const double ns = scalar == 0 ? nsPerUpdate<float>(m_trace)
+                        : scalar == 1 ? nsPerUpdate<double>(m_trace)
+                                      : nsPerUpdate<FixedPoint<>>(m_trace);
+        QTest::setBenchmarkResult(ns, QTest::WalltimeNanoseconds);
+        qInfo("[KalmanSpeedFilter] %s: %.1f ns/update", QTest::currentDataTag(), ns);
+    }
+
+private:
+    SpeedTrace m_trace;
+};
+
+QObject *createKalmanSpeedFilterTest()
+{
+    return new KalmanSpeedFilterTest;
+}
+
+#include "tst_kalman_speed_filter.moc"
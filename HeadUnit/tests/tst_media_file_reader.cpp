@@ -0,0 +1,182 @@
+// tst_media_file_reader.cpp
+#include <QElapsedTimer>
+#include <QTemporaryFile>
+#include <QTest>
+#include <QThread>
+#include <atomic>
+#include <memory>
+#include "media_file_reader.h"
+#include "pcm_jitter_buffer.h"
+#include "test_suites.h"
+
+namespace {
+
+// USB stick stand-in: page-ins are free until the device is armed, then the
+// next one starts a stall that every page-in waits out, like a stick busy
+// with wear levelling
+class StallingDevice
+{
+public:
+    explicit StallingDevice(qint64 stallMs)
+        : m_stallNs(stallMs * 1000000)
+    {
+        m_clock.start();
+    }
+
+    void arm() { m_armed = true; }
+    bool hasStalled() const { return m_stallEndNs.load() > 0; }
+
+    void pageIn(qint64, qint64)
+    {
+        if (m_armed.exchange(false)) {
+            m_stallEndNs = m_clock.nsecsElapsed() + m_stallNs;
+        }
+        qint64 remainingNs;
+        while ((remainingNs = m_stallEndNs.load() - m_clock.nsecsElapsed()) > 0) {
+            QThread::usleep(static_cast<unsigned long>(qMin<qint64>(remainingNs / 1000 + 1, 10000)));
+        }
+    }
+
+private:
+    QElapsedTimer m_clock;
+    const qint64 m_stallNs;
+    std::atomic<bool> m_armed { false };
+    std::atomic<qint64> m_stallEndNs { 0 };
+};
+
+} // namespace
+
+// Reader -> jitter buffer -> sink as in AudioEngine, with the decoder passing
+// bytes through: a 500 ms device stall in the middle of playback must be
+// covered by readahead, without underruns and without blocking a read
+class MediaFileReaderTest : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void survivesUsbStall()
+    {
+        // Four times 48 kHz stereo 16-bit PCM, more than any track consumes,
+        // so the test takes seconds; the jitter buffer holds 250 ms of it
+        constexpr qint64 kBytesPerSec = 4 * 48000 * 2 * 2;
+        constexpr qint64 kSinkPeriodMs = 10;
+        constexpr qint64 kSinkChunk = kBytesPerSec * kSinkPeriodMs / 1000;
+        constexpr qint64 kDecodeChunk = 16 * 1024;
+        constexpr qint64 kFileSize = 4 * 1024 * 1024;
+        constexpr qint64 kPlayBytes = 2 * 1024 * 1024;
+        constexpr qint64 kArmAt = 256 * 1024;
+
+        QTemporaryFile file;
+        QVERIFY(file.open());
+        QByteArray block(64 * 1024, '\0');
+        for (int i = 0; i < block.size(); ++i) {
+            block[i] = char(i * 7);
+        }
+        for (qint64 written = 0; written < kFileSize; written += block.size()) {
+            QCOMPARE(file.write(block), qint64(block.size()));
+        }
+        QVERIFY(file.flush());
+
+        StallingDevice device(500);
+        MediaFileReader reader;
+        reader.setPageInHook([&device](qint64 offset, qint64 length) { device.pageIn(offset, length); });
+        QVERIFY(reader.openFile(file.fileName()));
+
+        PcmJitterBuffer jitter(kBytesPerSec / 4);
+        std::atomic<bool> decoderDone(false);
+        qint64 maxReadNs = 0;
+        qint64 decoded = 0;
+
+        std::unique_ptr<QThread> decoder(QThread::create([&]() {
+            QByteArray buffer(kDecodeChunk, '\0');
+            QElapsedTimer timer;
+            while (decoded < kPlayBytes) {
+                if (jitter.freeSpace() < kDecodeChunk) {
+                    QThread::msleep(1);
+                    continue;
+                }
+                timer.start();
+                const qint64 n = reader.read(buffer.data(), kDecodeChunk);
+                maxReadNs = qMax(maxReadNs, timer.nsecsElapsed());
+                if (n <= 0) {
+                    break;
+                }
+                jitter.write(buffer.constData(), n);
+                decoded += n;
+                if (decoded >= kArmAt) {
+                    device.arm();
+                }
+            }
+            decoderDone = true;
+        }));
+
+        std::unique_ptr<QThread> sink(QThread::create([&]() {
+            // Starts once half full, as QAudioSink does with its own buffer
+            while (jitter.fillLevel() < jitter.capacity() / 2 && !decoderDone.load()) {
+                QThread::msleep(1);
+            }
+            jitter.resetUnderruns();
+
+            QByteArray buffer(kSinkChunk, '\0');
+            QElapsedTimer clock;
+            clock.start();
+            qint64 nextMs = 0;
+            for (;;) {
+                const bool streaming = !decoderDone.load();
+                if (!streaming && jitter.fillLevel() == 0) {
+                    break;
+                }
+                jitter.read(buffer.data(), kSinkChunk, streaming);
+                nextMs += kSinkPeriodMs;
+                const qint64 sleepMs = nextMs - clock.elapsed();
+                if (sleepMs > 0) {
+                    QThread::msleep(static_cast<unsigned long>(sleepMs));
+                }
+            }
+        }));
+
+        decoder->start();
+        sink->start();
+        QVERIFY(decoder->wait(30000));
+        QVERIFY(sink->wait(30000));
+
+        qInfo("[MediaFileReader] stalls %d, slowest read %.2f ms, underruns %d, readahead window %lld KiB",
+              reader.stallCount(), maxReadNs / 1e6, jitter.underrunCount(),
+              static_cast<long long>(reader.readaheadWindow() / 1024));
+
+        QCOMPARE(decoded, kPlayBytes);
+        QVERIFY(device.hasStalled());
+        QVERIFY(reader.stallCount() >= 1);
+        QCOMPARE(jitter.underrunCount(), 0);
+        // Served from readahead: no read waited for the device
+        QVERIFY2(maxReadNs < 100000000, qPrintable(QString::number(maxReadNs / 1e6)));
+        // The window grows after a stall
+        QVERIFY(reader.readaheadWindow() > 1024 * 1024);
+    }
+
+    void jitterBufferDropsOnClear()
+    {
+        PcmJitterBuffer jitter(8);
+        QCOMPARE(jitter.write("abcdef", 6), qint64(6));
+        char out[8] = {};
+        QCOMPARE(jitter.read(out, 2, false), qint64(2));
+
+        // Space the consumer has not moved past yet is not reused
+        jitter.clear();
+        QCOMPARE(jitter.fillLevel(), qint64(0));
+        QCOMPARE(jitter.freeSpace(), qint64(4));
+
+        QCOMPARE(jitter.write("wxyz", 4), qint64(4));
+        QCOMPARE(jitter.read(out, 8, true), qint64(8));
+        QCOMPARE(QByteArray(out, 4), QByteArray("wxyz"));
+        QCOMPARE(jitter.underrunCount(), 1);
+        QCOMPARE(jitter.freeSpace(), qint64(8));
+    }
+};
+
+QObject *createMediaFileReaderTest()
+{
+    return new MediaFileReaderTest;
+}
+
+#include "tst_media_file_reader.moc"
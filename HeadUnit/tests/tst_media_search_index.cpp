@@ -0,0 +1,226 @@
+// tst_media_search_index.cpp
+#include <QElapsedTimer>
+#include <QRandomGenerator>
+#include <QTest>
+#include <algorithm>
+#include "media_search_index.h"
+#include "test_suites.h"
+
+namespace {
+
+constexpr int kLibrarySize = 50000;
+// What a keystroke may cost, index lookup to ranked results
+constexpr qint64 kKeystrokeBudgetNs = 5000000;
+
+// Tracks with known words, at the start of the list
+const MediaSearchIndex::Track kKnown[] = {
+    { "Come Together", "The Beatles", "Abbey Road", "01 Come Together.mp3", 0 },
+    { "Something", "The Beatles", "Abbey Road", "02 Something.mp3", 1 },
+    { "Road to Nowhere", "Talking Heads", "Little Creatures", "road_to_nowhere.flac", 2 },
+    { "Bohemian Rhapsody", "Queen", "A Night at the Opera", "bohemian.mp3", 3 },
+    { "Ace of Spades", "Motörhead", "Ace of Spades", "ace.mp3", 4 },
+    { "Abbey", "Roadrunners", "Live", "abbey.mp3", 5 },
+    { "Queens of the Stone Age Medley", "Tribute", "Covers", "medley.mp3", 6 },
+};
+constexpr int kKnownCount = int(sizeof(kKnown) / sizeof(kKnown[0]));
+
+// Filler words share no trigram with the known ones (letters k v x z j w f
+// and vowels only), so they never turn up in the known tracks' results
+QString fillerWord(QRandomGenerator &random)
+{
+    static const char consonants[] = "kvxzjwf";
+    static const char vowels[] = "aeiou";
+    QString word;
+    const int syllables = 2 + random.bounded(3);
+    for (int i = 0; i < syllables; ++i) {
+        word += QLatin1Char(consonants[random.bounded(7)]);
+        word += QLatin1Char(vowels[random.bounded(5)]);
+    }
+    return word;
+}
+
+QString fillerText(QRandomGenerator &random, const QStringList &words, int maxWords)
+{
+    QStringList text;
+    const int count = 1 + random.bounded(maxWords);
+    for (int i = 0; i < count; ++i) {
+        text << words[random.bounded(words.size())];
+    }
+    return text.join(QLatin1Char(' '));
+}
+
+// A library the size of a large USB stick: 20000 distinct words, 2000
+// artists with 5000 albums between them
+MediaSearchIndex *buildLibrary(int size)
+{
+    QRandomGenerator random(2024);
+    QStringList words;
+    for (int i = 0; i < 20000; ++i) {
+        words << fillerWord(random);
+    }
+    QStringList artists;
+    for (int i = 0; i < 2000; ++i) {
+        artists << fillerText(random, words, 2);
+    }
+    QStringList albums;
+    for (int i = 0; i < 5000; ++i) {
+        albums << fillerText(random, words, 3);
+    }
+
+    auto *index = new MediaSearchIndex;
+    for (const MediaSearchIndex::Track &track : kKnown) {
+        index->addTrack(track);
+    }
+    for (int i = kKnownCount; i < size; ++i) {
+        MediaSearchIndex::Track track;
+        track.title = fillerText(random, words, 4);
+        track.album = albums[random.bounded(albums.size())];
+        track.artist = artists[random.bounded(artists.size())];
+        track.fileName = QStringLiteral("%1 %2.mp3").arg(i % 20 + 1, 2, 10, QLatin1Char('0')).arg(track.title);
+        track.listIndex = i;
+        index->addTrack(track);
+    }
+    index->build();
+    return index;
+}
+
+QVector<int> listIndices(const MediaSearchIndex &index, const QVector<MediaSearchIndex::Result> &results)
+{
+    QVector<int> out;
+    for (const MediaSearchIndex::Result &result : results) {
+        out << index.track(result.track).listIndex;
+    }
+    return out;
+}
+
+} // namespace
+
+// Matching and ranking against a 50k-track library, and the cost of each
+// keystroke of prefix and misspelt queries
+class MediaSearchIndexTest : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase()
+    {
+        QElapsedTimer timer;
+        timer.start();
+        m_index.reset(buildLibrary(kLibrarySize));
+        qInfo("[MediaSearch] %d tracks, %d tokens, built in %lld ms", m_index->trackCount(),
+              m_index->tokenCount(), timer.elapsed());
+        QCOMPARE(m_index->trackCount(), kLibrarySize);
+    }
+
+    void matches_data()
+    {
+        QTest::addColumn<QString>("query");
+        QTest::addColumn<QVector<int>>("expected");     // list indices, best first
+
+        // Title beats album, exact beats prefix
+        QTest::newRow("field") << "abbey" << QVector<int>{ 5, 0, 1 };
+        QTest::newRow("exact before prefix") << "road" << QVector<int>{ 2, 0, 1, 5 };
+        QTest::newRow("prefix") << "bohem" << QVector<int>{ 3 };
+        QTest::newRow("accents folded") << "MOTORHEAD" << QVector<int>{ 4 };
+        QTest::newRow("case and punctuation") << "come-TOGETHER!" << QVector<int>{ 0 };
+
+        // Typos: transposition, deletion, two edits. The misspelt word
+        // matches a prefix too ("queens"), and a title still beats an artist
+        QTest::newRow("transposed") << "beatels" << QVector<int>{ 0, 1 };
+        QTest::newRow("missing letter") << "qeen" << QVector<int>{ 6, 3 };
+        QTest::newRow("transposed long") << "bohemain" << QVector<int>{ 3 };
+        QTest::newRow("two edits") << "rhapsodie" << QVector<int>{ 3 };
+        QTest::newRow("too far") << "rapsodie" << QVector<int>{};
+
+        // Every term must match, in any field
+        QTest::newRow("and across fields") << "abbey road" << QVector<int>{ 5, 0, 1 };
+        QTest::newRow("and narrows") << "beatles something" << QVector<int>{ 1 };
+        QTest::newRow("and with prefix") << "queen opera" << QVector<int>{ 3 };
+        QTest::newRow("and with typos") << "beatels somthing" << QVector<int>{ 1 };
+        QTest::newRow("and unmatched") << "beatles nowhere" << QVector<int>{};
+        QTest::newRow("order free") << "heads talking" << QVector<int>{ 2 };
+        QTest::newRow("empty") << " - " << QVector<int>{};
+    }
+
+    void matches()
+    {
+        QFETCH(QString, query);
+        QFETCH(QVector<int>, expected);
+
+        QCOMPARE(listIndices(*m_index, m_index->search(query, 100)), expected);
+    }
+
+    void reusedStateIsReset()
+    {
+        // A broad query, then a narrow one: nothing of the first may leak
+        QVERIFY(m_index->search(QStringLiteral("k"), 100).size() == 100);
+        QCOMPARE(listIndices(*m_index, m_index->search(QStringLiteral("something"), 100)), QVector<int>{ 1 });
+        QCOMPARE(listIndices(*m_index, m_index->search(QStringLiteral("k"), 100)),
+                 listIndices(*m_index, m_index->search(QStringLiteral("k"), 100)));
+    }
+
+    void benchmarkKeystrokes_data()
+    {
+        QTest::addColumn<bool>("typo");
+        QTest::newRow("prefix") << false;
+        QTest::newRow("fuzzy") << true;
+    }
+
+    void benchmarkKeystrokes()
+    {
+        QFETCH(bool, typo);
+
+        // "artist title" of random tracks, typed one character at a time;
+        // with a typo, two letters of each word are swapped
+        QRandomGenerator random(7);
+        QStringList queries;
+        for (int i = 0; i < 20; ++i) {
+            const MediaSearchIndex::Track &track = m_index->track(kKnownCount + random.bounded(kLibrarySize - kKnownCount));
+            QStringList words = { track.artist.section(' ', 0, 0), track.title.section(' ', 0, 0) };
+            if (typo) {
+                for (QString &word : words) {
+                    const int at = 1 + random.bounded(int(word.size()) - 2);
+                    std::swap(word[at], word[at + 1]);
+                }
+            }
+            queries << words.join(QLatin1Char(' '));
+        }
+
+        QVector<qint64> keystrokes;
+        int found = 0;
+        QElapsedTimer timer;
+        for (const QString &query : std::as_const(queries)) {
+            for (int length = 1; length <= query.size(); ++length) {
+                timer.start();
+                const QVector<MediaSearchIndex::Result> results = m_index->search(query.left(length), 100);
+                keystrokes << timer.nsecsElapsed();
+                found += results.isEmpty() ? 0 : 1;
+            }
+        }
+        QVERIFY(found > keystrokes.size() / 2);
+
+        std::sort(keystrokes.begin(), keystrokes.end());
+        const double medianMs = keystrokes[keystrokes.size() / 2] / 1e6;
+        const double p95Ms = keystrokes[keystrokes.size() * 95 / 100] / 1e6;
+        const double maxMs = keystrokes.last() / 1e6;
+        QTest::setBenchmarkResult(medianMs, QTest::WalltimeMilliseconds);
+        qInfo("[MediaSearch] %s: %d keystrokes, median %.3f ms, p95 %.3f ms, max %.3f ms",
+              typo ? "fuzzy" : "prefix", int(keystrokes.size()), medianMs, p95Ms, maxMs);
+
+        // Debug builds only report
+#ifdef QT_NO_DEBUG
+        QVERIFY2(keystrokes.last() < kKeystrokeBudgetNs,
+                 qPrintable(QStringLiteral("slowest keystroke %1 ms").arg(maxMs)));
+#endif
+    }
+
+private:
+    QScopedPointer<MediaSearchIndex> m_index;
+};
+
+QObject *createMediaSearchIndexTest()
+{
+    return new MediaSearchIndexTest;
+}
+
+#include "tst_media_search_index.moc"
@@ -0,0 +1,104 @@
+// tst_signal_decoder.cpp
+#include <QElapsedTimer>
+#include <QTest>
+#include <algorithm>
+#include <cstring>
+#include <initializer_list>
+#include "candump.h"
+#include "signal_decoder.h"
+#include "test_suites.h"
+
+using namespace vehicle;
+
+namespace {
+
+can_frame makeFrame(quint32 canId, std::initializer_list<quint8> data)
+{
+    can_frame frame;
+    std::memset(&frame, 0, sizeof(frame));
+    frame.can_id = canId;
+    frame.can_dlc = quint8(data.size());
+    std::copy(data.begin(), data.end(), frame.data);
+    return frame;
+}
+
+} // namespace
+
+class SignalDecoderTest : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void decodesVehicleMatrix()
+    {
+        const SignalDecoder decoder(kSignalTable, kSignalTableSize);
+        double values[SignalCount] = {};
+
+        // Speed is Motorola, 16 bit from bit 7
+        QCOMPARE(decoder.decode(makeFrame(0x100, { 0x12, 0x34 }), values), 1u << SpeedSignal);
+        QCOMPARE(values[SpeedSignal], 4660.0);
+
+        QCOMPARE(decoder.decode(makeFrame(0x102, { 'D' }), values), 1u << GearSignal);
+        QCOMPARE(values[GearSignal], double('D'));
+
+        QCOMPARE(decoder.decode(makeFrame(0x103, { 3 }), values), 1u << TurnSignal);
+        QCOMPARE(values[TurnSignal], 3.0);
+
+        // Unknown id, and a frame too short for its signal, change nothing
+        QCOMPARE(decoder.decode(makeFrame(0x101, { 0xff, 0xff }), values), 0u);
+        QCOMPARE(decoder.decode(makeFrame(0x100, { 0xff }), values), 0u);
+        QCOMPARE(values[SpeedSignal], 4660.0);
+
+        QVERIFY(decoder.isDiscrete(GearSignal));
+        QVERIFY(!decoder.isDiscrete(SpeedSignal));
+    }
+
+    void decodesRecordedTrace()
+    {
+        const QVector<TimedFrame> frames = loadCandump(QStringLiteral(HEADUNIT_TRACE_DIR "/sample_drive.log"));
+        QVERIFY(!frames.isEmpty());
+
+        const SignalDecoder decoder(kSignalTable, kSignalTableSize);
+        double values[SignalCount] = {};
+        int decoded = 0;
+        for (const TimedFrame &timed : frames) {
+            if (decoder.decode(timed.frame, values)) {
+                decoded++;
+            }
+        }
+        // Every frame of the sample is in the matrix; it ends parked
+        QCOMPARE(decoded, int(frames.size()));
+        QCOMPARE(values[SpeedSignal], 0.0);
+    }
+
+    void benchmarkDecode()
+    {
+        const QVector<TimedFrame> frames = loadCandump(QStringLiteral(HEADUNIT_TRACE_DIR "/sample_drive.log"));
+        QVERIFY(!frames.isEmpty());
+
+        constexpr int kRounds = 5000;
+        const SignalDecoder decoder(kSignalTable, kSignalTableSize);
+        double values[SignalCount] = {};
+        volatile quint32 sink = 0;
+
+        QElapsedTimer timer;
+        timer.start();
+        for (int round = 0; round < kRounds; ++round) {
+            for (const TimedFrame &timed : frames) {
+                sink = sink + decoder.decode(timed.frame, values);
+            }
+        }
+        const double ns = double(timer.nsecsElapsed()) / (double(kRounds) * frames.size());
+        Q_UNUSED(sink);
+
+        QTest::setBenchmarkResult(ns, QTest::WalltimeNanoseconds);
+        qInfo("[SignalDecoder] %.1f ns/frame", ns);
+    }
+};
+
+QObject *createSignalDecoderTest()
+{
+    return new SignalDecoderTest;
+}
+
+#include "tst_signal_decoder.moc"
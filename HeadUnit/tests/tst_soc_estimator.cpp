@@ -0,0 +1,72 @@
+// tst_soc_estimator.cpp
+#include <QTest>
+#include <cmath>
+#include "power_sensor.h"
+#include "soc_estimator.h"
+#include "test_suites.h"
+
+using namespace vehicle;
+
+// The SoC estimator fed by the recorded INA219 trace, at the battery
+// monitor's 100 Hz
+class SocEstimatorTest : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void followsCoulombCountOverTrace()
+    {
+        constexpr double kPeriodS = 0.01;
+        constexpr int kSteps = 11900;      // the 120 s trace once, not looped
+
+        TraceSensor sensor(QStringLiteral(HEADUNIT_TRACE_DIR "/sample_battery.csv"), kPeriodS);
+        QVERIFY(sensor.open());
+
+        SocEstimator estimator;
+        double initialSoc = 0.0;
+        double usedAh = 0.0;
+        PowerSample sample;
+        for (int step = 0; step < kSteps; ++step) {
+            QVERIFY(sensor.read(&sample));
+            estimator.step(sample.voltage, sample.current, kPeriodS);
+            QVERIFY(estimator.isValid());
+            QVERIFY2(estimator.soc() >= 0.0 && estimator.soc() <= 1.0,
+                     qPrintable(QString::number(estimator.soc())));
+
+            if (step == 0) {
+                initialSoc = estimator.soc();
+            } else {
+                usedAh += sample.current * kPeriodS / 3600.0;
+            }
+        }
+
+        // The trace starts at rest at about 60%
+        QVERIFY2(std::fabs(initialSoc - 0.60) < 0.02, qPrintable(QString::number(initialSoc)));
+
+        // A drive happened, and the voltage under load did not pull the
+        // estimate away from the charge actually drawn
+        QVERIFY2(usedAh > 0.03, qPrintable(QString::number(usedAh)));
+        const double counted = initialSoc - usedAh / estimator.params().capacityAh;
+        QVERIFY2(std::fabs(estimator.soc() - counted) < 0.005,
+                 qPrintable(QStringLiteral("soc %1, coulomb count %2").arg(estimator.soc()).arg(counted)));
+    }
+
+    void ocvCurveIsMonotonic()
+    {
+        QCOMPARE(SocEstimator::socFromCellVoltage(2.5), 0.0);
+        QCOMPARE(SocEstimator::socFromCellVoltage(4.3), 1.0);
+        double last = 0.0;
+        for (double volts = 3.0; volts <= 4.2; volts += 0.01) {
+            const double soc = SocEstimator::socFromCellVoltage(volts);
+            QVERIFY(soc >= last);
+            last = soc;
+        }
+    }
+};
+
+QObject *createSocEstimatorTest()
+{
+    return new SocEstimatorTest;
+}
+
+#include "tst_soc_estimator.moc"
@@ -0,0 +1,143 @@
+// tst_subscription_manager.cpp
+#include <QDBusConnection>
+#include <QDBusVariant>
+#include <QElapsedTimer>
+#include <QTest>
+#include "subscription_manager.h"
+#include "test_suites.h"
+
+using namespace vehicle;
+
+namespace {
+
+const QString kPath = QStringLiteral("/com/headunit/test/VehicleData");
+const QString kInterface = QStringLiteral("com.headunit.test.VehicleData");
+
+} // namespace
+
+// Delivery semantics as a client sees them: the test subscribes with its
+// own bus name and collects the Updated messages it is sent
+class SubscriptionManagerTest : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase()
+    {
+        QDBusConnection bus = QDBusConnection::sessionBus();
+        if (!bus.isConnected()) {
+            QSKIP("no session bus");
+        }
+        m_client = bus.baseService();
+        QVERIFY(bus.connect(QString(), kPath, kInterface, QStringLiteral("Updated"),
+                            this, SLOT(onUpdated(QString,QDBusVariant))));
+    }
+
+    void init()
+    {
+        m_members.clear();
+        m_values.clear();
+    }
+
+    void deadbandHoldsUntilSettled()
+    {
+        SubscriptionManager manager(kPath, kInterface);
+        manager.subscribe(m_client, SpeedSignal, 0.0, 50.0, 0.0);
+        QTRY_COMPARE(m_values.size(), 1);
+
+        // Inside the deadband: nothing yet
+        manager.offer(SpeedSignal, 30.0);
+        manager.offer(SpeedSignal, 40.0);
+        QTest::qWait(20);
+        QCOMPARE(m_values.size(), 1);
+
+        // Out of it: right away
+        manager.offer(SpeedSignal, 100.0);
+        QTRY_COMPARE_WITH_TIMEOUT(m_values.size(), 2, 50);
+        QCOMPARE(m_values.last(), 100.0);
+
+        // A small last step still arrives once the signal holds still
+        manager.offer(SpeedSignal, 120.0);
+        QTRY_COMPARE_WITH_TIMEOUT(m_values.size(), 3, 1000);
+        QCOMPARE(m_values.last(), 120.0);
+        QCOMPARE(m_members.last(), QStringLiteral("SpeedChanged"));
+
+        // Back to the delivered value: nothing to send
+        manager.offer(SpeedSignal, 130.0);
+        manager.offer(SpeedSignal, 120.0);
+        QTest::qWait(200);
+        QCOMPARE(m_values.size(), 3);
+        QCOMPARE(manager.counters().suppressed, quint64(1));
+    }
+
+    void rateLimitKeepsLatest()
+    {
+        constexpr double kRateHz = 10.0;
+        SubscriptionManager manager(kPath, kInterface);
+        manager.subscribe(m_client, SpeedSignal, kRateHz, 0.0, QVariant());
+
+        // 100 distinct values over half a second
+        QElapsedTimer timer;
+        timer.start();
+        double value = 0.0;
+        for (int i = 0; i < 100; ++i) {
+            value = 10.0 * (i + 1);
+            manager.offer(SpeedSignal, value);
+            QTest::qWait(5);
+        }
+        const double elapsedS = timer.elapsed() / 1000.0;
+
+        // The last value arrives, at no more than the rate in between
+        QTRY_COMPARE_WITH_TIMEOUT(m_values.isEmpty() ? 0.0 : m_values.last(), value, 1000);
+        QTest::qWait(150);
+        QCOMPARE(m_values.last(), value);
+        QVERIFY2(m_values.size() <= int(elapsedS * kRateHz) + 2,
+                 qPrintable(QStringLiteral("%1 updates in %2 s").arg(m_values.size()).arg(elapsedS)));
+        QVERIFY(manager.counters().coalesced > 0);
+
+        for (int i = 1; i < m_values.size(); ++i) {
+            QVERIFY(m_values[i] > m_values[i - 1]);
+        }
+    }
+
+    void limitsAndDiscreteAreImmediate()
+    {
+        SubscriptionManager manager(kPath, kInterface);
+        manager.subscribe(m_client, BatterySignal, 0.0, 5.0, 98.0);
+        manager.subscribe(m_client, GearSignal, 0.0, 0.0, double('P'));
+        QTRY_COMPARE(m_values.size(), 2);
+
+        // Full is sent although it is inside the deadband...
+        manager.offer(BatterySignal, 100.0);
+        QTRY_COMPARE_WITH_TIMEOUT(m_values.size(), 3, 50);
+        QCOMPARE(m_values.last(), 100.0);
+        QCOMPARE(m_members.last(), QStringLiteral("BatteryChanged"));
+
+        // ...and a gear change on change, a repeat not at all
+        manager.offer(GearSignal, double('D'));
+        manager.offer(GearSignal, double('D'));
+        QTRY_COMPARE_WITH_TIMEOUT(m_values.size(), 4, 50);
+        QCOMPARE(m_values.last(), double('D'));
+        QTest::qWait(50);
+        QCOMPARE(m_values.size(), 4);
+    }
+
+public slots:
+    void onUpdated(const QString &member, const QDBusVariant &value)
+    {
+        m_members.append(member);
+        m_values.append(value.variant().toDouble());
+    }
+
+private:
+    QString m_client;
+    QStringList m_members;
+    QVector<double> m_values;
+};
+
+QObject *createSubscriptionManagerTest()
+{
+    return new SubscriptionManagerTest;
+}
+
+#include "tst_subscription_manager.moc"
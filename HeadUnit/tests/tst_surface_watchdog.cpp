@@ -0,0 +1,187 @@
+// tst_surface_watchdog.cpp
+#include <QDBusConnection>
+#include <QDBusContext>
+#include <QElapsedTimer>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QSignalSpy>
+#include <QTest>
+#include <QThread>
+#include "dbus_manager.h"
+#include "surface_registry.h"
+#include "surface_watchdog.h"
+#include "test_suites.h"
+
+namespace {
+
+constexpr int kAppId = 1002;
+constexpr int kHangMs = 400;
+constexpr int kRestartMs = 300;
+// The watchdog pings every hang/4, at least every 100 ms
+constexpr int kIntervalMs = 100;
+// Coarse QTimer jitter over the ticks up to the hang
+constexpr int kTimerSlackMs = 25;
+
+const QString kStandInConnection = QStringLiteral("watchdog-stand-ins");
+
+// com.headunit.App<id> of a client whose GUI thread is stuck: every Ping
+// is accepted and never answered
+class HungApp : public QObject, protected QDBusContext
+{
+    Q_OBJECT
+    Q_CLASSINFO("D-Bus Interface", "com.headunit.AppLiveness")
+
+public:
+    int pings() const { return m_pings.loadRelaxed(); }
+
+public slots:
+    uint Ping(uint serial)
+    {
+        m_pings.fetchAndAddRelaxed(1);
+        setDelayedReply(true);
+        return serial;
+    }
+
+private:
+    QAtomicInt m_pings;
+};
+
+// The AFM, as far as DBusManager::restartApp() goes
+class AppLifecycle : public QObject
+{
+    Q_OBJECT
+    Q_CLASSINFO("D-Bus Interface", "com.headunit.AppLifecycle")
+
+public:
+    QList<int> restarts() const
+    {
+        QMutexLocker locker(&m_mutex);
+        return m_restarts;
+    }
+
+public slots:
+    void RestartApp(int iviId)
+    {
+        QMutexLocker locker(&m_mutex);
+        m_restarts.append(iviId);
+    }
+
+private:
+    mutable QMutex m_mutex;
+    QList<int> m_restarts;
+};
+
+} // namespace
+
+// A client that stops answering pings, seen from the compositor. The
+// stand-ins live on their own bus connection and thread, so the watchdog's
+// calls go through the bus daemon like they would to a real client.
+class SurfaceWatchdogTest : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase()
+    {
+        if (!QDBusConnection::sessionBus().isConnected()) {
+            QSKIP("no session bus");
+        }
+        qputenv("HEADUNIT_WATCHDOG_HANG_MS", QByteArray::number(kHangMs));
+        qputenv("HEADUNIT_WATCHDOG_RESTART_MS", QByteArray::number(kRestartMs));
+
+        m_standInThread.start();
+        m_app.moveToThread(&m_standInThread);
+        m_afm.moveToThread(&m_standInThread);
+
+        QDBusConnection standIns = QDBusConnection::connectToBus(QDBusConnection::SessionBus, kStandInConnection);
+        QVERIFY(standIns.isConnected());
+        QVERIFY(standIns.registerObject(QStringLiteral("/com/headunit/App"), &m_app,
+                                        QDBusConnection::ExportAllSlots));
+        QVERIFY(standIns.registerService(QStringLiteral("com.headunit.App%1").arg(kAppId)));
+        QVERIFY(standIns.registerObject(QStringLiteral("/com/headunit/AppLifecycle"), &m_afm,
+                                        QDBusConnection::ExportAllSlots));
+        QVERIFY(standIns.registerService(QStringLiteral("com.headunit.AppLifecycle")));
+    }
+
+    void cleanupTestCase()
+    {
+        QDBusConnection::disconnectFromBus(kStandInConnection);
+        m_standInThread.quit();
+        m_standInThread.wait();
+        qunsetenv("HEADUNIT_WATCHDOG_HANG_MS");
+        qunsetenv("HEADUNIT_WATCHDOG_RESTART_MS");
+    }
+
+    void hungClientIsRestarted()
+    {
+        SurfaceRegistry registry(nullptr);
+        DBusManager dbus;
+        QVERIFY(dbus.isAFMConnected());
+        SurfaceWatchdog watchdog(&registry, &dbus);
+        QSignalSpy recovered(&watchdog, &SurfaceWatchdog::surfaceRecovered);
+
+        QElapsedTimer clock;
+        qint64 hungAfterMs = -1;
+        connect(&watchdog, &SurfaceWatchdog::surfaceHung, this, [&](int iviId) {
+            QCOMPARE(iviId, kAppId);
+            hungAfterMs = clock.elapsed();
+        });
+
+        // The compositor's own event loop: a 10 ms timer must keep firing
+        // while the client does not answer
+        QTimer heartbeat;
+        heartbeat.setTimerType(Qt::PreciseTimer);
+        heartbeat.setInterval(10);
+        QElapsedTimer sinceBeat;
+        qint64 longestGapMs = 0;
+        int beats = 0;
+        connect(&heartbeat, &QTimer::timeout, this, [&] {
+            longestGapMs = qMax(longestGapMs, sinceBeat.restart());
+            beats++;
+        });
+
+        clock.start();
+        sinceBeat.start();
+        heartbeat.start();
+        emit registry.surfaceAdded(kAppId, nullptr, false);
+        QVERIFY(watchdog.isResponding(kAppId));
+
+        QTRY_VERIFY_WITH_TIMEOUT(hungAfterMs >= 0, kHangMs + kIntervalMs + 500);
+        QVERIFY(hungAfterMs >= kHangMs);
+        QVERIFY2(hungAfterMs <= kHangMs + kIntervalMs + kTimerSlackMs,
+                 qPrintable(QStringLiteral("reported hung after %1 ms").arg(hungAfterMs)));
+        QVERIFY(!watchdog.isResponding(kAppId));
+        QCOMPARE(watchdog.hungSurfaces(), QVariantList{ kAppId });
+
+        QTRY_COMPARE_WITH_TIMEOUT(m_afm.restarts(), QList<int>{ kAppId }, kRestartMs + kIntervalMs + 500);
+        const qint64 restartAfterMs = clock.elapsed();
+        qInfo("[SurfaceWatchdog] hung after %lld ms, restart requested after %lld ms", hungAfterMs,
+              restartAfterMs);
+
+        // Asked once, with one ping in flight the whole time
+        QTest::qWait(3 * kIntervalMs);
+        QCOMPARE(m_afm.restarts(), QList<int>{ kAppId });
+        QCOMPARE(m_app.pings(), 1);
+        QCOMPARE(recovered.count(), 0);
+
+        QVERIFY(beats >= int(clock.elapsed() / 10) / 2);
+        QVERIFY2(longestGapMs < 50, qPrintable(QStringLiteral("event loop stalled %1 ms").arg(longestGapMs)));
+
+        // The surface going away ends the episode
+        emit registry.surfaceRemoved(kAppId);
+        QCOMPARE(recovered.count(), 1);
+        QVERIFY(watchdog.hungSurfaces().isEmpty());
+    }
+
+private:
+    QThread m_standInThread;
+    HungApp m_app;
+    AppLifecycle m_afm;
+};
+
+QObject *createSurfaceWatchdogTest()
+{
+    return new SurfaceWatchdogTest;
+}
+
+#include "tst_surface_watchdog.moc"
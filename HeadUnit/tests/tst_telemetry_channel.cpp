@@ -0,0 +1,140 @@
+// tst_telemetry_channel.cpp
+#include <QTest>
+#include <QThread>
+#include <atomic>
+#include <memory>
+#include <vector>
+#include "telemetry_channel.h"
+#include "test_suites.h"
+
+using namespace telemetry;
+
+namespace {
+
+struct ReaderResult {
+    int received = 0;
+    quint64 lost = 0;
+    int outOfOrder = 0;     // value not the expected next one
+    qint64 maxLagNs = 0;    // publish to read
+};
+
+// Polls like a consumer's draw loop until count samples arrived
+ReaderResult consume(int fd, int count, const std::atomic<bool> &stop)
+{
+    ReaderResult result;
+    Reader reader;
+    if (!reader.attach(fd)) {
+        return result;
+    }
+
+    quint64 cursor = 0;
+    Sample samples[64];
+    while (result.received < count && !stop.load()) {
+        const int n = reader.read(&cursor, samples, 64, &result.lost);
+        const qint64 now = monotonicNs();
+        for (int i = 0; i < n; ++i) {
+            if (samples[i].signal != Speed || samples[i].value != double(result.received)) {
+                result.outOfOrder++;
+            }
+            result.maxLagNs = qMax(result.maxLagNs, now - samples[i].timestampNs);
+            result.received++;
+        }
+        QThread::usleep(500);
+    }
+    return result;
+}
+
+} // namespace
+
+class TelemetryChannelTest : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void fiveReadersAtOneKilohertz()
+    {
+        constexpr int kReaders = 5;
+        constexpr int kSamples = 1000;      // one second at 1 kHz
+        constexpr qint64 kPeriodNs = 1000000;
+
+        Writer writer;
+        QVERIFY(writer.create());
+
+        std::atomic<bool> stop(false);
+        ReaderResult results[kReaders];
+        std::vector<std::unique_ptr<QThread>> threads;
+        for (int i = 0; i < kReaders; ++i) {
+            ReaderResult *result = &results[i];
+            const int fd = writer.fd();
+            threads.emplace_back(QThread::create([result, fd, &stop]() {
+                *result = consume(fd, kSamples, stop);
+            }));
+            threads.back()->start();
+        }
+
+        const qint64 start = monotonicNs();
+        for (int i = 0; i < kSamples; ++i) {
+            const qint64 due = start + i * kPeriodNs;
+            while (monotonicNs() < due) {
+                QThread::usleep(100);
+            }
+            writer.publish(Speed, double(i), monotonicNs());
+        }
+        QCOMPARE(writer.written(), quint64(kSamples));
+
+        for (auto &thread : threads) {
+            if (!thread->wait(5000)) {
+                stop = true;
+                thread->wait();
+            }
+        }
+
+        for (int i = 0; i < kReaders; ++i) {
+            const ReaderResult &result = results[i];
+            qInfo("[Telemetry] reader %d: %d samples, %llu lost, max lag %.2f ms", i, result.received,
+                  static_cast<unsigned long long>(result.lost), result.maxLagNs / 1e6);
+            QCOMPARE(result.received, kSamples);
+            QCOMPARE(result.lost, quint64(0));
+            QCOMPARE(result.outOfOrder, 0);
+        }
+
+        Reader reader;
+        QVERIFY(reader.attach(writer.fd()));
+        Sample latest;
+        QVERIFY(reader.latest(Speed, &latest));
+        QCOMPARE(latest.value, double(kSamples - 1));
+        QVERIFY(!reader.latest(Battery, &latest));
+    }
+
+    void stalledReaderCountsLostSamples()
+    {
+        constexpr int kSamples = 2 * int(kCapacity);
+
+        Writer writer;
+        QVERIFY(writer.create());
+        Reader reader;
+        QVERIFY(reader.attach(writer.fd()));
+
+        for (int i = 0; i < kSamples; ++i) {
+            writer.publish(Speed, double(i), monotonicNs());
+        }
+
+        // Only the last kCapacity are still there, oldest first
+        quint64 cursor = 0;
+        quint64 lost = 0;
+        std::vector<Sample> samples(kSamples);
+        const int n = reader.read(&cursor, samples.data(), kSamples, &lost);
+        QCOMPARE(n, int(kCapacity));
+        QCOMPARE(lost, quint64(kSamples - kCapacity));
+        QCOMPARE(samples[0].value, double(kSamples - kCapacity));
+        QCOMPARE(samples[n - 1].value, double(kSamples - 1));
+        QCOMPARE(cursor, quint64(kSamples));
+    }
+};
+
+QObject *createTelemetryChannelTest()
+{
+    return new TelemetryChannelTest;
+}
+
+#include "tst_telemetry_channel.moc"
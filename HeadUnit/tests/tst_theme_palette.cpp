@@ -0,0 +1,171 @@
+// tst_theme_palette.cpp
+#include <QTest>
+#include <cmath>
+#include "test_suites.h"
+#include "theme_palette.h"
+
+namespace {
+
+double chroma(const OkLab &lab)
+{
+    return std::hypot(lab.a, lab.b);
+}
+
+// Degrees between two hues
+double hueDistance(const OkLab &x, const OkLab &y)
+{
+    const double d = std::fabs(std::atan2(x.b, x.a) - std::atan2(y.b, y.a)) * 180.0 / M_PI;
+    return d > 180.0 ? 360.0 - d : d;
+}
+
+int channelDistance(const QColor &x, const QColor &y)
+{
+    return qMax(qAbs(x.red() - y.red()), qMax(qAbs(x.green() - y.green()), qAbs(x.blue() - y.blue())));
+}
+
+} // namespace
+
+// OKLab conversions, the palette derived from a base color and the mix
+// between two palettes that theme transitions show
+class ThemePaletteTest : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void okLabRoundTrip()
+    {
+        // 4096 colors spread over the sRGB cube, grays and primaries included
+        int worst = 0;
+        for (int r = 0; r < 256; r += 17) {
+            for (int g = 0; g < 256; g += 17) {
+                for (int b = 0; b < 256; b += 17) {
+                    const QColor color(r, g, b);
+                    worst = qMax(worst, channelDistance(fromOkLab(toOkLab(color)), color));
+                }
+            }
+        }
+        QCOMPARE(worst, 0);
+    }
+
+    void outOfGamutKeepsLightnessAndHue_data()
+    {
+        QTest::addColumn<double>("L");
+        QTest::addColumn<double>("a");
+        QTest::addColumn<double>("b");
+
+        QTest::newRow("red") << 0.7 << 0.4 << 0.0;
+        QTest::newRow("blue") << 0.5 << -0.1 << -0.35;
+        QTest::newRow("green") << 0.85 << -0.3 << 0.2;
+        QTest::newRow("dark yellow") << 0.3 << 0.02 << 0.3;
+    }
+
+    void outOfGamutKeepsLightnessAndHue()
+    {
+        QFETCH(double, L);
+        QFETCH(double, a);
+        QFETCH(double, b);
+
+        // Clamped by reducing chroma, not by clipping channels
+        const OkLab wanted{ L, a, b };
+        const OkLab shown = toOkLab(fromOkLab(wanted));
+        QVERIFY(chroma(shown) < chroma(wanted));
+        QVERIFY2(std::fabs(shown.L - L) < 0.005, qPrintable(QString::number(shown.L)));
+        QVERIFY2(hueDistance(shown, wanted) < 1.0, qPrintable(QString::number(hueDistance(shown, wanted))));
+    }
+
+    void derivedColorsKeepHue()
+    {
+        // Saturated bases of every hue; hue means nothing near gray, and
+        // 8-bit rounding moves it by a degree or two at low chroma
+        for (int hue = 0; hue < 360; hue += 15) {
+            for (const QColor &base : { QColor::fromHsv(hue, 255, 255), QColor::fromHsv(hue, 230, 128) }) {
+                const OkLab lab = toOkLab(base);
+                const ThemePalette palette = ThemePalette::fromColor(base);
+                const QString where = base.name() + QLatin1Char(' ');
+
+                for (const QColor &derived : { palette.hover(), palette.pressed(), palette.accent(),
+                                               palette.disabled() }) {
+                    const OkLab shown = toOkLab(derived);
+                    if (chroma(shown) >= 0.02) {
+                        QVERIFY2(hueDistance(shown, lab) < 3.0,
+                                 qPrintable(where + derived.name()));
+                    }
+                }
+
+                // Same perceived step for every base
+                const OkLab hover = toOkLab(palette.hover());
+                const OkLab pressed = toOkLab(palette.pressed());
+                QVERIFY2(std::fabs(hover.L - qMin(1.0, lab.L + 0.07)) < 0.005, qPrintable(where + palette.hover().name()));
+                QVERIFY2(std::fabs(pressed.L - qMax(0.0, lab.L - 0.08)) < 0.005, qPrintable(where + palette.pressed().name()));
+                QVERIFY2(std::fabs(toOkLab(palette.accent()).L - lab.L) > 0.13, qPrintable(where + palette.accent().name()));
+            }
+        }
+    }
+
+    void textIsReadable()
+    {
+        QCOMPARE(ThemePalette::fromColor(QColor(0x3b, 0x82, 0xf6)).text(), QColor(Qt::white));
+        QCOMPARE(ThemePalette::fromColor(QColor(0xfd, 0xe0, 0x47)).text(), QColor(0x0f, 0x17, 0x2a));
+    }
+
+    void cacheHit()
+    {
+        const ThemePalette first = ThemePalette::fromColor(QColor(QStringLiteral("#3B82F6")));
+        const ThemePalette again = ThemePalette::fromColor(QColor(QStringLiteral("#3b82f6")));
+        QVERIFY(again.isSharedWith(first));
+        QVERIFY(ThemePalette().isSharedWith(first));
+
+        const ThemePalette other = ThemePalette::fromColor(QColor(0x22, 0xc5, 0x5e));
+        QVERIFY(!other.isSharedWith(first));
+        QVERIFY(other != first);
+        QVERIFY(ThemePalette::fromColor(QColor(0x22, 0xc5, 0x5e)).isSharedWith(other));
+    }
+
+    void mixEndpoints()
+    {
+        const ThemePalette from = ThemePalette::fromColor(QColor(0x3b, 0x82, 0xf6));
+        const ThemePalette to = ThemePalette::fromColor(QColor(0xef, 0x44, 0x44));
+
+        // The ends are the palettes themselves, so a finished transition
+        // shows exactly the target, also for t past the ends
+        QVERIFY(ThemePalette::mix(from, to, 0.0).isSharedWith(from));
+        QVERIFY(ThemePalette::mix(from, to, -0.5).isSharedWith(from));
+        QVERIFY(ThemePalette::mix(from, to, 1.0).isSharedWith(to));
+        QVERIFY(ThemePalette::mix(from, to, 1.5).isSharedWith(to));
+        QVERIFY(ThemePalette::mix(from, from, 0.5).isSharedWith(from));
+
+        // Next to the ends, one 8-bit step at most from them
+        QVERIFY(channelDistance(ThemePalette::mix(from, to, 1e-6).base(), from.base()) <= 1);
+        QVERIFY(channelDistance(ThemePalette::mix(from, to, 1.0 - 1e-6).accent(), to.accent()) <= 1);
+    }
+
+    void mixMidpoint()
+    {
+        const ThemePalette from = ThemePalette::fromColor(QColor(0x3b, 0x82, 0xf6));
+        const ThemePalette to = ThemePalette::fromColor(QColor(0xef, 0x44, 0x44));
+        const ThemePalette half = ThemePalette::mix(from, to, 0.5);
+        QVERIFY(!half.isSharedWith(from) && !half.isSharedWith(to));
+
+        // Halfway in OKLab, every color of the palette
+        const auto check = [](const QColor &x, const QColor &y, const QColor &mid) {
+            const OkLab a = toOkLab(x);
+            const OkLab b = toOkLab(y);
+            const OkLab m = toOkLab(mid);
+            return std::fabs(m.L - (a.L + b.L) / 2) < 0.005 && std::fabs(m.a - (a.a + b.a) / 2) < 0.005
+                   && std::fabs(m.b - (a.b + b.b) / 2) < 0.005;
+        };
+        QVERIFY(check(from.base(), to.base(), half.base()));
+        QVERIFY(check(from.hover(), to.hover(), half.hover()));
+        QVERIFY(check(from.pressed(), to.pressed(), half.pressed()));
+        QVERIFY(check(from.accent(), to.accent(), half.accent()));
+        QVERIFY(check(from.text(), to.text(), half.text()));
+        QVERIFY(check(from.disabled(), to.disabled(), half.disabled()));
+    }
+};
+
+QObject *createThemePaletteTest()
+{
+    return new ThemePaletteTest;
+}
+
+#include "tst_theme_palette.moc"
@@ -0,0 +1,197 @@
+// tst_trace_log.cpp
+#include <QFileInfo>
+#include <QTemporaryDir>
+#include <QTest>
+#include <climits>
+#include "test_suites.h"
+#include "trace_log.h"
+
+namespace {
+
+const QString kPath = QStringLiteral("/com/headunit/VehicleData");
+const QString kInterface = QStringLiteral("com.headunit.VehicleData");
+
+can_frame makeFrame(canid_t id, quint8 seed)
+{
+    can_frame frame = {};
+    frame.can_id = id;
+    frame.can_dlc = quint8(seed % (CAN_MAX_DLEN + 1));
+    for (int i = 0; i < frame.can_dlc; ++i) {
+        frame.data[i] = quint8(seed + i);
+    }
+    return frame;
+}
+
+} // namespace
+
+// Write -> read of every record kind, and what a reader makes of a file
+// whose recorder died mid-block
+class TraceLogTest : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase()
+    {
+        QVERIFY(m_dir.isValid());
+    }
+
+    void signalValueKeepsType_data()
+    {
+        QTest::addColumn<QVariant>("value");
+        QTest::addColumn<int>("replayed");     // QMetaType id
+
+        QTest::newRow("double") << QVariant(-12.5) << int(QMetaType::Double);
+        QTest::newRow("float") << QVariant(0.25f) << int(QMetaType::Double);
+        QTest::newRow("bool") << QVariant(true) << int(QMetaType::Bool);
+        QTest::newRow("uchar") << QVariant::fromValue(uchar(255)) << int(QMetaType::UChar);
+        QTest::newRow("short") << QVariant::fromValue(qint16(SHRT_MIN)) << int(QMetaType::Short);
+        QTest::newRow("ushort") << QVariant::fromValue(quint16(USHRT_MAX)) << int(QMetaType::UShort);
+        QTest::newRow("int") << QVariant(INT_MIN) << int(QMetaType::Int);
+        QTest::newRow("uint") << QVariant(UINT_MAX) << int(QMetaType::UInt);
+        QTest::newRow("longlong") << QVariant(qint64(LLONG_MIN)) << int(QMetaType::LongLong);
+        QTest::newRow("ulonglong") << QVariant(quint64(ULLONG_MAX)) << int(QMetaType::ULongLong);
+        QTest::newRow("string") << QVariant(QStringLiteral("D")) << int(QMetaType::QString);
+    }
+
+    void signalValueKeepsType()
+    {
+        QFETCH(QVariant, value);
+        QFETCH(int, replayed);
+
+        const QString file = m_dir.filePath(QStringLiteral("value.hutr"));
+        trace::Writer writer;
+        QVERIFY(writer.open(file));
+        QVERIFY(writer.writeSignal(1000, kPath, kInterface, QStringLiteral("Changed"), value));
+        writer.close();
+
+        trace::Reader reader;
+        QVERIFY2(reader.open(file), qPrintable(reader.errorString()));
+        trace::Record record;
+        QVERIFY2(reader.next(&record), qPrintable(reader.errorString()));
+        QCOMPARE(record.type, trace::SignalRecord);
+        QCOMPARE(record.timestampNs, qint64(1000));
+        QCOMPARE(record.path, kPath);
+        QCOMPARE(record.interface, kInterface);
+        QCOMPARE(record.member, QStringLiteral("Changed"));
+        QCOMPARE(record.value.metaType().id(), replayed);
+        QVERIFY(QVariant::compare(record.value, value) == QPartialOrdering::Equivalent);
+        QVERIFY(!reader.next(&record));
+        QVERIFY(reader.errorString().isEmpty());
+    }
+
+    void unsupportedValueIsRejected()
+    {
+        const QString file = m_dir.filePath(QStringLiteral("unsupported.hutr"));
+        trace::Writer writer;
+        QVERIFY(writer.open(file));
+        QVERIFY(!writer.writeSignal(1000, kPath, kInterface, QStringLiteral("Changed"),
+                                    QVariant(QStringList{ QStringLiteral("P") })));
+        QVERIFY(!writer.writeSignal(1000, kPath, kInterface, QStringLiteral("Changed"), QVariant()));
+        QCOMPARE(writer.records(), quint64(0));
+        writer.close();
+
+        trace::Reader reader;
+        QVERIFY(reader.open(file));
+        trace::Record record;
+        QVERIFY(!reader.next(&record));
+        QVERIFY(reader.errorString().isEmpty());
+    }
+
+    void framesAcrossBlocks()
+    {
+        // More than one block by size, timestamps going back once (clock step)
+        const QString file = m_dir.filePath(QStringLiteral("frames.hutr"));
+        const int count = 3 * trace::kBlockSize / 10;
+        trace::Writer writer;
+        QVERIFY(writer.open(file));
+        for (int i = 0; i < count; ++i) {
+            const qint64 stamp = i == count / 2 ? 5 : 1000000LL * i;
+            writer.writeFrame(stamp, makeFrame(canid_t(i % 0x800), quint8(i)));
+        }
+        writer.writeFrame(0, makeFrame(0x12345678u | CAN_EFF_FLAG, 8));
+        writer.close();
+
+        trace::Reader reader;
+        QVERIFY(reader.open(file));
+        trace::Record record;
+        for (int i = 0; i < count; ++i) {
+            QVERIFY2(reader.next(&record), qPrintable(QStringLiteral("record %1: %2").arg(i).arg(reader.errorString())));
+            const can_frame expected = makeFrame(canid_t(i % 0x800), quint8(i));
+            QCOMPARE(record.type, trace::FrameRecord);
+            QCOMPARE(record.timestampNs, i == count / 2 ? 5 : 1000000LL * i);
+            QCOMPARE(record.frame.can_id, expected.can_id);
+            QCOMPARE(record.frame.can_dlc, expected.can_dlc);
+            QVERIFY(memcmp(record.frame.data, expected.data, expected.can_dlc) == 0);
+        }
+        QVERIFY(reader.next(&record));
+        QCOMPARE(record.frame.can_id, canid_t(0x12345678u | CAN_EFF_FLAG));
+        QVERIFY(!reader.next(&record));
+        QVERIFY(reader.errorString().isEmpty());
+    }
+
+    void truncatedFinalBlock_data()
+    {
+        QTest::addColumn<int>("cut");
+        QTest::addColumn<QString>("error");
+
+        // Bytes of the last block left in the file
+        QTest::newRow("mid data") << 10 << QStringLiteral("truncated block");
+        QTest::newRow("header only") << 4 << QStringLiteral("truncated block");
+        QTest::newRow("mid header") << 2 << QStringLiteral("truncated block header");
+    }
+
+    void truncatedFinalBlock()
+    {
+        QFETCH(int, cut);
+        QFETCH(QString, error);
+
+        // Two complete blocks, then the one a crashed recorder left behind
+        const QString file = m_dir.filePath(QStringLiteral("truncated.hutr"));
+        qint64 completeSize = 0;
+        trace::Writer writer;
+        QVERIFY(writer.open(file));
+        for (int block = 0; block < 3; ++block) {
+            for (int i = 0; i < 100; ++i) {
+                writer.writeFrame(qint64(block * 100 + i) * 1000, makeFrame(0x101, quint8(i)));
+            }
+            writer.writeSignal(qint64(block * 100 + 99) * 1000, kPath, kInterface,
+                               QStringLiteral("SpeedChanged"), QVariant(double(block)));
+            QVERIFY(writer.flush());
+            if (block == 1) {
+                completeSize = QFileInfo(file).size();
+            }
+        }
+        writer.close();
+
+        QFile damaged(file);
+        QVERIFY(damaged.resize(completeSize + cut));
+
+        trace::Reader reader;
+        QVERIFY(reader.open(file));
+        trace::Record record;
+        int frames = 0;
+        int signalRecords = 0;
+        while (reader.next(&record)) {
+            if (record.type == trace::FrameRecord) {
+                frames++;
+            } else {
+                signalRecords++;
+            }
+        }
+        QCOMPARE(frames, 200);
+        QCOMPARE(signalRecords, 2);
+        QCOMPARE(record.value.toDouble(), 1.0);
+        QCOMPARE(reader.errorString(), error);
+    }
+
+private:
+    QTemporaryDir m_dir;
+};
+
+QObject *createTraceLogTest()
+{
+    return new TraceLogTest;
+}
+
+#include "tst_trace_log.moc"
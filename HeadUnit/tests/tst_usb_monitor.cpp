@@ -0,0 +1,170 @@
+// tst_usb_monitor.cpp
+#include <QSignalSpy>
+#include <QTest>
+#include "test_suites.h"
+#include "usb_monitor.h"
+
+namespace {
+
+const QString kDevice = QStringLiteral("/dev/sda1");
+const QString kMountPoint = QStringLiteral("/media/pi/STICK");
+
+// The system mounts every mountinfo dump has, none of them removable
+const QByteArray kSystemMounts =
+    "22 1 179:2 / / rw,noatime shared:1 - ext4 /dev/mmcblk0p2 rw\n"
+    "23 22 0:5 / /proc rw,nosuid,nodev,noexec shared:12 - proc proc rw\n"
+    "24 22 179:1 / /boot rw,noatime shared:2 - vfat /dev/mmcblk0p1 rw\n";
+
+QByteArray mountLine(const QString &device, const QString &mountPoint)
+{
+    return "36 22 8:1 / " + mountPoint.toUtf8() + " rw,nosuid,nodev master:1 - vfat "
+           + device.toUtf8() + " rw,uid=1000\n";
+}
+
+QByteArray withStick()
+{
+    return kSystemMounts + mountLine(kDevice, kMountPoint);
+}
+
+} // namespace
+
+// Insert and yank sequences, udev events and mountinfo dumps played in the
+// order the kernel and the automounter produce them
+class UsbMonitorTest : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void init()
+    {
+        m_monitor.reset(new UsbMonitor(UsbMonitor::FedEvents));
+        m_inserted.reset(new QSignalSpy(m_monitor.data(), &UsbMonitor::deviceInserted));
+        m_removed.reset(new QSignalSpy(m_monitor.data(), &UsbMonitor::deviceRemoved));
+        m_monitor->applyMountInfo(kSystemMounts);
+        QVERIFY(m_monitor->mountedDevices().isEmpty());
+    }
+
+    void parsesMountInfo()
+    {
+        const QByteArray dump = kSystemMounts + mountLine(kDevice, QStringLiteral("/media/pi/MY\\040STICK"));
+        const QList<QPair<QString, QString>> mounts = UsbMonitor::parseMountInfo(dump);
+        QCOMPARE(mounts.size(), 4);
+        QCOMPARE(mounts.first(), qMakePair(QStringLiteral("/"), QStringLiteral("/dev/mmcblk0p2")));
+        QCOMPARE(mounts.last(), qMakePair(QStringLiteral("/media/pi/MY STICK"), kDevice));
+    }
+
+    void addThenMount()
+    {
+        m_monitor->applyUdevEvent(QStringLiteral("add"), kDevice);
+        QCOMPARE(m_inserted->count(), 0);
+        QTest::qSleep(20);
+
+        m_monitor->applyMountInfo(withStick());
+        QCOMPARE(m_inserted->count(), 1);
+        QCOMPARE(m_inserted->takeFirst().at(0).toString(), kMountPoint);
+        QCOMPARE(m_monitor->mountedDevices(), QStringList{ kMountPoint });
+        // Timed from the udev add, not from the mount
+        QVERIFY(m_monitor->elapsedSinceInsert(kMountPoint) >= 20);
+
+        // The same table again is no new insert
+        m_monitor->applyMountInfo(withStick());
+        QCOMPARE(m_inserted->count(), 0);
+        QCOMPARE(m_removed->count(), 0);
+    }
+
+    void mountWithoutUdev()
+    {
+        // Only removable devices under the automount roots count
+        m_monitor->applyMountInfo(kSystemMounts + mountLine(QStringLiteral("/dev/nvme0n1p1"), kMountPoint)
+                                  + mountLine(kDevice, QStringLiteral("/srv/data")));
+        QCOMPARE(m_inserted->count(), 0);
+
+        m_monitor->applyMountInfo(withStick());
+        QCOMPARE(m_inserted->count(), 1);
+        QVERIFY(m_monitor->elapsedSinceInsert(kMountPoint) >= 0);
+        QCOMPARE(m_monitor->elapsedSinceInsert(QStringLiteral("/media/pi/OTHER")), qint64(-1));
+    }
+
+    void unmount()
+    {
+        m_monitor->applyUdevEvent(QStringLiteral("add"), kDevice);
+        m_monitor->applyMountInfo(withStick());
+
+        // Ejected from the UI: gone from mountinfo, the stick still plugged
+        m_monitor->applyMountInfo(kSystemMounts);
+        QCOMPARE(m_removed->count(), 1);
+        QCOMPARE(m_removed->takeFirst().at(0).toString(), kMountPoint);
+        QVERIFY(m_monitor->mountedDevices().isEmpty());
+    }
+
+    void lazyUnmount()
+    {
+        m_monitor->applyUdevEvent(QStringLiteral("add"), kDevice);
+        m_monitor->applyMountInfo(withStick());
+
+        // Yanked: udev reports it long before the lazy unmount completes
+        m_monitor->applyUdevEvent(QStringLiteral("remove"), kDevice);
+        QCOMPARE(m_removed->count(), 1);
+        QCOMPARE(m_removed->takeFirst().at(0).toString(), kMountPoint);
+        QVERIFY(m_monitor->mountedDevices().isEmpty());
+
+        // Other mount changes while it is still listed bring nothing back
+        m_monitor->applyMountInfo(withStick() + mountLine(QStringLiteral("/dev/sdb1"), QStringLiteral("/srv/x")));
+        QCOMPARE(m_inserted->count(), 0);
+        QVERIFY(m_monitor->mountedDevices().isEmpty());
+
+        // Nor is it reported a second time when it finally goes
+        m_monitor->applyMountInfo(kSystemMounts);
+        QCOMPARE(m_removed->count(), 0);
+        QCOMPARE(m_inserted->count(), 0);
+    }
+
+    void reinsertAfterUnmount()
+    {
+        m_monitor->applyUdevEvent(QStringLiteral("add"), kDevice);
+        m_monitor->applyMountInfo(withStick());
+        m_monitor->applyUdevEvent(QStringLiteral("remove"), kDevice);
+        m_monitor->applyMountInfo(kSystemMounts);
+        m_inserted->clear();
+        m_removed->clear();
+
+        m_monitor->applyUdevEvent(QStringLiteral("add"), kDevice);
+        m_monitor->applyMountInfo(withStick());
+        QCOMPARE(m_inserted->count(), 1);
+        QCOMPARE(m_removed->count(), 0);
+        QCOMPARE(m_monitor->mountedDevices(), QStringList{ kMountPoint });
+    }
+
+    void reinsertDuringLazyUnmount()
+    {
+        m_monitor->applyUdevEvent(QStringLiteral("add"), kDevice);
+        m_monitor->applyMountInfo(withStick());
+        m_monitor->applyUdevEvent(QStringLiteral("remove"), kDevice);
+        m_inserted->clear();
+        m_removed->clear();
+
+        // Plugged back in before the old mount went away: the same node
+        // and mount point, but a fresh udev add makes it a new insert
+        m_monitor->applyUdevEvent(QStringLiteral("add"), kDevice);
+        m_monitor->applyMountInfo(withStick());
+        QCOMPARE(m_inserted->count(), 1);
+        QCOMPARE(m_inserted->takeFirst().at(0).toString(), kMountPoint);
+        QCOMPARE(m_monitor->mountedDevices(), QStringList{ kMountPoint });
+
+        m_monitor->applyMountInfo(withStick());
+        QCOMPARE(m_inserted->count(), 0);
+        QCOMPARE(m_removed->count(), 0);
+    }
+
+private:
+    QScopedPointer<UsbMonitor> m_monitor;
+    QScopedPointer<QSignalSpy> m_inserted;
+    QScopedPointer<QSignalSpy> m_removed;
+};
+
+QObject *createUsbMonitorTest()
+{
+    return new UsbMonitorTest;
+}
+
+#include "tst_usb_monitor.moc"
@@ -0,0 +1,164 @@
+#!/bin/sh
+
+# SetGear -> request frame 0x102 -> vehicle reports the gear on 0x102 ->
+# GearChanged/GetGear, through a virtual CAN interface:
+#
+#   sudo sh "Shell Scripts/setup_vcan.sh" vcan0
+#   sh vcan_gear_roundtrip.sh ./headunit-vehicledata
+#
+# The vehicle is a stand-in built from candump and cansend that reports a
+# requested gear after 50 ms. Without it a request must not be confirmed:
+# the daemon does not read back its own frames.
+#
+# Runs the daemon on a private session bus. Exits 77 (skipped) when the
+# interface, the D-Bus tools or can-utils are missing. VCAN_IFACE overrides
+# vcan0.
+
+DAEMON="$1"
+IFACE="${VCAN_IFACE:-vcan0}"
+SKIP=77
+
+SERVICE=com.headunit.VehicleData
+OBJECT=/com/headunit/VehicleData
+INTERFACE=com.headunit.VehicleData
+
+GREEN='\033[0;32m'
+RED='\033[0;31m'
+NC='\033[0m'
+
+log_info() {
+    printf "${GREEN}[GearRoundTrip]${NC} %s\n" "$1"
+}
+
+log_error() {
+    printf "${RED}[GearRoundTrip]${NC} %s\n" "$1"
+}
+
+if [ -z "$DAEMON" ] || [ ! -x "$DAEMON" ]; then
+    log_error "Usage: $0 <path to headunit-vehicledata>"
+    exit 1
+fi
+
+for tool in dbus-send dbus-run-session ip candump cansend; do
+    if ! command -v "$tool" >/dev/null 2>&1; then
+        log_info "$tool not found - skipping"
+        exit $SKIP
+    fi
+done
+
+if ! ip link show dev "$IFACE" up 2>/dev/null | grep -q "$IFACE"; then
+    log_info "$IFACE is not up (see setup_vcan.sh) - skipping"
+    exit $SKIP
+fi
+
+# Everything below runs on its own session bus
+if [ -z "$GEAR_ROUNDTRIP_BUS" ]; then
+    GEAR_ROUNDTRIP_BUS=1 exec dbus-run-session -- sh "$0" "$@"
+fi
+
+call() {
+    method="$1"
+    shift
+    dbus-send --session --print-reply=literal --dest=$SERVICE $OBJECT "$INTERFACE.$method" "$@" 2>/dev/null \
+        | sed 's/^ *//'
+}
+
+# Polls until the method's reply contains the expected text; 5 s at most
+wait_for() {
+    tries=0
+    while [ $tries -lt 50 ]; do
+        if call "$1" | grep -q "$2"; then
+            return 0
+        fi
+        tries=$((tries + 1))
+        sleep 0.1
+    done
+    return 1
+}
+
+# Vehicle stand-in: reports each newly requested gear once. It also sees
+# its own reports (another socket), which the last-value check ignores.
+vehicle() {
+    last=""
+    while read -r stamp iface frame; do
+        data="${frame#*#}"
+        if [ "$data" != "$last" ]; then
+            last="$data"
+            sleep 0.05
+            cansend "$IFACE" "102#$data"
+        fi
+    done
+}
+
+LOG_DIR=$(mktemp -d)
+PIDS=""
+
+cleanup() {
+    for pid in $PIDS; do
+        kill "$pid" 2>/dev/null
+    done
+    wait 2>/dev/null
+    rm -rf "$LOG_DIR"
+}
+trap cleanup EXIT
+
+if command -v dbus-monitor >/dev/null 2>&1; then
+    dbus-monitor --session "type='signal',interface='$INTERFACE',member='GearChanged'" \
+        > "$LOG_DIR/signals.log" 2>/dev/null &
+    PIDS="$PIDS $!"
+    MONITOR=1
+fi
+
+CAN_IFACE="$IFACE" "$DAEMON" --battery none > "$LOG_DIR/daemon.log" 2>&1 &
+PIDS="$PIDS $!"
+
+if ! wait_for IsCanConnected true; then
+    log_error "Daemon did not come up on $IFACE"
+    cat "$LOG_DIR/daemon.log"
+    exit 1
+fi
+log_info "Daemon connected to $IFACE"
+
+status=0
+
+# No vehicle on the bus: the request goes out but nothing confirms it
+call SetGear string:D >/dev/null
+sleep 1
+if call GetGear | grep -q D; then
+    log_error "D confirmed without a vehicle report (own frame read back?)"
+    status=1
+else
+    log_info "Unanswered request not confirmed"
+fi
+
+mkfifo "$LOG_DIR/frames"
+candump -L "$IFACE,102:7FF" > "$LOG_DIR/frames" &
+PIDS="$PIDS $!"
+vehicle < "$LOG_DIR/frames" &
+PIDS="$PIDS $!"
+sleep 0.2
+
+for gear in R N D P; do
+    call SetGear string:$gear >/dev/null
+    if wait_for GetGear "$gear"; then
+        log_info "$gear reported by the vehicle"
+    else
+        log_error "$gear not reported, gear is $(call GetGear)"
+        status=1
+    fi
+done
+
+if [ -n "$MONITOR" ]; then
+    sleep 0.2
+    for gear in R N D P; do
+        if ! grep -q "string \"$gear\"" "$LOG_DIR/signals.log"; then
+            log_error "No GearChanged $gear"
+            status=1
+        fi
+    done
+fi
+
+if [ $status -ne 0 ]; then
+    cat "$LOG_DIR/daemon.log"
+fi
+exit $status
@@ -1,57 +1,162 @@
 #include "theme_client.h"
 #include <QDebug>
+#include <QFile>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+// Theme snapshot written by PythonScripts/theme_service.py: native byte
+// order, replaced by rename on every change, so a reader never sees a
+// partial write. A newer version may append fields.
+struct ThemeSnapshot {
+    quint32 magic;
+    quint32 version;
+    quint32 argb;           // base color, 0xAARRGGBB
+};
+
+constexpr quint32 kSnapshotMagic = 0x48555448;     // "HUTH"
+constexpr quint32 kSnapshotVersion = 1;
+
+const char kThemeService[] = "com.piracer.dashboard";
+const char kThemePath[] = "/com/piracer/dashboard";
+
+constexpr int kDefaultTransitionMs = 300;
+// Ticks further apart than a 60 Hz frame (plus slack) mean a missed frame
+constexpr qint64 kFrameBudgetNs = 1000000000 / 60 + 1000000;
+
+QString snapshotPath()
+{
+    return qEnvironmentVariable("XDG_RUNTIME_DIR", "/tmp") + "/headunit-theme";
+}
+
+} // namespace
 
 ThemeClient::ThemeClient(QObject *parent)
     : QObject(parent)
     , m_interface(nullptr)
-    , m_themeColor("#3b82f6")  // Default blue
+    , m_transition(new QVariantAnimation(this))
+    , m_lastFrameNs(0)
+    , m_frames(0)
+    , m_slowFrames(0)
+    , m_maxFrameNs(0)
 {
+    m_startup.start();
+
+    bool ok = false;
+    const int transitionMs = qEnvironmentVariableIntValue("HEADUNIT_THEME_TRANSITION_MS", &ok);
+    m_transition->setDuration(ok && transitionMs >= 0 ? transitionMs : kDefaultTransitionMs);
+    m_transition->setStartValue(0.0);
+    m_transition->setEndValue(1.0);
+    m_transition->setEasingCurve(QEasingCurve::InOutQuad);
+    connect(m_transition, &QVariantAnimation::valueChanged, this, &ThemeClient::onTransitionFrame);
+    connect(m_transition, &QVariantAnimation::finished, this, &ThemeClient::onTransitionFinished);
+
+    // The snapshot first, so the first frame has the color before any D-Bus
+    // round trip
+    QColor snapshot;
+    const bool haveSnapshot = readSnapshot(&snapshot);
+    if (haveSnapshot) {
+        // Nothing is bound yet, no notification needed
+        m_palette = ThemePalette::fromColor(snapshot);
+        m_target = m_palette;
+        qDebug() << "ThemeClient: Theme color" << m_palette.base().name()
+                 << "from snapshot in" << m_startup.nsecsElapsed() / 1000 << "us";
+    }
+
     setupDBusConnection();
-    requestCurrentColor();
+
+    // The service rewrites the snapshot before it signals, so a change made
+    // before the subscription took effect is in the snapshot now
+    QColor current;
+    if (!haveSnapshot) {
+        requestCurrentColor();
+    } else if (readSnapshot(&current) && current != snapshot) {
+        applyColor(current.name(QColor::HexArgb), false);
+    }
 }
 
-void ThemeClient::setupDBusConnection()
+bool ThemeClient::readSnapshot(QColor *color) const
 {
-    m_interface = new QDBusInterface(
-        "com.piracer.dashboard",
-        "/com/piracer/dashboard",
-        "com.piracer.dashboard",
-        QDBusConnection::sessionBus(),
-        this
-    );
-    
-    if (!m_interface->isValid()) {
-        qWarning() << "Theme service not available:"
-                   << QDBusConnection::sessionBus().lastError().message();
-        qWarning() << "Using default theme color";
-        return;
+    const QByteArray path = QFile::encodeName(snapshotPath());
+    const int fd = ::open(path.constData(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return false;
     }
-    
-    // Connect to ColorChanged signal
+
+    ThemeSnapshot snapshot;
+    struct stat st;
+    void *map = MAP_FAILED;
+    if (fstat(fd, &st) == 0 && st.st_size >= qint64(sizeof(snapshot))) {
+        map = mmap(nullptr, sizeof(snapshot), PROT_READ, MAP_SHARED, fd, 0);
+    }
+    ::close(fd);
+    if (map == MAP_FAILED) {
+        qWarning() << "ThemeClient: Unreadable theme snapshot" << path;
+        return false;
+    }
+    memcpy(&snapshot, map, sizeof(snapshot));
+    munmap(map, sizeof(snapshot));
+
+    if (snapshot.magic != kSnapshotMagic || snapshot.version < kSnapshotVersion) {
+        qWarning() << "ThemeClient: Unknown theme snapshot format in" << path;
+        return false;
+    }
+
+    *color = QColor::fromRgba(snapshot.argb);
+    return true;
+}
+
+void ThemeClient::setupDBusConnection()
+{
+    // A plain match rule: no introspection, and it holds while the service
+    // is not running yet
     bool connected = QDBusConnection::sessionBus().connect(
-        "com.piracer.dashboard",
-        "/com/piracer/dashboard",
-        "com.piracer.dashboard",
+        kThemeService,
+        kThemePath,
+        kThemeService,
         "ColorChanged",
         this,
         SLOT(onColorChangedSignal(QString))
     );
     
     if (connected) {
-        qDebug() << "ThemeClient: Connected to theme service";
+        qDebug() << "ThemeClient: Subscribed to theme changes";
     } else {
-        qWarning() << "ThemeClient: Failed to connect to ColorChanged signal";
+        qWarning() << "ThemeClient: Failed to connect to ColorChanged signal:"
+                   << QDBusConnection::sessionBus().lastError().message();
+    }
+}
+
+QDBusInterface *ThemeClient::themeInterface()
+{
+    // Created on first use: constructing it introspects the service
+    if (!m_interface) {
+        m_interface = new QDBusInterface(kThemeService, kThemePath, kThemeService,
+                                         QDBusConnection::sessionBus(), this);
+    }
+    if (!m_interface->isValid()) {
+        qWarning() << "Theme service not available:"
+                   << QDBusConnection::sessionBus().lastError().message();
+        // Introspected again next time, the service may have started since
+        delete m_interface;
+        m_interface = nullptr;
     }
+    return m_interface;
 }
 
 void ThemeClient::requestCurrentColor()
 {
-    if (!m_interface || !m_interface->isValid()) {
-        qWarning() << "Cannot request color - service not available";
+    QDBusInterface *theme = themeInterface();
+    if (!theme) {
+        qWarning() << "Cannot request color - using default theme color";
         return;
     }
     
-    QDBusPendingReply<QString> reply = m_interface->asyncCall("GetColor");
+    QDBusPendingReply<QString> reply = theme->asyncCall("GetColor");
     auto *watcher = new QDBusPendingCallWatcher(reply, this);
     connect(watcher, &QDBusPendingCallWatcher::finished,
             this, &ThemeClient::onGetColorFinished);
@@ -59,8 +164,9 @@ void ThemeClient::requestCurrentColor()
 
 void ThemeClient::setColor(const QString &color)
 {
-    if (m_interface && m_interface->isValid()) {
-        m_interface->call("SetColor", color);
+    QDBusInterface *theme = themeInterface();
+    if (theme) {
+        theme->call("SetColor", color);
         qDebug() << "ThemeClient: Set color to" << color;
     } else {
         qWarning() << "Cannot set color - service not available";
@@ -69,56 +175,89 @@ void ThemeClient::setColor(const QString &color)
 
 void ThemeClient::onColorChangedSignal(const QString &color)
 {
-    if (m_themeColor != color) {
-        m_themeColor = color;
-        qDebug() << "ThemeClient: Theme color changed to:" << color;
-        emit themeColorChanged();
-    }
+    applyColor(color, true);
 }
 
-void ThemeClient::onGetColorFinished(QDBusPendingCallWatcher *watcher)
+void ThemeClient::applyColor(const QString &color, bool animate)
 {
-    QDBusPendingReply<QString> reply = *watcher;
-    
-    if (reply.isError()) {
-        qWarning() << "Failed to get color from service:"
-                   << reply.error().message();
-    } else {
-        QString color = reply.value();
-        if (m_themeColor != color) {
-            m_themeColor = color;
-            qDebug() << "ThemeClient: Initial color received:" << color;
-            emit themeColorChanged();
+    const QColor base(color);
+    if (!base.isValid()) {
+        qWarning() << "ThemeClient: Ignoring invalid color" << color;
+        return;
+    }
+
+    // Compared as colors: "#3B82F6" and "#3b82f6" are no change
+    const ThemePalette palette = ThemePalette::fromColor(base);
+    if (palette == m_target) {
+        return;
+    }
+    m_target = palette;
+    qDebug() << "ThemeClient: Theme color changed to:" << m_target.base().name();
+
+    const bool wasRunning = transitioning();
+    m_transition->stop();
+    if (!animate || m_transition->duration() == 0) {
+        m_palette = m_target;
+        emit themeColorChanged();
+        if (wasRunning) {
+            emit transitioningChanged();
         }
+        return;
     }
-    
-    watcher->deleteLater();
-}
 
-QString ThemeClient::buttonHoverColor() const
-{
-    QColor base(m_themeColor);
-    return lighten(base, 20).name();
+    // From what is on screen, also when a transition was still running
+    m_from = m_palette;
+    m_frames = 0;
+    m_slowFrames = 0;
+    m_maxFrameNs = 0;
+    m_lastFrameNs = 0;
+    m_frameClock.start();
+    m_transition->start();
+    if (!wasRunning) {
+        emit transitioningChanged();
+    }
 }
 
-QString ThemeClient::buttonPressedColor() const
+void ThemeClient::onTransitionFrame(const QVariant &progress)
 {
-    QColor base(m_themeColor);
-    return darken(base, 20).name();
-}
+    const qint64 now = m_frameClock.nsecsElapsed();
+    if (m_frames > 0) {
+        const qint64 frameNs = now - m_lastFrameNs;
+        m_maxFrameNs = qMax(m_maxFrameNs, frameNs);
+        if (frameNs > kFrameBudgetNs) {
+            m_slowFrames++;
+        }
+    }
+    m_lastFrameNs = now;
+    m_frames++;
 
-QString ThemeClient::accentColor() const
-{
-    QColor base(m_themeColor);
-    return lighten(base, 40).name();
+    m_palette = ThemePalette::mix(m_from, m_target, progress.toDouble());
+    emit themeColorChanged();
 }
 
-QColor ThemeClient::lighten(const QColor &color, int amount) const
+void ThemeClient::onTransitionFinished()
 {
-    return color.lighter(100 + amount);
+    if (m_palette.base() != m_target.base()) {
+        m_palette = m_target;
+        emit themeColorChanged();
+    }
+    qDebug() << "ThemeClient: Transition took" << m_frameClock.elapsed() << "ms," << m_frames
+             << "frames, longest" << m_maxFrameNs / 1000 << "us," << m_slowFrames << "over 60 Hz";
+    emit transitioningChanged();
 }
 
-QColor ThemeClient::darken(const QColor &color, int amount) const
+void ThemeClient::onGetColorFinished(QDBusPendingCallWatcher *watcher)
 {
-    return color.darker(100 + amount);
+    QDBusPendingReply<QString> reply = *watcher;
+    
+    if (reply.isError()) {
+        qWarning() << "Failed to get color from service:"
+                   << reply.error().message();
+    } else {
+        qDebug() << "ThemeClient: Initial color received after"
+                 << m_startup.elapsed() << "ms over D-Bus";
+        applyColor(reply.value(), false);
+    }
+    
+    watcher->deleteLater();
 }
@@ -4,34 +4,64 @@
 #include <QObject>
 #include <QString>
 #include <QColor>
+#include <QElapsedTimer>
+#include <QVariantAnimation>
 #include <QDBusInterface>
 #include <QDBusConnection>
 #include <QDBusPendingCallWatcher>
 #include <QDBusPendingReply>
+#include "theme_palette.h"
 
+// Theme colors for QML.
+//
+// The whole palette is derived once per theme change (see ThemePalette) and
+// the getters only return its precomputed colors, so a theme change is one
+// themeColorChanged() and bindings re-read values instead of deriving them.
+//
+// The starting color comes from the snapshot file the theme service keeps
+// in XDG_RUNTIME_DIR, read first in the constructor, so the first frame
+// already has the right colors. After that D-Bus only brings ColorChanged,
+// through a match rule. The service interface, which costs an
+// introspection, is only created for GetColor (when there is no snapshot)
+// and SetColor.
+//
+// A change is a transition of the whole palette, interpolated in OKLab over
+// HEADUNIT_THEME_TRANSITION_MS (0: switch at once). The animation ticks with
+// Qt Quick's animation driver, so there is one themeColorChanged() per
+// frame for all colors together. While it runs, transitioning is true;
+// Behaviors on theme colors are disabled for that time, they would restart
+// on every frame.
 class ThemeClient : public QObject
 {
     Q_OBJECT
-    Q_PROPERTY(QString themeColor READ themeColor NOTIFY themeColorChanged)
-    Q_PROPERTY(QString buttonColor READ buttonColor NOTIFY themeColorChanged)
-    Q_PROPERTY(QString buttonHoverColor READ buttonHoverColor NOTIFY themeColorChanged)
-    Q_PROPERTY(QString buttonPressedColor READ buttonPressedColor NOTIFY themeColorChanged)
-    Q_PROPERTY(QString accentColor READ accentColor NOTIFY themeColorChanged)
+    Q_PROPERTY(QColor themeColor READ themeColor NOTIFY themeColorChanged)
+    Q_PROPERTY(QColor buttonColor READ buttonColor NOTIFY themeColorChanged)
+    Q_PROPERTY(QColor buttonHoverColor READ buttonHoverColor NOTIFY themeColorChanged)
+    Q_PROPERTY(QColor buttonPressedColor READ buttonPressedColor NOTIFY themeColorChanged)
+    Q_PROPERTY(QColor accentColor READ accentColor NOTIFY themeColorChanged)
+    Q_PROPERTY(QColor textColor READ textColor NOTIFY themeColorChanged)
+    Q_PROPERTY(QColor disabledColor READ disabledColor NOTIFY themeColorChanged)
+    Q_PROPERTY(bool transitioning READ transitioning NOTIFY transitioningChanged)
     
 public:
     explicit ThemeClient(QObject *parent = nullptr);
     
-    QString themeColor() const { return m_themeColor; }
-    QString buttonColor() const { return m_themeColor; }
-    QString buttonHoverColor() const;
-    QString buttonPressedColor() const;
-    QString accentColor() const;
+    QColor themeColor() const { return m_palette.base(); }
+    QColor buttonColor() const { return m_palette.base(); }
+    QColor buttonHoverColor() const { return m_palette.hover(); }
+    QColor buttonPressedColor() const { return m_palette.pressed(); }
+    QColor accentColor() const { return m_palette.accent(); }
+    QColor textColor() const { return m_palette.text(); }
+    QColor disabledColor() const { return m_palette.disabled(); }
+    const ThemePalette &palette() const { return m_palette; }
+    bool transitioning() const { return m_transition->state() == QAbstractAnimation::Running; }
     
     Q_INVOKABLE void requestCurrentColor();
     Q_INVOKABLE void setColor(const QString &color);
     
 signals:
     void themeColorChanged();
+    void transitioningChanged();
     
 private slots:
     void onColorChangedSignal(const QString &color);
@@ -39,11 +69,25 @@ private slots:
     
 private:
     void setupDBusConnection();
-    QColor lighten(const QColor &color, int amount) const;
-    QColor darken(const QColor &color, int amount) const;
+    bool readSnapshot(QColor *color) const;
+    QDBusInterface *themeInterface();
+    void applyColor(const QString &color, bool animate);
+    void onTransitionFrame(const QVariant &progress);
+    void onTransitionFinished();
     
-    QDBusInterface *m_interface;
-    QString m_themeColor;
+    QDBusInterface *m_interface;    // created on first GetColor or SetColor
+    ThemePalette m_palette;         // shown, between m_from and m_target in a transition
+    ThemePalette m_from;
+    ThemePalette m_target;
+    QVariantAnimation *m_transition;
+    QElapsedTimer m_startup;        // construction to the current color, logged
+
+    // Frame times of the running transition, logged when it ends
+    QElapsedTimer m_frameClock;
+    qint64 m_lastFrameNs;
+    int m_frames;
+    int m_slowFrames;
+    qint64 m_maxFrameNs;
 };
 
 #endif // THEME_CLIENT_H
@@ -0,0 +1,175 @@
+#include "theme_palette.h"
+#include <QHash>
+#include <QMutex>
+#include <QMutexLocker>
+#include <cmath>
+
+namespace {
+
+// Steps in OKLab lightness; the old lighter(120)/darker(120)/lighter(140)
+// in HSV moved dark and saturated colors far less than light ones
+constexpr double kHoverLightness = 0.07;
+constexpr double kPressedLightness = -0.08;
+constexpr double kAccentLightness = 0.14;
+constexpr double kAccentChroma = 0.9;
+// Above this the accent would wash out to white; it goes darker instead
+constexpr double kAccentMaxLightness = 0.92;
+constexpr double kDisabledLightness = 0.45;
+constexpr double kDisabledChroma = 0.25;
+
+// Text turns dark on bases lighter than this
+constexpr double kLightBase = 0.7;
+const QColor kDarkText(0x0f, 0x17, 0x2a);
+const QColor kLightText(Qt::white);
+
+// Palettes of the colors seen so far; themes only use a handful
+constexpr int kMaxCached = 64;
+
+double toLinear(double c)
+{
+    return c <= 0.04045 ? c / 12.92 : std::pow((c + 0.055) / 1.055, 2.4);
+}
+
+double fromLinear(double c)
+{
+    return c <= 0.0031308 ? c * 12.92 : 1.055 * std::pow(c, 1.0 / 2.4) - 0.055;
+}
+
+struct LinearRgb {
+    double r;
+    double g;
+    double b;
+
+    bool inGamut() const
+    {
+        constexpr double e = 1e-6;
+        return r >= -e && r <= 1 + e && g >= -e && g <= 1 + e && b >= -e && b <= 1 + e;
+    }
+};
+
+LinearRgb linearFromOkLab(const OkLab &lab)
+{
+    const double l = std::pow(lab.L + 0.3963377774 * lab.a + 0.2158037573 * lab.b, 3);
+    const double m = std::pow(lab.L - 0.1055613458 * lab.a - 0.0638541728 * lab.b, 3);
+    const double s = std::pow(lab.L - 0.0894841775 * lab.a - 1.2914855480 * lab.b, 3);
+    return {
+        4.0767416621 * l - 3.3077115913 * m + 0.2309699292 * s,
+        -1.2684380046 * l + 2.6097574011 * m - 0.3413193965 * s,
+        -0.0041960863 * l - 0.7034186147 * m + 1.7076147010 * s,
+    };
+}
+
+// Lightness moved by dL, chroma scaled, hue kept
+OkLab adjust(const OkLab &lab, double dL, double chromaScale)
+{
+    return { qBound(0.0, lab.L + dL, 1.0), lab.a * chromaScale, lab.b * chromaScale };
+}
+
+} // namespace
+
+OkLab toOkLab(const QColor &color)
+{
+    const QColor rgb = color.toRgb();
+    const double r = toLinear(rgb.redF());
+    const double g = toLinear(rgb.greenF());
+    const double b = toLinear(rgb.blueF());
+
+    const double l = std::cbrt(0.4122214708 * r + 0.5363325363 * g + 0.0514459929 * b);
+    const double m = std::cbrt(0.2119034982 * r + 0.6806995451 * g + 0.1073969566 * b);
+    const double s = std::cbrt(0.0883024619 * r + 0.2817188376 * g + 0.6299787005 * b);
+    return {
+        0.2104542553 * l + 0.7936177850 * m - 0.0040720468 * s,
+        1.9779984951 * l - 2.4285922050 * m + 0.4505937099 * s,
+        0.0259040371 * l + 0.7827717662 * m - 0.8086757660 * s,
+    };
+}
+
+QColor fromOkLab(const OkLab &lab)
+{
+    LinearRgb rgb = linearFromOkLab(lab);
+    if (!rgb.inGamut()) {
+        // Largest chroma that fits, by bisection; 12 steps are below 8 bit
+        double low = 0.0;
+        double high = 1.0;
+        for (int i = 0; i < 12; ++i) {
+            const double scale = (low + high) / 2;
+            if (linearFromOkLab({ lab.L, lab.a * scale, lab.b * scale }).inGamut()) {
+                low = scale;
+            } else {
+                high = scale;
+            }
+        }
+        rgb = linearFromOkLab({ lab.L, lab.a * low, lab.b * low });
+    }
+    return QColor::fromRgbF(float(qBound(0.0, fromLinear(rgb.r), 1.0)),
+                            float(qBound(0.0, fromLinear(rgb.g), 1.0)),
+                            float(qBound(0.0, fromLinear(rgb.b), 1.0)));
+}
+
+// ============================================================================
+// ThemePalette Implementation
+// ============================================================================
+
+ThemePalette::ThemePalette()
+    : ThemePalette(fromColor(QColor(0x3b, 0x82, 0xf6)))
+{
+}
+
+ThemePalette ThemePalette::fromColor(const QColor &base)
+{
+    static QMutex mutex;
+    static QHash<QRgb, ThemePalette> cache;
+
+    const QRgb key = base.rgb();
+    QMutexLocker locker(&mutex);
+    const auto it = cache.constFind(key);
+    if (it != cache.constEnd()) {
+        return *it;
+    }
+    if (cache.size() >= kMaxCached) {
+        cache.clear();
+    }
+    const ThemePalette palette(derive(QColor::fromRgb(key)));
+    cache.insert(key, palette);
+    return palette;
+}
+
+ThemePalette ThemePalette::mix(const ThemePalette &from, const ThemePalette &to, double t)
+{
+    if (t <= 0.0 || from.d == to.d) {
+        return from;
+    }
+    if (t >= 1.0) {
+        return to;
+    }
+
+    const auto lerp = [t](const QColor &a, const QColor &b) {
+        const OkLab x = toOkLab(a);
+        const OkLab y = toOkLab(b);
+        return fromOkLab({ x.L + (y.L - x.L) * t, x.a + (y.a - x.a) * t, x.b + (y.b - x.b) * t });
+    };
+
+    auto *data = new Data;
+    data->base = lerp(from.d->base, to.d->base);
+    data->hover = lerp(from.d->hover, to.d->hover);
+    data->pressed = lerp(from.d->pressed, to.d->pressed);
+    data->accent = lerp(from.d->accent, to.d->accent);
+    data->text = lerp(from.d->text, to.d->text);
+    data->disabled = lerp(from.d->disabled, to.d->disabled);
+    return ThemePalette(data);
+}
+
+const ThemePalette::Data *ThemePalette::derive(const QColor &base)
+{
+    const OkLab lab = toOkLab(base);
+
+    auto *data = new Data;
+    data->base = base;
+    data->hover = fromOkLab(adjust(lab, kHoverLightness, 1.0));
+    data->pressed = fromOkLab(adjust(lab, kPressedLightness, 1.0));
+    const double accentStep = lab.L + kAccentLightness > kAccentMaxLightness ? -kAccentLightness : kAccentLightness;
+    data->accent = fromOkLab(adjust(lab, accentStep, kAccentChroma));
+    data->text = lab.L > kLightBase ? kDarkText : kLightText;
+    data->disabled = fromOkLab(adjust(lab, (kDisabledLightness - lab.L) * 0.5, kDisabledChroma));
+    return data;
+}
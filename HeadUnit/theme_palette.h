@@ -0,0 +1,68 @@
+#ifndef THEME_PALETTE_H
+#define THEME_PALETTE_H
+
+#include <QColor>
+#include <QExplicitlySharedDataPointer>
+#include <QSharedData>
+
+// OKLab (Ottosson): perceptually uniform, so equal steps in L look like
+// equal steps in lightness whatever the hue. Conversions go through linear
+// sRGB; fromOkLab() maps colors outside sRGB back in by reducing chroma at
+// constant lightness and hue.
+struct OkLab {
+    double L = 0.0;     // 0..1
+    double a = 0.0;
+    double b = 0.0;
+};
+
+OkLab toOkLab(const QColor &color);
+QColor fromOkLab(const OkLab &lab);
+
+// The theme colors derived from one base color.
+//
+// Derived in OKLCH (OKLab as lightness, chroma and hue), so hover, pressed
+// and accent keep the hue of the base and differ from it by the same
+// perceived amount for every base. A palette is computed once per base color
+// and shared: fromColor() returns the cached one when the color comes back,
+// and copies only bump a reference count.
+class ThemePalette
+{
+public:
+    // Default theme blue
+    ThemePalette();
+
+    static ThemePalette fromColor(const QColor &base);
+    // Every color t of the way from one palette to the other, in OKLab.
+    // For transitions; the result is not cached.
+    static ThemePalette mix(const ThemePalette &from, const ThemePalette &to, double t);
+
+    QColor base() const { return d->base; }
+    QColor hover() const { return d->hover; }
+    QColor pressed() const { return d->pressed; }
+    QColor accent() const { return d->accent; }
+    QColor text() const { return d->text; }         // readable on base
+    QColor disabled() const { return d->disabled; }
+
+    // Same derived data, not just the same colors: a cache hit
+    bool isSharedWith(const ThemePalette &other) const { return d == other.d; }
+
+    bool operator==(const ThemePalette &other) const { return d == other.d || d->base == other.d->base; }
+    bool operator!=(const ThemePalette &other) const { return !(*this == other); }
+
+private:
+    struct Data : QSharedData {
+        QColor base;
+        QColor hover;
+        QColor pressed;
+        QColor accent;
+        QColor text;
+        QColor disabled;
+    };
+
+    explicit ThemePalette(const Data *data) : d(data) {}
+    static const Data *derive(const QColor &base);
+
+    QExplicitlySharedDataPointer<const Data> d;
+};
+
+#endif // THEME_PALETTE_H